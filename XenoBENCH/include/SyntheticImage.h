@@ -0,0 +1,66 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// This builds images that pass every check XenoReader_Open makes without needing a real disc. They have the right
+// sector count, the boot record and disc identification strings and a table of contents laid out however the layout
+// says. Files are filled with bytes that only depend on the seed, so the same layout always gives the same image.
+
+/// @brief Everything that decides what a synthetic image looks like.
+typedef struct
+{
+    /// @brief Disc the image pretends to be. This decides the sector count. 1 or 2.
+    int discNumber;
+
+    /// @brief Number of files directly in the root. These come before any directory in the table.
+    int rootFileCount;
+
+    /// @brief Number of directories in the root and the number of files in each of them.
+    int dirCount;
+    int filesPerDir;
+
+    /// @brief Sizes of files are picked evenly between these, both included.
+    uint32_t minFileSize;
+    uint32_t maxFileSize;
+
+    /// @brief Seed for the sizes and the filler.
+    uint32_t seed;
+
+    /// @brief Whether every written sector gets a real EDC and ECC. This is slow, but the image passes verification.
+    bool generateEcc;
+} SyntheticLayout;
+
+/// @brief Sets the layout to the default. This is about 70MB of files in 528 of them.
+/// @param layout Layout to set.
+void SyntheticLayout_SetDefaults(SyntheticLayout *layout);
+
+/// @brief Checks that the layout fits in the table of contents and on the disc.
+/// @param layout Layout to check.
+/// @return True if an image can be built from it.
+bool SyntheticLayout_IsValid(const SyntheticLayout *layout);
+
+/// @brief Returns the number of sectors an image of the disc has. 0 if the disc number is wrong.
+/// @param discNumber Disc number.
+size_t SyntheticImage_GetSectorCount(int discNumber);
+
+/// @brief Builds an image in memory.
+/// @param layout Layout of the image.
+/// @param sizeOut Set to the size of the image in bytes.
+/// @return Image on success. Free it with free(). NULL if the layout is invalid or memory couldn't be allocated.
+/// @note The image is allocated with calloc and only the sectors in use are touched, so the rest never gets committed.
+unsigned char *SyntheticImage_Create(const SyntheticLayout *layout, size_t *sizeOut);
+
+/// @brief Writes an image to a file.
+/// @param layout Layout of the image.
+/// @param path Path of the file. It's replaced if it already exists.
+/// @return True on success. False if the layout is invalid or the file couldn't be written.
+/// @note Sectors that aren't used are skipped over, so the file is sparse wherever the file system allows it.
+bool SyntheticImage_Write(const SyntheticLayout *layout, const char *path);
@@ -0,0 +1,299 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "SyntheticImage.h"
+
+#include "Sector.h"
+#include "SectorEcc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// These match what XenoReader_Open checks for.
+#define DISC_1_SECTOR_COUNT        305586
+#define DISC_2_SECTOR_COUNT        292815
+#define BOOT_RECORD_SECTOR         16
+#define BOOT_RECORD_OFFSET         0x28
+#define DISC_IDENTIFICATION_SECTOR 23
+#define TABLE_SECTOR               24
+#define TABLE_SECTOR_COUNT         16
+#define TABLE_ENTRY_SIZE           7
+
+/// @brief Files begin right after the table of contents.
+#define FIRST_FILE_SECTOR (TABLE_SECTOR + TABLE_SECTOR_COUNT)
+
+/// @brief This is the most entries the table can hold.
+#define MAX_ENTRY_COUNT (TABLE_SECTOR_COUNT * DATA_SIZE / TABLE_ENTRY_SIZE)
+
+/// @brief CD addresses begin two seconds in. This is how many frames that is.
+#define PREGAP_FRAME_COUNT 150
+
+/// @brief Function signature for whatever the sectors are being written to. Sectors always arrive in order.
+typedef bool (*SectorWriter)(void *context, size_t sectorNumber, const Sector *sector);
+
+/// @brief This is where a file is and how big it is.
+typedef struct
+{
+    uint32_t sector;
+    uint32_t size;
+} FileSpan;
+
+/// @brief This is the state of writing to a file.
+typedef struct
+{
+    FILE *file;
+
+    /// @brief Sector the file position is at.
+    size_t position;
+} FileWriter;
+
+static void finish_sector(Sector *sector, size_t sectorNumber, uint8_t subMode, bool generateEcc);
+static bool build_image(const SyntheticLayout *layout, SectorWriter writer, void *context);
+static bool write_memory(void *context, size_t sectorNumber, const Sector *sector);
+static bool write_file(void *context, size_t sectorNumber, const Sector *sector);
+
+/// @brief This is the xorshift generator everything random comes from.
+static inline uint32_t next_random(uint32_t *state)
+{
+    uint32_t value = *state;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+
+    return value;
+}
+
+/// @brief Mixes the seed with something else so every file gets a different stream. The state can never be zero.
+static inline uint32_t mix_seed(uint32_t seed, uint32_t value)
+{
+    const uint32_t mixed = (seed ^ 0x9E3779B9u) * 0x85EBCA6Bu + value * 0xC2B2AE35u;
+    return mixed ? mixed : 1;
+}
+
+static inline uint8_t to_bcd(size_t value) { return (uint8_t)(((value / 10) << 4) | (value % 10)); }
+
+void SyntheticLayout_SetDefaults(SyntheticLayout *layout)
+{
+    *layout = (SyntheticLayout){.discNumber    = 1,
+                                .rootFileCount = 16,
+                                .dirCount      = 8,
+                                .filesPerDir   = 64,
+                                .minFileSize   = 0x800,
+                                .maxFileSize   = 0x40000,
+                                .seed          = 1,
+                                .generateEcc   = false};
+}
+
+bool SyntheticLayout_IsValid(const SyntheticLayout *layout)
+{
+    if (SyntheticImage_GetSectorCount(layout->discNumber) == 0) { return false; }
+    if (layout->rootFileCount < 0 || layout->dirCount < 0 || layout->filesPerDir < 0) { return false; }
+    if (layout->minFileSize > layout->maxFileSize || layout->maxFileSize > INT32_MAX) { return false; }
+
+    // Every directory takes an entry of its own.
+    const int64_t entryCount = layout->rootFileCount + (int64_t)layout->dirCount * (1 + layout->filesPerDir);
+    if (entryCount > MAX_ENTRY_COUNT) { return false; }
+
+    // Worst case every file is the biggest it can be. Every file takes at least a sector.
+    const int64_t fileCount     = layout->rootFileCount + (int64_t)layout->dirCount * layout->filesPerDir;
+    const int64_t fileSectors   = layout->maxFileSize ? (layout->maxFileSize + DATA_SIZE - 1) / DATA_SIZE : 1;
+    const int64_t sectorsNeeded = FIRST_FILE_SECTOR + fileCount * fileSectors;
+
+    return sectorsNeeded <= (int64_t)SyntheticImage_GetSectorCount(layout->discNumber);
+}
+
+size_t SyntheticImage_GetSectorCount(int discNumber)
+{
+    switch (discNumber)
+    {
+        case 1: return DISC_1_SECTOR_COUNT;
+        case 2: return DISC_2_SECTOR_COUNT;
+        default: return 0;
+    }
+}
+
+unsigned char *SyntheticImage_Create(const SyntheticLayout *layout, size_t *sizeOut)
+{
+    if (!SyntheticLayout_IsValid(layout)) { return NULL; }
+
+    // calloc is used so the untouched pages never actually get committed.
+    const size_t sectorCount = SyntheticImage_GetSectorCount(layout->discNumber);
+    unsigned char *image     = calloc(sectorCount, SECTOR_SIZE);
+    if (!image) { return NULL; }
+
+    if (!build_image(layout, write_memory, image))
+    {
+        free(image);
+        return NULL;
+    }
+
+    *sizeOut = sectorCount * SECTOR_SIZE;
+
+    return image;
+}
+
+bool SyntheticImage_Write(const SyntheticLayout *layout, const char *path)
+{
+    if (!SyntheticLayout_IsValid(layout)) { return false; }
+
+    FileWriter writer = {.file = fopen(path, "wb"), .position = 0};
+    if (!writer.file) { return false; }
+
+    bool success = build_image(layout, write_file, &writer);
+
+    // Whatever is left is a hole. The last byte is written so the file is the right size.
+    const size_t imageSize = SyntheticImage_GetSectorCount(layout->discNumber) * SECTOR_SIZE;
+    if (success && writer.position * SECTOR_SIZE < imageSize)
+    {
+        success = fseek(writer.file, (long)(imageSize - 1), SEEK_SET) == 0 && fputc(0, writer.file) != EOF;
+    }
+
+    success = fclose(writer.file) == 0 && success;
+    if (!success) { remove(path); }
+
+    return success;
+}
+
+static void finish_sector(Sector *sector, size_t sectorNumber, uint8_t subMode, bool generateEcc)
+{
+    static const uint8_t SYNC_PATTERN[12] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+    memcpy(sector->syncPattern, SYNC_PATTERN, sizeof(SYNC_PATTERN));
+
+    // Addresses are minutes, seconds and frames in BCD.
+    const size_t frame    = sectorNumber + PREGAP_FRAME_COUNT;
+    sector->header.minute = to_bcd(frame / (60 * 75));
+    sector->header.second = to_bcd(frame / 75 % 60);
+    sector->header.frame  = to_bcd(frame % 75);
+    sector->header.mode   = 2;
+    sector->subHeader[0]  = (SectorSubHeader){.subMode = subMode};
+    sector->subHeader[1]  = sector->subHeader[0];
+
+    if (generateEcc) { SectorEcc_Generate((unsigned char *)sector); }
+}
+
+static bool build_image(const SyntheticLayout *layout, SectorWriter writer, void *context)
+{
+    const int fileCount = layout->rootFileCount + layout->dirCount * layout->filesPerDir;
+
+    // These are declared up here so the cleanup label never sees garbage.
+    bool success         = false;
+    unsigned char *table = calloc(TABLE_SECTOR_COUNT, DATA_SIZE);
+    FileSpan *files      = malloc(sizeof(FileSpan) * (fileCount ? fileCount : 1));
+    if (!table || !files) { goto Label_cleanup; }
+
+    // Lay out the table and the files at the same time. Files are packed back to back in the same order as the table.
+    uint32_t sizeState  = mix_seed(layout->seed, 0);
+    uint32_t nextSector = FIRST_FILE_SECTOR;
+    int entryIndex      = 0;
+    int fileIndex       = 0;
+    for (int dir = -1; dir < layout->dirCount; dir++)
+    {
+        // -1 is the root, which doesn't have an entry.
+        const int dirFileCount = dir < 0 ? layout->rootFileCount : layout->filesPerDir;
+        if (dir >= 0)
+        {
+            // Directories point at their first file and their size is the number of entries in them.
+            const int32_t size = -dirFileCount;
+            memcpy(&table[entryIndex * TABLE_ENTRY_SIZE], &nextSector, 3);
+            memcpy(&table[entryIndex * TABLE_ENTRY_SIZE + 3], &size, 4);
+            ++entryIndex;
+        }
+
+        for (int i = 0; i < dirFileCount; i++)
+        {
+            const uint32_t range = layout->maxFileSize - layout->minFileSize;
+            const uint32_t size  = layout->minFileSize + (range ? next_random(&sizeState) % (range + 1) : 0);
+            memcpy(&table[entryIndex * TABLE_ENTRY_SIZE], &nextSector, 3);
+            memcpy(&table[entryIndex * TABLE_ENTRY_SIZE + 3], &size, 4);
+            ++entryIndex;
+
+            files[fileIndex++] = (FileSpan){.sector = nextSector, .size = size};
+
+            const uint32_t sectorCount = (size + DATA_SIZE - 1) / DATA_SIZE;
+            nextSector += sectorCount ? sectorCount : 1;
+        }
+    }
+
+    // Everything before the files, in order.
+    Sector sector = {0};
+    for (size_t i = BOOT_RECORD_SECTOR; i < FIRST_FILE_SECTOR; i++)
+    {
+        memset(&sector, 0, sizeof(sector));
+        if (i == BOOT_RECORD_SECTOR)
+        {
+            // This is where a volume descriptor would be. Only the name really matters.
+            sector.data[0] = 1;
+            memcpy(&sector.data[1], "CD001", 5);
+            sector.data[6] = 1;
+            memcpy(&sector.data[BOOT_RECORD_OFFSET], "XENOGEARS", 9);
+        }
+        else if (i == DISC_IDENTIFICATION_SECTOR)
+        {
+            memcpy(sector.data, layout->discNumber == 1 ? "DS01_XENOGEARS" : "DS02_XENOGEARS", 14);
+        }
+        else if (i >= TABLE_SECTOR) { memcpy(sector.data, &table[(i - TABLE_SECTOR) * DATA_SIZE], DATA_SIZE); }
+
+        finish_sector(&sector, i, SUBMODE_DATA, layout->generateEcc);
+        if (!writer(context, i, &sector)) { goto Label_cleanup; }
+    }
+
+    // Then every file. The filler only depends on the seed and which file it is.
+    for (int i = 0; i < fileCount; i++)
+    {
+        uint32_t fillState         = mix_seed(layout->seed, (uint32_t)i + 1);
+        const uint32_t sectorCount = files[i].size ? (files[i].size + DATA_SIZE - 1) / DATA_SIZE : 1;
+        for (uint32_t j = 0; j < sectorCount; j++)
+        {
+            memset(&sector, 0, sizeof(sector));
+
+            const uint32_t offset   = j * DATA_SIZE;
+            const uint32_t dataSize = files[i].size - offset < DATA_SIZE ? files[i].size - offset : DATA_SIZE;
+            for (uint32_t k = 0; k < dataSize; k += 4)
+            {
+                const uint32_t value = next_random(&fillState);
+                memcpy(&sector.data[k], &value, dataSize - k < 4 ? dataSize - k : 4);
+            }
+
+            const bool last       = j + 1 == sectorCount;
+            const uint8_t subMode = SUBMODE_DATA | (last ? SUBMODE_END_OF_RECORD | SUBMODE_END_OF_FILE : 0);
+            finish_sector(&sector, files[i].sector + j, subMode, layout->generateEcc);
+            if (!writer(context, files[i].sector + j, &sector)) { goto Label_cleanup; }
+        }
+    }
+
+    success = true;
+
+Label_cleanup:
+    free(files);
+    free(table);
+
+    return success;
+}
+
+static bool write_memory(void *context, size_t sectorNumber, const Sector *sector)
+{
+    memcpy((unsigned char *)context + sectorNumber * SECTOR_SIZE, sector, SECTOR_SIZE);
+    return true;
+}
+
+static bool write_file(void *context, size_t sectorNumber, const Sector *sector)
+{
+    FileWriter *writer = (FileWriter *)context;
+
+    // Only seek when there's a gap. Skipping over it is what leaves the hole.
+    if (writer->position != sectorNumber && fseek(writer->file, (long)(sectorNumber * SECTOR_SIZE), SEEK_SET) != 0)
+    {
+        return false;
+    }
+
+    writer->position = sectorNumber + 1;
+
+    return fwrite(sector, 1, SECTOR_SIZE, writer->file) == SECTOR_SIZE;
+}
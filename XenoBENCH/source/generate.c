@@ -0,0 +1,89 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "SyntheticImage.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// This writes a synthetic image to disk so it can be opened with XenoREADER or handed to xeno_bench with --image.
+
+static void print_usage(const char *program);
+
+int main(int argc, const char *argv[])
+{
+    printf("--- XenoGEN ---\n\n");
+
+    SyntheticLayout layout;
+    SyntheticLayout_SetDefaults(&layout);
+
+    const char *outputPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        // Everything but --ecc takes a value.
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--ecc") == 0) { layout.generateEcc = true; }
+        else if (strcmp(argv[i], "--disc") == 0 && hasValue) { layout.discNumber = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "--root-files") == 0 && hasValue) { layout.rootFileCount = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "--dirs") == 0 && hasValue) { layout.dirCount = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "--files-per-dir") == 0 && hasValue) { layout.filesPerDir = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "--min-size") == 0 && hasValue)
+        {
+            layout.minFileSize = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--max-size") == 0 && hasValue)
+        {
+            layout.maxFileSize = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) { layout.seed = (uint32_t)strtoul(argv[++i], NULL, 0); }
+        else if (argv[i][0] != '-' && !outputPath) { outputPath = argv[i]; }
+        else
+        {
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (!outputPath)
+    {
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    if (!SyntheticLayout_IsValid(&layout))
+    {
+        printf("That layout doesn't fit in the table of contents or on the disc!\n");
+        return -1;
+    }
+
+    const int fileCount = layout.rootFileCount + layout.dirCount * layout.filesPerDir;
+    printf("Writing disc %d image with %d file(s) in %d directories to \"%s\"... ", layout.discNumber, fileCount,
+           layout.dirCount, outputPath);
+    if (!SyntheticImage_Write(&layout, outputPath))
+    {
+        printf("Failed!\n");
+        return -1;
+    }
+    printf("Finished!\n");
+
+    return 0;
+}
+
+static void print_usage(const char *program)
+{
+    printf("Usage: %s <output> [options]\n", program);
+    printf("  --disc N           Disc to pretend to be. 1 or 2. Default 1.\n");
+    printf("  --root-files N     Files directly in the root. Default 16.\n");
+    printf("  --dirs N           Directories in the root. Default 8.\n");
+    printf("  --files-per-dir N  Files in each directory. Default 64.\n");
+    printf("  --min-size BYTES   Smallest a file can be. Default 0x800.\n");
+    printf("  --max-size BYTES   Biggest a file can be. Default 0x40000.\n");
+    printf("  --seed N           Seed for file sizes and contents. Default 1.\n");
+    printf("  --ecc              Write a real EDC and ECC for every sector so the image passes --verify.\n");
+}
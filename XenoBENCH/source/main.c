@@ -0,0 +1,584 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "ExtractPlan.h"
+#include "SectorGather.h"
+#include "SyntheticImage.h"
+#include "ThreadPool.h"
+#include "XenoBackend.h"
+#include "XenoFileStream.h"
+#include "XenoReader.h"
+
+#define __XENO_INTERNAL__
+#include "XenoDirInternal.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// This times the reader on a synthetic image, or a real one if it's passed with --image. The synthetic image is built
+// in memory from the default layout and written next to the benchmark so the file backends have something to open.
+// Results are printed as a table and can be written as JSON with --json so they can be compared between builds.
+
+/// @brief Path the synthetic image is written to. It's removed when the benchmark finishes.
+#define SYNTHETIC_IMAGE_PATH "xeno_bench.bin"
+
+/// @brief Default directory extraction is timed into.
+#define DEFAULT_EXTRACT_PATH "xeno_bench_extract"
+
+/// @brief Number of times each benchmark is run. The best run is reported along with the mean.
+#define RUN_COUNT 10
+
+/// @brief Extraction writes every file to disk, so it's run fewer times.
+#define EXTRACT_RUN_COUNT 3
+
+/// @brief The gather kernels are timed on at most this many sectors. 64MB of data.
+#define GATHER_SECTOR_COUNT 32768
+
+/// @brief Number of sectors read at a time by the raw sector benchmark.
+#define RAW_CHUNK_SECTOR_COUNT 256
+
+/// @brief The table of contents begins at sector 24 and takes up 16 sectors.
+#define TABLE_SECTOR       24
+#define TABLE_SECTOR_COUNT 16
+
+/// @brief Most results a run can have.
+#define MAX_RESULT_COUNT 64
+
+/// @brief Everything a benchmark might need.
+typedef struct
+{
+    /// @brief Path of the image on disk.
+    const char *imagePath;
+
+    /// @brief The image in memory. NULL if it was passed with --image, in which case the memory backend is skipped.
+    const unsigned char *image;
+    size_t imageSize;
+
+    /// @brief Reader for whichever backend is being timed.
+    XenoReader *reader;
+
+    /// @brief Data of the table of contents sectors.
+    unsigned char table[TABLE_SECTOR_COUNT * DATA_SIZE];
+
+    /// @brief Sectors from the beginning of the first file to the end of the last one.
+    size_t firstSector;
+    size_t sectorCount;
+
+    /// @brief Total size of every file.
+    uint64_t fileBytes;
+
+    /// @brief Big enough for the data of every sector in the span above.
+    unsigned char *output;
+
+    /// @brief Raw sectors the gather kernels are timed on.
+    unsigned char *raw;
+    size_t rawSectorCount;
+
+    /// @brief Extraction plan and the pool threaded extraction runs on.
+    ExtractPlan *plan;
+    ThreadPool *pool;
+} BenchContext;
+
+/// @brief Function signature for a benchmark.
+typedef bool (*BenchFunction)(BenchContext *context);
+
+/// @brief Function signature for opening a backend to time.
+typedef XenoBackend *(*BackendOpener)(const BenchContext *context);
+
+/// @brief This is the timing of a single benchmark.
+typedef struct
+{
+    char name[64];
+    int runs;
+
+    /// @brief Best and mean time of a run in seconds.
+    double best;
+    double mean;
+
+    /// @brief Bytes handled by a single run. 0 if the benchmark isn't about throughput.
+    uint64_t bytes;
+} BenchResult;
+
+/// @brief Results in the order they were run.
+static BenchResult results[MAX_RESULT_COUNT];
+static int resultCount = 0;
+
+/// @brief Number of files threaded extraction failed on.
+static atomic_int extractFailures;
+
+static bool measure_image(BenchContext *context);
+static void run_benchmark(const char *name, BenchFunction function, BenchContext *context, int runs, uint64_t bytes);
+static bool write_json(const char *path, const BenchContext *context, bool synthetic);
+
+static bool bench_toc_parse(BenchContext *context);
+static bool bench_gather_scalar(BenchContext *context);
+static bool bench_gather(BenchContext *context);
+static bool bench_open(BenchContext *context);
+static bool bench_open_path(BenchContext *context);
+static bool bench_per_sector(BenchContext *context);
+static bool bench_raw_sectors(BenchContext *context);
+static bool bench_sector_data(BenchContext *context);
+static bool bench_read_file(BenchContext *context);
+static bool bench_extract_serial(BenchContext *context);
+static bool bench_extract_threaded(BenchContext *context);
+
+static XenoBackend *open_memory(const BenchContext *context);
+static XenoBackend *open_mmap(const BenchContext *context);
+static XenoBackend *open_file(const BenchContext *context);
+static XenoBackend *open_stdio(const BenchContext *context);
+
+/// @brief Backend the open benchmark uses. It's set before each run of it.
+static BackendOpener currentOpener = NULL;
+
+int main(int argc, const char *argv[])
+{
+    printf("--- XenoBENCH ---\n\n");
+
+    const char *imagePath   = NULL;
+    const char *jsonPath    = NULL;
+    const char *extractPath = DEFAULT_EXTRACT_PATH;
+    int threadCount         = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--image") == 0 && hasValue) { imagePath = argv[++i]; }
+        else if (strcmp(argv[i], "--json") == 0 && hasValue) { jsonPath = argv[++i]; }
+        else if (strcmp(argv[i], "--extract") == 0 && hasValue) { extractPath = argv[++i]; }
+        else if (strcmp(argv[i], "-j") == 0 && hasValue) { threadCount = atoi(argv[++i]); }
+        else
+        {
+            printf("Usage: %s [--image path] [--json path] [--extract path] [-j threads]\n", argv[0]);
+            printf("    --image    Times an existing image instead of a synthetic one.\n");
+            printf("    --json     Writes the results as JSON.\n");
+            printf("    --extract  Directory extraction is timed into. Default \"%s\".\n", DEFAULT_EXTRACT_PATH);
+            printf("    -j         Threads for threaded extraction. Default is every processor.\n");
+            return -1;
+        }
+    }
+
+    BenchContext *context = calloc(1, sizeof(BenchContext));
+    if (!context)
+    {
+        printf("Error allocating memory!\n");
+        return -1;
+    }
+
+    int exitCode         = -1;
+    const bool synthetic = imagePath == NULL;
+    unsigned char *image = NULL;
+
+    // Build the synthetic image if there's no real one. It's kept in memory for the memory backend too.
+    if (synthetic)
+    {
+        SyntheticLayout layout;
+        SyntheticLayout_SetDefaults(&layout);
+
+        image = SyntheticImage_Create(&layout, &context->imageSize);
+        if (!image || !SyntheticImage_Write(&layout, SYNTHETIC_IMAGE_PATH))
+        {
+            printf("Error creating synthetic image!\n");
+            goto Label_cleanup;
+        }
+
+        imagePath = SYNTHETIC_IMAGE_PATH;
+    }
+
+    context->imagePath = imagePath;
+    context->image     = image;
+    if (!measure_image(context))
+    {
+        printf("Error reading \"%s\"!\n", imagePath);
+        goto Label_cleanup;
+    }
+
+    printf("Image: \"%s\", %u files, %zu sectors holding %llu bytes.\n", imagePath,
+           XenoReader_GetFileCount(context->reader), context->sectorCount, (unsigned long long)context->fileBytes);
+    printf("Best kernel: %s\n\n", SectorGather_GetKernelName());
+    printf("%-32s %12s %12s %10s\n", "Benchmark", "Best (ms)", "Mean (ms)", "GB/s");
+
+    // Things that don't depend on the backend.
+    const uint64_t gatherBytes = (uint64_t)context->rawSectorCount * DATA_SIZE;
+    run_benchmark("toc_parse", bench_toc_parse, context, RUN_COUNT, 0);
+    run_benchmark("gather/scalar", bench_gather_scalar, context, RUN_COUNT, gatherBytes);
+    run_benchmark("gather/best", bench_gather, context, RUN_COUNT, gatherBytes);
+    run_benchmark("open/path", bench_open_path, context, RUN_COUNT, 0);
+
+    // The reader measure_image opened isn't needed anymore. Each backend gets its own.
+    XenoReader_Close(context->reader);
+    context->reader = NULL;
+
+    const BackendOpener openers[4] = {open_memory, open_mmap, open_file, open_stdio};
+    const char *backendNames[4]    = {"memory", "mmap", "file", "stdio"};
+    for (int i = 0; i < 4; i++)
+    {
+        // The memory backend needs the image in memory, which only the synthetic one is.
+        if (openers[i] == open_memory && !context->image) { continue; }
+
+        XenoBackend *backend = openers[i](context);
+        context->reader      = XenoReader_OpenWithBackend(backend);
+        if (!context->reader)
+        {
+            printf("Error opening %s backend!\n", backendNames[i]);
+            if (backend) { XenoBackend_Close(backend); }
+            continue;
+        }
+
+        const uint64_t rawBytes  = (uint64_t)context->sectorCount * SECTOR_SIZE;
+        const uint64_t dataBytes = (uint64_t)context->sectorCount * DATA_SIZE;
+
+        char name[64] = {0};
+        currentOpener = openers[i];
+        snprintf(name, sizeof(name), "open/%s", backendNames[i]);
+        run_benchmark(name, bench_open, context, RUN_COUNT, 0);
+
+        snprintf(name, sizeof(name), "raw_sectors/%s", backendNames[i]);
+        run_benchmark(name, bench_raw_sectors, context, RUN_COUNT, rawBytes);
+
+        snprintf(name, sizeof(name), "per_sector/%s", backendNames[i]);
+        run_benchmark(name, bench_per_sector, context, RUN_COUNT, dataBytes);
+
+        snprintf(name, sizeof(name), "sector_data/%s", backendNames[i]);
+        run_benchmark(name, bench_sector_data, context, RUN_COUNT, dataBytes);
+
+        snprintf(name, sizeof(name), "read_file/%s", backendNames[i]);
+        run_benchmark(name, bench_read_file, context, RUN_COUNT, context->fileBytes);
+
+        XenoReader_Close(context->reader);
+        context->reader = NULL;
+    }
+
+    // Extraction goes through the same path XenoREADER does, files and all.
+    context->reader = XenoReader_Open(imagePath);
+    context->plan   = context->reader ? ExtractPlan_Create(context->reader, extractPath) : NULL;
+    context->pool   = ThreadPool_Create(threadCount);
+    if (context->plan)
+    {
+        ExtractPlan_CreateDirectories(context->plan);
+        run_benchmark("extract/serial", bench_extract_serial, context, EXTRACT_RUN_COUNT, context->fileBytes);
+
+        if (context->pool)
+        {
+            char name[64] = {0};
+            snprintf(name, sizeof(name), "extract/threads_%d", ThreadPool_GetThreadCount(context->pool));
+            run_benchmark(name, bench_extract_threaded, context, EXTRACT_RUN_COUNT, context->fileBytes);
+        }
+    }
+    else { printf("Error planning extraction to \"%s\"!\n", extractPath); }
+
+    if (jsonPath && !write_json(jsonPath, context, synthetic)) { printf("Error writing \"%s\"!\n", jsonPath); }
+
+    exitCode = 0;
+
+Label_cleanup:
+    if (context->pool) { ThreadPool_Free(context->pool); }
+    if (context->plan)
+    {
+        // Extraction leaves every file behind. Only the synthetic image is ours to remove otherwise.
+        ExtractPlan_RemoveOutputs(context->plan);
+        ExtractPlan_Free(context->plan);
+    }
+    if (context->reader) { XenoReader_Close(context->reader); }
+    if (synthetic) { remove(SYNTHETIC_IMAGE_PATH); }
+
+    free(context->raw);
+    free(context->output);
+    free(context);
+    free(image);
+
+    return exitCode;
+}
+
+static bool measure_image(BenchContext *context)
+{
+    context->reader = XenoReader_Open(context->imagePath);
+    if (!context->reader) { return false; }
+
+    // The span covers every file so the sector benchmarks read the same data extraction does.
+    size_t firstSector = SIZE_MAX;
+    size_t endSector   = 0;
+
+    const uint32_t fileCount = XenoReader_GetFileCount(context->reader);
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        const XenoFile *file = XenoReader_GetFileAt(context->reader, (int)i);
+        const int32_t size   = XenoFile_GetSize(file);
+        if (size < 0) { continue; }
+
+        const size_t sector = XenoFile_GetSector(file);
+        const size_t end    = sector + ((size_t)size + DATA_SIZE - 1) / DATA_SIZE;
+        if (end > XenoReader_GetSectorCount(context->reader)) { continue; }
+
+        if (sector < firstSector) { firstSector = sector; }
+        if (end > endSector) { endSector = end; }
+        context->fileBytes += (uint64_t)size;
+    }
+
+    if (endSector == 0) { return false; }
+
+    context->firstSector    = firstSector;
+    context->sectorCount    = endSector - firstSector;
+    context->rawSectorCount = context->sectorCount < GATHER_SECTOR_COUNT ? context->sectorCount : GATHER_SECTOR_COUNT;
+
+    // Everything the benchmarks read is pulled in once here so the first timed run isn't the only cold one.
+    context->output = malloc(context->sectorCount * DATA_SIZE);
+    context->raw    = malloc(context->rawSectorCount * SECTOR_SIZE);
+    if (!context->output || !context->raw) { return false; }
+
+    const bool tableRead = XenoReader_ReadSectorData(context->reader, TABLE_SECTOR, TABLE_SECTOR_COUNT, context->table);
+    const bool rawRead   = XenoReader_ReadRawSectors(context->reader, context->firstSector, context->rawSectorCount,
+                                                     (Sector *)context->raw);
+
+    return tableRead && rawRead;
+}
+
+static double get_seconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+static void run_benchmark(const char *name, BenchFunction function, BenchContext *context, int runs, uint64_t bytes)
+{
+    if (resultCount >= MAX_RESULT_COUNT) { return; }
+
+    double best  = 1e9;
+    double total = 0.0;
+    for (int i = 0; i < runs; i++)
+    {
+        const double begin = get_seconds();
+        if (!function(context)) { printf("Benchmark %s failed!\n", name); }
+        const double elapsed = get_seconds() - begin;
+
+        total += elapsed;
+        if (elapsed < best) { best = elapsed; }
+    }
+
+    BenchResult *result = &results[resultCount++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->runs  = runs;
+    result->best  = best;
+    result->mean  = total / runs;
+    result->bytes = bytes;
+
+    if (bytes) { printf("%-32s %12.3f %12.3f %10.2f\n", name, best * 1e3, result->mean * 1e3, bytes / best / 1e9); }
+    else { printf("%-32s %12.3f %12.3f %10s\n", name, best * 1e3, result->mean * 1e3, "-"); }
+}
+
+static void write_json_string(FILE *out, const char *string)
+{
+    fputc('"', out);
+    for (const char *c = string; *c; c++)
+    {
+        if (*c == '"' || *c == '\\') { fprintf(out, "\\%c", *c); }
+        else if ((unsigned char)*c < 0x20) { fprintf(out, "\\u%04x", (unsigned char)*c); }
+        else { fputc(*c, out); }
+    }
+    fputc('"', out);
+}
+
+static bool write_json(const char *path, const BenchContext *context, bool synthetic)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) { return false; }
+
+    fprintf(out, "{\n  \"kernel\": ");
+    write_json_string(out, SectorGather_GetKernelName());
+    fprintf(out, ",\n  \"image\": {\n    \"path\": ");
+    write_json_string(out, context->imagePath);
+    fprintf(out, ",\n    \"synthetic\": %s,\n", synthetic ? "true" : "false");
+    fprintf(out, "    \"span_sectors\": %zu,\n", context->sectorCount);
+    fprintf(out, "    \"file_bytes\": %llu\n  },\n", (unsigned long long)context->fileBytes);
+    fprintf(out, "  \"results\": [\n");
+
+    for (int i = 0; i < resultCount; i++)
+    {
+        const BenchResult *result = &results[i];
+        fprintf(out, "    {\"name\": ");
+        write_json_string(out, result->name);
+        fprintf(out, ", \"runs\": %d, \"best_seconds\": %.9f, \"mean_seconds\": %.9f, \"bytes\": %llu, ", result->runs,
+                result->best, result->mean, (unsigned long long)result->bytes);
+        fprintf(out, "\"bytes_per_second\": %.1f, \"ops_per_second\": %.3f}%s\n",
+                result->bytes ? result->bytes / result->best : 0.0, 1.0 / result->best, i + 1 < resultCount ? "," : "");
+    }
+
+    fprintf(out, "  ]\n}\n");
+
+    return fclose(out) == 0;
+}
+
+static bool bench_toc_parse(BenchContext *context)
+{
+    XenoFsTable *table = XenoFsTable_Parse(context->table, sizeof(context->table));
+    if (!table) { return false; }
+
+    free(table);
+
+    return true;
+}
+
+static bool bench_gather_scalar(BenchContext *context)
+{
+    SectorGather_PayloadsScalar(context->output, context->raw, context->rawSectorCount);
+    return true;
+}
+
+static bool bench_gather(BenchContext *context)
+{
+    SectorGather_Payloads(context->output, context->raw, context->rawSectorCount);
+    return true;
+}
+
+static bool bench_open(BenchContext *context)
+{
+    XenoBackend *backend = currentOpener(context);
+    XenoReader *reader   = XenoReader_OpenWithBackend(backend);
+    if (!reader)
+    {
+        if (backend) { XenoBackend_Close(backend); }
+        return false;
+    }
+
+    XenoReader_Close(reader);
+
+    return true;
+}
+
+static bool bench_open_path(BenchContext *context)
+{
+    XenoReader *reader = XenoReader_Open(context->imagePath);
+    if (!reader) { return false; }
+
+    XenoReader_Close(reader);
+
+    return true;
+}
+
+static bool bench_per_sector(BenchContext *context)
+{
+    // This is how XenoReader_ReadFile used to work.
+    if (!XenoReader_SeekToSector(context->reader, context->firstSector)) { return false; }
+
+    for (size_t i = 0; i < context->sectorCount; i++)
+    {
+        Sector sector = {0};
+        if (!XenoReader_ReadRawSector(context->reader, &sector)) { return false; }
+
+        memcpy(&context->output[i * DATA_SIZE], sector.data, DATA_SIZE);
+    }
+
+    return true;
+}
+
+static bool bench_raw_sectors(BenchContext *context)
+{
+    static Sector chunk[RAW_CHUNK_SECTOR_COUNT];
+
+    for (size_t i = 0; i < context->sectorCount; i += RAW_CHUNK_SECTOR_COUNT)
+    {
+        const size_t remaining = context->sectorCount - i;
+        const size_t count     = remaining < RAW_CHUNK_SECTOR_COUNT ? remaining : RAW_CHUNK_SECTOR_COUNT;
+        if (!XenoReader_ReadRawSectors(context->reader, context->firstSector + i, count, chunk)) { return false; }
+    }
+
+    return true;
+}
+
+static bool bench_sector_data(BenchContext *context)
+{
+    return XenoReader_ReadSectorData(context->reader, context->firstSector, context->sectorCount, context->output);
+}
+
+static bool bench_read_file(BenchContext *context)
+{
+    const uint32_t fileCount = XenoReader_GetFileCount(context->reader);
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        // Empty files and padding entries have nothing to read and might not get a buffer at all. That isn't a failure.
+        const XenoFile *file = XenoReader_GetFileAt(context->reader, (int)i);
+        if (XenoFile_GetSize(file) <= 0) { continue; }
+
+        XenoBuffer *buffer = XenoReader_ReadFile(context->reader, file);
+        if (!buffer) { return false; }
+
+        XenoBuffer_Free(buffer);
+    }
+
+    return true;
+}
+
+static bool extract_job(const ExtractJob *job)
+{
+    // This is the same as extracting in XenoREADER without all the printing.
+    XenoFileStream *stream = XenoReader_OpenFileStream(job->reader, job->file);
+    if (!stream) { return false; }
+
+    FILE *out = fopen(job->path, "wb");
+    if (!out)
+    {
+        XenoFileStream_Close(stream);
+        return false;
+    }
+
+    unsigned char buffer[XENO_FILE_STREAM_WINDOW_SECTORS * DATA_SIZE];
+    int64_t bytesRead = 0;
+    bool success      = true;
+    while (success && (bytesRead = XenoFileStream_Read(stream, buffer, sizeof(buffer))) > 0)
+    {
+        success = fwrite(buffer, 1, (size_t)bytesRead, out) == (size_t)bytesRead;
+    }
+
+    XenoFileStream_Close(stream);
+
+    return fclose(out) == 0 && success && bytesRead == 0;
+}
+
+static void extract_task(void *argument)
+{
+    if (!extract_job((const ExtractJob *)argument)) { atomic_fetch_add(&extractFailures, 1); }
+}
+
+static bool bench_extract_serial(BenchContext *context)
+{
+    bool success       = true;
+    const int jobCount = ExtractPlan_GetJobCount(context->plan);
+    for (int i = 0; i < jobCount; i++) { success = extract_job(ExtractPlan_GetJobAt(context->plan, i)) && success; }
+
+    return success;
+}
+
+static bool bench_extract_threaded(BenchContext *context)
+{
+    atomic_store(&extractFailures, 0);
+
+    const int jobCount = ExtractPlan_GetJobCount(context->plan);
+    for (int i = 0; i < jobCount; i++)
+    {
+        ExtractJob *job = ExtractPlan_GetJobAt(context->plan, i);
+        if (!ThreadPool_Submit(context->pool, extract_task, job)) { extract_task(job); }
+    }
+
+    ThreadPool_Wait(context->pool);
+
+    return atomic_load(&extractFailures) == 0;
+}
+
+static XenoBackend *open_memory(const BenchContext *context)
+{
+    return XenoBackend_OpenMemory(context->image, context->imageSize);
+}
+
+static XenoBackend *open_mmap(const BenchContext *context) { return XenoBackend_OpenMmap(context->imagePath); }
+
+static XenoBackend *open_file(const BenchContext *context) { return XenoBackend_OpenFile(context->imagePath); }
+
+static XenoBackend *open_stdio(const BenchContext *context) { return XenoBackend_OpenStdio(context->imagePath); }
@@ -0,0 +1,24 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "ExtractPlan.h"
+
+#include <stdbool.h>
+
+/// @brief Decompresses a file straight from the image if it's LZSS compressed. The result is written next to where
+/// the file is extracted to with .dec.bin in place of .bin.
+/// @param job Job of the file to decompress.
+/// @return True if the file was decompressed. False if it isn't compressed or anything went wrong.
+/// @note The file is streamed through the decompressor, so memory doesn't depend on how big the file is. Files whose
+/// header can't be LZSS are skipped without a word. Anything that fails partway through is deleted.
+bool DecompressFile_Run(const ExtractJob *job);
+
+/// @brief Works out the path a file's decompressed copy is written to.
+/// @param path Path the file is extracted to.
+/// @param pathOut Set to the path of the decompressed copy.
+void DecompressFile_GetPath(const char *path, char pathOut[PATH_BUFFER_SIZE]);
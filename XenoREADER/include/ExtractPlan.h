@@ -0,0 +1,87 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// This is the buffer size for paths.
+#define PATH_BUFFER_SIZE 0xFF
+
+/// @brief Where files are written to. See OutputSink.h.
+typedef struct OutputSink OutputSink;
+
+/// @brief This is every directory and file extracted from an image, worked out ahead of time so the files can be
+/// extracted in any order.
+typedef struct ExtractPlan ExtractPlan;
+
+/// @brief This is everything needed to extract a single file.
+typedef struct
+{
+    /// @brief Reader the file belongs to.
+    XenoReader *reader;
+
+    /// @brief Plan the job belongs to. Failures are counted here.
+    ExtractPlan *plan;
+
+    /// @brief File to extract.
+    const XenoFile *file;
+
+    /// @brief Where the file is written to.
+    char path[PATH_BUFFER_SIZE];
+
+    /// @brief Sink the file is written through. NULL until one is set with ExtractPlan_SetSink.
+    OutputSink *sink;
+
+    /// @brief Set by an incremental run when the file's output, or its decompressed copy, is already up to date.
+    /// Extraction and decompression are told apart so an unchanged file can still get a copy it never had.
+    bool skipExtract;
+    bool skipDecompress;
+} ExtractJob;
+
+/// @brief Walks the reader's filesystem and works out the output path of every directory and file.
+/// @param reader Reader to plan extraction of.
+/// @param target Directory everything is placed under.
+/// @note Paths are named the same way the serial extractor always has: DISC_ROOT, DIR_%04d and FILE_%04d.bin.
+ExtractPlan *ExtractPlan_Create(XenoReader *reader, const char *target);
+
+/// @brief Frees the plan.
+/// @param plan Plan to free.
+void ExtractPlan_Free(ExtractPlan *plan);
+
+/// @brief Creates every directory in the plan, starting with the target. Parents always come before their children.
+/// @param plan Plan to create the directories of.
+void ExtractPlan_CreateDirectories(const ExtractPlan *plan);
+
+/// @brief Removes every file the plan extracts and then every directory it created, target included. Anything else
+/// written into them is left alone, along with the directories it's in.
+/// @param plan Plan to remove the outputs of.
+void ExtractPlan_RemoveOutputs(const ExtractPlan *plan);
+
+/// @brief Sets the sink every file in the plan is written through.
+/// @param plan Plan to set the sink of.
+/// @param sink Sink to write through. This still belongs to the caller.
+void ExtractPlan_SetSink(ExtractPlan *plan, OutputSink *sink);
+
+/// @brief Counts a file of the plan that failed to extract. This is safe to call from any thread.
+/// @param plan Plan the file belongs to.
+void ExtractPlan_RecordFailure(ExtractPlan *plan);
+
+/// @brief Returns the number of files of the plan that failed to extract.
+/// @param plan Plan to get the count of.
+int ExtractPlan_GetFailureCount(ExtractPlan *plan);
+
+/// @brief Returns the number of files in the plan.
+/// @param plan Plan to get the count of.
+int ExtractPlan_GetJobCount(const ExtractPlan *plan);
+
+/// @brief Returns the job at the index passed. NULL on failure.
+/// @param plan Plan to get the job from.
+/// @param index Index of the job.
+ExtractJob *ExtractPlan_GetJobAt(const ExtractPlan *plan, int index);
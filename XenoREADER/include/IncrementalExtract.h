@@ -0,0 +1,35 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "ExtractPlan.h"
+
+#include <stdbool.h>
+
+/// @brief What's left of an incremental extraction between working out what to extract and writing the new manifest.
+typedef struct IncrementalExtract IncrementalExtract;
+
+/// @brief Hashes the image and compares every file against "manifest.json" in the target from the last run. Files
+/// whose size and hashes match and whose output is still there at the right size are marked to skip extraction, and
+/// to skip decompression too if their decompressed copy is there. Outputs the last run wrote that aren't in the plan
+/// anymore are deleted. The new manifest is written next to the old one, but doesn't replace it until
+/// IncrementalExtract_Finish.
+/// @param reader Reader to extract.
+/// @param plan Plan of the same reader. Its directories need to exist already.
+/// @param target Directory the plan places everything under.
+/// @param threadCount Number of threads to hash with. 0 or less uses every processor.
+/// @return State to finish with on success. NULL on failure, in which case the plan is untouched.
+/// @note Without a manifest from the last run, every file is extracted. Only paths the plan could have made are ever
+/// deleted, so a manifest that's been tampered with can't reach outside the target.
+IncrementalExtract *IncrementalExtract_Begin(XenoReader *reader, ExtractPlan *plan, const char *target, int threadCount);
+
+/// @brief Replaces the last manifest with the new one if everything was extracted and frees the state.
+/// @param incremental State to finish.
+/// @param success Whether every file left in the plan was extracted. If not, the old manifest is kept so the files
+/// that failed are tried again next time.
+/// @return True if the new manifest is in place. False otherwise.
+bool IncrementalExtract_Finish(IncrementalExtract *incremental, bool success);
@@ -0,0 +1,49 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "ExtractPlan.h"
+#include "XenoHash.h"
+
+#include <stdbool.h>
+
+/// @brief What a manifest can be written as.
+typedef enum
+{
+    MANIFEST_JSON,
+    MANIFEST_CSV
+} ManifestFormat;
+
+/// @brief Hashes an image and every file in it and writes the hashes to "manifest.json" or "manifest.csv" in the
+/// target.
+/// @param reader Reader to hash.
+/// @param plan Plan of the same reader. Files are listed in plan order by the path they would be extracted to, relative
+/// to the target.
+/// @param target Directory the manifest is written to. It's made if it doesn't exist.
+/// @param format Format to write.
+/// @param threadCount Number of threads to hash with. 0 or less uses every processor.
+/// @return True if everything was hashed and written. False if anything couldn't be.
+bool Manifest_Run(XenoReader *reader,
+                  const ExtractPlan *plan,
+                  const char *target,
+                  ManifestFormat format,
+                  int threadCount);
+
+/// @brief Writes a manifest from hashes that were already made.
+/// @param reader Reader the hashes were made from.
+/// @param plan Plan of the same reader.
+/// @param report Hashes of the image and its files.
+/// @param target Directory every path in the plan begins with. Paths are listed relative to it.
+/// @param format Format to write.
+/// @param path Path to write the manifest to.
+/// @return True if the manifest was written. False if it couldn't be.
+bool Manifest_Write(XenoReader *reader,
+                    const ExtractPlan *plan,
+                    const XenoHashReport *report,
+                    const char *target,
+                    ManifestFormat format,
+                    const char *path);
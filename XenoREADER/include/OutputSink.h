@@ -0,0 +1,81 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "ExtractPlan.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Where extracted files end up. Everything that writes a file goes through one of these.
+typedef struct OutputSink OutputSink;
+
+/// @brief Table of functions used to implement a sink. Every function is called from whatever threads are extracting,
+/// so they all need to be safe to call at the same time on different entries.
+typedef struct
+{
+    /// @brief Begins an entry at the path from the plan. Size is what the entry will be. Returns NULL on failure.
+    void *(*open)(void *context, const char *path, uint32_t sector, uint64_t size);
+
+    /// @brief Writes the next length bytes of an entry. Must return true only if everything was written.
+    bool (*write)(void *context, void *entry, const void *data, size_t length);
+
+    /// @brief Ends an entry. If keep is false, whatever was written is thrown away.
+    bool (*close)(void *context, void *entry, bool keep);
+
+    /// @brief Optional. Finishes whatever the context holds and frees it. Called once every entry is closed.
+    bool (*finish)(void *context);
+} OutputSinkInterface;
+
+/// @brief Creates a sink from a custom interface.
+/// @param interface Function table. This is copied.
+/// @param context Pointer passed to every function in the table.
+OutputSink *OutputSink_Create(const OutputSinkInterface *interface, void *context);
+
+/// @brief Opens a sink that writes every file to its own path like extraction always has. This creates every
+/// directory in the plan.
+/// @param plan Plan the files come from.
+/// @return Sink on success. NULL on failure.
+OutputSink *OutputSink_OpenDirectory(const ExtractPlan *plan);
+
+/// @brief Opens a sink that writes every file into a single pack. Entries are named by their path relative to the
+/// target, so "./Xenogears_Disc_1/DISC_ROOT/FILE_0001.bin" is "DISC_ROOT/FILE_0001.bin".
+/// @param target Directory the plan places everything under.
+/// @param packPath Path of the pack.
+/// @return Sink on success. NULL if the pack couldn't be created.
+/// @note Space in the pack is handed out in the order entries are opened, so extracting in sector order with
+/// --sequential writes the whole pack front to back.
+OutputSink *OutputSink_OpenPack(const char *target, const char *packPath);
+
+/// @brief Begins an entry.
+/// @param sink Sink to write to.
+/// @param path Path the file would be extracted to.
+/// @param sector Sector the file came from.
+/// @param size Size of the file in bytes.
+/// @return Entry on success. NULL on failure.
+void *OutputSink_Open(OutputSink *sink, const char *path, uint32_t sector, uint64_t size);
+
+/// @brief Writes the next part of an entry.
+/// @param sink Sink the entry belongs to.
+/// @param entry Entry to write to.
+/// @param data Data to write.
+/// @param length Number of bytes.
+/// @return True on success. False on failure.
+bool OutputSink_Write(OutputSink *sink, void *entry, const void *data, size_t length);
+
+/// @brief Ends an entry.
+/// @param sink Sink the entry belongs to.
+/// @param entry Entry to end. It can't be used after this.
+/// @param keep False to throw away whatever was written.
+/// @return True if the entry was written in full and kept. False otherwise.
+bool OutputSink_CloseEntry(OutputSink *sink, void *entry, bool keep);
+
+/// @brief Finishes the sink and frees it.
+/// @param sink Sink to finish.
+/// @return True if everything written to it is where it should be. False otherwise.
+bool OutputSink_Finish(OutputSink *sink);
@@ -0,0 +1,19 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "ExtractPlan.h"
+
+#include <stdbool.h>
+
+/// @brief Extracts every file in the plan in a single front to back pass over the image.
+/// @param plan Plan to extract.
+/// @return True if every file was extracted. False if anything went wrong.
+/// @note Files are sorted by sector and the image is read in large sequential chunks. Each chunk is split up between
+/// whichever files it belongs to. Only one chunk and the files currently being written are held at a time. Any
+/// sectors between files that no file claims are skipped and reported.
+bool SequentialExtract_Run(const ExtractPlan *plan);
@@ -0,0 +1,18 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "ExtractPlan.h"
+
+#include <stdbool.h>
+
+/// @brief Checks the EDC and ECC of every sector of an image and prints what's wrong and how fast it went.
+/// @param reader Reader to verify.
+/// @param plan Plan of the same reader. Bad sectors are reported with the path their file would be extracted to.
+/// @param threadCount Number of threads to check with. 0 or less uses every processor.
+/// @return True if every sector is good. False if any are bad or the check couldn't run.
+bool VerifyImage_Run(XenoReader *reader, const ExtractPlan *plan, int threadCount);
@@ -0,0 +1,19 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+
+/// @brief Demuxes every XA audio stream on the image into WAV files in a single pass.
+/// @param reader Reader to demux.
+/// @param target Directory to put the XA directory in.
+/// @return True if every stream was written. False if anything went wrong.
+/// @note Files are named after the file and channel numbers from the subheader and a counter, since the same pair can
+/// carry more than one stream. A stream ends at its end of file sector. Only the streams currently playing are open.
+bool XaExtract_Run(XenoReader *reader, const char *target);
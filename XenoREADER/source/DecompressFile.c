@@ -0,0 +1,72 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "DecompressFile.h"
+
+#include "OutputSink.h"
+#include "XenoLzss.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/// @brief Extension every extracted file ends with.
+#define FILE_EXTENSION "bin"
+
+bool DecompressFile_Run(const ExtractJob *job)
+{
+    XenoFileStream *source = XenoReader_OpenFileStream(job->reader, job->file);
+    if (!source) { return false; }
+
+    // Most files aren't compressed at all. Those stop here after reading four bytes.
+    XenoLzssStream *stream = XenoLzssStream_Open(source);
+    if (!stream)
+    {
+        XenoFileStream_Close(source);
+        return false;
+    }
+
+    char path[PATH_BUFFER_SIZE] = {0};
+    DecompressFile_GetPath(job->path, path);
+
+    const int64_t size = XenoLzssStream_GetSize(stream);
+    void *out          = OutputSink_Open(job->sink, path, XenoFile_GetSector(job->file), (uint64_t)size);
+    bool success       = out != NULL;
+    if (!out) { printf("Error opening \"%s\" for writing!\n", path); }
+
+    unsigned char buffer[XENO_FILE_STREAM_WINDOW_SECTORS * DATA_SIZE];
+    while (success)
+    {
+        const int64_t bytesRead = XenoLzssStream_Read(stream, buffer, sizeof(buffer));
+        if (bytesRead <= 0)
+        {
+            success = bytesRead == 0;
+            break;
+        }
+
+        success = OutputSink_Write(job->sink, out, buffer, (size_t)bytesRead);
+        if (!success) { printf("Error writing \"%s\"!\n", path); }
+    }
+
+    // A file that only looked compressed shouldn't leave half of something behind.
+    if (out) { success = OutputSink_CloseEntry(job->sink, out, success) && success; }
+    XenoLzssStream_Close(stream);
+    XenoFileStream_Close(source);
+
+    if (!success) { return false; }
+
+    printf("Decompressing file at sector 0x%0X to \"%s\"... Finished!\n", XenoFile_GetSector(job->file), path);
+
+    return true;
+}
+
+void DecompressFile_GetPath(const char *path, char pathOut[PATH_BUFFER_SIZE])
+{
+    // FILE_0001.bin becomes FILE_0001.dec.bin.
+    const int baseLength = (int)(strlen(path) - (sizeof(FILE_EXTENSION) - 1));
+    snprintf(pathOut, PATH_BUFFER_SIZE, "%.*sdec.%s", baseLength, path, FILE_EXTENSION);
+}
@@ -0,0 +1,197 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "ExtractPlan.h"
+
+#include "DynamicArray.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+// clang-format off
+/// @brief Directory paths are stored in these so they can go into a DynamicArray.
+typedef struct
+{
+    char path[PATH_BUFFER_SIZE];
+} DirectoryPath;
+
+struct ExtractPlan
+{
+    /// @brief Array of DirectoryPath in the order they need to be created.
+    DynamicArray *directories;
+
+    /// @brief Array of ExtractJob in the order the serial extractor always used.
+    DynamicArray *jobs;
+
+    /// @brief This replaces the static counter the recursive extractor used to use.
+    int dirCount;
+
+    /// @brief Number of files that failed to extract.
+    atomic_int failureCount;
+};
+// clang-format on
+
+// This is a recursive function to plan the contents of the directory.
+static bool plan_directory(ExtractPlan *plan, XenoReader *reader, const XenoDir *dir, const char *target);
+
+// This is so I don't need to change this when switching OS's
+static void create_directory(const char *path);
+static void remove_directory(const char *path);
+
+ExtractPlan *ExtractPlan_Create(XenoReader *reader, const char *target)
+{
+    ExtractPlan *plan = malloc(sizeof(ExtractPlan));
+    if (!plan) { return NULL; }
+
+    plan->directories = DynamicArray_Create(sizeof(DirectoryPath), 64);
+    plan->jobs        = DynamicArray_Create(sizeof(ExtractJob), 1024);
+    plan->dirCount    = 0;
+    atomic_init(&plan->failureCount, 0);
+    if (!plan->directories || !plan->jobs) { goto Label_cleanup; }
+
+    // The target itself needs to exist before anything else.
+    DirectoryPath *targetPath = (DirectoryPath *)DynamicArray_New(plan->directories);
+    if (!targetPath) { goto Label_cleanup; }
+    snprintf(targetPath->path, PATH_BUFFER_SIZE, "%s", target);
+
+    const XenoDir *root = XenoReader_GetRootDirectory(reader);
+    if (!root || !plan_directory(plan, reader, root, target)) { goto Label_cleanup; }
+
+    return plan;
+
+Label_cleanup:
+    ExtractPlan_Free(plan);
+
+    return NULL;
+}
+
+void ExtractPlan_Free(ExtractPlan *plan)
+{
+    if (!plan) { return; }
+
+    if (plan->directories) { DynamicArray_Free(plan->directories); }
+    if (plan->jobs) { DynamicArray_Free(plan->jobs); }
+    free(plan);
+}
+
+void ExtractPlan_CreateDirectories(const ExtractPlan *plan)
+{
+    const int dirCount = DynamicArray_GetLength(plan->directories);
+    for (int i = 0; i < dirCount; i++)
+    {
+        const DirectoryPath *directory = (const DirectoryPath *)DynamicArray_GetElementAt(plan->directories, i);
+        create_directory(directory->path);
+    }
+}
+
+void ExtractPlan_RemoveOutputs(const ExtractPlan *plan)
+{
+    const int jobCount = DynamicArray_GetLength(plan->jobs);
+    for (int i = 0; i < jobCount; i++) { remove(ExtractPlan_GetJobAt(plan, i)->path); }
+
+    // Backwards so every directory is already empty by the time it's removed.
+    const int dirCount = DynamicArray_GetLength(plan->directories);
+    for (int i = dirCount - 1; i >= 0; i--)
+    {
+        const DirectoryPath *directory = (const DirectoryPath *)DynamicArray_GetElementAt(plan->directories, i);
+        remove_directory(directory->path);
+    }
+}
+
+void ExtractPlan_SetSink(ExtractPlan *plan, OutputSink *sink)
+{
+    const int jobCount = DynamicArray_GetLength(plan->jobs);
+    for (int i = 0; i < jobCount; i++) { ExtractPlan_GetJobAt(plan, i)->sink = sink; }
+}
+
+void ExtractPlan_RecordFailure(ExtractPlan *plan) { atomic_fetch_add(&plan->failureCount, 1); }
+
+int ExtractPlan_GetFailureCount(ExtractPlan *plan) { return atomic_load(&plan->failureCount); }
+
+int ExtractPlan_GetJobCount(const ExtractPlan *plan) { return DynamicArray_GetLength(plan->jobs); }
+
+ExtractJob *ExtractPlan_GetJobAt(const ExtractPlan *plan, int index)
+{
+    return (ExtractJob *)DynamicArray_GetElementAt(plan->jobs, index);
+}
+
+static bool plan_directory(ExtractPlan *plan, XenoReader *reader, const XenoDir *dir, const char *target)
+{
+    DirectoryPath *directory = (DirectoryPath *)DynamicArray_New(plan->directories);
+    if (!directory) { return false; }
+
+    // 0 is always the root. This will make this less confusing IMO.
+    if (plan->dirCount == 0)
+    {
+        snprintf(directory->path, PATH_BUFFER_SIZE, "%s/DISC_ROOT", target);
+        ++plan->dirCount;
+    }
+    else { snprintf(directory->path, PATH_BUFFER_SIZE, "%s/DIR_%04d", target, plan->dirCount++); }
+
+    // The array can move when it grows, so the path needs to be copied before recursing.
+    char outputPath[PATH_BUFFER_SIZE] = {0};
+    snprintf(outputPath, PATH_BUFFER_SIZE, "%s", directory->path);
+
+    // Need these to loop.
+    const int subDirs = XenoDir_GetSubDirCount(dir);
+    const int files   = XenoDir_GetFileCount(dir);
+
+    for (int i = 0; i < subDirs; i++)
+    {
+        const XenoDir *subDir = XenoDir_GetDirAt(dir, i);
+        if (!plan_directory(plan, reader, subDir, outputPath)) { return false; }
+    }
+
+    for (int i = 0; i < files; i++)
+    {
+        // Grab the pointer to the file.
+        const XenoFile *file = XenoDir_GetFileAt(dir, i);
+        // This sector is basically padding.
+        if (XenoFile_GetSector(file) == 0xFFFFFF) { break; }
+
+        ExtractJob *job = (ExtractJob *)DynamicArray_New(plan->jobs);
+        if (!job) { return false; }
+
+        job->reader = reader;
+        job->plan   = plan;
+        job->file   = file;
+        job->sink   = NULL;
+
+        job->skipExtract    = false;
+        job->skipDecompress = false;
+        snprintf(job->path, PATH_BUFFER_SIZE, "%s/FILE_%04d.bin", outputPath, i + 1);
+    }
+
+    return true;
+}
+
+static void create_directory(const char *path)
+{
+#ifdef _WIN32
+    mkdir(path);
+#elif __linux__
+    mkdir(path, 0777);
+#endif
+}
+
+static void remove_directory(const char *path)
+{
+#ifdef _WIN32
+    _rmdir(path);
+#else
+    rmdir(path);
+#endif
+}
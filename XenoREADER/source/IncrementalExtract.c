@@ -0,0 +1,335 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "IncrementalExtract.h"
+
+#include "DecompressFile.h"
+#include "DynamicArray.h"
+#include "Manifest.h"
+#include "ThreadPool.h"
+#include "XenoHash.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/// @brief Longest line the manifest has. Every file is one line.
+#define LINE_BUFFER_SIZE 0x200
+
+// clang-format off
+struct IncrementalExtract
+{
+    /// @brief The last manifest and the new one waiting to replace it.
+    char manifestPath[PATH_BUFFER_SIZE];
+    char tempPath[PATH_BUFFER_SIZE];
+};
+
+/// @brief A file from the last manifest.
+typedef struct
+{
+    /// @brief Path relative to the target.
+    char path[PATH_BUFFER_SIZE];
+
+    /// @brief Size of the file.
+    int32_t size;
+
+    /// @brief Hashes of the file. Only set if it was hashed.
+    XenoDigest digest;
+    bool hashed;
+
+    /// @brief Set once a file in the plan has the same path. Anything left unclaimed is stale.
+    bool claimed;
+} ManifestRecord;
+// clang-format on
+
+// Defined at bottom.
+static DynamicArray *load_manifest(const char *path);
+static bool parse_record(const char *line, ManifestRecord *recordOut);
+static int compare_records(const void *a, const void *b);
+static int compare_path(const void *key, const void *record);
+static ManifestRecord *find_record(DynamicArray *records, const char *path);
+static bool output_matches(const char *path, int32_t size);
+static bool is_plan_path(const char *path);
+static const char *skip_number(const char *text);
+static bool remove_output(const char *path);
+
+IncrementalExtract *IncrementalExtract_Begin(XenoReader *reader, ExtractPlan *plan, const char *target, int threadCount)
+{
+    if (threadCount <= 0) { threadCount = ThreadPool_GetProcessorCount(); }
+
+    IncrementalExtract *incremental = malloc(sizeof(IncrementalExtract));
+    if (!incremental) { return NULL; }
+
+    const int manifestLength = snprintf(incremental->manifestPath, PATH_BUFFER_SIZE, "%s/manifest.json", target);
+    const int tempLength     = snprintf(incremental->tempPath, PATH_BUFFER_SIZE, "%s/manifest.json.tmp", target);
+    if (manifestLength < 0 || manifestLength >= PATH_BUFFER_SIZE || tempLength < 0 || tempLength >= PATH_BUFFER_SIZE)
+    {
+        printf("Manifest path is too long!\n");
+        free(incremental);
+        return NULL;
+    }
+
+    printf("Hashing %zu sectors with %i threads to find what changed...\n", XenoReader_GetSectorCount(reader),
+           threadCount);
+
+    XenoHashReport *report = XenoReader_HashImage(reader, threadCount);
+    DynamicArray *records  = load_manifest(incremental->manifestPath);
+    const int jobCount     = ExtractPlan_GetJobCount(plan);
+    bool *keep             = malloc(sizeof(bool) * (jobCount > 0 ? jobCount : 1));
+    bool success           = report && records && keep;
+    if (!success)
+    {
+        printf("Error comparing against \"%s\"!\n", incremental->manifestPath);
+        goto Label_cleanup;
+    }
+
+    // Every path in the plan begins with the target and a slash. The manifest lists them relative to it.
+    const size_t targetLength = strlen(target) + 1;
+
+    int unchangedCount = 0;
+    for (int i = 0; i < jobCount; i++)
+    {
+        const ExtractJob *job  = ExtractPlan_GetJobAt(plan, i);
+        const int32_t size     = XenoFile_GetSize(job->file);
+        ManifestRecord *record = find_record(records, &job->path[targetLength]);
+
+        XenoDigest digest;
+        const bool hashed = XenoHashReport_GetFileDigest(report, job->file, &digest);
+
+        // Where a file is doesn't matter. Only what's in it and whether the output is still there.
+        const bool unchanged = hashed && record && record->hashed && record->size == size &&
+                               record->digest.xxh3 == digest.xxh3 &&
+                               memcmp(record->digest.sha1, digest.sha1, XENO_SHA1_SIZE) == 0 &&
+                               output_matches(job->path, size);
+
+        keep[i] = !unchanged;
+        if (unchanged) { ++unchangedCount; }
+
+        // A decompressed copy of the old contents would be left behind if the new contents aren't compressed.
+        if (record && !unchanged)
+        {
+            char decompressedPath[PATH_BUFFER_SIZE];
+            DecompressFile_GetPath(job->path, decompressedPath);
+            remove(decompressedPath);
+        }
+
+        if (record) { record->claimed = true; }
+    }
+
+    int staleCount        = 0;
+    const int recordCount = DynamicArray_GetLength(records);
+    for (int i = 0; i < recordCount; i++)
+    {
+        const ManifestRecord *record = (const ManifestRecord *)DynamicArray_GetElementAt(records, i);
+        if (record->claimed || !is_plan_path(record->path)) { continue; }
+
+        char path[PATH_BUFFER_SIZE];
+        const int pathLength = snprintf(path, PATH_BUFFER_SIZE, "%s/%s", target, record->path);
+        if (pathLength < 0 || pathLength >= PATH_BUFFER_SIZE) { continue; }
+
+        // Files the last run failed to write might not be there at all.
+        if (remove_output(path))
+        {
+            printf("Removed stale output \"%s\".\n", path);
+            ++staleCount;
+        }
+    }
+
+    success = Manifest_Write(reader, plan, report, target, MANIFEST_JSON, incremental->tempPath);
+    if (success)
+    {
+        // Decompressing is decided separately. An unchanged file whose copy is missing might just never have been
+        // decompressed, and finding out only costs reading its header.
+        for (int i = 0; i < jobCount; i++)
+        {
+            ExtractJob *job = ExtractPlan_GetJobAt(plan, i);
+
+            char decompressedPath[PATH_BUFFER_SIZE];
+            DecompressFile_GetPath(job->path, decompressedPath);
+
+            struct stat info;
+            job->skipExtract    = !keep[i];
+            job->skipDecompress = !keep[i] && stat(decompressedPath, &info) == 0;
+        }
+
+        printf("%i file(s) unchanged, %i to extract, %i stale output(s) removed.\n", unchangedCount,
+               jobCount - unchangedCount, staleCount);
+    }
+
+Label_cleanup:
+    free(keep);
+    if (records) { DynamicArray_Free(records); }
+    XenoHashReport_Free(report);
+
+    if (!success)
+    {
+        free(incremental);
+        return NULL;
+    }
+
+    return incremental;
+}
+
+bool IncrementalExtract_Finish(IncrementalExtract *incremental, bool success)
+{
+    if (!incremental) { return false; }
+
+#ifdef _WIN32
+    // rename won't replace an existing file on Windows.
+    if (success) { remove(incremental->manifestPath); }
+#endif
+
+    success = success && rename(incremental->tempPath, incremental->manifestPath) == 0;
+    if (!success) { remove(incremental->tempPath); }
+
+    free(incremental);
+
+    return success;
+}
+
+static DynamicArray *load_manifest(const char *path)
+{
+    DynamicArray *records = DynamicArray_Create(sizeof(ManifestRecord), 1024);
+    if (!records) { return NULL; }
+
+    // No manifest just means there's nothing to compare against, so everything is extracted.
+    FILE *in = fopen(path, "r");
+    if (!in) { return records; }
+
+    char line[LINE_BUFFER_SIZE];
+    while (fgets(line, sizeof(line), in))
+    {
+        ManifestRecord record;
+        if (!parse_record(line, &record)) { continue; }
+
+        ManifestRecord *slot = (ManifestRecord *)DynamicArray_New(records);
+        if (!slot)
+        {
+            DynamicArray_Free(records);
+            records = NULL;
+            break;
+        }
+
+        *slot = record;
+    }
+
+    fclose(in);
+
+    // Sorted by path so every file in the plan can be looked up with a binary search.
+    const size_t recordCount = records ? DynamicArray_GetLength(records) : 0;
+    if (recordCount > 1)
+    {
+        qsort(DynamicArray_GetElementAt(records, 0), recordCount, sizeof(ManifestRecord), compare_records);
+    }
+
+    return records;
+}
+
+static bool parse_record(const char *line, ManifestRecord *recordOut)
+{
+    // This only reads what Manifest_Write writes. Every file is on a line of its own.
+    static const char PATH_KEY[] = "{\"path\": \"";
+
+    const char *object = strstr(line, PATH_KEY);
+    if (!object) { return false; }
+
+    // The path is copied by hand so it's bounded by the buffer it goes in. A path too long for it couldn't have been
+    // one of ours anyway.
+    const char *path      = &object[sizeof(PATH_KEY) - 1];
+    const char *pathEnd   = strchr(path, '"');
+    const size_t pathSize = pathEnd ? (size_t)(pathEnd - path) : 0;
+    if (pathSize == 0 || pathSize >= PATH_BUFFER_SIZE) { return false; }
+
+    memcpy(recordOut->path, path, pathSize);
+    recordOut->path[pathSize] = '\0';
+
+    char sha1[XENO_SHA1_SIZE * 2 + 1] = {0};
+    char xxh3[17]                     = {0};
+    uint32_t sector                   = 0;
+
+    const int matched = sscanf(pathEnd,
+                               "\", \"sector\": %u, \"size\": %d, \"sha1\": \"%40[0-9a-f]\", \"xxh3\": \"%16[0-9a-f]\"}",
+                               &sector, &recordOut->size, sha1, xxh3);
+    if (matched < 2) { return false; }
+
+    // Files that couldn't be hashed have null hashes. They're still listed so their outputs can go stale.
+    recordOut->hashed  = matched == 4 && strlen(sha1) == XENO_SHA1_SIZE * 2 && strlen(xxh3) == 16;
+    recordOut->claimed = false;
+    if (!recordOut->hashed) { return true; }
+
+    for (int i = 0; i < XENO_SHA1_SIZE; i++) { sscanf(&sha1[i * 2], "%2hhx", &recordOut->digest.sha1[i]); }
+    recordOut->digest.xxh3 = strtoull(xxh3, NULL, 16);
+
+    return true;
+}
+
+static int compare_records(const void *a, const void *b)
+{
+    return strcmp(((const ManifestRecord *)a)->path, ((const ManifestRecord *)b)->path);
+}
+
+static int compare_path(const void *key, const void *record)
+{
+    return strcmp((const char *)key, ((const ManifestRecord *)record)->path);
+}
+
+static ManifestRecord *find_record(DynamicArray *records, const char *path)
+{
+    const size_t recordCount = DynamicArray_GetLength(records);
+    if (recordCount == 0) { return NULL; }
+
+    return (ManifestRecord *)bsearch(path, DynamicArray_GetElementAt(records, 0), recordCount, sizeof(ManifestRecord),
+                                     compare_path);
+}
+
+static bool output_matches(const char *path, int32_t size)
+{
+    struct stat info;
+    return stat(path, &info) == 0 && (info.st_mode & S_IFMT) == S_IFREG && info.st_size == (off_t)size;
+}
+
+static bool is_plan_path(const char *path)
+{
+    // The plan only ever makes DISC_ROOT, then any number of DIR_%04d, then FILE_%04d.bin. Anything else in the
+    // manifest wasn't written by us and is left alone.
+    static const char ROOT[] = "DISC_ROOT/";
+    if (strncmp(path, ROOT, sizeof(ROOT) - 1) != 0) { return false; }
+    path += sizeof(ROOT) - 1;
+
+    while (strncmp(path, "DIR_", 4) == 0)
+    {
+        path = skip_number(&path[4]);
+        if (!path || *path != '/') { return false; }
+        ++path;
+    }
+
+    if (strncmp(path, "FILE_", 5) != 0) { return false; }
+    path = skip_number(&path[5]);
+
+    return path && strcmp(path, ".bin") == 0;
+}
+
+static const char *skip_number(const char *text)
+{
+    // %04d is at least four digits, but there's nothing stopping it from being more.
+    int digits = 0;
+    while (isdigit((unsigned char)text[digits])) { ++digits; }
+
+    return digits >= 4 ? &text[digits] : NULL;
+}
+
+static bool remove_output(const char *path)
+{
+    char decompressedPath[PATH_BUFFER_SIZE];
+    DecompressFile_GetPath(path, decompressedPath);
+    remove(decompressedPath);
+
+    return remove(path) == 0;
+}
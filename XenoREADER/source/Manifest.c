@@ -0,0 +1,209 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "Manifest.h"
+
+#include "ThreadPool.h"
+#include "XenoHash.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/// @brief Room for a SHA-1 in hex and its terminator.
+#define SHA1_HEX_SIZE (XENO_SHA1_SIZE * 2 + 1)
+
+// Writes every file in JSON. The image is an object at the top and the files are an array in it.
+static bool write_json(FILE *out,
+                       XenoReader *reader,
+                       const ExtractPlan *plan,
+                       const XenoHashReport *report,
+                       size_t targetLength);
+
+// Writes every file in CSV. The image is the first row with an empty path.
+static bool write_csv(FILE *out,
+                      XenoReader *reader,
+                      const ExtractPlan *plan,
+                      const XenoHashReport *report,
+                      size_t targetLength);
+
+// Writes a SHA-1 as hex.
+static void format_sha1(const XenoDigest *digest, char out[SHA1_HEX_SIZE]);
+
+// Returns a monotonic time in seconds.
+static double get_seconds(void);
+
+bool Manifest_Run(XenoReader *reader,
+                  const ExtractPlan *plan,
+                  const char *target,
+                  ManifestFormat format,
+                  int threadCount)
+{
+    if (threadCount <= 0) { threadCount = ThreadPool_GetProcessorCount(); }
+
+    printf("Hashing %zu sectors with %i threads and the %s XXH3...\n", XenoReader_GetSectorCount(reader), threadCount,
+           XenoHash_GetKernelName());
+
+    const double begin     = get_seconds();
+    XenoHashReport *report = XenoReader_HashImage(reader, threadCount);
+    const double elapsed   = get_seconds() - begin;
+    if (!report)
+    {
+        printf("Error hashing image!\n");
+        return false;
+    }
+
+    XenoDigest image;
+    XenoHashReport_GetImageDigest(report, &image);
+
+    char sha1[SHA1_HEX_SIZE];
+    format_sha1(&image, sha1);
+    printf("Image SHA-1 %s XXH3 %016llx\n", sha1, (unsigned long long)image.xxh3);
+
+    const double megabytes = (double)XenoReader_GetSectorCount(reader) * SECTOR_SIZE / (1024.0 * 1024.0);
+    printf("Hashed %.1f MB in %.3f seconds (%.1f MB/s).\n", megabytes, elapsed,
+           elapsed > 0.0 ? megabytes / elapsed : 0.0);
+
+    // The target might not exist yet since nothing was extracted.
+#ifdef _WIN32
+    mkdir(target);
+#elif __linux__
+    mkdir(target, 0777);
+#endif
+
+    char path[PATH_BUFFER_SIZE];
+    const int pathLength = snprintf(path, sizeof(path), "%s/manifest.%s", target,
+                                    format == MANIFEST_CSV ? "csv" : "json");
+    if (pathLength < 0 || pathLength >= (int)sizeof(path))
+    {
+        printf("Manifest path is too long!\n");
+        XenoHashReport_Free(report);
+        return false;
+    }
+
+    const bool success = Manifest_Write(reader, plan, report, target, format, path);
+    if (success) { printf("Wrote manifest of %i file(s) to \"%s\".\n", ExtractPlan_GetJobCount(plan), path); }
+
+    XenoHashReport_Free(report);
+
+    return success;
+}
+
+bool Manifest_Write(XenoReader *reader,
+                    const ExtractPlan *plan,
+                    const XenoHashReport *report,
+                    const char *target,
+                    ManifestFormat format,
+                    const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (!out)
+    {
+        printf("Error opening \"%s\" for writing!\n", path);
+        return false;
+    }
+
+    // Every path in the plan begins with the target and a slash. The manifest lists them relative to it.
+    const size_t targetLength = strlen(target) + 1;
+    bool success              = format == MANIFEST_CSV ? write_csv(out, reader, plan, report, targetLength)
+                                                       : write_json(out, reader, plan, report, targetLength);
+    success                   = fclose(out) == 0 && success;
+
+    if (!success) { printf("Error writing \"%s\"!\n", path); }
+
+    return success;
+}
+
+static bool write_json(FILE *out,
+                       XenoReader *reader,
+                       const ExtractPlan *plan,
+                       const XenoHashReport *report,
+                       size_t targetLength)
+{
+    XenoDigest image;
+    XenoHashReport_GetImageDigest(report, &image);
+
+    char sha1[SHA1_HEX_SIZE];
+    format_sha1(&image, sha1);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"disc\": %i,\n", XenoReader_GetDiscNumber(reader));
+    fprintf(out, "  \"sectors\": %zu,\n", XenoReader_GetSectorCount(reader));
+    fprintf(out, "  \"sha1\": \"%s\",\n", sha1);
+    fprintf(out, "  \"xxh3\": \"%016llx\",\n", (unsigned long long)image.xxh3);
+    fprintf(out, "  \"files\": [");
+
+    // Paths are only ever made of the names the plan gives, so nothing in them needs escaping.
+    const int jobCount = ExtractPlan_GetJobCount(plan);
+    for (int i = 0; i < jobCount; i++)
+    {
+        const ExtractJob *job = ExtractPlan_GetJobAt(plan, i);
+        fprintf(out, "%s\n    {\"path\": \"%s\", \"sector\": %u, \"size\": %i, ", i > 0 ? "," : "",
+                &job->path[targetLength], XenoFile_GetSector(job->file), XenoFile_GetSize(job->file));
+
+        XenoDigest digest;
+        if (XenoHashReport_GetFileDigest(report, job->file, &digest))
+        {
+            format_sha1(&digest, sha1);
+            fprintf(out, "\"sha1\": \"%s\", \"xxh3\": \"%016llx\"}", sha1, (unsigned long long)digest.xxh3);
+        }
+        else { fprintf(out, "\"sha1\": null, \"xxh3\": null}"); }
+    }
+
+    fprintf(out, "%s]\n}\n", jobCount > 0 ? "\n  " : "");
+
+    return !ferror(out);
+}
+
+static bool write_csv(FILE *out,
+                      XenoReader *reader,
+                      const ExtractPlan *plan,
+                      const XenoHashReport *report,
+                      size_t targetLength)
+{
+    XenoDigest image;
+    XenoHashReport_GetImageDigest(report, &image);
+
+    char sha1[SHA1_HEX_SIZE];
+    format_sha1(&image, sha1);
+
+    fprintf(out, "path,sector,size,sha1,xxh3\n");
+    fprintf(out, ",0,%zu,%s,%016llx\n", XenoReader_GetSectorCount(reader) * SECTOR_SIZE, sha1,
+            (unsigned long long)image.xxh3);
+
+    // Files that couldn't be hashed get empty hashes.
+    const int jobCount = ExtractPlan_GetJobCount(plan);
+    for (int i = 0; i < jobCount; i++)
+    {
+        const ExtractJob *job = ExtractPlan_GetJobAt(plan, i);
+        fprintf(out, "%s,%u,%i,", &job->path[targetLength], XenoFile_GetSector(job->file), XenoFile_GetSize(job->file));
+
+        XenoDigest digest;
+        if (XenoHashReport_GetFileDigest(report, job->file, &digest))
+        {
+            format_sha1(&digest, sha1);
+            fprintf(out, "%s,%016llx\n", sha1, (unsigned long long)digest.xxh3);
+        }
+        else { fprintf(out, ",\n"); }
+    }
+
+    return !ferror(out);
+}
+
+static void format_sha1(const XenoDigest *digest, char out[SHA1_HEX_SIZE])
+{
+    for (int i = 0; i < XENO_SHA1_SIZE; i++) { snprintf(&out[i * 2], 3, "%02x", digest->sha1[i]); }
+}
+
+static double get_seconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
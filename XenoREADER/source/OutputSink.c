@@ -0,0 +1,253 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "OutputSink.h"
+
+#include "XenoPack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// clang-format off
+struct OutputSink
+{
+    /// @brief The functions used to actually do things.
+    OutputSinkInterface interface;
+
+    /// @brief Passed to the functions above.
+    void *context;
+};
+
+/// @brief A file being written by the directory sink.
+typedef struct
+{
+    /// @brief The file itself.
+    FILE *out;
+
+    /// @brief Size the file should be and how much has been written.
+    uint64_t size;
+    uint64_t written;
+
+    /// @brief Path of the file, so it can be removed if it isn't kept.
+    char path[PATH_BUFFER_SIZE];
+} DirectoryEntry;
+
+/// @brief Context of the pack sink.
+typedef struct
+{
+    /// @brief The pack being written.
+    XenoPackWriter *writer;
+
+    /// @brief The target and the slash after it are left off the front of every name.
+    char target[PATH_BUFFER_SIZE];
+    size_t targetLength;
+} PackSink;
+
+/// @brief An entry being written by the pack sink.
+typedef struct
+{
+    /// @brief Index of the entry in the pack.
+    int index;
+
+    /// @brief Size the entry should be and how much has been written.
+    uint64_t size;
+    uint64_t written;
+} PackEntry;
+// clang-format on
+
+// Defined at bottom.
+static void *directory_open(void *context, const char *path, uint32_t sector, uint64_t size);
+static bool directory_write(void *context, void *entry, const void *data, size_t length);
+static bool directory_close(void *context, void *entry, bool keep);
+static void *pack_open(void *context, const char *path, uint32_t sector, uint64_t size);
+static bool pack_write(void *context, void *entry, const void *data, size_t length);
+static bool pack_close(void *context, void *entry, bool keep);
+static bool pack_finish(void *context);
+
+OutputSink *OutputSink_Create(const OutputSinkInterface *interface, void *context)
+{
+    if (!interface || !interface->open || !interface->write || !interface->close) { return NULL; }
+
+    OutputSink *sink = malloc(sizeof(OutputSink));
+    if (!sink) { return NULL; }
+
+    sink->interface = *interface;
+    sink->context   = context;
+
+    return sink;
+}
+
+OutputSink *OutputSink_OpenDirectory(const ExtractPlan *plan)
+{
+    static const OutputSinkInterface DIRECTORY_INTERFACE = {.open   = directory_open,
+                                                            .write  = directory_write,
+                                                            .close  = directory_close,
+                                                            .finish = NULL};
+
+    ExtractPlan_CreateDirectories(plan);
+
+    return OutputSink_Create(&DIRECTORY_INTERFACE, NULL);
+}
+
+OutputSink *OutputSink_OpenPack(const char *target, const char *packPath)
+{
+    static const OutputSinkInterface PACK_INTERFACE = {.open   = pack_open,
+                                                       .write  = pack_write,
+                                                       .close  = pack_close,
+                                                       .finish = pack_finish};
+
+    PackSink *pack = malloc(sizeof(PackSink));
+    if (!pack) { return NULL; }
+
+    OutputSink *sink = OutputSink_Create(&PACK_INTERFACE, pack);
+    pack->writer     = sink ? XenoPackWriter_Create(packPath) : NULL;
+    if (!pack->writer)
+    {
+        free(sink);
+        free(pack);
+        return NULL;
+    }
+
+    snprintf(pack->target, PATH_BUFFER_SIZE, "%s", target);
+    pack->targetLength = strlen(pack->target);
+
+    return sink;
+}
+
+void *OutputSink_Open(OutputSink *sink, const char *path, uint32_t sector, uint64_t size)
+{
+    return sink->interface.open(sink->context, path, sector, size);
+}
+
+bool OutputSink_Write(OutputSink *sink, void *entry, const void *data, size_t length)
+{
+    return sink->interface.write(sink->context, entry, data, length);
+}
+
+bool OutputSink_CloseEntry(OutputSink *sink, void *entry, bool keep)
+{
+    return sink->interface.close(sink->context, entry, keep);
+}
+
+bool OutputSink_Finish(OutputSink *sink)
+{
+    if (!sink) { return true; }
+
+    const bool finished = sink->interface.finish ? sink->interface.finish(sink->context) : true;
+    free(sink);
+
+    return finished;
+}
+
+static void *directory_open(void *context, const char *path, uint32_t sector, uint64_t size)
+{
+    (void)context;
+    (void)sector;
+
+    DirectoryEntry *entry = malloc(sizeof(DirectoryEntry));
+    if (!entry) { return NULL; }
+
+    entry->out = fopen(path, "wb");
+    if (!entry->out)
+    {
+        free(entry);
+        return NULL;
+    }
+
+    entry->size    = size;
+    entry->written = 0;
+    snprintf(entry->path, PATH_BUFFER_SIZE, "%s", path);
+
+    return entry;
+}
+
+static bool directory_write(void *context, void *entry, const void *data, size_t length)
+{
+    (void)context;
+
+    DirectoryEntry *file = (DirectoryEntry *)entry;
+    if (fwrite(data, 1, length, file->out) != length) { return false; }
+
+    file->written += length;
+
+    return true;
+}
+
+static bool directory_close(void *context, void *entry, bool keep)
+{
+    (void)context;
+
+    DirectoryEntry *file = (DirectoryEntry *)entry;
+
+    // A file that came up short is still left in place like it always has been, but it doesn't count as written.
+    const bool closed = fclose(file->out) == 0;
+    if (!keep) { remove(file->path); }
+
+    const bool kept = keep && closed && file->written == file->size;
+    free(file);
+
+    return kept;
+}
+
+static void *pack_open(void *context, const char *path, uint32_t sector, uint64_t size)
+{
+    PackSink *pack = (PackSink *)context;
+
+    PackEntry *entry = malloc(sizeof(PackEntry));
+    if (!entry) { return NULL; }
+
+    // Every path in the plan begins with the target and a slash. Anything else is stored as it is.
+    const bool relative = strncmp(path, pack->target, pack->targetLength) == 0 && path[pack->targetLength] == '/';
+    const char *name    = relative ? &path[pack->targetLength + 1] : path;
+
+    entry->index   = XenoPackWriter_AddEntry(pack->writer, name, sector, size);
+    entry->size    = size;
+    entry->written = 0;
+    if (entry->index < 0)
+    {
+        free(entry);
+        return NULL;
+    }
+
+    return entry;
+}
+
+static bool pack_write(void *context, void *entry, const void *data, size_t length)
+{
+    PackSink *pack       = (PackSink *)context;
+    PackEntry *packEntry = (PackEntry *)entry;
+    if (!XenoPackWriter_Write(pack->writer, packEntry->index, packEntry->written, data, length)) { return false; }
+
+    packEntry->written += length;
+
+    return true;
+}
+
+static bool pack_close(void *context, void *entry, bool keep)
+{
+    PackSink *pack       = (PackSink *)context;
+    PackEntry *packEntry = (PackEntry *)entry;
+
+    // Space in the pack is already set aside, so anything short would read back with a run of zeroes at the end.
+    const bool kept = keep && packEntry->written == packEntry->size;
+    if (!kept) { XenoPackWriter_DropEntry(pack->writer, packEntry->index); }
+
+    free(packEntry);
+
+    return kept;
+}
+
+static bool pack_finish(void *context)
+{
+    PackSink *pack      = (PackSink *)context;
+    const bool finished = XenoPackWriter_Close(pack->writer);
+    free(pack);
+
+    return finished;
+}
@@ -0,0 +1,222 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "SequentialExtract.h"
+
+#include "OutputSink.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// @brief Number of sectors read at a time. This is 1MB of data.
+#define CHUNK_SECTOR_COUNT 512
+
+// clang-format off
+/// @brief This is a file that's being extracted.
+typedef struct
+{
+    /// @brief The job from the plan.
+    const ExtractJob *job;
+
+    /// @brief Index in the plan. This keeps the sort stable for files that start in the same sector.
+    int index;
+
+    /// @brief First sector of the file.
+    size_t firstSector;
+
+    /// @brief Sector after the last one the file uses.
+    size_t endSector;
+
+    /// @brief Size of the file in bytes.
+    size_t size;
+
+    /// @brief Entry in the job's sink. NULL until the sweep reaches the file.
+    void *out;
+
+    /// @brief Set if anything went wrong writing.
+    bool failed;
+} Target;
+// clang-format on
+
+// Defined at bottom.
+static int compare_targets(const void *a, const void *b);
+static bool open_target(Target *target);
+static bool finish_target(Target *target);
+static void write_chunk(Target *target, const unsigned char *chunk, size_t chunkBegin, size_t chunkEnd);
+
+bool SequentialExtract_Run(const ExtractPlan *plan)
+{
+    const int jobCount = ExtractPlan_GetJobCount(plan);
+    if (jobCount == 0) { return true; }
+
+    XenoReader *reader = ExtractPlan_GetJobAt(plan, 0)->reader;
+
+    Target *targets      = calloc(jobCount, sizeof(Target));
+    Target **active      = calloc(jobCount, sizeof(Target *));
+    unsigned char *chunk = malloc((size_t)CHUNK_SECTOR_COUNT * DATA_SIZE);
+    bool success         = targets && active && chunk;
+    if (!success) { goto Label_cleanup; }
+
+    for (int i = 0; i < jobCount; i++)
+    {
+        const ExtractJob *job = ExtractPlan_GetJobAt(plan, i);
+        const int32_t size    = XenoFile_GetSize(job->file);
+
+        targets[i].job         = job;
+        targets[i].index       = i;
+        targets[i].firstSector = XenoFile_GetSector(job->file);
+        targets[i].size        = size > 0 ? (size_t)size : 0;
+        targets[i].endSector   = targets[i].firstSector + (targets[i].size + DATA_SIZE - 1) / DATA_SIZE;
+    }
+
+    qsort(targets, jobCount, sizeof(Target), compare_targets);
+
+    // These are used to keep track of what has and hasn't been covered by a file.
+    size_t coveredEnd     = targets[0].firstSector;
+    size_t gapCount       = 0;
+    size_t gapSectorCount = 0;
+
+    int next        = 0;
+    int activeCount = 0;
+    size_t position = 0;
+    while (next < jobCount || activeCount > 0)
+    {
+        // If nothing is being written, jump straight to the next file instead of reading what's in between.
+        if (activeCount == 0 && targets[next].firstSector > position) { position = targets[next].firstSector; }
+
+        // Pull in every file that begins inside the chunk.
+        size_t chunkEnd = position + CHUNK_SECTOR_COUNT;
+        while (next < jobCount && targets[next].firstSector < chunkEnd)
+        {
+            Target *target = &targets[next++];
+
+            if (target->firstSector > coveredEnd)
+            {
+                const size_t gapSize = target->firstSector - coveredEnd;
+                printf("Skipping %zu unclaimed sector(s) from 0x%zX to 0x%zX.\n", gapSize, coveredEnd,
+                       target->firstSector - 1);
+                ++gapCount;
+                gapSectorCount += gapSize;
+            }
+            if (target->endSector > coveredEnd) { coveredEnd = target->endSector; }
+
+            // Files an incremental run found up to date still claim their sectors. They just aren't written.
+            if (target->job->skipExtract) { continue; }
+
+            if (!open_target(target))
+            {
+                success = false;
+                continue;
+            }
+
+            // Empty files are done as soon as they're created.
+            if (target->endSector == target->firstSector)
+            {
+                success = finish_target(target) && success;
+                continue;
+            }
+
+            active[activeCount++] = target;
+        }
+
+        if (activeCount == 0) { continue; }
+
+        // Don't read past the end of the last file that needs this chunk.
+        size_t neededEnd = position;
+        for (int i = 0; i < activeCount; i++)
+        {
+            if (active[i]->endSector > neededEnd) { neededEnd = active[i]->endSector; }
+        }
+        if (neededEnd < chunkEnd) { chunkEnd = neededEnd; }
+
+        const bool chunkRead = XenoReader_ReadSectorData(reader, position, chunkEnd - position, chunk);
+        if (!chunkRead) { printf("Error reading sectors 0x%zX to 0x%zX!\n", position, chunkEnd - 1); }
+
+        // Hand the chunk out and retire whatever is finished.
+        int remaining = 0;
+        for (int i = 0; i < activeCount; i++)
+        {
+            Target *target = active[i];
+            if (chunkRead) { write_chunk(target, chunk, position, chunkEnd); }
+            else { target->failed = true; }
+
+            if (target->endSector <= chunkEnd) { success = finish_target(target) && success; }
+            else { active[remaining++] = target; }
+        }
+        activeCount = remaining;
+
+        position = chunkEnd;
+    }
+
+    printf("Skipped %zu gap(s) totalling %zu sector(s).\n", gapCount, gapSectorCount);
+
+Label_cleanup:
+    free(chunk);
+    free(active);
+    free(targets);
+
+    return success;
+}
+
+static int compare_targets(const void *a, const void *b)
+{
+    const Target *targetA = (const Target *)a;
+    const Target *targetB = (const Target *)b;
+
+    if (targetA->firstSector != targetB->firstSector) { return targetA->firstSector < targetB->firstSector ? -1 : 1; }
+
+    return targetA->index - targetB->index;
+}
+
+static bool open_target(Target *target)
+{
+    const ExtractJob *job = target->job;
+
+    target->out = OutputSink_Open(job->sink, job->path, (uint32_t)target->firstSector, target->size);
+    if (!target->out)
+    {
+        printf("Error opening \"%s\" for writing!\n", job->path);
+        return false;
+    }
+
+    return true;
+}
+
+static bool finish_target(Target *target)
+{
+    // Files that failed are left where they are like they always have been. A pack drops them on its own.
+    const bool closed = OutputSink_CloseEntry(target->job->sink, target->out, true);
+    target->out       = NULL;
+
+    if (target->failed || !closed)
+    {
+        printf("Error writing \"%s\"!\n", target->job->path);
+        return false;
+    }
+
+    printf("Extracting file at sector 0x%0zX to \"%s\"... Finished!\n", target->firstSector, target->job->path);
+
+    return true;
+}
+
+static void write_chunk(Target *target, const unsigned char *chunk, size_t chunkBegin, size_t chunkEnd)
+{
+    // Work out which part of the chunk belongs to this file.
+    const size_t beginSector = target->firstSector > chunkBegin ? target->firstSector : chunkBegin;
+    const size_t endSector   = target->endSector < chunkEnd ? target->endSector : chunkEnd;
+
+    // The last sector of the file is trimmed to its size.
+    const size_t fileBegin = (beginSector - target->firstSector) * DATA_SIZE;
+    size_t fileEnd         = (endSector - target->firstSector) * DATA_SIZE;
+    if (fileEnd > target->size) { fileEnd = target->size; }
+
+    const unsigned char *data = &chunk[(beginSector - chunkBegin) * DATA_SIZE];
+    const size_t length       = fileEnd - fileBegin;
+    if (!OutputSink_Write(target->job->sink, target->out, data, length)) { target->failed = true; }
+}
@@ -0,0 +1,85 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "VerifyImage.h"
+
+#include "ThreadPool.h"
+#include "XenoVerify.h"
+
+#include <stdio.h>
+#include <time.h>
+
+// Returns the path the file would be extracted to. NULL if it isn't in the plan.
+static const char *get_file_path(const ExtractPlan *plan, const XenoFile *file);
+
+// Returns a monotonic time in seconds.
+static double get_seconds(void);
+
+bool VerifyImage_Run(XenoReader *reader, const ExtractPlan *plan, int threadCount)
+{
+    if (threadCount <= 0) { threadCount = ThreadPool_GetProcessorCount(); }
+
+    printf("Verifying %zu sectors with %i threads and the %s EDC...\n", XenoReader_GetSectorCount(reader), threadCount,
+           XenoVerify_GetKernelName());
+
+    const double begin       = get_seconds();
+    XenoVerifyReport *report = XenoReader_VerifyImage(reader, threadCount);
+    const double elapsed     = get_seconds() - begin;
+    if (!report)
+    {
+        printf("Error verifying image!\n");
+        return false;
+    }
+
+    const size_t badSectorCount = XenoVerifyReport_GetBadSectorCount(report);
+    for (size_t i = 0; i < badSectorCount; i++)
+    {
+        XenoBadSector badSector;
+        XenoVerifyReport_GetBadSectorAt(report, i, &badSector);
+
+        const char *path = badSector.file ? get_file_path(plan, badSector.file) : NULL;
+        printf("Bad sector 0x%0X:%s%s%s%s%s%s in %s\n", badSector.sector,
+               (badSector.errors & XENO_SECTOR_BAD_SYNC) ? " sync" : "",
+               (badSector.errors & XENO_SECTOR_BAD_MODE) ? " mode" : "",
+               (badSector.errors & XENO_SECTOR_BAD_EDC) ? " EDC" : "",
+               (badSector.errors & XENO_SECTOR_BAD_ECC_P) ? " ECC-P" : "",
+               (badSector.errors & XENO_SECTOR_BAD_ECC_Q) ? " ECC-Q" : "",
+               (badSector.errors & XENO_SECTOR_UNREADABLE) ? " unreadable" : "", path ? path : "no file");
+    }
+
+    // Throughput is over the whole image since every sector is read, even the empty ones.
+    const double megabytes = (double)XenoReader_GetSectorCount(reader) * SECTOR_SIZE / (1024.0 * 1024.0);
+    printf("Checked %zu sector(s) and skipped %zu empty sector(s). %zu bad sector(s) found.\n",
+           XenoVerifyReport_GetCheckedCount(report), XenoVerifyReport_GetSkippedCount(report), badSectorCount);
+    printf("Verified %.1f MB in %.3f seconds (%.1f MB/s).\n", megabytes, elapsed,
+           elapsed > 0.0 ? megabytes / elapsed : 0.0);
+
+    XenoVerifyReport_Free(report);
+
+    return badSectorCount == 0;
+}
+
+static const char *get_file_path(const ExtractPlan *plan, const XenoFile *file)
+{
+    // Bad sectors are rare, so a search through the plan is fine.
+    const int jobCount = ExtractPlan_GetJobCount(plan);
+    for (int i = 0; i < jobCount; i++)
+    {
+        const ExtractJob *job = ExtractPlan_GetJobAt(plan, i);
+        if (job->file == file) { return job->path; }
+    }
+
+    return NULL;
+}
+
+static double get_seconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
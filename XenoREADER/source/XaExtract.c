@@ -0,0 +1,252 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XaExtract.h"
+
+#include "ExtractPlan.h"
+#include "XenoXa.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/// @brief Size of the RIFF header written in front of the samples.
+#define WAV_HEADER_SIZE 44
+
+// clang-format off
+/// @brief A stream being written.
+typedef struct
+{
+    /// @brief File and channel from the subheader.
+    uint8_t fileNumber;
+    uint8_t channelNumber;
+
+    /// @brief Number of streams already finished on this file and channel.
+    int segment;
+
+    /// @brief Format of the stream. Taken from its first sector.
+    uint32_t sampleRate;
+    uint32_t channelCount;
+
+    /// @brief Sector the current stream began at.
+    uint32_t firstSector;
+
+    /// @brief Output file. NULL between streams.
+    FILE *out;
+    char path[PATH_BUFFER_SIZE];
+
+    /// @brief Bytes of samples written so far.
+    uint32_t dataSize;
+
+    /// @brief Set if anything went wrong writing.
+    bool failed;
+} Track;
+
+/// @brief State passed through the demuxer.
+typedef struct
+{
+    /// @brief Directory the files go in.
+    char directory[PATH_BUFFER_SIZE];
+
+    /// @brief Every file and channel seen so far.
+    Track *tracks;
+    int trackCount;
+    int trackCapacity;
+
+    /// @brief Totals for the summary.
+    int streamCount;
+    bool success;
+} XaExtract;
+// clang-format on
+
+// Called with every decoded sector.
+static bool write_block(void *userData, const XenoXaBlock *block, const int16_t *samples, size_t frameCount);
+
+// Returns the track for the file and channel or adds one.
+static Track *get_track(XaExtract *extract, uint8_t fileNumber, uint8_t channelNumber);
+
+// Opens the next file of a track and writes a placeholder header.
+static bool open_track(XaExtract *extract, Track *track, const XenoXaBlock *block);
+
+// Fills in the sizes in the header and closes the file.
+static bool finish_track(Track *track);
+
+// Writes a RIFF header for the track with the current data size.
+static bool write_header(Track *track);
+
+// Stores a little endian value.
+static void put_u16(unsigned char *out, uint16_t value);
+static void put_u32(unsigned char *out, uint32_t value);
+
+bool XaExtract_Run(XenoReader *reader, const char *target)
+{
+    XaExtract extract = {.success = true};
+    snprintf(extract.directory, PATH_BUFFER_SIZE, "%s/XA", target);
+
+    // The target might not exist yet since nothing was planned.
+#ifdef _WIN32
+    mkdir(target);
+    mkdir(extract.directory);
+#elif __linux__
+    mkdir(target, 0777);
+    mkdir(extract.directory, 0777);
+#endif
+
+    printf("Demuxing XA audio with the %s decoder...\n", XenoXa_GetKernelName());
+
+    const bool demuxed = XenoReader_DemuxXa(reader, 0, XenoReader_GetSectorCount(reader), write_block, &extract);
+    if (!demuxed) { printf("Error demuxing XA audio!\n"); }
+
+    // Streams that never hit an end of file sector still get finished.
+    for (int i = 0; i < extract.trackCount; i++)
+    {
+        Track *track = &extract.tracks[i];
+        if (track->out) { extract.success = finish_track(track) && extract.success; }
+    }
+
+    printf("Wrote %i XA stream(s) to \"%s\".\n", extract.streamCount, extract.directory);
+
+    free(extract.tracks);
+
+    return demuxed && extract.success;
+}
+
+static bool write_block(void *userData, const XenoXaBlock *block, const int16_t *samples, size_t frameCount)
+{
+    XaExtract *extract = (XaExtract *)userData;
+
+    Track *track = get_track(extract, block->fileNumber, block->channelNumber);
+    if (!track) { return false; }
+
+    // A stream that changes format partway through isn't something a single WAV can hold, so it's split.
+    const bool formatChanged = track->sampleRate != block->sampleRate || track->channelCount != block->channelCount;
+    if (track->out && formatChanged) { extract->success = finish_track(track) && extract->success; }
+
+    if (!track->out && !open_track(extract, track, block))
+    {
+        extract->success = false;
+        return true;
+    }
+
+    const size_t size = frameCount * block->channelCount * sizeof(int16_t);
+    if (fwrite(samples, 1, size, track->out) != size) { track->failed = true; }
+    track->dataSize += (uint32_t)size;
+
+    if (block->endOfStream) { extract->success = finish_track(track) && extract->success; }
+
+    return true;
+}
+
+static Track *get_track(XaExtract *extract, uint8_t fileNumber, uint8_t channelNumber)
+{
+    for (int i = 0; i < extract->trackCount; i++)
+    {
+        Track *track = &extract->tracks[i];
+        if (track->fileNumber == fileNumber && track->channelNumber == channelNumber) { return track; }
+    }
+
+    if (extract->trackCount == extract->trackCapacity)
+    {
+        const int newCapacity = extract->trackCapacity ? extract->trackCapacity * 2 : 16;
+        Track *newTracks      = realloc(extract->tracks, sizeof(Track) * newCapacity);
+        if (!newTracks) { return NULL; }
+
+        extract->tracks        = newTracks;
+        extract->trackCapacity = newCapacity;
+    }
+
+    Track *track = &extract->tracks[extract->trackCount++];
+    *track       = (Track){.fileNumber = fileNumber, .channelNumber = channelNumber};
+
+    return track;
+}
+
+static bool open_track(XaExtract *extract, Track *track, const XenoXaBlock *block)
+{
+    const int length = snprintf(track->path, PATH_BUFFER_SIZE, "%s/F%03d_C%02d_%04d.wav", extract->directory,
+                                track->fileNumber, track->channelNumber, track->segment);
+    if (length < 0 || length >= PATH_BUFFER_SIZE)
+    {
+        printf("Path for XA stream at sector 0x%0X is too long!\n", block->sector);
+        return false;
+    }
+
+    track->firstSector  = block->sector;
+    track->sampleRate   = block->sampleRate;
+    track->channelCount = block->channelCount;
+    track->dataSize     = 0;
+    track->failed       = false;
+    track->out          = fopen(track->path, "wb");
+    if (!track->out)
+    {
+        printf("Error opening \"%s\" for writing!\n", track->path);
+        return false;
+    }
+
+    ++extract->streamCount;
+
+    // The sizes aren't known until the stream ends, so they're filled in then.
+    if (!write_header(track)) { track->failed = true; }
+
+    return true;
+}
+
+static bool finish_track(Track *track)
+{
+    // Going back to the start is enough. The header is always the same size.
+    const bool patched = fseek(track->out, 0, SEEK_SET) == 0 && write_header(track);
+    const bool closed  = fclose(track->out) == 0;
+
+    track->out = NULL;
+    ++track->segment;
+
+    if (track->failed || !patched || !closed)
+    {
+        printf("Error writing \"%s\"!\n", track->path);
+        return false;
+    }
+
+    printf("Extracting XA stream at sector 0x%0X to \"%s\"... Finished!\n", track->firstSector, track->path);
+
+    return true;
+}
+
+static bool write_header(Track *track)
+{
+    const uint16_t blockAlign = (uint16_t)(track->channelCount * sizeof(int16_t));
+
+    unsigned char header[WAV_HEADER_SIZE];
+    memcpy(&header[0], "RIFF", 4);
+    put_u32(&header[4], WAV_HEADER_SIZE - 8 + track->dataSize);
+    memcpy(&header[8], "WAVEfmt ", 8);
+    put_u32(&header[16], 16);
+    put_u16(&header[20], 1);
+    put_u16(&header[22], (uint16_t)track->channelCount);
+    put_u32(&header[24], track->sampleRate);
+    put_u32(&header[28], track->sampleRate * blockAlign);
+    put_u16(&header[32], blockAlign);
+    put_u16(&header[34], 16);
+    memcpy(&header[36], "data", 4);
+    put_u32(&header[40], track->dataSize);
+
+    return fwrite(header, 1, WAV_HEADER_SIZE, track->out) == WAV_HEADER_SIZE;
+}
+
+static void put_u16(unsigned char *out, uint16_t value)
+{
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+}
+
+static void put_u32(unsigned char *out, uint32_t value)
+{
+    put_u16(&out[0], (uint16_t)value);
+    put_u16(&out[2], (uint16_t)(value >> 16));
+}
@@ -1,130 +1,401 @@
+#include "DecompressFile.h"
+#include "ExtractPlan.h"
+#include "IncrementalExtract.h"
+#include "Manifest.h"
+#include "OutputSink.h"
+#include "SequentialExtract.h"
+#include "ThreadPool.h"
+#include "VerifyImage.h"
+#include "XaExtract.h"
 #include "XenoReader.h"
 
+#include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <sys/stat.h>
 
-// This is the buffer size for paths.
-#define PATH_BUFFER_SIZE 0xFF
+// This extracts a single file. It's used as-is for serial extraction and as the task for the thread pool.
+static void extract_file(void *argument);
 
-// This is a recursive function to extract the contents of the disc image.
-static void extract_directory(XenoReader *reader, const XenoDir *dir, const char *target, bool resetCount);
+// This decompresses a single file if it's compressed. It's a wrapper so it can be used as a thread pool task.
+static void decompress_file(void *argument);
 
-// This is so I don't need to change this when switching OS's
-static inline void create_directory(const char *path)
-{
-#ifdef _WIN32
-    mkdir(path);
-#elif __linux__
-    mkdir(path, 0777);
-#endif
-}
+// This runs a single pass extraction of a whole plan. It's a wrapper so it can be used as a thread pool task.
+static void extract_plan_sequential(void *argument);
+
+// This parses the thread count from either "-j N" or "-jN".
+static const char *get_option_value(int argc, const char *argv[], int *index);
+
+// Returns whether the text is a non-empty run of digits.
+static bool is_number(const char *text);
+
+// This prints every sub-directory in the order they're planned so there's something to watch on big discs.
+static void print_directories(const XenoDir *dir);
 
 int main(int argc, const char *argv[])
 {
     printf("--- XenoREADER Version 0.1 ---\n\n");
-    if (argc <= 1)
+
+    // Every argument that isn't an option is an image. There can't be more images than arguments.
+    const char **imagePaths = calloc(argc, sizeof(const char *));
+    XenoReader **readers    = calloc(argc, sizeof(XenoReader *));
+    ExtractPlan **plans     = calloc(argc, sizeof(ExtractPlan *));
+    OutputSink **sinks      = calloc(argc, sizeof(OutputSink *));
+
+    IncrementalExtract **incrementals = calloc(argc, sizeof(IncrementalExtract *));
+    if (!imagePaths || !readers || !plans || !sinks || !incrementals)
     {
-        printf("Usage: ./XenoREADER \"[path/to/XenogearsDisc1.bin]\" \"[path/to/XenogearsDisc2.bin]\"\n");
+        printf("Error allocating memory!\n");
         return -1;
     }
 
+    int imageCount   = 0;
+    int threadCount  = 1;
+    bool threadsSet  = false;
+    bool sequential  = false;
+    bool xa          = false;
+    bool verify      = false;
+    bool manifest    = false;
+    bool decompress  = false;
+    bool pack        = false;
+    bool incremental = false;
+
+    ManifestFormat manifestFormat = MANIFEST_JSON;
     for (int i = 1; i < argc; i++)
     {
-        printf("Opening \"%s\" and verifying image... ", argv[i]);
-        XenoReader *xenoReader = XenoReader_Open(argv[i]);
+        if (strcmp(argv[i], "--sequential") == 0) { sequential = true; }
+        else if (strcmp(argv[i], "--xa") == 0) { xa = true; }
+        else if (strcmp(argv[i], "--verify") == 0) { verify = true; }
+        else if (strcmp(argv[i], "--decompress") == 0) { decompress = true; }
+        else if (strcmp(argv[i], "--pack") == 0) { pack = true; }
+        else if (strcmp(argv[i], "--incremental") == 0) { incremental = true; }
+        else if (strcmp(argv[i], "--manifest") == 0)
+        {
+            // The format is optional. Anything else after it is an image.
+            manifest = true;
+            if (i + 1 < argc && strcmp(argv[i + 1], "csv") == 0) { manifestFormat = MANIFEST_CSV; }
+            if (i + 1 < argc && (strcmp(argv[i + 1], "csv") == 0 || strcmp(argv[i + 1], "json") == 0)) { ++i; }
+        }
+        else if (strcmp(argv[i], "-j") == 0 || (strncmp(argv[i], "-j", 2) == 0 && is_number(&argv[i][2])))
+        {
+            const char *value = get_option_value(argc, argv, &i);
+            threadCount       = value ? atoi(value) : 0;
+            if (threadCount <= 0) { threadCount = ThreadPool_GetProcessorCount(); }
+            threadsSet = true;
+        }
+        else { imagePaths[imageCount++] = argv[i]; }
+    }
 
-        if (!xenoReader)
+    if (imageCount == 0)
+    {
+        printf("Usage: ./XenoREADER [-j threads] \"[path/to/XenogearsDisc1.bin]\" \"[path/to/XenogearsDisc2.bin]\"\n");
+        printf("    -j N            Extracts with N threads. Leaving N out uses every processor.\n");
+        printf("    --sequential    Extracts in sector order with one pass over each image.\n");
+        printf("    --decompress    Also writes a decompressed copy of every LZSS compressed file as .dec.bin.\n");
+        printf("    --pack          Writes every file into one Xenogears_Disc_N.pack instead of a directory tree.\n");
+        printf("    --incremental   Only rewrites files that changed since the last --incremental run and removes\n");
+        printf("                    outputs that are gone from the image.\n");
+        printf("    --xa            Demuxes XA audio into WAV files instead of extracting files.\n");
+        printf("    --verify        Checks the EDC and ECC of every sector instead of extracting files.\n");
+        printf("    --manifest [F]  Hashes the image and every file into a manifest instead of extracting files.\n");
+        printf("                    F is json or csv. Leaving F out writes JSON.\n");
+        return -1;
+    }
+
+    // A pack is always written whole, so there's nothing to compare against.
+    if (incremental && pack)
+    {
+        printf("--incremental only works with directory output. Extracting everything...\n");
+        incremental = false;
+    }
+
+    // Every image is opened and planned up front. This way the files from every disc can be extracted at once.
+    for (int i = 0; i < imageCount; i++)
+    {
+        printf("Opening \"%s\" and verifying image... ", imagePaths[i]);
+        readers[i] = XenoReader_Open(imagePaths[i]);
+
+        if (!readers[i])
         {
             printf("File is not a valid Xenogears image!\n");
             continue;
         }
 
-        printf("Xenogears Disc #%i detected.\n", XenoReader_GetDiscNumber(xenoReader));
+        printf("Xenogears Disc #%i detected.\n", XenoReader_GetDiscNumber(readers[i]));
         printf("Begin extracting contents...\n");
 
-        XenoDir *root = XenoReader_GetRootDirectory(xenoReader);
-        if (!root)
+        // This is where we begin and put the root directory.
+        char outputPath[PATH_BUFFER_SIZE] = {0};
+        snprintf(outputPath, PATH_BUFFER_SIZE, "./Xenogears_Disc_%i", XenoReader_GetDiscNumber(readers[i]));
+
+        // Demuxing is one pass over the whole image, so there's nothing to plan or hand out to threads.
+        if (xa)
         {
-            printf("Root directory is NULL!");
+            if (!XaExtract_Run(readers[i], outputPath)) { printf("XA demuxing finished with errors!\n"); }
             continue;
         }
 
-        // This is where we begin and put the root directory.
-        char outputPath[PATH_BUFFER_SIZE] = {0};
-        snprintf(outputPath, PATH_BUFFER_SIZE, "./Xenogears_Disc_%i", XenoReader_GetDiscNumber(xenoReader));
-        create_directory(outputPath);
+        print_directories(XenoReader_GetRootDirectory(readers[i]));
+        plans[i] = ExtractPlan_Create(readers[i], outputPath);
+        if (!plans[i])
+        {
+            printf("Error reading filesystem of \"%s\"!\n", imagePaths[i]);
+            continue;
+        }
 
-        extract_directory(xenoReader, root, outputPath, true);
+        // The plan is only needed to name the files bad sectors belong to. Verifying uses every processor unless told
+        // otherwise since it's one big job per image.
+        if (verify)
+        {
+            if (!VerifyImage_Run(readers[i], plans[i], threadsSet ? threadCount : 0))
+            {
+                printf("Image \"%s\" failed verification!\n", imagePaths[i]);
+            }
 
-        XenoReader_Close(xenoReader);
-    }
+            ExtractPlan_Free(plans[i]);
+            plans[i] = NULL;
+            continue;
+        }
 
-    return 0;
-}
+        // Hashing is one sweep over the image like verifying, so it gets every processor the same way.
+        if (manifest)
+        {
+            if (!Manifest_Run(readers[i], plans[i], outputPath, manifestFormat, threadsSet ? threadCount : 0))
+            {
+                printf("Manifest of \"%s\" finished with errors!\n", imagePaths[i]);
+            }
 
-static void extract_directory(XenoReader *reader, const XenoDir *dir, const char *target, bool resetCount)
-{
-    static int dirCount = 0;
-    if (resetCount) { dirCount = 0; }
+            ExtractPlan_Free(plans[i]);
+            plans[i] = NULL;
+            continue;
+        }
+
+        // Nothing is created on disk for a pack until it's finished.
+        char packPath[PATH_BUFFER_SIZE] = {0};
+        snprintf(packPath, PATH_BUFFER_SIZE, "%s.pack", outputPath);
+
+        sinks[i] = pack ? OutputSink_OpenPack(outputPath, packPath) : OutputSink_OpenDirectory(plans[i]);
+        if (!sinks[i])
+        {
+            printf("Error opening output of \"%s\"!\n", imagePaths[i]);
+            ExtractPlan_Free(plans[i]);
+            plans[i] = NULL;
+            continue;
+        }
 
-    char outputPath[PATH_BUFFER_SIZE] = {0};
-    // 0 is always the root. This will make this less confusing IMO.
-    if (dirCount == 0)
+        // This marks every file that's already up to date so extraction skips it.
+        if (incremental)
+        {
+            incrementals[i] = IncrementalExtract_Begin(readers[i], plans[i], outputPath, threadsSet ? threadCount : 0);
+            if (!incrementals[i]) { printf("Extracting everything from \"%s\"...\n", imagePaths[i]); }
+        }
+
+        ExtractPlan_SetSink(plans[i], sinks[i]);
+    }
+
+    // Verifying, hashing and demuxing are already done, so there might not be anything left to extract. Nothing is
+    // started for nothing.
+    bool extracting = false;
+    for (int i = 0; i < imageCount; i++) { extracting = extracting || plans[i]; }
+
+    if (threadCount == 1 || !extracting)
     {
-        snprintf(outputPath, PATH_BUFFER_SIZE, "%s/DISC_ROOT", target);
-        ++dirCount;
+        for (int i = 0; i < imageCount; i++)
+        {
+            if (sequential && plans[i]) { extract_plan_sequential(plans[i]); }
+
+            const int jobCount = plans[i] && !sequential ? ExtractPlan_GetJobCount(plans[i]) : 0;
+            for (int j = 0; j < jobCount; j++)
+            {
+                ExtractJob *job = ExtractPlan_GetJobAt(plans[i], j);
+                if (!job->skipExtract) { extract_file(job); }
+            }
+
+            // Decompressing reads straight from the image, so it doesn't care how the files were extracted.
+            const int decompressCount = plans[i] && decompress ? ExtractPlan_GetJobCount(plans[i]) : 0;
+            for (int j = 0; j < decompressCount; j++)
+            {
+                ExtractJob *job = ExtractPlan_GetJobAt(plans[i], j);
+                if (!job->skipDecompress) { decompress_file(job); }
+            }
+        }
     }
-    else { snprintf(outputPath, PATH_BUFFER_SIZE, "%s/DIR_%04d", target, dirCount++); }
+    else
+    {
+        ThreadPool *pool = ThreadPool_Create(threadCount);
+        if (!pool)
+        {
+            printf("Error starting %i threads!\n", threadCount);
+            return -1;
+        }
+
+        printf("Extracting with %i threads...\n", ThreadPool_GetThreadCount(pool));
+        for (int i = 0; i < imageCount; i++)
+        {
+            // A sequential pass can't be split up, but every image can get its own. Anything that can't be queued is
+            // run right here instead of being lost.
+            if (sequential && plans[i] && !ThreadPool_Submit(pool, extract_plan_sequential, plans[i]))
+            {
+                extract_plan_sequential(plans[i]);
+            }
 
-    // Ensure the end output path exists.
-    create_directory(outputPath);
+            const int jobCount = plans[i] && !sequential ? ExtractPlan_GetJobCount(plans[i]) : 0;
+            for (int j = 0; j < jobCount; j++)
+            {
+                ExtractJob *job = ExtractPlan_GetJobAt(plans[i], j);
+                if (!job->skipExtract && !ThreadPool_Submit(pool, extract_file, job)) { extract_file(job); }
+            }
 
-    // Need these to loop.
-    const int subDirs = XenoDir_GetSubDirCount(dir);
-    const int files   = XenoDir_GetFileCount(dir);
+            const int decompressCount = plans[i] && decompress ? ExtractPlan_GetJobCount(plans[i]) : 0;
+            for (int j = 0; j < decompressCount; j++)
+            {
+                ExtractJob *job = ExtractPlan_GetJobAt(plans[i], j);
+                if (!job->skipDecompress && !ThreadPool_Submit(pool, decompress_file, job)) { decompress_file(job); }
+            }
+        }
 
-    for (int i = 0; i < subDirs; i++)
+        // This waits for everything to finish.
+        ThreadPool_Free(pool);
+    }
+
+    bool failed = false;
+    for (int i = 0; i < imageCount; i++)
     {
-        printf("Opening sub-directory %i...\n", i);
-        const XenoDir *subDir = XenoDir_GetDirAt(dir, i);
-        extract_directory(reader, subDir, outputPath, false);
+        // Every file is closed by now, so this is where a pack gets its table.
+        if (!OutputSink_Finish(sinks[i]))
+        {
+            printf("Error finishing output of \"%s\"!\n", imagePaths[i]);
+            failed = true;
+        }
+
+        // Anything that failed keeps the last manifest, so it's tried again next time. Other images don't care.
+        const bool extracted = plans[i] && ExtractPlan_GetFailureCount(plans[i]) == 0;
+        if (!readers[i] || (plans[i] && !extracted)) { failed = true; }
+        if (incrementals[i] && !IncrementalExtract_Finish(incrementals[i], extracted))
+        {
+            printf("Manifest of \"%s\" was not updated!\n", imagePaths[i]);
+        }
+
+        ExtractPlan_Free(plans[i]);
+        XenoReader_Close(readers[i]);
     }
 
-    for (int i = 0; i < files; i++)
+    free(incrementals);
+    free(sinks);
+    free(plans);
+    free(readers);
+    free(imagePaths);
+
+    return failed ? -1 : 0;
+}
+
+static void extract_file(void *argument)
+{
+    const ExtractJob *job = (const ExtractJob *)argument;
+    const uint32_t sector = XenoFile_GetSector(job->file);
+
+    // The stream only ever holds a window of the file, so memory doesn't depend on how big the file is.
+    XenoFileStream *stream = XenoReader_OpenFileStream(job->reader, job->file);
+    if (!stream)
     {
-        // Grab the pointer to the file.
-        const XenoFile *file = XenoDir_GetFileAt(dir, i);
-        // This sector is basically padding.
-        if (XenoFile_GetSector(file) == 0xFFFFFF) { break; }
+        printf("Error reading file at sector 0x%0X!\n", sector);
+        ExtractPlan_RecordFailure(job->plan);
+        return;
+    }
 
-        // Create this so we have it to print.
-        char filePath[PATH_BUFFER_SIZE] = {0};
-        snprintf(filePath, PATH_BUFFER_SIZE, "%s/FILE_%04d.bin", outputPath, i + 1);
+    void *out = OutputSink_Open(job->sink, job->path, sector, (uint64_t)XenoFileStream_GetSize(stream));
+    if (!out)
+    {
+        printf("Error opening \"%s\" for writing!\n", job->path);
+        ExtractPlan_RecordFailure(job->plan);
+        XenoFileStream_Close(stream);
+        return;
+    }
 
-        // Print a message so it looks like important things are happening when we're all just playing video games and
-        // waiting to die.
-        printf("Extracting file at sector 0x%0X to \"%s\"... ", XenoFile_GetSector(file), filePath);
+    bool success = true;
 
-        // Make reader read file to buffer to use.
-        XenoBuffer *fileBuffer = XenoReader_ReadFile(reader, file);
-        FILE *out              = fopen(filePath, "wb");
-        if (!out)
+    unsigned char buffer[XENO_FILE_STREAM_WINDOW_SECTORS * DATA_SIZE];
+    while (true)
+    {
+        const int64_t bytesRead = XenoFileStream_Read(stream, buffer, sizeof(buffer));
+        if (bytesRead < 0)
         {
-            printf("Error opening file for writing!\n");
-            continue;
+            printf("Error reading file at sector 0x%0X!\n", sector);
+            success = false;
         }
+        if (bytesRead <= 0) { break; }
 
-        if (fwrite(fileBuffer->data, 1, fileBuffer->size, out) != fileBuffer->size)
+        if (!OutputSink_Write(job->sink, out, buffer, (size_t)bytesRead))
         {
-            printf("Error writing buffer contents to file!\n");
-            XenoBuffer_Free(fileBuffer);
-            fclose(out);
-            continue;
+            printf("Error writing \"%s\"!\n", job->path);
+            success = false;
+            break;
         }
+    }
+
+    // A file can still come up short without either of the above, so closing has the final say.
+    if (!OutputSink_CloseEntry(job->sink, out, true) && success)
+    {
+        printf("Error writing \"%s\"!\n", job->path);
+        success = false;
+    }
+    XenoFileStream_Close(stream);
+
+    if (!success)
+    {
+        ExtractPlan_RecordFailure(job->plan);
+        return;
+    }
+
+    // Print a message so it looks like important things are happening when we're all just playing video games and
+    // waiting to die. This is one call so lines from different threads don't get mixed together.
+    printf("Extracting file at sector 0x%0X to \"%s\"... Finished!\n", sector, job->path);
+}
 
-        fclose(out);
-        XenoBuffer_Free(fileBuffer);
-        printf("Finished!\n");
+static void decompress_file(void *argument) { DecompressFile_Run((const ExtractJob *)argument); }
+
+static void extract_plan_sequential(void *argument)
+{
+    ExtractPlan *plan = (ExtractPlan *)argument;
+    if (!SequentialExtract_Run(plan))
+    {
+        printf("Sequential extraction finished with errors!\n");
+        ExtractPlan_RecordFailure(plan);
     }
-}
\ No newline at end of file
+}
+
+static const char *get_option_value(int argc, const char *argv[], int *index)
+{
+    // -jN
+    const char *argument = argv[*index];
+    if (argument[2] != '\0') { return &argument[2]; }
+
+    // -j N. A bare -j followed by an image means every processor, like make.
+    if (*index + 1 < argc && is_number(argv[*index + 1])) { return argv[++*index]; }
+
+    return NULL;
+}
+
+static bool is_number(const char *text)
+{
+    if (*text == '\0') { return false; }
+
+    for (; *text != '\0'; text++)
+    {
+        if (!isdigit((unsigned char)*text)) { return false; }
+    }
+
+    return true;
+}
+
+static void print_directories(const XenoDir *dir)
+{
+    if (!dir) { return; }
+
+    const int subDirs = XenoDir_GetSubDirCount(dir);
+    for (int i = 0; i < subDirs; i++)
+    {
+        printf("Opening sub-directory %i...\n", i);
+        print_directories(XenoDir_GetDirAt(dir, i));
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// Decoders for the two general purpose codecs CHD images use: raw deflate (RFC 1951, no zlib header) and raw LZMA (no
+// header and no end marker needed). The size of what comes out is always known up front and everything is decoded in
+// one call, so neither keeps a window between calls.
+
+/// @brief Decodes raw deflate.
+/// @param input Compressed bytes.
+/// @param inputSize Number of compressed bytes.
+/// @param output Buffer to decode to.
+/// @param outputSize Number of bytes to decode.
+/// @return True if exactly outputSize bytes were decoded. False if the input is corrupt or ends early.
+bool Inflate_Decode(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize);
+
+/// @brief Decodes raw LZMA.
+/// @param input Compressed bytes. This begins with the range coder's first byte.
+/// @param inputSize Number of compressed bytes.
+/// @param output Buffer to decode to.
+/// @param outputSize Number of bytes to decode. Decoding stops here whether there's an end marker or not.
+/// @param lc Number of literal context bits.
+/// @param lp Number of literal position bits.
+/// @param pb Number of position bits.
+/// @return True if exactly outputSize bytes were decoded. False if the input is corrupt or ends early.
+bool Lzma_Decode(const unsigned char *input,
+                 size_t inputSize,
+                 unsigned char *output,
+                 size_t outputSize,
+                 int lc,
+                 int lp,
+                 int pb);
@@ -0,0 +1,80 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming SHA-1 and XXH3. SHA-1 is what Redump lists dumps by. XXH3 is the 64 bit variant with a seed of 0 and the
+// default secret, so it matches xxhsum -H3 and every other implementation. Both take their input in any number of
+// pieces and give the same result as if it came all at once.
+
+/// @brief Size of a SHA-1 digest.
+#define DIGEST_SHA1_SIZE 20
+
+// clang-format off
+/// @brief SHA-1 state.
+typedef struct
+{
+    /// @brief Intermediate hash.
+    uint32_t state[5];
+
+    /// @brief Number of bytes taken so far.
+    uint64_t length;
+
+    /// @brief Bytes that don't fill a block yet.
+    unsigned char buffer[64];
+    size_t bufferedSize;
+} Sha1State;
+
+/// @brief XXH3 state.
+typedef struct
+{
+    /// @brief Accumulators. These are aligned so the vector kernel can load them directly.
+    _Alignas(16) uint64_t acc[8];
+
+    /// @brief Number of bytes taken so far.
+    uint64_t length;
+
+    /// @brief Number of stripes taken since the last scramble.
+    size_t stripeCount;
+
+    /// @brief Input that hasn't been taken yet. The last 64 bytes taken are kept at the end in case the input ends
+    /// right on a stripe.
+    unsigned char buffer[256];
+    size_t bufferedSize;
+} Xxh3State;
+// clang-format on
+
+/// @brief Starts a SHA-1.
+void Sha1_Init(Sha1State *state);
+
+/// @brief Adds bytes to a SHA-1.
+/// @param state State to add to.
+/// @param data Bytes to add.
+/// @param size Number of bytes.
+void Sha1_Update(Sha1State *state, const void *data, size_t size);
+
+/// @brief Finishes a SHA-1. The state can't be updated after this.
+/// @param state State to finish.
+/// @param digestOut Set to DIGEST_SHA1_SIZE bytes of digest.
+void Sha1_Final(Sha1State *state, unsigned char *digestOut);
+
+/// @brief Starts an XXH3.
+void Xxh3_Init(Xxh3State *state);
+
+/// @brief Adds bytes to an XXH3.
+/// @param state State to add to.
+/// @param data Bytes to add.
+/// @param size Number of bytes.
+void Xxh3_Update(Xxh3State *state, const void *data, size_t size);
+
+/// @brief Returns the XXH3 of everything added so far. The state isn't changed, so more can be added after.
+uint64_t Xxh3_Digest(const Xxh3State *state);
+
+/// @brief Returns the name of the kernel XXH3 stripes are accumulated with.
+const char *Xxh3_GetKernelName(void);
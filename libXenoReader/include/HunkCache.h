@@ -0,0 +1,41 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// This is the cache of decoded hunks the compressed backends keep. Decoding a hunk takes far longer than copying one,
+// and reads of neighboring sectors land in the same hunk over and over. There are only ever a handful of slots, so one
+// lock and a linear search are plenty.
+
+typedef struct HunkCache HunkCache;
+
+/// @brief Creates a cache.
+/// @param hunkSize Size of every hunk in bytes.
+/// @param slotCount Number of hunks to hold.
+/// @return Cache on success. NULL on failure.
+HunkCache *HunkCache_Create(size_t hunkSize, int slotCount);
+
+/// @brief Frees the cache.
+void HunkCache_Free(HunkCache *cache);
+
+/// @brief Copies part of a hunk out of the cache if it's there.
+/// @param cache Cache to check.
+/// @param hunk Hunk number.
+/// @param offset Offset in the hunk to begin copying at.
+/// @param buffer Buffer to copy to.
+/// @param length Number of bytes to copy. This can't run past the end of the hunk.
+/// @return True on a hit. False on a miss.
+bool HunkCache_Read(HunkCache *cache, uint64_t hunk, size_t offset, void *buffer, size_t length);
+
+/// @brief Copies a hunk into the cache. If the cache is full, something that hasn't been used lately is evicted.
+/// @param cache Cache to add to.
+/// @param hunk Hunk number.
+/// @param hunkData The whole hunk.
+void HunkCache_Put(HunkCache *cache, uint64_t hunk, const void *hunkData);
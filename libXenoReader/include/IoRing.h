@@ -0,0 +1,50 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// This is a bare minimum io_uring wrapper that only does reads. It talks to the kernel directly so there's nothing
+// extra to link. Everywhere other than Linux, IoRing_Create just returns NULL.
+
+typedef struct IoRing IoRing;
+
+/// @brief Creates a ring.
+/// @param entryCount Number of reads that can be queued before they need to be submitted.
+/// @return Ring on success. NULL if io_uring isn't available or is blocked.
+IoRing *IoRing_Create(unsigned int entryCount);
+
+/// @brief Frees the ring. Reads still in flight need to be reaped first or their buffers can still be written to.
+void IoRing_Free(IoRing *ring);
+
+/// @brief Returns the number of completions the ring can hold. More reads than this should never be in flight.
+unsigned int IoRing_GetCompletionCapacity(const IoRing *ring);
+
+/// @brief Queues a read. Nothing happens until IoRing_Submit is called.
+/// @param ring Ring to queue to.
+/// @param descriptor File to read from.
+/// @param buffer Buffer to read to.
+/// @param length Number of bytes to read.
+/// @param offset Offset in the file.
+/// @param userData Handed back with the completion.
+/// @return True on success. False if the submission queue is full.
+bool IoRing_QueueRead(IoRing *ring, int descriptor, void *buffer, uint32_t length, uint64_t offset, uint64_t userData);
+
+/// @brief Submits everything queued and optionally waits for completions.
+/// @param ring Ring to submit.
+/// @param waitCount Number of completions to wait for. 0 doesn't wait.
+/// @return True on success. False on failure.
+bool IoRing_Submit(IoRing *ring, unsigned int waitCount);
+
+/// @brief Takes one completion if there is one.
+/// @param ring Ring to take from.
+/// @param userDataOut Set to the userData the read was queued with.
+/// @param resultOut Set to the number of bytes read or a negative errno.
+/// @return True if there was a completion. False if there wasn't.
+bool IoRing_PopCompletion(IoRing *ring, uint64_t *userDataOut, int32_t *resultOut);
@@ -30,6 +30,16 @@ typedef struct
     uint8_t mode;
 } SectorHeader;
 
+/// @brief Bits of SectorSubHeader.subMode.
+#define SUBMODE_END_OF_RECORD 0x01
+#define SUBMODE_VIDEO         0x02
+#define SUBMODE_AUDIO         0x04
+#define SUBMODE_DATA          0x08
+#define SUBMODE_TRIGGER       0x10
+#define SUBMODE_FORM_2        0x20
+#define SUBMODE_REAL_TIME     0x40
+#define SUBMODE_END_OF_FILE   0x80
+
 /// @brief This is the subheader struct. Every sector has this repeated.
 typedef struct
 {
@@ -53,7 +63,7 @@ typedef struct
     /// @brief This is the raw sector data.
     uint8_t data[DATA_SIZE];
     
-    /// @brief I'm not entirely sure what is here. I don't really care about it either unless it becomes a problem. Then I'll care.
+    /// @brief The EDC and ECC of Form 1 sectors. Form 2 sectors have more data and put their EDC at the very end.
     uint8_t edcCrc[EDC_CRC_SIZE];
 } Sector;
 
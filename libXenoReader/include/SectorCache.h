@@ -0,0 +1,51 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// This is the cache of raw sectors a reader can put in front of a backend. It's split into shards that each have their
+// own lock and their own CLOCK hand, so threads reading different sectors rarely wait on each other.
+
+typedef struct SectorCache SectorCache;
+
+/// @brief Creates a cache.
+/// @param budget Maximum number of bytes of sectors to hold.
+/// @return Cache on success. NULL on failure or if the budget can't hold at least one sector per shard.
+SectorCache *SectorCache_Create(size_t budget);
+
+/// @brief Frees the cache.
+void SectorCache_Free(SectorCache *cache);
+
+/// @brief Copies a sector out of the cache if it's there.
+/// @param cache Cache to check.
+/// @param sector Sector number.
+/// @param sectorOut Buffer that is at least SECTOR_SIZE bytes.
+/// @return True on a hit. False on a miss.
+bool SectorCache_Get(SectorCache *cache, uint32_t sector, void *sectorOut);
+
+/// @brief Copies a sector into the cache. If the sector's shard is full, something that hasn't been used lately is
+/// evicted.
+/// @param cache Cache to add to.
+/// @param sector Sector number.
+/// @param sectorData SECTOR_SIZE bytes of raw sector.
+void SectorCache_Put(SectorCache *cache, uint32_t sector, const void *sectorData);
+
+/// @brief Overwrites a sector if it's already in the cache. Nothing is added or evicted. Use this after writing.
+/// @param cache Cache to update.
+/// @param sector Sector number.
+/// @param sectorData SECTOR_SIZE bytes of raw sector.
+void SectorCache_Update(SectorCache *cache, uint32_t sector, const void *sectorData);
+
+/// @brief Gets the counters of the cache.
+/// @param cache Cache to get the counters of.
+/// @param statsOut Set to the counters.
+void SectorCache_GetStats(SectorCache *cache, XenoCacheStats *statsOut);
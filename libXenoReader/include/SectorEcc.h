@@ -0,0 +1,55 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "Sector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// This is the error detection and correction every CD-ROM sector carries. The EDC is a 32 bit CRC. The ECC is two
+// Reed-Solomon product codes over GF(2^8) called P and Q. Mode 2 sectors leave the header out of the ECC by treating it
+// as zero.
+
+/// @brief Offsets in a raw sector.
+#define SECTOR_ECC_HEADER_OFFSET 12
+#define SECTOR_ECC_P_OFFSET      2076
+#define SECTOR_ECC_Q_OFFSET      2248
+
+/// @brief Sizes of the parity.
+#define SECTOR_ECC_P_SIZE 172
+#define SECTOR_ECC_Q_SIZE 104
+
+/// @brief Offset and size of what the EDC covers in each kind of sector. The EDC is stored right after.
+#define SECTOR_EDC_MODE_1_SIZE   2064
+#define SECTOR_EDC_FORM_1_OFFSET 16
+#define SECTOR_EDC_FORM_1_SIZE   2056
+#define SECTOR_EDC_FORM_2_OFFSET 16
+#define SECTOR_EDC_FORM_2_SIZE   2332
+
+/// @brief Computes the EDC of a run of bytes.
+/// @param data Bytes to compute the EDC of.
+/// @param size Number of bytes.
+/// @return The EDC. It's stored little endian.
+uint32_t SectorEcc_ComputeEdc(const unsigned char *data, size_t size);
+
+/// @brief Computes the P parity of a sector.
+/// @param sector Raw sector.
+/// @param parityOut Set to SECTOR_ECC_P_SIZE bytes of parity.
+/// @note Mode 2 sectors are handled by treating the header as zero. The sector isn't changed.
+void SectorEcc_ComputeP(const unsigned char *sector, unsigned char *parityOut);
+
+/// @brief Computes the Q parity of a sector. Q covers P, so this uses whatever P is already in the sector.
+/// @param sector Raw sector.
+/// @param parityOut Set to SECTOR_ECC_Q_SIZE bytes of parity.
+void SectorEcc_ComputeQ(const unsigned char *sector, unsigned char *parityOut);
+
+/// @brief Rewrites the EDC and ECC of a sector to match its contents.
+/// @param sector Raw sector. The mode and for Mode 2 the subheader decide what is written.
+/// @return True on success. False if the sector isn't a mode that has an EDC.
+bool SectorEcc_Generate(unsigned char *sector);
@@ -0,0 +1,25 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stddef.h>
+
+// These are the kernels used to pull the data out of a run of raw sectors. The header and edcCrc trailer of every
+// sector are skipped and the data is packed tightly into the destination.
+
+/// @brief Copies the data of count raw sectors from source to destination using the best kernel the CPU supports.
+/// @param destination Buffer that is at least count * DATA_SIZE bytes.
+/// @param source Buffer containing count raw sectors.
+/// @param count Number of sectors.
+void SectorGather_Payloads(unsigned char *destination, const unsigned char *source, size_t count);
+
+/// @brief Same as above, but always uses plain memcpy. This is mostly here for comparison.
+void SectorGather_PayloadsScalar(unsigned char *destination, const unsigned char *source, size_t count);
+
+/// @brief Returns the name of the kernel SectorGather_Payloads uses. Large runs into aligned buffers always use SSE2
+/// streaming stores instead.
+const char *SectorGather_GetKernelName(void);
@@ -0,0 +1,44 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+/// @brief Simple work-stealing thread pool. Every thread has its own queue and takes from the others when it runs out.
+typedef struct ThreadPool ThreadPool;
+
+/// @brief Function signature for tasks submitted to the pool.
+typedef void (*ThreadPoolTask)(void *argument);
+
+/// @brief Creates a new thread pool.
+/// @param threadCount Number of threads to start. 0 or less uses the number of processors.
+/// @return Pointer to the new pool. NULL on failure.
+ThreadPool *ThreadPool_Create(int threadCount);
+
+/// @brief Waits for every task to finish, stops the threads and frees the pool.
+/// @param pool Pool to free.
+void ThreadPool_Free(ThreadPool *pool);
+
+/// @brief Submits a task to the pool.
+/// @param pool Pool to submit to.
+/// @param task Function to run.
+/// @param argument Argument passed to the function.
+/// @return True on success. False on failure.
+/// @note Tasks are allowed to submit more tasks.
+bool ThreadPool_Submit(ThreadPool *pool, ThreadPoolTask task, void *argument);
+
+/// @brief Blocks until every task submitted so far has finished.
+/// @param pool Pool to wait on.
+void ThreadPool_Wait(ThreadPool *pool);
+
+/// @brief Returns the number of threads in the pool.
+/// @param pool Pool to get the thread count of.
+int ThreadPool_GetThreadCount(const ThreadPool *pool);
+
+/// @brief Returns the number of processors available.
+int ThreadPool_GetProcessorCount(void);
@@ -0,0 +1,87 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A lot of files are archives of other files. These begin with a 32 bit little endian count followed by that many 32
+// bit offsets from the beginning of the archive. Each entry runs from its offset to the next one, and the last runs to
+// the end. Entries can be archives themselves.
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief The parsed offset table of an archive. These are cached by the reader and never need to be freed.
+typedef struct XenoArchive XenoArchive;
+
+/// @brief One entry of an archive. This is just where the entry is, so nothing is read until something asks.
+typedef struct
+{
+    /// @brief File the entry is in.
+    const XenoFile *file;
+
+    /// @brief Offset of the entry in the file and its size.
+    uint32_t offset;
+    uint32_t size;
+} XenoArchiveEntry;
+
+/// @brief Gets the table of an archive file. Only the table is read, and only the first time it's asked for.
+/// @param reader Reader the file belongs to.
+/// @param file File to parse.
+/// @return Table on success. NULL if the file doesn't look like an archive or couldn't be read.
+/// @note Files that aren't archives are remembered too, so asking again doesn't read anything. Tables stay valid until
+/// the file is replaced or the reader is closed. This can be called from any number of threads at once.
+const XenoArchive *XenoReader_GetArchive(XenoReader *reader, const XenoFile *file);
+
+/// @brief Gets the table of an entry that's an archive itself. This is cached in the parent the same way.
+/// @param reader Reader the archive came from.
+/// @param archive Archive the entry belongs to.
+/// @param index Index of the entry.
+/// @return Table on success. NULL if the entry doesn't look like an archive, couldn't be read or doesn't exist.
+const XenoArchive *XenoArchive_GetNested(XenoReader *reader, const XenoArchive *archive, int index);
+
+/// @brief Returns the number of entries in the archive.
+/// @param archive Archive to get the count of.
+int XenoArchive_GetEntryCount(const XenoArchive *archive);
+
+/// @brief Gets an entry of the archive.
+/// @param archive Archive to get the entry from.
+/// @param index Index of the entry.
+/// @param entryOut Set to the entry.
+/// @return True on success. False if the index is out of range.
+bool XenoArchive_GetEntry(const XenoArchive *archive, int index, XenoArchiveEntry *entryOut);
+
+/// @brief Reads part of an entry into a buffer owned by the caller. Only the sectors that cover the range are read.
+/// @param reader Reader the entry's file belongs to.
+/// @param entry Entry to read from.
+/// @param offset Offset in the entry to begin reading at.
+/// @param length Number of bytes to read.
+/// @param dataOut Buffer that is at least length bytes.
+/// @return True on success. False on failure or if the range doesn't fit in the entry.
+bool XenoArchiveEntry_ReadRange(XenoReader *reader,
+                                const XenoArchiveEntry *entry,
+                                size_t offset,
+                                size_t length,
+                                void *dataOut);
+
+/// @brief Reads a whole entry into a new buffer.
+/// @param reader Reader the entry's file belongs to.
+/// @param entry Entry to read.
+/// @return Buffer on success. NULL on failure.
+XenoBuffer *XenoArchiveEntry_Read(XenoReader *reader, const XenoArchiveEntry *entry);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
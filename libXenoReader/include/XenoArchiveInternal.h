@@ -0,0 +1,16 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoArchive.h"
+
+#ifdef __XENO_INTERNAL__
+/// @brief Frees a cached table and every nested table cached under it. Anything the reader uses to mark files that
+/// aren't archives is ignored, as is NULL.
+/// @param archive Table to free.
+void XenoArchive_Free(XenoArchive *archive);
+#endif
@@ -0,0 +1,105 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoFile.h"
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Queue of reads that run in the background. Reads are queued, submitted as one batch, and then reaped with
+/// XenoAsync_Poll.
+/// @note If the reader was opened with a XenoBackend_OpenFile backend and the kernel allows it, batches are handed to
+/// io_uring. Mapped images are copied right away when the batch is submitted. Everything else is read by a thread pool.
+/// @note A queue belongs to one thread. Any number of queues can share a reader.
+typedef struct XenoAsync XenoAsync;
+
+/// @brief Called when a read finishes. This always happens inside of XenoAsync_Poll on the thread that called it.
+/// @param userData Pointer passed when the read was queued.
+/// @param success True if everything was read.
+typedef void (*XenoAsyncCallback)(void *userData, bool success);
+
+/// @brief This is what XenoAsync_Poll hands back for every read that finished.
+typedef struct
+{
+    /// @brief Pointer passed when the read was queued.
+    void *userData;
+
+    /// @brief True if everything was read.
+    bool success;
+} XenoAsyncCompletion;
+
+/// @brief Creates a queue.
+/// @param reader Reader to read from. This needs to stay open until the queue is freed.
+/// @param queueDepth Maximum number of reads in flight at once. 0 or less uses 64.
+/// @return Queue on success. NULL on failure.
+XenoAsync *XenoAsync_Create(XenoReader *reader, int queueDepth);
+
+/// @brief Waits for every read in flight and frees the queue. Completions that were never polled are dropped.
+/// @param async Queue to free.
+void XenoAsync_Free(XenoAsync *async);
+
+/// @brief Queues a read of a whole file.
+/// @param async Queue to add the read to.
+/// @param file File to read.
+/// @param dataOut Buffer that is at least XenoFile_GetSize bytes. This needs to stay valid until the read finishes.
+/// @param callback Optional. Called when the read finishes.
+/// @param userData Passed to the callback and returned by XenoAsync_Poll.
+/// @return True on success. False on failure.
+bool XenoAsync_QueueFile(XenoAsync *async,
+                         const XenoFile *file,
+                         unsigned char *dataOut,
+                         XenoAsyncCallback callback,
+                         void *userData);
+
+/// @brief Queues a read of the data of a run of sectors. This is the same as XenoReader_ReadSectorData.
+/// @param async Queue to add the read to.
+/// @param firstSector First sector to read.
+/// @param count Number of sectors.
+/// @param dataOut Buffer that is at least count * DATA_SIZE bytes. This needs to stay valid until the read finishes.
+/// @param callback Optional. Called when the read finishes.
+/// @param userData Passed to the callback and returned by XenoAsync_Poll.
+/// @return True on success. False on failure.
+bool XenoAsync_QueueSectorData(XenoAsync *async,
+                               size_t firstSector,
+                               size_t count,
+                               unsigned char *dataOut,
+                               XenoAsyncCallback callback,
+                               void *userData);
+
+/// @brief Submits every read queued since the last submit as one batch.
+/// @param async Queue to submit.
+/// @return Number of reads submitted. -1 on failure.
+int XenoAsync_Submit(XenoAsync *async);
+
+/// @brief Reaps finished reads. Callbacks are called here.
+/// @param async Queue to poll.
+/// @param completionsOut Optional. Array to write completions to.
+/// @param maxCompletions Maximum number of completions to reap.
+/// @param wait If true and nothing has finished yet, blocks until at least one read does.
+/// @return Number of completions reaped.
+int XenoAsync_Poll(XenoAsync *async, XenoAsyncCompletion *completionsOut, int maxCompletions, bool wait);
+
+/// @brief Returns the number of reads submitted that haven't been reaped yet.
+/// @param async Queue to get the count of.
+int XenoAsync_GetPendingCount(const XenoAsync *async);
+
+/// @brief Returns the name of what the queue is using to read. "io_uring", "mapped" or "thread pool".
+/// @param async Queue to get the name of.
+const char *XenoAsync_GetEngineName(const XenoAsync *async);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
@@ -0,0 +1,135 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief This is what XenoReader actually pulls bytes from. It can be a FILE, a memory map, or whatever else.
+typedef struct XenoBackend XenoBackend;
+
+/// @brief Table of functions used to implement a backend. Only read is required.
+/// @note Readers call read and map from whatever threads are using them, so both need to be safe to call at the same
+/// time if a reader is going to be shared. Write is called from multiple threads too, but never on the same bytes.
+typedef struct
+{
+    /// @brief Reads length bytes starting at offset into buffer. Must return true only if everything was read.
+    bool (*read)(void *context, uint64_t offset, void *buffer, size_t length);
+
+    /// @brief Optional. Returns a pointer to length bytes at offset if the image is already in memory. NULL otherwise.
+    const void *(*map)(void *context, uint64_t offset, size_t length);
+
+    /// @brief Optional. Frees whatever the context holds.
+    void (*close)(void *context);
+
+    /// @brief Optional. Writes length bytes from buffer starting at offset. Must return true only if everything was
+    /// written. Backends without this are read-only.
+    bool (*write)(void *context, uint64_t offset, const void *buffer, size_t length);
+} XenoBackendInterface;
+
+/// @brief Creates a backend from a custom interface.
+/// @param interface Function table. This is copied.
+/// @param context Pointer passed to every function in the table.
+/// @param size Total size of the image in bytes.
+XenoBackend *XenoBackend_Create(const XenoBackendInterface *interface, void *context, uint64_t size);
+
+/// @brief Opens a backend that uses fseek and fread. This is how XenoReader has always worked.
+/// @param path Path to the image.
+/// @note The FILE is locked for every read, so this is thread safe, but reads never overlap.
+XenoBackend *XenoBackend_OpenStdio(const char *path);
+
+/// @brief Opens a backend that uses pread on a file descriptor. Reads from multiple threads can overlap.
+/// @param path Path to the image.
+/// @return Backend on success. NULL on failure or if the platform doesn't have pread.
+XenoBackend *XenoBackend_OpenFile(const char *path);
+
+/// @brief Opens a backend that can write to the image as well as read it. Nothing is ever mapped.
+/// @param path Path to the image.
+/// @return Backend on success. NULL on failure.
+/// @note This uses pread and pwrite where they're available and a locked FILE everywhere else.
+XenoBackend *XenoBackend_OpenWritable(const char *path);
+
+/// @brief Opens a backend that maps the image read-only. Reading a sector is just pointer arithmetic.
+/// @param path Path to the image.
+/// @return Backend on success. NULL on failure or if the platform doesn't support mmap.
+/// @note This is always NULL on Windows, where none of the backends that open a path have map. Everything there is
+/// read into buffers instead.
+XenoBackend *XenoBackend_OpenMmap(const char *path);
+
+/// @brief Opens a backend over an image that is already in memory.
+/// @param data Pointer to the image. This isn't copied, so it needs to stay valid until the backend is closed.
+/// @param size Size of the image in bytes.
+XenoBackend *XenoBackend_OpenMemory(const void *data, size_t size);
+
+/// @brief Opens a backend that decodes an ECM image. Everything reads as the raw image the ECM was made from.
+/// @param source Backend holding the ECM file. The new backend takes this over and closes it when it's closed.
+/// @return Backend on success. NULL on failure, in which case the source still belongs to the caller.
+/// @note Every record header is read once up front to find where decoding has to begin for each block of 16 sectors.
+/// Reads only decode the blocks they touch, and the last few blocks decoded are kept. Nothing can be mapped.
+XenoBackend *XenoBackend_OpenEcm(XenoBackend *source);
+
+/// @brief Opens a backend that decodes a CHD image of a CD. Everything reads as the raw sectors of the first track,
+/// without subcode, so it looks just like a BIN.
+/// @param source Backend holding the CHD file. The new backend takes this over and closes it when it's closed.
+/// @return Backend on success. NULL on failure, in which case the source still belongs to the caller.
+/// @note Only version 5 images without a parent are read. Hunks can be stored as they are, refer to an earlier hunk or
+/// be compressed with deflate or LZMA, with or without the CD variants. Images with FLAC or Zstandard hunks fail to
+/// open. Reads only decode the hunks they touch, and the last few hunks decoded are kept.
+XenoBackend *XenoBackend_OpenChd(XenoBackend *source);
+
+/// @brief Closes the backend and frees it.
+/// @param backend Backend to close.
+void XenoBackend_Close(XenoBackend *backend);
+
+/// @brief Returns the size of the image the backend is reading.
+/// @param backend Backend to get the size of.
+uint64_t XenoBackend_GetSize(const XenoBackend *backend);
+
+/// @brief Reads from the backend.
+/// @param backend Backend to read from.
+/// @param offset Offset in bytes to begin reading at.
+/// @param buffer Buffer to read to.
+/// @param length Number of bytes to read.
+/// @return True on success. False on failure.
+bool XenoBackend_Read(XenoBackend *backend, uint64_t offset, void *buffer, size_t length);
+
+/// @brief Writes to the backend.
+/// @param backend Backend to write to.
+/// @param offset Offset in bytes to begin writing at.
+/// @param buffer Bytes to write.
+/// @param length Number of bytes to write.
+/// @return True on success. False on failure, if it would go past the end of the image, or if the backend is read-only.
+bool XenoBackend_Write(XenoBackend *backend, uint64_t offset, const void *buffer, size_t length);
+
+/// @brief Returns true if the backend can be written to.
+/// @param backend Backend to check.
+bool XenoBackend_IsWritable(const XenoBackend *backend);
+
+/// @brief Returns a pointer to the bytes requested if the backend has the image in memory.
+/// @param backend Backend to map from.
+/// @param offset Offset in bytes.
+/// @param length Number of bytes that need to be valid from the pointer.
+/// @return Pointer on success. NULL if the backend can't map or the range is out of bounds.
+const void *XenoBackend_Map(XenoBackend *backend, uint64_t offset, size_t length);
+
+/// @brief Returns the file descriptor the backend reads from if it was opened with XenoBackend_OpenFile.
+/// @param backend Backend to get the descriptor of.
+/// @return Descriptor on success. -1 if the backend doesn't read through a descriptor.
+/// @note The descriptor still belongs to the backend. This is here so reads can be handed straight to the kernel.
+int XenoBackend_GetDescriptor(const XenoBackend *backend);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
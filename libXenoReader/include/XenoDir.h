@@ -10,16 +10,12 @@
 
 #include <stdint.h>
 
+/// @brief Directory in the hidden filesystem. Once XenoReader_Open returns, any number of threads can walk these. The
+/// only change ever made is XenoReader_ReplaceFiles updating file sizes in place, which can't happen while they do.
+/// @note Every directory and file of a reader lives in one flat table owned by the reader. These are only views into
+/// it and are freed when the reader is closed.
 typedef struct XenoDir XenoDir;
 
-/// @brief Creates a new XenoDir with the default initial capacity.
-XenoDir *XenoDir_Create();
-
-/// @brief Frees the XenoDir.
-/// @param dir Dir to free.
-/// @param isRoot Whether or not the dir is the root of the Xenogears filesystem.
-void XenoDir_Free(XenoDir *dir, bool isRoot);
-
 /// @brief Returns the subdirectory count.
 /// @param dir Directory to get subdirectory count of.
 uint32_t XenoDir_GetSubDirCount(const XenoDir *dir);
@@ -6,8 +6,8 @@
  *      See the included LICENSE file for license and attribution details.
  */
 #pragma once
-#include "DynamicArray.h"
-
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define __XENO_INTERNAL__
@@ -16,14 +16,79 @@
 #ifdef __XENO_INTERNAL__
 
 // clang-format off
+/// @brief This is a raw entry from the table of contents.
+typedef struct
+{
+    uint32_t sector;
+    int32_t size;
+
+    /// @brief Where the entry sits in the table of contents, counting the entries that get skipped.
+    uint32_t tableIndex;
+} FsEntry;
+
+/// @brief Directories are just spans of the table below. Nothing in here is a pointer, so the whole table can be
+/// copied or mapped anywhere and still work.
 struct XenoDir
 {
-    /// @brief Sub directory array.
-    DynamicArray *subDirs;
+    /// @brief Index of this directory in the table. This is how the table is found from a directory.
+    uint32_t index;
+
+    /// @brief Index of the first subdirectory. Subdirectories of the same directory are always next to each other.
+    uint32_t firstSubDir;
 
-    /// @brief File array.
-    DynamicArray *files;
+    /// @brief Number of subdirectories.
+    uint32_t subDirCount;
+
+    /// @brief Index of the first file. Files of the same directory are always next to each other.
+    uint32_t firstFile;
+
+    /// @brief Number of files.
+    uint32_t fileCount;
 };
+
+/// @brief This is the whole filesystem in one allocation. The root is always dirs[0] and the files array directly
+/// follows the directories.
+typedef struct
+{
+    /// @brief Total number of directories including the root.
+    uint32_t dirCount;
+
+    /// @brief Total number of files.
+    uint32_t fileCount;
+
+    /// @brief Directory array. The file array is right after it.
+    XenoDir dirs[];
+} XenoFsTable;
 // clang-format on
 
-#endif
\ No newline at end of file
+/// @brief Builds the table from the raw entries. This is a single allocation. Free it with free().
+/// @param entries Entries read from the table of contents.
+/// @param entryCount Number of entries.
+XenoFsTable *XenoFsTable_Build(const FsEntry *entries, int entryCount);
+
+/// @brief Reads the raw entries out of the table of contents and builds the table from them.
+/// @param tableData Data of the table of contents sectors.
+/// @param size Size of the data. Anything past the last whole entry is ignored.
+/// @return Table on success. Free it with free(). NULL if memory couldn't be allocated.
+XenoFsTable *XenoFsTable_Parse(const unsigned char *tableData, size_t size);
+
+/// @brief Works out which entry of the table of contents every file was read from. Files are laid out by directory,
+/// so their order doesn't match the table's.
+/// @param tableData Data of the table of contents sectors.
+/// @param size Size of the data.
+/// @param fileCount Number of files the table built from the same data has.
+/// @param tableIndicesOut Array of fileCount indices to write to. The index of a file goes where the file is.
+/// @return True on success. False if the data doesn't have fileCount files or memory couldn't be allocated.
+bool XenoFsTable_GetTableIndices(const unsigned char *tableData, size_t size, uint32_t fileCount,
+                                 uint32_t *tableIndicesOut);
+
+/// @brief Returns the size of the table in bytes.
+size_t XenoFsTable_GetSize(const XenoFsTable *table);
+
+/// @brief Returns the root directory of the table.
+XenoDir *XenoFsTable_GetRoot(const XenoFsTable *table);
+
+/// @brief Returns the file array of the table.
+XenoFile *XenoFsTable_GetFiles(const XenoFsTable *table);
+
+#endif
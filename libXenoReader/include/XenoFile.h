@@ -11,10 +11,29 @@
 
 typedef struct XenoFile XenoFile;
 
+// clang-format off
+/// @brief Extra information about a file that's worked out after the image is opened. This is saved with the index.
+typedef struct
+{
+    /// @brief Hash of the file's contents. 0 if nobody has set it.
+    uint64_t hash;
+
+    /// @brief What kind of file this is. 0 means unknown. The library doesn't assign these itself.
+    uint32_t type;
+
+    /// @brief Anything else the caller wants to keep around.
+    uint32_t flags;
+} XenoFileMetadata;
+// clang-format on
+
 /// @brief Returns the sector that contains the beginning of the file.
 /// @param file File to get the sector of.
 uint32_t XenoFile_GetSector(const XenoFile *file);
 
 /// @brief Returns the size of the file passed.
 /// @param file XenoFile to get size of.
-int32_t XenoFile_GetSize(const XenoFile *file);
\ No newline at end of file
+int32_t XenoFile_GetSize(const XenoFile *file);
+
+/// @brief Returns the most the file can hold if it's replaced. This is every byte of data in the sectors it claims.
+/// @param file File to get the capacity of.
+size_t XenoFile_GetCapacity(const XenoFile *file);
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Reads a file a piece at a time through a small window of sectors. The window is the same size no matter how
+/// big the file is.
+/// @note A stream belongs to one thread. Any number of streams can share a reader.
+typedef struct XenoFileStream XenoFileStream;
+
+/// @brief Number of sectors of data the window holds.
+#define XENO_FILE_STREAM_WINDOW_SECTORS 32
+
+/// @brief Closes the stream. The reader isn't touched.
+/// @param stream Stream to close.
+void XenoFileStream_Close(XenoFileStream *stream);
+
+/// @brief Reads from the stream's position and moves it forward.
+/// @param stream Stream to read from.
+/// @param buffer Buffer to read to.
+/// @param length Maximum number of bytes to read.
+/// @return Number of bytes read. This is only less than length at the end of the file. -1 on failure.
+/// @note Reads that begin on a sector boundary and cover whole sectors skip the window and go straight to buffer.
+int64_t XenoFileStream_Read(XenoFileStream *stream, void *buffer, size_t length);
+
+/// @brief Moves the position of the stream. This works like fseek.
+/// @param stream Stream to seek.
+/// @param offset Offset to seek to.
+/// @param origin SEEK_SET, SEEK_CUR or SEEK_END.
+/// @return True on success. False if the position would end up before the beginning or after the end of the file.
+bool XenoFileStream_Seek(XenoFileStream *stream, int64_t offset, int origin);
+
+/// @brief Returns the current position of the stream.
+/// @param stream Stream to get the position of.
+int64_t XenoFileStream_Tell(const XenoFileStream *stream);
+
+/// @brief Returns the size of the file the stream is reading.
+/// @param stream Stream to get the size of.
+int64_t XenoFileStream_GetSize(const XenoFileStream *stream);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
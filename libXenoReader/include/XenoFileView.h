@@ -0,0 +1,58 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief This is a pointer to a run of file data and how long it is. One of these is made per sector.
+/// @note On POSIX systems this has the same layout as struct iovec, so an array of them can be passed to writev.
+typedef struct
+{
+    /// @brief Pointer to the data.
+    const unsigned char *data;
+
+    /// @brief Number of bytes the pointer above is good for.
+    size_t length;
+} XenoSegment;
+
+/// @brief This is a view of a file's data that points straight into the image instead of copying it.
+typedef struct XenoFileView XenoFileView;
+
+/// @brief Frees the view. This doesn't touch the image.
+/// @param view View to free.
+void XenoFileView_Free(XenoFileView *view);
+
+/// @brief Returns the segment array of the view.
+/// @param view View to get the segments of.
+const XenoSegment *XenoFileView_GetSegments(const XenoFileView *view);
+
+/// @brief Returns the number of segments in the view.
+/// @param view View to get the count of.
+int XenoFileView_GetSegmentCount(const XenoFileView *view);
+
+/// @brief Returns the total size of the file the view is of.
+/// @param view View to get the size of.
+int32_t XenoFileView_GetSize(const XenoFileView *view);
+
+/// @brief Writes every segment in the view to the descriptor passed using writev.
+/// @param view View to write.
+/// @param descriptor File descriptor to write to.
+/// @return True on success. False on failure or if the platform has no writev.
+bool XenoFileView_Write(const XenoFileView *view, int descriptor);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
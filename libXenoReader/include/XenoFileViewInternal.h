@@ -0,0 +1,30 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoFileView.h"
+
+#include <stdint.h>
+
+#ifdef __XENO_INTERNAL__
+// clang-format off
+struct XenoFileView
+{
+    /// @brief Segment array. This is allocated in the same block as the view.
+    XenoSegment *segments;
+
+    /// @brief Number of segments in the array above.
+    int segmentCount;
+
+    /// @brief Size of the file in bytes.
+    int32_t size;
+
+    /// @brief If the backend can't map, the raw sectors are read here and the segments point into it. NULL otherwise.
+    unsigned char *staging;
+};
+#endif
+// clang-format on
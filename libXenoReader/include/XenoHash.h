@@ -0,0 +1,75 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Size of a SHA-1 digest.
+#define XENO_SHA1_SIZE 20
+
+/// @brief Hashes of a run of bytes.
+typedef struct
+{
+    /// @brief SHA-1. This is what Redump and most dump lists go by.
+    uint8_t sha1[XENO_SHA1_SIZE];
+
+    /// @brief 64 bit XXH3 with a seed of 0. Much faster to compare and good for anything that isn't checking a dump
+    /// against someone else's.
+    uint64_t xxh3;
+} XenoDigest;
+
+/// @brief Hashes of the whole image and of every file in it.
+typedef struct XenoHashReport XenoHashReport;
+
+/// @brief Hashes the raw image and the contents of every file in its table.
+/// @param reader Reader to hash.
+/// @param threadCount Number of threads to hash with. 0 or less uses every processor.
+/// @return Report on success. NULL if anything couldn't be allocated or the image couldn't be read.
+/// @note Every sector is read once, in order, around the sector cache. Each chunk that's read is hashed by several
+/// tasks at once: one for the SHA-1 of the image, one for its XXH3 and the rest split across the files in the chunk.
+/// The next chunk is read while they run. Files that share sectors with an earlier entry in the table are only hashed
+/// once. The XXH3 of every file is also stored in its metadata so it's saved by XenoReader_SaveIndex.
+XenoHashReport *XenoReader_HashImage(XenoReader *reader, int threadCount);
+
+/// @brief Frees the report.
+void XenoHashReport_Free(XenoHashReport *report);
+
+/// @brief Gets the hashes of the raw image. Every byte of every sector is included.
+/// @param report Report to get the hashes from.
+/// @param digestOut Set to the hashes.
+void XenoHashReport_GetImageDigest(const XenoHashReport *report, XenoDigest *digestOut);
+
+/// @brief Gets the hashes of a file's contents. These match the hashes of the file once it's extracted.
+/// @param report Report to get the hashes from.
+/// @param file File from the reader the report was made from.
+/// @param digestOut Set to the hashes.
+/// @return True on success. False if the file isn't from the reader or runs past the end of the image.
+bool XenoHashReport_GetFileDigest(const XenoHashReport *report, const XenoFile *file, XenoDigest *digestOut);
+
+/// @brief Hashes a run of bytes in memory.
+/// @param data Bytes to hash.
+/// @param size Number of bytes.
+/// @param digestOut Set to the hashes.
+void XenoHash_Compute(const void *data, size_t size, XenoDigest *digestOut);
+
+/// @brief Returns the name of the kernel XXH3 is computed with.
+const char *XenoHash_GetKernelName(void);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
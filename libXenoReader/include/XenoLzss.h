@@ -0,0 +1,88 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoBuffer.h"
+#include "XenoFileStream.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// This is the LZSS Xenogears compresses most of its data with. Compressed data begins with its decompressed size as a 32
+// bit little endian integer. After that, each flag byte covers the next eight items from the low bit up. A clear bit is
+// a literal byte. A set bit is a two byte reference to something already decompressed: the low 12 bits are how far
+// back it begins and the top 4 bits are its length minus 3.
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Size of the header in front of compressed data.
+#define XENO_LZSS_HEADER_SIZE 4
+
+/// @brief Reads the decompressed size from the header of compressed data.
+/// @param data Compressed data.
+/// @param size Number of bytes of compressed data. The header is only trusted if this could decompress to it.
+/// @return Decompressed size on success. -1 if the data is too short or can't be LZSS.
+int64_t XenoLzss_GetSize(const void *data, size_t size);
+
+/// @brief Decompresses data that's already in memory.
+/// @param input Compressed data, header and all.
+/// @param inputSize Number of bytes of compressed data.
+/// @param output Buffer to decompress to. This must be the size XenoLzss_GetSize returns.
+/// @param outputSize Size of the output buffer.
+/// @return True on success. False if the data is corrupt or ends early.
+bool XenoLzss_Decompress(const void *input, size_t inputSize, void *output, size_t outputSize);
+
+/// @brief Decompresses a file as it's read. Only the last 4KB that was decompressed and a small amount of what's
+/// coming up are held at once.
+/// @note A stream belongs to one thread, just like the file stream it reads from.
+typedef struct XenoLzssStream XenoLzssStream;
+
+/// @brief Begins decompressing a file stream from its current position.
+/// @param source Stream to read the compressed data from. This needs to stay open until the LZSS stream is closed.
+/// @return Stream on success. NULL if the header couldn't be read or doesn't fit what's left of the source.
+XenoLzssStream *XenoLzssStream_Open(XenoFileStream *source);
+
+/// @brief Closes the stream. The source is left open.
+/// @param stream Stream to close.
+void XenoLzssStream_Close(XenoLzssStream *stream);
+
+/// @brief Decompresses the next bytes of the stream.
+/// @param stream Stream to read from.
+/// @param buffer Buffer to read to.
+/// @param length Maximum number of bytes to read.
+/// @return Number of bytes read. This is only less than length at the end of the data. -1 on failure.
+int64_t XenoLzssStream_Read(XenoLzssStream *stream, void *buffer, size_t length);
+
+/// @brief Returns the decompressed size of the data the stream is reading.
+/// @param stream Stream to get the size of.
+int64_t XenoLzssStream_GetSize(const XenoLzssStream *stream);
+
+/// @brief Decompresses a buffer.
+/// @param buffer Buffer holding compressed data.
+/// @return New buffer on success. NULL if the data is corrupt or memory couldn't be allocated.
+XenoBuffer *XenoBuffer_DecompressLzss(const XenoBuffer *buffer);
+
+/// @brief Decompresses a batch of buffers at the same time.
+/// @param buffers Buffers holding compressed data.
+/// @param count Number of buffers.
+/// @param threadCount Number of threads to decompress with. 0 or less uses every processor.
+/// @param decompressedOut Array of count pointers. Each is set to the decompressed buffer or NULL if that one failed.
+/// @return True if every buffer was decompressed. False if any of them failed.
+bool XenoBuffer_DecompressLzssBatch(const XenoBuffer *const *buffers,
+                                    int count,
+                                    int threadCount,
+                                    XenoBuffer **decompressedOut);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
@@ -0,0 +1,108 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A pack is a lot of files in one. It begins with a short header, then the data of every entry back to back, each
+// aligned to 16 bytes. The table of entries and their names comes after the data and a footer at the very end says
+// where the table is. This way the whole thing can be written front to back without knowing what's going in it ahead
+// of time, and read by mapping it and jumping straight to whichever entry is wanted.
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Writes a pack. Entries can be written from any number of threads at once.
+typedef struct XenoPackWriter XenoPackWriter;
+
+/// @brief A mapped pack.
+typedef struct XenoPack XenoPack;
+
+/// @brief One entry of a pack.
+typedef struct
+{
+    /// @brief Name the entry was added with.
+    const char *name;
+
+    /// @brief Data of the entry. This points into the map, so it's only valid until the pack is closed.
+    const unsigned char *data;
+
+    /// @brief Size of the entry in bytes.
+    uint64_t size;
+
+    /// @brief Sector the entry came from. This is whatever it was added with.
+    uint32_t sector;
+} XenoPackEntry;
+
+/// @brief Begins writing a pack. Everything goes to a temporary file next to path until the pack is closed.
+/// @param path Path of the pack.
+/// @return Writer on success. NULL if the file couldn't be created.
+XenoPackWriter *XenoPackWriter_Create(const char *path);
+
+/// @brief Makes room for an entry. Space is handed out in the order entries are added, so adding them in the order
+/// they're written keeps every write sequential.
+/// @param writer Writer to add to.
+/// @param name Name of the entry. This is copied.
+/// @param sector Sector the entry came from. This is only stored.
+/// @param size Size of the entry in bytes.
+/// @return Index of the entry on success. -1 if memory couldn't be allocated.
+int XenoPackWriter_AddEntry(XenoPackWriter *writer, const char *name, uint32_t sector, uint64_t size);
+
+/// @brief Writes part of an entry.
+/// @param writer Writer the entry belongs to.
+/// @param index Index of the entry.
+/// @param offset Offset in the entry to write to.
+/// @param data Data to write.
+/// @param length Number of bytes. The write can't go past the size the entry was added with.
+/// @return True on success. False on failure. A failed write fails the whole pack.
+bool XenoPackWriter_Write(XenoPackWriter *writer, int index, uint64_t offset, const void *data, size_t length);
+
+/// @brief Leaves an entry out of the table. Its space is still used, but nothing can find it.
+/// @param writer Writer the entry belongs to.
+/// @param index Index of the entry.
+void XenoPackWriter_DropEntry(XenoPackWriter *writer, int index);
+
+/// @brief Writes the table and footer, moves the pack into place and frees the writer.
+/// @param writer Writer to close.
+/// @return True if the pack was written. False if anything failed, in which case nothing is left behind.
+bool XenoPackWriter_Close(XenoPackWriter *writer);
+
+/// @brief Maps a pack and checks its table.
+/// @param path Path of the pack.
+/// @return Pack on success. NULL if it can't be mapped or isn't a valid pack.
+XenoPack *XenoPack_Open(const char *path);
+
+/// @brief Unmaps a pack.
+/// @param pack Pack to close.
+void XenoPack_Close(XenoPack *pack);
+
+/// @brief Returns the number of entries in a pack.
+/// @param pack Pack to get the count of.
+int XenoPack_GetEntryCount(const XenoPack *pack);
+
+/// @brief Gets an entry of a pack.
+/// @param pack Pack to get the entry from.
+/// @param index Index of the entry. Entries are in the order they were added, minus any that were dropped.
+/// @param entryOut Set to the entry.
+/// @return True on success. False if the index is out of range.
+bool XenoPack_GetEntry(const XenoPack *pack, int index, XenoPackEntry *entryOut);
+
+/// @brief Finds an entry by name.
+/// @param pack Pack to search.
+/// @param name Name of the entry.
+/// @return Index of the entry. -1 if there isn't one by that name.
+int XenoPack_FindEntry(const XenoPack *pack, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
@@ -7,8 +7,11 @@
  */
 #pragma once
 #include "Sector.h"
+#include "XenoBackend.h"
 #include "XenoBuffer.h"
 #include "XenoDir.h"
+#include "XenoFileStream.h"
+#include "XenoFileView.h"
 
 #include <stdbool.h>
 
@@ -18,17 +21,96 @@ extern "C"
 {
 #endif
 
+/// @brief Reads a Xenogears image.
+/// @note Everything except XenoReader_SeekToSector and XenoReader_ReadRawSector reads at an explicit position and
+/// can be called from multiple threads on the same reader at the same time. The filesystem tree is built during
+/// XenoReader_Open and can be shared too. The only thing that can't be shared is the position used by the seek API,
+/// which is kept around for compatibility.
+/// @note XenoReader_ReplaceFiles is the one exception. It updates the sizes of the files it replaces in place, so it
+/// can't run while other threads are using the reader or its tree.
 typedef struct XenoReader XenoReader;
 
+/// @brief A run of sectors.
+typedef struct
+{
+    /// @brief First sector of the run.
+    uint32_t firstSector;
+
+    /// @brief Number of sectors in the run.
+    uint32_t sectorCount;
+} XenoSectorRange;
+
+/// @brief Counters of the sector cache.
+typedef struct
+{
+    /// @brief Number of sectors found in the cache.
+    uint64_t hits;
+
+    /// @brief Number of sectors that had to be read from the backend.
+    uint64_t misses;
+
+    /// @brief Number of sectors thrown out to make room.
+    uint64_t evictions;
+
+    /// @brief Number of bytes the cache is allowed to use.
+    size_t budget;
+
+    /// @brief Number of bytes of sectors currently in the cache.
+    size_t used;
+} XenoCacheStats;
+
 /// @brief Attempts to open a Xenogears disc image.
 /// @param path Path to the image to attempt to open.
 /// @note Verifies the image in multiple ways before returning a XenoReader.
+/// @note The image is mapped if the platform allows it. If not, it's read with pread, and if that isn't available
+/// either, through stdio.
+/// @note ECM and CHD images are decoded as they're read. Only the sizes they decode to are checked.
 XenoReader *XenoReader_Open(const char *path);
 
+/// @brief Attempts to open a Xenogears disc image through the backend passed.
+/// @param backend Backend to read the image through.
+/// @note Runs the same verification as XenoReader_Open. On success, the reader owns the backend and closes it. On
+/// failure, the backend still belongs to the caller.
+XenoReader *XenoReader_OpenWithBackend(XenoBackend *backend);
+
+/// @brief Opens a Xenogears disc image so files can be replaced with XenoReader_ReplaceFiles.
+/// @param path Path to the image to open.
+/// @note Runs the same verification as XenoReader_Open. The image is never mapped, so reads are a little slower.
+XenoReader *XenoReader_OpenWritable(const char *path);
+
+/// @brief Opens an image using a saved index so the filesystem table doesn't need to be read or parsed.
+/// @param imagePath Path to the image.
+/// @param indexPath Path to the index. It's created if it doesn't exist yet.
+/// @note The index is thrown out and rebuilt if the image's size or modification time has changed, if sectors 16
+/// through 39 don't hash to what they did when it was saved, or if it was written by a different version or on a
+/// machine with a different byte order. The index is mapped and the table is used right where it sits in the map.
+XenoReader *XenoReader_OpenWithIndex(const char *imagePath, const char *indexPath);
+
+/// @brief Saves the filesystem table and file metadata of the reader to an index.
+/// @param reader Reader to save.
+/// @param imagePath Path to the image the reader was opened from. Its size and modification time are saved.
+/// @param indexPath Path to write the index to. This is written to a temporary file and renamed into place.
+/// @return True on success. False on failure.
+bool XenoReader_SaveIndex(XenoReader *reader, const char *imagePath, const char *indexPath);
+
 /// @brief Closes the reader passed.
 /// @param reader Reader to close.
 void XenoReader_Close(XenoReader *reader);
 
+/// @brief Puts a cache of raw sectors in front of the image. Every read through the reader uses it.
+/// @param reader Reader to enable the cache of.
+/// @param budget Maximum number of bytes the cache can hold.
+/// @return True on success. False if the cache couldn't be created or already exists.
+/// @note This needs to be called right after the reader is opened, before it's shared between threads.
+/// @note Reads of more than 256 sectors at once skip the cache so one big file can't push everything else out.
+/// @note If the image is mapped, reading it is already a memcpy, so the cache isn't created and this just returns true.
+bool XenoReader_EnableCache(XenoReader *reader, size_t budget);
+
+/// @brief Gets the counters of the sector cache. Everything is 0 if there is no cache.
+/// @param reader Reader to get the counters of.
+/// @param statsOut Set to the counters.
+void XenoReader_GetCacheStats(XenoReader *reader, XenoCacheStats *statsOut);
+
 /// @brief Shortcut function to return the disc number fetched during allocation.
 /// @param reader Reader to get disc number from.
 /// @return Disc 1 or 2. -1 on failure.
@@ -40,6 +122,7 @@ int XenoReader_GetDiscNumber(const XenoReader *reader);
 size_t XenoReader_GetSectorCount(const XenoReader *reader);
 
 /// @brief Seeks to the sector passed.
+/// @note This and XenoReader_ReadRawSector share one position per reader and aren't thread safe.
 /// @param reader Reader to seek with.
 /// @param sectorNumber Sector number to seek to.
 /// @return True on success. False on failure.
@@ -51,16 +134,129 @@ bool XenoReader_SeekToSector(XenoReader *reader, size_t sectorNumber);
 /// @return True on success. False on failure.
 bool XenoReader_ReadRawSector(XenoReader *reader, Sector *sectorOut);
 
+/// @brief Reads the sector passed to the Sector struct passed. This doesn't use or change the seek position.
+/// @param reader XenoReader to read from.
+/// @param sectorNumber Sector to read.
+/// @param sectorOut Sector to read data into.
+/// @return True on success. False on failure.
+bool XenoReader_ReadRawSectorAt(XenoReader *reader, size_t sectorNumber, Sector *sectorOut);
+
+/// @brief Reads a run of sectors in one go. This doesn't touch the position used by XenoReader_ReadRawSector.
+/// @param reader XenoReader to read from.
+/// @param firstSector First sector to read.
+/// @param count Number of sectors to read.
+/// @param sectorsOut Array of at least count sectors to read to.
+/// @return True on success. False on failure.
+bool XenoReader_ReadRawSectors(XenoReader *reader, size_t firstSector, size_t count, Sector *sectorsOut);
+
+/// @brief Reads a run of sectors and packs only their data into the buffer passed. The headers and edcCrc are skipped.
+/// @param reader XenoReader to read from.
+/// @param firstSector First sector to read.
+/// @param count Number of sectors to read.
+/// @param dataOut Buffer that is at least count * DATA_SIZE bytes.
+/// @return True on success. False on failure.
+bool XenoReader_ReadSectorData(XenoReader *reader, size_t firstSector, size_t count, unsigned char *dataOut);
+
 /// @brief Returns the root "hidden" directory.
 /// @param reader Reader to return the root filesystem of.
+/// @note The tree is valid until the reader is closed. Only XenoReader_ReplaceFiles changes it, by updating the sizes
+/// of the files it replaces in place.
 XenoDir *XenoReader_GetRootDirectory(XenoReader *reader);
 
+/// @brief Returns the total number of files in every directory of the image.
+/// @param reader Reader to get the count of.
+uint32_t XenoReader_GetFileCount(const XenoReader *reader);
+
+/// @brief Returns a file from the flat table every directory points into. NULL if the index is out of bounds.
+/// @param reader Reader to get the file from.
+/// @param index Index of the file. The files of each directory are next to each other in the table.
+XenoFile *XenoReader_GetFileAt(const XenoReader *reader, int index);
+
+/// @brief Returns the metadata of the file passed. This can be written to and is saved by XenoReader_SaveIndex.
+/// @param reader Reader the file belongs to.
+/// @param file File to get the metadata of.
+/// @return Metadata on success. NULL if the file isn't from this reader.
+/// @note Writing to the metadata of the same file from multiple threads isn't safe.
+XenoFileMetadata *XenoReader_GetFileMetadata(XenoReader *reader, const XenoFile *file);
+
+/// @brief Returns the file that contains the sector passed.
+/// @param reader Reader to search.
+/// @param sector Sector to find the owner of.
+/// @return File on success. NULL if no file claims the sector.
+/// @note The first call sorts every file by sector. Every call after is a binary search. If files overlap, the one that
+/// begins last is returned.
+XenoFile *XenoReader_FindFileBySector(XenoReader *reader, uint32_t sector);
+
+/// @brief Returns the number of runs of sectors in the image that no file claims.
+/// @param reader Reader to get the count of.
+/// @note This includes the system area and table at the beginning of the image and the space after the last file.
+/// Padding entries that point past the end of the image don't claim anything.
+int XenoReader_GetUnclaimedRangeCount(XenoReader *reader);
+
+/// @brief Gets a run of sectors that no file claims. Runs are in sector order.
+/// @param reader Reader to get the run from.
+/// @param index Index of the run.
+/// @param rangeOut Set to the run.
+/// @return True on success. False if the index is out of bounds.
+bool XenoReader_GetUnclaimedRangeAt(XenoReader *reader, int index, XenoSectorRange *rangeOut);
+
+/// @brief Returns the directory with the number the CLI gives it.
+/// @param reader Reader to search.
+/// @param dirNumber 0 is the root. Everything else is numbered in the order the tree is walked, depth first.
+/// @return Directory on success. NULL if the number is out of bounds.
+XenoDir *XenoReader_GetDirByNumber(XenoReader *reader, int dirNumber);
+
+/// @brief Returns the file the CLI would write to DIR_[dirNumber]/FILE_[fileNumber].bin.
+/// @param reader Reader to search.
+/// @param dirNumber Number of the directory. 0 is DISC_ROOT.
+/// @param fileNumber Number of the file. These start at 1 like the CLI.
+/// @return File on success. NULL if either number is out of bounds.
+XenoFile *XenoReader_FindFile(XenoReader *reader, int dirNumber, int fileNumber);
+
+/// @brief Returns the file at a path using the same names the CLI writes.
+/// @param reader Reader to search.
+/// @param path Path like "DIR_0012/FILE_0034" or "DISC_ROOT/DIR_0001/DIR_0002/FILE_0003.bin". Anything before
+/// the first directory is ignored. The first directory can be any directory. Each one after has to be inside of
+/// the last.
+/// @return File on success. NULL if the path doesn't exist.
+/// @note The first lookup numbers every directory. Lookups after that are constant time.
+XenoFile *XenoReader_FindFileByPath(XenoReader *reader, const char *path);
+
 /// @brief Reads the passed file from the disc image and returns it in a buffer.
 /// @param reader Reader to use to read the data.
 /// @param file File to read from the image.
 /// @return Buffer containing the file. Since this is a PS1 game in 2025, I'm not concerned about RAM usage.
+/// @note The whole file is allocated. XenoReader_OpenFileStream reads in constant memory instead.
 XenoBuffer *XenoReader_ReadFile(XenoReader *reader, const XenoFile *file);
 
+/// @brief Reads part of a file into a buffer owned by the caller. Only the sectors that cover the range are read.
+/// @param reader Reader the file belongs to.
+/// @param file File to read from.
+/// @param offset Offset in the file to begin reading at.
+/// @param length Number of bytes to read.
+/// @param dataOut Buffer that is at least length bytes.
+/// @return True on success. False on failure or if the range doesn't fit in the file.
+/// @note Nothing is allocated unless the backend can't map and another thread is using the staging buffer.
+bool XenoReader_ReadFileRange(XenoReader *reader,
+                              const XenoFile *file,
+                              size_t offset,
+                              size_t length,
+                              unsigned char *dataOut);
+
+/// @brief Returns a view of the file passed without copying its data.
+/// @param reader Reader the file belongs to.
+/// @param file File to get a view of.
+/// @return View on success. NULL on failure.
+/// @note If the backend can map, the segments point straight into the image and are valid until the reader is closed.
+/// Otherwise, the raw sectors are read into memory owned by the view.
+XenoFileView *XenoReader_OpenFileView(XenoReader *reader, const XenoFile *file);
+
+/// @brief Opens a stream of the file passed. Use this instead of XenoReader_ReadFile when memory is tight.
+/// @param reader Reader the file belongs to. This needs to stay open until the stream is closed.
+/// @param file File to stream.
+/// @return Stream on success. NULL on failure.
+XenoFileStream *XenoReader_OpenFileStream(XenoReader *reader, const XenoFile *file);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,121 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "SectorCache.h"
+#include "XenoArchive.h"
+#include "XenoBackend.h"
+#include "XenoFile.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define __XENO_INTERNAL__
+#include "XenoDirInternal.h"
+#include "XenoStatsInternal.h"
+
+#ifdef __XENO_INTERNAL__
+
+/// @brief This is the sector the table of contents begins at.
+static const size_t TABLE_SECTOR = 24;
+
+/// @brief This is how many sectors the table of contents takes up.
+static const size_t TABLE_SECTOR_COUNT = 16;
+
+/// @brief Size of a single entry in the table of contents. A 24 bit sector followed by a 32 bit size.
+static const int TABLE_ENTRY_SIZE = 7;
+
+/// @brief Sorted sector ranges of every file. This is built the first time someone needs it. Free it with free().
+typedef struct XenoSectorMap XenoSectorMap;
+
+/// @brief Directories in the order the CLI numbers them. This is built the first time someone needs it too.
+typedef struct XenoPathMap XenoPathMap;
+
+// clang-format off
+struct XenoReader
+{
+    /// @brief Backend the image is being read through.
+    XenoBackend *backend;
+
+    /// @brief This is the sector the next call to XenoReader_ReadRawSector reads. This is the only thing reads change.
+    size_t currentSector;
+
+    /// @brief Stores the number of sectors the image has.
+    size_t sectorCount;
+
+    /// @brief Stores the disc number from allocation verification.
+    int discNumber;
+
+    /// @brief This is the entire filesystem in one flat allocation.
+    XenoFsTable *fsTable;
+
+    /// @brief If the table came from an index, this is the index it's mapped from. NULL if the table was malloc'd.
+    XenoBackend *indexBackend;
+
+    /// @brief This is the root of the filesystem. It points into the table above.
+    XenoDir *root;
+
+    /// @brief One of these per file in the table. These are saved with the index.
+    XenoFileMetadata *metadata;
+
+    /// @brief Archive table of each file in the table. Each is parsed the first time it's asked for.
+    _Atomic(XenoArchive *) *archives;
+
+    /// @brief Built by the first sector lookup. Threads race to build it and the loser frees theirs.
+    _Atomic(XenoSectorMap *) sectorMap;
+
+    /// @brief Built by the first path lookup the same way.
+    _Atomic(XenoPathMap *) pathMap;
+
+    /// @brief Optional cache of raw sectors. NULL unless XenoReader_EnableCache was called.
+    SectorCache *cache;
+
+    /// @brief Raw sectors are read here in bulk when the backend can't map. NULL if the backend can map.
+    unsigned char *staging;
+
+    /// @brief Set while a thread is using the staging buffer. Anyone else gets a temporary buffer instead.
+    atomic_flag stagingInUse;
+
+    /// @brief Counters and trace callback. Nothing is recorded unless one of them is turned on.
+    XenoStatsState stats;
+};
+// clang-format on
+
+/// @brief Opens the best backend available for the image at path. ECM and CHD images are recognized by their magic
+/// and decoded on the fly.
+/// @param path Path to the image.
+XenoBackend *XenoReader_OpenImageBackend(const char *path);
+
+/// @brief Allocates a reader for an image that has already been verified. Everything but the backend is empty.
+/// @param backend Backend the reader reads through.
+/// @param sectorCount Number of sectors in the image.
+/// @param discNumber Disc number.
+XenoReader *XenoReader_Allocate(XenoBackend *backend, size_t sectorCount, int discNumber);
+
+/// @brief Gives the reader its filesystem table.
+/// @param reader Reader to give the table to.
+/// @param fsTable Table. The reader frees this on close unless indexBackend is passed.
+/// @param indexBackend Backend the table is mapped from. Closed with the reader. NULL if the table is malloc'd.
+/// @return True on success. False on failure. The reader owns both either way.
+bool XenoReader_AttachTable(XenoReader *reader, XenoFsTable *fsTable, XenoBackend *indexBackend);
+
+/// @brief Reads raw sectors straight from the backend, around the cache. This is where backend reads are counted and
+/// traced, so anything in the library that reads the image without going through the cache uses this.
+/// @param reader Reader to read through.
+/// @param firstSector First sector to read.
+/// @param count Number of sectors to read.
+/// @param out Buffer of at least count * SECTOR_SIZE bytes.
+/// @return True on success. False on failure.
+bool XenoReader_ReadBackend(XenoReader *reader, size_t firstSector, size_t count, unsigned char *out);
+
+/// @brief Checks the sector count, boot record and disc identification sector of the image behind the backend.
+/// @param backend Backend to check.
+/// @param discNumberOut Set to the disc number if the image checks out.
+/// @return True if this is a Xenogears image.
+bool XenoReader_VerifyBackend(XenoBackend *backend, int *discNumberOut);
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief One file to replace and what to replace it with.
+typedef struct
+{
+    /// @brief File to replace. This has to come from the reader the replacement is passed to.
+    const XenoFile *file;
+
+    /// @brief New contents of the file. This only needs to stay valid until the call returns.
+    const void *data;
+
+    /// @brief Size of the new contents in bytes.
+    size_t size;
+} XenoReplacement;
+
+/// @brief Replaces the contents of a file in place.
+/// @param reader Reader opened with XenoReader_OpenWritable.
+/// @param file File to replace.
+/// @param data New contents.
+/// @param size Size of the new contents. This can't be more than XenoFile_GetCapacity.
+/// @return True on success. False on failure.
+/// @note This is XenoReader_ReplaceFiles with one replacement.
+bool XenoReader_ReplaceFile(XenoReader *reader, const XenoFile *file, const void *data, size_t size);
+
+/// @brief Replaces the contents of many files in one pass.
+/// @param reader Reader opened with XenoReader_OpenWritable.
+/// @param replacements Files to replace. No two of them can share sectors, before or after they're replaced.
+/// @param count Number of replacements.
+/// @param threadCount Number of threads to regenerate sectors with. 0 or less uses every processor.
+/// @return True on success. False on failure.
+/// @note Everything is checked before anything is written, so a replacement that doesn't fit or a file that isn't in
+/// the table leaves the image alone. Only the data of each sector is rewritten. The headers are kept and the EDC and
+/// ECC are regenerated to match. The sizes in the table at sector 24 are updated last, but only the entry each file was
+/// read from. Other entries at the same sector keep their sizes. If a write fails partway, the image can be left with
+/// new data under old sizes. Shrinking a file gives up the sectors it no longer uses.
+/// @note The size of every XenoFile replaced is updated in place, so nothing else can be using the reader or its tree
+/// while this runs.
+bool XenoReader_ReplaceFiles(XenoReader *reader, const XenoReplacement *replacements, int count, int threadCount);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
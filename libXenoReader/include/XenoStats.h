@@ -0,0 +1,125 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Readers can count what they do and report each step to a callback as it happens. Both are off until asked for, and
+// while they're off each read only checks a flag. While they're on, counting is a handful of relaxed atomic adds and
+// two clock reads per batch of sectors, so it's cheap enough to leave on.
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Counters of everything a reader has done since counting was turned on or last reset.
+typedef struct
+{
+    /// @brief Number of reads that went to the backend.
+    uint64_t readCalls;
+
+    /// @brief Number of reads that didn't begin where the one before them ended.
+    uint64_t seekCount;
+
+    /// @brief Number of raw sectors read from the backend or gathered straight out of a mapped image.
+    uint64_t sectorsRead;
+
+    /// @brief Number of raw bytes those sectors take up.
+    uint64_t bytesRead;
+
+    /// @brief Number of bytes handed back by the reader's read functions.
+    uint64_t bytesDelivered;
+
+    /// @brief Number of allocations made while reading and how many bytes they were.
+    uint64_t allocationCount;
+    uint64_t allocationBytes;
+
+    /// @brief Number of sectors found in the sector cache. 0 if there is no cache.
+    uint64_t cacheHits;
+
+    /// @brief Time spent waiting on the backend and time spent copying data out of raw sectors, in nanoseconds.
+    uint64_t ioNanoseconds;
+    uint64_t copyNanoseconds;
+} XenoReaderStats;
+
+/// @brief What a trace event is about.
+typedef enum
+{
+    /// @brief The reader was opened. This is the first event a reader ever reports.
+    XENO_TRACE_OPEN,
+
+    /// @brief A file or part of one was read.
+    XENO_TRACE_FILE_READ,
+
+    /// @brief A run of sectors was read from the backend or gathered out of a mapped image.
+    XENO_TRACE_SECTOR_BATCH
+} XenoTraceType;
+
+/// @brief A single thing a reader did.
+typedef struct
+{
+    /// @brief What the event is about.
+    XenoTraceType type;
+
+    /// @brief When it began and ended. These come from XenoTrace_GetTime.
+    uint64_t begin;
+    uint64_t end;
+
+    /// @brief First sector and number of sectors. For file reads, this is the file's sector and the sectors the
+    /// range covers. For opens, this is 0 and the number of sectors in the image.
+    uint32_t firstSector;
+    uint32_t sectorCount;
+
+    /// @brief Number of bytes. Raw bytes for sector batches and data bytes for file reads.
+    uint64_t bytes;
+
+    /// @brief Whether it worked.
+    bool success;
+} XenoTraceEvent;
+
+/// @brief Function signature for trace callbacks.
+/// @param userData Whatever was passed with the callback.
+/// @param event The event. It only lives until the callback returns.
+/// @note Callbacks run on whichever thread did the work, so they need to be thread safe if the reader is shared.
+typedef void (*XenoTraceCallback)(void *userData, const XenoTraceEvent *event);
+
+/// @brief Turns the counters of a reader on or off.
+/// @param reader Reader to turn the counters of on or off. NULL sets whether readers opened from now on count.
+/// @param enabled Whether to count.
+/// @note Counters keep their values while they're off.
+void XenoReader_EnableStats(XenoReader *reader, bool enabled);
+
+/// @brief Gets the counters of a reader.
+/// @param reader Reader to get the counters of.
+/// @param statsOut Set to the counters.
+/// @note Counters are read one at a time, so if other threads are reading they might not add up exactly.
+void XenoReader_GetStats(XenoReader *reader, XenoReaderStats *statsOut);
+
+/// @brief Sets every counter back to 0. The sector cache's own counters aren't touched.
+/// @param reader Reader to reset the counters of.
+void XenoReader_ResetStats(XenoReader *reader);
+
+/// @brief Sets the trace callback of a reader.
+/// @param reader Reader to trace. NULL sets the callback readers opened from now on begin with, which is the only way
+/// to see their open event.
+/// @param callback Callback to call. NULL turns tracing off.
+/// @param userData Passed to the callback.
+/// @note This needs to be called before the reader is shared between threads.
+void XenoReader_SetTraceCallback(XenoReader *reader, XenoTraceCallback callback, void *userData);
+
+/// @brief Returns the time trace events are stamped with in nanoseconds. This only means anything compared to another.
+uint64_t XenoTrace_GetTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
@@ -0,0 +1,110 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoStats.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __XENO_INTERNAL__
+// clang-format off
+/// @brief Counters and trace callback of a reader. Everything that records something checks XenoStats_IsActive
+/// first, so readers that aren't counting or tracing never call any of it.
+typedef struct
+{
+    /// @brief Whether the counters are counting.
+    atomic_bool enabled;
+
+    /// @brief Trace callback and what's passed to it. These are only set before the reader is shared.
+    XenoTraceCallback traceCallback;
+    void *traceUserData;
+
+    /// @brief Sector the last read ended at. A read that begins anywhere else is a seek.
+    atomic_size_t nextSector;
+
+    /// @brief The counters themselves.
+    atomic_uint_fast64_t readCalls;
+    atomic_uint_fast64_t seekCount;
+    atomic_uint_fast64_t sectorsRead;
+    atomic_uint_fast64_t bytesRead;
+    atomic_uint_fast64_t bytesDelivered;
+    atomic_uint_fast64_t allocationCount;
+    atomic_uint_fast64_t allocationBytes;
+    atomic_uint_fast64_t ioNanoseconds;
+    atomic_uint_fast64_t copyNanoseconds;
+} XenoStatsState;
+// clang-format on
+
+/// @brief Sets up the state of a new reader. It begins with whatever was set for new readers.
+/// @param state State to set up.
+void XenoStats_Init(XenoStatsState *state);
+
+/// @brief Returns whether the reader is counting or tracing anything at all.
+static inline bool XenoStats_IsActive(XenoStatsState *state)
+{
+    return state->traceCallback || atomic_load_explicit(&state->enabled, memory_order_relaxed);
+}
+
+/// @brief Records the reader being opened.
+/// @param state State of the reader.
+/// @param begin When opening began.
+/// @param sectorCount Number of sectors in the image.
+void XenoStats_RecordOpen(XenoStatsState *state, uint64_t begin, size_t sectorCount);
+
+/// @brief Records a run of sectors being read.
+/// @param state State of the reader.
+/// @param firstSector First sector of the run.
+/// @param count Number of sectors.
+/// @param begin When the read began.
+/// @param end When the read ended.
+/// @param mapped True if the sectors were gathered straight out of a map. Those aren't backend reads and the time is
+/// counted as copying instead.
+/// @param success Whether the read worked.
+void XenoStats_RecordSectors(XenoStatsState *state,
+                             size_t firstSector,
+                             size_t count,
+                             uint64_t begin,
+                             uint64_t end,
+                             bool mapped,
+                             bool success);
+
+/// @brief Records part of a file being read. The bytes count as delivered.
+/// @param state State of the reader.
+/// @param sector First sector of the file.
+/// @param offset Offset in the file the read began at.
+/// @param length Number of bytes read.
+/// @param begin When the read began.
+/// @param success Whether the read worked.
+void XenoStats_RecordFileRead(XenoStatsState *state,
+                              uint32_t sector,
+                              size_t offset,
+                              size_t length,
+                              uint64_t begin,
+                              bool success);
+
+/// @brief Records time spent copying data out of raw sectors.
+void XenoStats_RecordCopy(XenoStatsState *state, uint64_t begin, uint64_t end);
+
+/// @brief Records bytes handed back to a caller.
+static inline void XenoStats_RecordDelivered(XenoStatsState *state, uint64_t bytes)
+{
+    if (!atomic_load_explicit(&state->enabled, memory_order_relaxed)) { return; }
+
+    atomic_fetch_add_explicit(&state->bytesDelivered, bytes, memory_order_relaxed);
+}
+
+/// @brief Records an allocation made while reading.
+static inline void XenoStats_RecordAllocation(XenoStatsState *state, uint64_t bytes)
+{
+    if (!atomic_load_explicit(&state->enabled, memory_order_relaxed)) { return; }
+
+    atomic_fetch_add_explicit(&state->allocationCount, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&state->allocationBytes, bytes, memory_order_relaxed);
+}
+#endif
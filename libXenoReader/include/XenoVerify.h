@@ -0,0 +1,80 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief What can be wrong with a sector. A bad sector can have more than one of these.
+#define XENO_SECTOR_BAD_SYNC   0x01
+#define XENO_SECTOR_BAD_MODE   0x02
+#define XENO_SECTOR_BAD_EDC    0x04
+#define XENO_SECTOR_BAD_ECC_P  0x08
+#define XENO_SECTOR_BAD_ECC_Q  0x10
+#define XENO_SECTOR_UNREADABLE 0x20
+
+/// @brief Result of verifying the whole image.
+typedef struct XenoVerifyReport XenoVerifyReport;
+
+/// @brief A sector that failed verification.
+typedef struct
+{
+    /// @brief Sector number.
+    uint32_t sector;
+
+    /// @brief XENO_SECTOR_* flags of everything that was wrong.
+    uint32_t errors;
+
+    /// @brief File that claims the sector. NULL if no file does. This is valid until the reader is closed.
+    XenoFile *file;
+} XenoBadSector;
+
+/// @brief Checks the EDC and ECC of every sector of the image.
+/// @param reader Reader to verify.
+/// @param threadCount Number of threads to check with. 0 or less uses every processor.
+/// @return Report on success. NULL if anything couldn't be allocated. A report is returned even if sectors are bad.
+/// @note The image is split into runs that are each read and checked on their own, so this scales with threads until
+/// the storage can't keep up. Mode 1 and Mode 2 Form 1 sectors have their EDC and both ECC codes checked. Form 2
+/// sectors only have an EDC, and an EDC of 0 means it was never written. Empty sectors are skipped. Reads go around the
+/// sector cache so a pass over the whole image doesn't push out everything else.
+XenoVerifyReport *XenoReader_VerifyImage(XenoReader *reader, int threadCount);
+
+/// @brief Frees the report.
+void XenoVerifyReport_Free(XenoVerifyReport *report);
+
+/// @brief Returns the number of sectors that were checked. Empty sectors aren't counted.
+size_t XenoVerifyReport_GetCheckedCount(const XenoVerifyReport *report);
+
+/// @brief Returns the number of empty sectors that were skipped.
+size_t XenoVerifyReport_GetSkippedCount(const XenoVerifyReport *report);
+
+/// @brief Returns the number of bad sectors.
+size_t XenoVerifyReport_GetBadSectorCount(const XenoVerifyReport *report);
+
+/// @brief Gets a bad sector. These are in sector order.
+/// @param report Report to get the sector from.
+/// @param index Index of the bad sector.
+/// @param badSectorOut Set to the bad sector.
+/// @return True on success. False if the index is out of bounds.
+bool XenoVerifyReport_GetBadSectorAt(const XenoVerifyReport *report, size_t index, XenoBadSector *badSectorOut);
+
+/// @brief Returns the name of the kernel the EDC is computed with.
+const char *XenoVerify_GetKernelName(void);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
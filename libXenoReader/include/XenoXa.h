@@ -0,0 +1,69 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+#pragma once
+#include "XenoReader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// clang-format off
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Describes the sector a block of decoded XA audio came from.
+typedef struct
+{
+    /// @brief File and channel from the subheader. Together these are what identify a stream.
+    uint8_t fileNumber;
+    uint8_t channelNumber;
+
+    /// @brief Sector the block was decoded from.
+    uint32_t sector;
+
+    /// @brief 37800 or 18900.
+    uint32_t sampleRate;
+
+    /// @brief 1 or 2. Stereo samples are interleaved left then right.
+    uint32_t channelCount;
+
+    /// @brief 4 or 8. This is what the sector was encoded with. The samples passed are always 16 bit.
+    uint32_t bitsPerSample;
+
+    /// @brief Set if this was the last sector of the stream. The next block on the same file and channel is a new one.
+    bool endOfStream;
+} XenoXaBlock;
+
+/// @brief Called with every sector of XA audio decoded, in the order they are on the disc.
+/// @param userData Pointer passed to XenoReader_DemuxXa.
+/// @param block Where the samples came from.
+/// @param samples Decoded samples. These are only valid until the callback returns.
+/// @param frameCount Number of frames. Every frame is channelCount samples.
+/// @return True to keep going. False to stop.
+typedef bool (*XenoXaCallback)(void *userData, const XenoXaBlock *block, const int16_t *samples, size_t frameCount);
+
+/// @brief Decodes every XA audio sector in a run of sectors in a single pass.
+/// @param reader Reader to read from.
+/// @param firstSector First sector to scan.
+/// @param count Number of sectors to scan.
+/// @param callback Called with every block of decoded samples.
+/// @param userData Passed to the callback.
+/// @return True on success. False if reading failed or the callback stopped the pass.
+/// @note Sectors are read in fixed size chunks and anything that isn't Form 2 audio is skipped. Each file and channel
+/// pair keeps its own decoder history, so interleaved streams come out clean. Nothing is buffered beyond one chunk.
+bool XenoReader_DemuxXa(XenoReader *reader, size_t firstSector, size_t count, XenoXaCallback callback, void *userData);
+
+/// @brief Returns the name of the kernel the decoder expands samples with.
+const char *XenoXa_GetKernelName(void);
+
+#ifdef __cplusplus
+}
+#endif
+// clang-format on
@@ -7,6 +7,8 @@
 /// @brief This is the size of the data portion of the sector.
 #define DATA_SIZE 2048
 
-// I'm going off some documents on the ISO-9660 standard for this one.
-// I'm not sure what's contained in here and it needs more research.
+/// @brief This is the size of the data portion of a Mode 2 Form 2 sector. XA audio uses these.
+#define FORM_2_DATA_SIZE 2324
+
+// This is the 4 byte EDC followed by the 172 bytes of P parity and 104 bytes of Q parity. SectorEcc.h has the details.
 #define EDC_CRC_SIZE 280
\ No newline at end of file
@@ -0,0 +1,705 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "Codec.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Longest Huffman code deflate allows.
+#define INFLATE_MAX_BITS 15
+
+/// @brief Codes up to this long are decoded with one table lookup. Anything longer is walked a bit at a time.
+#define INFLATE_FAST_BITS 9
+
+/// @brief Number of literal/length and distance symbols, including the ones that are never used.
+#define INFLATE_LENGTH_SYMBOLS   288
+#define INFLATE_DISTANCE_SYMBOLS 32
+
+/// @brief Number of states the LZMA decoder can be in.
+#define LZMA_STATE_COUNT 12
+
+/// @brief LZMA probabilities are 11 bits. Every one of them begins at one half.
+#define LZMA_PROBABILITY_BITS 11
+#define LZMA_PROBABILITY_HALF (1 << (LZMA_PROBABILITY_BITS - 1))
+
+/// @brief Distances with a slot below this have their low bits coded with probabilities. The rest are mostly direct.
+#define LZMA_END_POSITION_SLOT 14
+
+/// @brief Number of distances that are coded entirely with probabilities.
+#define LZMA_FULL_DISTANCES 128
+
+/// @brief Number of bits in the lowest part of big distances.
+#define LZMA_ALIGN_BITS 4
+
+/// @brief The range coder moves to the next byte whenever the range falls under this.
+#define LZMA_RANGE_TOP (1u << 24)
+
+// clang-format off
+/// @brief Canonical Huffman decoding table.
+typedef struct
+{
+    /// @brief Symbol and length of every code that fits in INFLATE_FAST_BITS, indexed by the next bits of input. The
+    /// symbol is in the top bits and the length in the low four. 0 means the code is longer.
+    uint16_t fast[1 << INFLATE_FAST_BITS];
+
+    /// @brief Number of codes of each length.
+    uint16_t counts[INFLATE_MAX_BITS + 1];
+
+    /// @brief Symbols in code order.
+    uint16_t symbols[INFLATE_LENGTH_SYMBOLS];
+} Huffman;
+
+/// @brief Deflate input. Bits are taken from the bottom of each byte first.
+typedef struct
+{
+    /// @brief Input and how far into it has been loaded.
+    const unsigned char *input;
+    size_t inputSize;
+    size_t position;
+
+    /// @brief Bits loaded but not taken yet. Past the end of the input these are zeros.
+    uint64_t bits;
+    int bitCount;
+} BitReader;
+
+/// @brief Length decoder. There's one for matches and one for repeated matches.
+typedef struct
+{
+    uint16_t choice;
+    uint16_t choice2;
+    uint16_t low[16][8];
+    uint16_t mid[16][8];
+    uint16_t high[256];
+} LzmaLength;
+
+/// @brief Every probability the LZMA decoder uses except the literal ones, which depend on lc and lp.
+typedef struct
+{
+    uint16_t isMatch[LZMA_STATE_COUNT << 4];
+    uint16_t isRep[LZMA_STATE_COUNT];
+    uint16_t isRepG0[LZMA_STATE_COUNT];
+    uint16_t isRepG1[LZMA_STATE_COUNT];
+    uint16_t isRepG2[LZMA_STATE_COUNT];
+    uint16_t isRep0Long[LZMA_STATE_COUNT << 4];
+    uint16_t positionSlots[4][64];
+    uint16_t positions[1 + LZMA_FULL_DISTANCES - LZMA_END_POSITION_SLOT];
+    uint16_t align[1 << LZMA_ALIGN_BITS];
+    LzmaLength length;
+    LzmaLength repLength;
+} LzmaModel;
+
+/// @brief LZMA range decoder.
+typedef struct
+{
+    /// @brief Input and how far into it has been read.
+    const unsigned char *input;
+    size_t inputSize;
+    size_t position;
+
+    /// @brief Current range and code.
+    uint32_t range;
+    uint32_t code;
+} RangeDecoder;
+// clang-format on
+
+// Bases and extra bits of deflate lengths and distances.
+static const uint16_t LENGTH_BASES[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                          31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29]  = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASES[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                            33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30]  = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Order the lengths of the code length code are stored in.
+static const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// Takes bits from the input.
+static void refill_bits(BitReader *reader);
+static uint32_t read_bits(BitReader *reader, int count);
+
+// Returns true if more bits have been taken than the input has.
+static bool is_overrun(const BitReader *reader);
+
+// Builds a table from the length of each symbol's code. 0 means the symbol isn't used.
+static bool build_huffman(Huffman *huffman, const uint8_t *lengths, int symbolCount);
+
+// Decodes one symbol. Returns -1 if the bits aren't a code.
+static int decode_symbol(BitReader *reader, const Huffman *huffman);
+
+// Reads the tables of a dynamic block.
+static bool read_dynamic_tables(BitReader *reader, Huffman *lengths, Huffman *distances);
+
+// Decodes the codes of one compressed block.
+static bool inflate_codes(BitReader *reader,
+                          const Huffman *lengths,
+                          const Huffman *distances,
+                          unsigned char *output,
+                          size_t outputSize,
+                          size_t *positionInOut);
+
+// Range decoder functions.
+static bool range_init(RangeDecoder *decoder, const unsigned char *input, size_t inputSize);
+static void range_normalize(RangeDecoder *decoder);
+static uint32_t range_decode_bit(RangeDecoder *decoder, uint16_t *probability);
+static uint32_t range_decode_direct(RangeDecoder *decoder, int count);
+static uint32_t range_decode_tree(RangeDecoder *decoder, uint16_t *probabilities, int count);
+static uint32_t range_decode_reverse(RangeDecoder *decoder, uint16_t *probabilities, int count);
+
+// Decodes a match length. The result is 0 for the shortest match.
+static uint32_t lzma_decode_length(RangeDecoder *decoder, LzmaLength *length, uint32_t positionState);
+
+// Decodes a match distance. The result is 0 for the byte right before.
+static uint32_t lzma_decode_distance(RangeDecoder *decoder, LzmaModel *model, uint32_t length);
+
+bool Inflate_Decode(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize)
+{
+    BitReader reader = {.input = input, .inputSize = inputSize, .position = 0, .bits = 0, .bitCount = 0};
+
+    // These are a few KB each, which is fine for the stack. The fixed tables are only built if a block needs them.
+    Huffman lengths;
+    Huffman distances;
+    size_t position = 0;
+    bool final      = false;
+    while (!final)
+    {
+        final               = read_bits(&reader, 1) != 0;
+        const uint32_t type = read_bits(&reader, 2);
+
+        if (type == 0)
+        {
+            // Stored blocks begin on a byte. Whatever whole bytes are still loaded get handed back to the input.
+            read_bits(&reader, reader.bitCount & 7);
+            reader.position -= (size_t)(reader.bitCount / 8);
+            reader.bits     = 0;
+            reader.bitCount = 0;
+
+            if (reader.position + 4 > inputSize) { return false; }
+
+            const size_t length  = input[reader.position] | (size_t)input[reader.position + 1] << 8;
+            const size_t inverse = input[reader.position + 2] | (size_t)input[reader.position + 3] << 8;
+            reader.position += 4;
+
+            if ((length ^ 0xFFFF) != inverse || length > inputSize - reader.position || length > outputSize - position)
+            {
+                return false;
+            }
+
+            memcpy(&output[position], &input[reader.position], length);
+            reader.position += length;
+            position += length;
+            continue;
+        }
+
+        if (type == 1)
+        {
+            uint8_t codeLengths[INFLATE_LENGTH_SYMBOLS + INFLATE_DISTANCE_SYMBOLS];
+            for (int i = 0; i < 144; i++) { codeLengths[i] = 8; }
+            for (int i = 144; i < 256; i++) { codeLengths[i] = 9; }
+            for (int i = 256; i < 280; i++) { codeLengths[i] = 7; }
+            for (int i = 280; i < INFLATE_LENGTH_SYMBOLS; i++) { codeLengths[i] = 8; }
+            for (int i = 0; i < INFLATE_DISTANCE_SYMBOLS; i++) { codeLengths[INFLATE_LENGTH_SYMBOLS + i] = 5; }
+
+            build_huffman(&lengths, codeLengths, INFLATE_LENGTH_SYMBOLS);
+            build_huffman(&distances, &codeLengths[INFLATE_LENGTH_SYMBOLS], INFLATE_DISTANCE_SYMBOLS);
+        }
+        else if (type != 2 || !read_dynamic_tables(&reader, &lengths, &distances)) { return false; }
+
+        if (!inflate_codes(&reader, &lengths, &distances, output, outputSize, &position) || is_overrun(&reader))
+        {
+            return false;
+        }
+    }
+
+    return position == outputSize;
+}
+
+bool Lzma_Decode(const unsigned char *input,
+                 size_t inputSize,
+                 unsigned char *output,
+                 size_t outputSize,
+                 int lc,
+                 int lp,
+                 int pb)
+{
+    if (lc < 0 || lc > 8 || lp < 0 || lp > 4 || pb < 0 || pb > 4) { return false; }
+
+    const size_t literalCount = (size_t)0x300 << (lc + lp);
+    LzmaModel *model          = malloc(sizeof(LzmaModel));
+    uint16_t *literals        = malloc(sizeof(uint16_t) * literalCount);
+    if (!model || !literals)
+    {
+        free(model);
+        free(literals);
+        return false;
+    }
+
+    // The model is nothing but probabilities, so it can be filled like an array.
+    uint16_t *probabilities = (uint16_t *)model;
+    for (size_t i = 0; i < sizeof(LzmaModel) / sizeof(uint16_t); i++) { probabilities[i] = LZMA_PROBABILITY_HALF; }
+    for (size_t i = 0; i < literalCount; i++) { literals[i] = LZMA_PROBABILITY_HALF; }
+
+    RangeDecoder decoder;
+    bool success = range_init(&decoder, input, inputSize);
+
+    const uint32_t positionMask = (1u << pb) - 1;
+    const uint32_t literalMask  = (1u << lp) - 1;
+    uint32_t reps[4]            = {0, 0, 0, 0};
+    uint32_t state              = 0;
+    size_t position             = 0;
+    while (success && position < outputSize)
+    {
+        const uint32_t positionState = (uint32_t)position & positionMask;
+
+        if (!range_decode_bit(&decoder, &model->isMatch[(state << 4) + positionState]))
+        {
+            const uint32_t previous = position > 0 ? output[position - 1] : 0;
+            uint16_t *probs = &literals[0x300 * (((position & literalMask) << lc) + (previous >> (8 - lc)))];
+
+            // After a match the byte the last distance points at predicts the literal until they differ.
+            uint32_t symbol = 1;
+            if (state >= 7)
+            {
+                uint32_t matchByte = output[position - reps[0] - 1];
+                while (symbol < 0x100)
+                {
+                    const uint32_t matchBit = (matchByte >> 7) & 1;
+                    matchByte <<= 1;
+
+                    const uint32_t bit = range_decode_bit(&decoder, &probs[((1 + matchBit) << 8) + symbol]);
+                    symbol             = (symbol << 1) | bit;
+                    if (bit != matchBit) { break; }
+                }
+            }
+
+            while (symbol < 0x100) { symbol = (symbol << 1) | range_decode_bit(&decoder, &probs[symbol]); }
+
+            output[position++] = (unsigned char)symbol;
+            state              = state < 4 ? 0 : (state < 10 ? state - 3 : state - 6);
+            continue;
+        }
+
+        uint32_t length = 0;
+        if (range_decode_bit(&decoder, &model->isRep[state]))
+        {
+            if (position == 0)
+            {
+                success = false;
+                break;
+            }
+
+            if (!range_decode_bit(&decoder, &model->isRepG0[state]))
+            {
+                // A single byte from the last distance.
+                if (!range_decode_bit(&decoder, &model->isRep0Long[(state << 4) + positionState]))
+                {
+                    state            = state < 7 ? 9 : 11;
+                    output[position] = output[position - reps[0] - 1];
+                    position++;
+                    continue;
+                }
+            }
+            else
+            {
+                uint32_t distance = 0;
+                if (!range_decode_bit(&decoder, &model->isRepG1[state])) { distance = reps[1]; }
+                else
+                {
+                    if (!range_decode_bit(&decoder, &model->isRepG2[state])) { distance = reps[2]; }
+                    else
+                    {
+                        distance = reps[3];
+                        reps[3]  = reps[2];
+                    }
+
+                    reps[2] = reps[1];
+                }
+
+                reps[1] = reps[0];
+                reps[0] = distance;
+            }
+
+            length = lzma_decode_length(&decoder, &model->repLength, positionState);
+            state  = state < 7 ? 8 : 11;
+        }
+        else
+        {
+            reps[3] = reps[2];
+            reps[2] = reps[1];
+            reps[1] = reps[0];
+            length  = lzma_decode_length(&decoder, &model->length, positionState);
+            state   = state < 7 ? 7 : 10;
+            reps[0] = lzma_decode_distance(&decoder, model, length);
+
+            // The end marker. Nothing should come after it, so the output has to be full already.
+            if (reps[0] == UINT32_MAX) { break; }
+        }
+
+        if (reps[0] >= position)
+        {
+            success = false;
+            break;
+        }
+
+        // Streams that were cut off at a known size can have the last match run past the end.
+        size_t count = length + 2;
+        if (count > outputSize - position) { count = outputSize - position; }
+
+        const size_t source = position - reps[0] - 1;
+        for (size_t i = 0; i < count; i++) { output[position + i] = output[source + i]; }
+        position += count;
+
+        success = decoder.position <= inputSize;
+    }
+
+    free(literals);
+    free(model);
+
+    // The range coder always reads four bytes ahead of what it has used, so it can't be held to the exact end.
+    return success && position == outputSize && decoder.position <= inputSize;
+}
+
+static void refill_bits(BitReader *reader)
+{
+    while (reader->bitCount <= 56)
+    {
+        const uint64_t byte = reader->position < reader->inputSize ? reader->input[reader->position] : 0;
+        reader->bits |= byte << reader->bitCount;
+        reader->bitCount += 8;
+        reader->position++;
+    }
+}
+
+static uint32_t read_bits(BitReader *reader, int count)
+{
+    if (reader->bitCount < count) { refill_bits(reader); }
+
+    const uint32_t value = (uint32_t)(reader->bits & ((1ull << count) - 1));
+    reader->bits >>= count;
+    reader->bitCount -= count;
+
+    return value;
+}
+
+static bool is_overrun(const BitReader *reader)
+{
+    return reader->position * 8 - (size_t)reader->bitCount > reader->inputSize * 8;
+}
+
+static bool build_huffman(Huffman *huffman, const uint8_t *lengths, int symbolCount)
+{
+    memset(huffman->counts, 0, sizeof(huffman->counts));
+    memset(huffman->fast, 0, sizeof(huffman->fast));
+    for (int i = 0; i < symbolCount; i++) { huffman->counts[lengths[i]]++; }
+    huffman->counts[0] = 0;
+
+    // Too many codes of a length can't be decoded. Too few is fine, since a block can leave codes out.
+    int left = 1;
+    for (int i = 1; i <= INFLATE_MAX_BITS; i++)
+    {
+        left = (left << 1) - huffman->counts[i];
+        if (left < 0) { return false; }
+    }
+
+    uint16_t offsets[INFLATE_MAX_BITS + 1];
+    uint32_t nextCodes[INFLATE_MAX_BITS + 1];
+    offsets[1]   = 0;
+    nextCodes[1] = 0;
+    for (int i = 1; i < INFLATE_MAX_BITS; i++)
+    {
+        offsets[i + 1]   = offsets[i] + huffman->counts[i];
+        nextCodes[i + 1] = (nextCodes[i] + huffman->counts[i]) << 1;
+    }
+
+    for (int symbol = 0; symbol < symbolCount; symbol++)
+    {
+        const int length = lengths[symbol];
+        if (length == 0) { continue; }
+
+        huffman->symbols[offsets[length]++] = (uint16_t)symbol;
+
+        // Codes are sent from the top bit down, so the table is indexed by the code backwards.
+        const uint32_t code = nextCodes[length]++;
+        if (length > INFLATE_FAST_BITS) { continue; }
+
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++) { reversed |= ((code >> i) & 1) << (length - 1 - i); }
+
+        for (uint32_t i = reversed; i < (1u << INFLATE_FAST_BITS); i += 1u << length)
+        {
+            huffman->fast[i] = (uint16_t)(symbol << 4 | length);
+        }
+    }
+
+    return true;
+}
+
+static int decode_symbol(BitReader *reader, const Huffman *huffman)
+{
+    if (reader->bitCount < INFLATE_MAX_BITS) { refill_bits(reader); }
+
+    const uint16_t entry = huffman->fast[reader->bits & ((1u << INFLATE_FAST_BITS) - 1)];
+    if (entry)
+    {
+        read_bits(reader, entry & 15);
+        return entry >> 4;
+    }
+
+    // Walk the code one bit at a time. Codes of each length are consecutive, so each length is a range check.
+    int code  = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length <= INFLATE_MAX_BITS; length++)
+    {
+        code |= (int)((reader->bits >> (length - 1)) & 1);
+
+        const int count = huffman->counts[length];
+        if (code - first < count)
+        {
+            read_bits(reader, length);
+            return huffman->symbols[index + code - first];
+        }
+
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+
+    return -1;
+}
+
+static bool read_dynamic_tables(BitReader *reader, Huffman *lengths, Huffman *distances)
+{
+    const int lengthCount     = (int)read_bits(reader, 5) + 257;
+    const int distanceCount   = (int)read_bits(reader, 5) + 1;
+    const int codeLengthCount = (int)read_bits(reader, 4) + 4;
+    if (lengthCount > 286 || distanceCount > 30) { return false; }
+
+    uint8_t codeLengths[INFLATE_LENGTH_SYMBOLS + INFLATE_DISTANCE_SYMBOLS] = {0};
+    for (int i = 0; i < codeLengthCount; i++) { codeLengths[CODE_LENGTH_ORDER[i]] = (uint8_t)read_bits(reader, 3); }
+
+    // The lengths of the real codes are themselves coded. This table is only needed until they're read.
+    if (!build_huffman(lengths, codeLengths, 19)) { return false; }
+
+    memset(codeLengths, 0, sizeof(codeLengths));
+    const int total = lengthCount + distanceCount;
+    int index       = 0;
+    while (index < total)
+    {
+        const int symbol = decode_symbol(reader, lengths);
+        if (symbol < 0) { return false; }
+
+        if (symbol < 16)
+        {
+            codeLengths[index++] = (uint8_t)symbol;
+            continue;
+        }
+
+        uint8_t value = 0;
+        int repeat    = 0;
+        if (symbol == 16)
+        {
+            if (index == 0) { return false; }
+
+            value  = codeLengths[index - 1];
+            repeat = 3 + (int)read_bits(reader, 2);
+        }
+        else if (symbol == 17) { repeat = 3 + (int)read_bits(reader, 3); }
+        else { repeat = 11 + (int)read_bits(reader, 7); }
+
+        if (index + repeat > total) { return false; }
+
+        while (repeat--) { codeLengths[index++] = value; }
+    }
+
+    // A block without an end code could never finish.
+    if (codeLengths[256] == 0) { return false; }
+
+    uint8_t distanceLengths[INFLATE_DISTANCE_SYMBOLS] = {0};
+    memcpy(distanceLengths, &codeLengths[lengthCount], (size_t)distanceCount);
+
+    return build_huffman(lengths, codeLengths, lengthCount) &&
+           build_huffman(distances, distanceLengths, INFLATE_DISTANCE_SYMBOLS);
+}
+
+static bool inflate_codes(BitReader *reader,
+                          const Huffman *lengths,
+                          const Huffman *distances,
+                          unsigned char *output,
+                          size_t outputSize,
+                          size_t *positionInOut)
+{
+    size_t position = *positionInOut;
+    while (true)
+    {
+        int symbol = decode_symbol(reader, lengths);
+        if (symbol < 0) { return false; }
+
+        if (symbol < 256)
+        {
+            if (position == outputSize) { return false; }
+
+            output[position++] = (unsigned char)symbol;
+            continue;
+        }
+
+        if (symbol == 256) { break; }
+
+        symbol -= 257;
+        if (symbol >= 29) { return false; }
+
+        const size_t length = LENGTH_BASES[symbol] + read_bits(reader, LENGTH_EXTRA[symbol]);
+
+        symbol = decode_symbol(reader, distances);
+        if (symbol < 0 || symbol >= 30) { return false; }
+
+        const size_t distance = DISTANCE_BASES[symbol] + read_bits(reader, DISTANCE_EXTRA[symbol]);
+        if (distance > position || length > outputSize - position) { return false; }
+
+        // Matches can overlap what they're copying, which repeats it. That has to go a byte at a time.
+        const unsigned char *source = &output[position - distance];
+        if (distance >= length) { memcpy(&output[position], source, length); }
+        else
+        {
+            for (size_t i = 0; i < length; i++) { output[position + i] = source[i]; }
+        }
+
+        position += length;
+    }
+
+    *positionInOut = position;
+
+    return true;
+}
+
+static bool range_init(RangeDecoder *decoder, const unsigned char *input, size_t inputSize)
+{
+    decoder->input     = input;
+    decoder->inputSize = inputSize;
+    decoder->position  = 5;
+    decoder->range     = UINT32_MAX;
+    decoder->code      = 0;
+
+    if (inputSize < 5 || input[0] != 0) { return false; }
+
+    for (int i = 1; i < 5; i++) { decoder->code = decoder->code << 8 | input[i]; }
+
+    return decoder->code != decoder->range;
+}
+
+static void range_normalize(RangeDecoder *decoder)
+{
+    if (decoder->range >= LZMA_RANGE_TOP) { return; }
+
+    // Running off the end reads zeros. The caller checks the position once it's done.
+    const uint32_t byte = decoder->position < decoder->inputSize ? decoder->input[decoder->position] : 0;
+    decoder->range <<= 8;
+    decoder->code = decoder->code << 8 | byte;
+    decoder->position++;
+}
+
+static uint32_t range_decode_bit(RangeDecoder *decoder, uint16_t *probability)
+{
+    const uint32_t bound = (decoder->range >> LZMA_PROBABILITY_BITS) * *probability;
+
+    uint32_t bit = 0;
+    if (decoder->code < bound)
+    {
+        *probability += ((1 << LZMA_PROBABILITY_BITS) - *probability) >> 5;
+        decoder->range = bound;
+    }
+    else
+    {
+        *probability -= *probability >> 5;
+        decoder->code -= bound;
+        decoder->range -= bound;
+        bit = 1;
+    }
+
+    range_normalize(decoder);
+
+    return bit;
+}
+
+static uint32_t range_decode_direct(RangeDecoder *decoder, int count)
+{
+    uint32_t result = 0;
+    while (count--)
+    {
+        decoder->range >>= 1;
+        decoder->code -= decoder->range;
+
+        // All ones if the code went under, which means the bit was 0.
+        const uint32_t mask = 0 - (decoder->code >> 31);
+        decoder->code += decoder->range & mask;
+        result = (result << 1) + (mask + 1);
+
+        range_normalize(decoder);
+    }
+
+    return result;
+}
+
+static uint32_t range_decode_tree(RangeDecoder *decoder, uint16_t *probabilities, int count)
+{
+    uint32_t node = 1;
+    for (int i = 0; i < count; i++) { node = (node << 1) + range_decode_bit(decoder, &probabilities[node]); }
+
+    return node - (1u << count);
+}
+
+static uint32_t range_decode_reverse(RangeDecoder *decoder, uint16_t *probabilities, int count)
+{
+    uint32_t node   = 1;
+    uint32_t result = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const uint32_t bit = range_decode_bit(decoder, &probabilities[node]);
+        node               = (node << 1) + bit;
+        result |= bit << i;
+    }
+
+    return result;
+}
+
+static uint32_t lzma_decode_length(RangeDecoder *decoder, LzmaLength *length, uint32_t positionState)
+{
+    if (!range_decode_bit(decoder, &length->choice))
+    {
+        return range_decode_tree(decoder, length->low[positionState], 3);
+    }
+
+    if (!range_decode_bit(decoder, &length->choice2))
+    {
+        return 8 + range_decode_tree(decoder, length->mid[positionState], 3);
+    }
+
+    return 16 + range_decode_tree(decoder, length->high, 8);
+}
+
+static uint32_t lzma_decode_distance(RangeDecoder *decoder, LzmaModel *model, uint32_t length)
+{
+    const uint32_t lengthState = length < 3 ? length : 3;
+    const uint32_t slot        = range_decode_tree(decoder, model->positionSlots[lengthState], 6);
+    if (slot < 4) { return slot; }
+
+    const int directBits = (int)(slot >> 1) - 1;
+    uint32_t distance    = (2 | (slot & 1)) << directBits;
+    if (slot < LZMA_END_POSITION_SLOT)
+    {
+        return distance + range_decode_reverse(decoder, &model->positions[distance - slot], directBits);
+    }
+
+    distance += range_decode_direct(decoder, directBits - LZMA_ALIGN_BITS) << LZMA_ALIGN_BITS;
+
+    return distance + range_decode_reverse(decoder, model->align, LZMA_ALIGN_BITS);
+}
@@ -0,0 +1,535 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "Digest.h"
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+/// @brief XXH3 works on 64 byte stripes. Each one uses the secret 8 bytes further in than the last.
+#define STRIPE_SIZE         64
+#define SECRET_CONSUME_RATE 8
+
+/// @brief Size of the default secret and how many stripes it covers before the accumulators are scrambled.
+#define SECRET_SIZE               192
+#define STRIPES_PER_BLOCK         ((SECRET_SIZE - STRIPE_SIZE) / SECRET_CONSUME_RATE)
+#define SECRET_SCRAMBLE_OFFSET    (SECRET_SIZE - STRIPE_SIZE)
+#define SECRET_LAST_STRIPE_OFFSET (SECRET_SIZE - STRIPE_SIZE - 7)
+#define SECRET_MERGE_OFFSET       11
+
+/// @brief Inputs up to this size don't use the accumulators at all.
+#define MID_SIZE_MAX 240
+
+/// @brief Offsets into the secret the 129 to 240 byte path uses past its first 8 rounds.
+#define MID_SIZE_START_OFFSET 3
+#define MID_SIZE_LAST_OFFSET  (136 - 17)
+
+/// @brief Primes from XXH32 and XXH64. XXH3 borrows them.
+#define PRIME32_1 0x9E3779B1u
+#define PRIME32_2 0x85EBCA77u
+#define PRIME32_3 0xC2B2AE3Du
+#define PRIME64_1 0x9E3779B185EBCA87ull
+#define PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define PRIME64_3 0x165667B19E3779F9ull
+#define PRIME64_4 0x85EBCA77C2B2AE63ull
+#define PRIME64_5 0x27D4EB2F165667C5ull
+
+static_assert(sizeof(((Xxh3State *)0)->buffer) % STRIPE_SIZE == 0, "XXH3 buffer needs to hold whole stripes");
+
+// clang-format off
+/// @brief The secret XXH3 uses when nobody passes their own.
+static const unsigned char DEFAULT_SECRET[SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+// clang-format on
+
+// Runs the SHA-1 compression function over 64 byte blocks.
+static void sha1_compress(uint32_t state[5], const unsigned char *blocks, size_t blockCount);
+
+// One round of SHA-1 and the next word of the message schedule.
+static inline void sha1_round(uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d, uint32_t *e, uint32_t f, uint32_t k,
+                              uint32_t word);
+static inline uint32_t sha1_schedule(uint32_t w[16], int round);
+
+// Adds one stripe to the accumulators.
+static void accumulate_stripe(uint64_t *acc, const unsigned char *input, const unsigned char *secret);
+
+// Mixes the accumulators at the end of a block.
+static void scramble(uint64_t *acc, const unsigned char *secret);
+
+// Adds whole stripes, scrambling whenever a block fills up. Returns the input past the last stripe.
+static const unsigned char *consume_stripes(uint64_t *acc,
+                                            size_t *stripeCount,
+                                            const unsigned char *input,
+                                            size_t count);
+
+// Hashes inputs of MID_SIZE_MAX bytes or less.
+static uint64_t hash_short(const unsigned char *input, size_t size);
+
+// Folds the accumulators into the final hash.
+static uint64_t merge_accumulators(const uint64_t *acc, uint64_t start);
+
+// Multiplies two 64 bit numbers into 128 bits and XORs the halves together.
+static inline uint64_t multiply_fold(uint64_t a, uint64_t b);
+
+// Mixes 16 bytes of input with 16 bytes of secret.
+static inline uint64_t mix_16(const unsigned char *input, const unsigned char *secret);
+
+// Final mixes.
+static inline uint64_t avalanche(uint64_t hash);
+static inline uint64_t avalanche_xxh64(uint64_t hash);
+static inline uint64_t avalanche_rrmxmx(uint64_t hash, uint64_t size);
+
+// Little endian loads and big endian SHA-1 words.
+static inline uint32_t read_32(const unsigned char *data);
+static inline uint64_t read_64(const unsigned char *data);
+static inline uint32_t read_32_big(const unsigned char *data);
+static inline uint64_t swap_64(uint64_t value);
+static inline uint32_t rotate_left_32(uint32_t value, int count);
+static inline uint64_t rotate_left_64(uint64_t value, int count);
+
+void Sha1_Init(Sha1State *state)
+{
+    state->state[0]     = 0x67452301u;
+    state->state[1]     = 0xEFCDAB89u;
+    state->state[2]     = 0x98BADCFEu;
+    state->state[3]     = 0x10325476u;
+    state->state[4]     = 0xC3D2E1F0u;
+    state->length       = 0;
+    state->bufferedSize = 0;
+}
+
+void Sha1_Update(Sha1State *state, const void *data, size_t size)
+{
+    if (size == 0) { return; }
+
+    const unsigned char *input = (const unsigned char *)data;
+    state->length += size;
+
+    if (state->bufferedSize > 0)
+    {
+        const size_t loadSize = sizeof(state->buffer) - state->bufferedSize < size
+                                    ? sizeof(state->buffer) - state->bufferedSize
+                                    : size;
+        memcpy(&state->buffer[state->bufferedSize], input, loadSize);
+        state->bufferedSize += loadSize;
+        input += loadSize;
+        size -= loadSize;
+
+        if (state->bufferedSize < sizeof(state->buffer)) { return; }
+
+        sha1_compress(state->state, state->buffer, 1);
+        state->bufferedSize = 0;
+    }
+
+    // Whole blocks go straight from the input.
+    const size_t blockCount = size / sizeof(state->buffer);
+    sha1_compress(state->state, input, blockCount);
+    input += blockCount * sizeof(state->buffer);
+    size -= blockCount * sizeof(state->buffer);
+
+    memcpy(state->buffer, input, size);
+    state->bufferedSize = size;
+}
+
+void Sha1_Final(Sha1State *state, unsigned char *digestOut)
+{
+    // A 1 bit, zeroes up to 8 bytes short of a block and the length in bits.
+    const uint64_t bitLength = state->length * 8;
+    const size_t padding     = (state->bufferedSize < 56 ? 56 : 120) - state->bufferedSize;
+
+    unsigned char tail[72] = {0x80};
+    for (int i = 0; i < 8; i++) { tail[padding + i] = (unsigned char)(bitLength >> (56 - i * 8)); }
+    Sha1_Update(state, tail, padding + 8);
+
+    for (int i = 0; i < 5; i++)
+    {
+        digestOut[i * 4 + 0] = (unsigned char)(state->state[i] >> 24);
+        digestOut[i * 4 + 1] = (unsigned char)(state->state[i] >> 16);
+        digestOut[i * 4 + 2] = (unsigned char)(state->state[i] >> 8);
+        digestOut[i * 4 + 3] = (unsigned char)state->state[i];
+    }
+}
+
+void Xxh3_Init(Xxh3State *state)
+{
+    static const uint64_t initial[8] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                                        PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+
+    memcpy(state->acc, initial, sizeof(initial));
+    state->length       = 0;
+    state->stripeCount  = 0;
+    state->bufferedSize = 0;
+}
+
+void Xxh3_Update(Xxh3State *state, const void *data, size_t size)
+{
+    const unsigned char *input = (const unsigned char *)data;
+    const unsigned char *end   = input + size;
+    const size_t bufferSize    = sizeof(state->buffer);
+    if (size == 0) { return; }
+
+    state->length += size;
+
+    // Nothing is taken until there's more than a buffer's worth. The last stripe of the input is special, so whatever
+    // ends the input has to still be around when the digest is taken.
+    if (state->bufferedSize + size <= bufferSize)
+    {
+        memcpy(&state->buffer[state->bufferedSize], input, size);
+        state->bufferedSize += size;
+        return;
+    }
+
+    if (state->bufferedSize > 0)
+    {
+        const size_t loadSize = bufferSize - state->bufferedSize;
+        memcpy(&state->buffer[state->bufferedSize], input, loadSize);
+        input += loadSize;
+
+        consume_stripes(state->acc, &state->stripeCount, state->buffer, bufferSize / STRIPE_SIZE);
+        state->bufferedSize = 0;
+    }
+
+    // Everything but the last stripe or so goes straight from the input. That stripe is kept at the end of the buffer.
+    if ((size_t)(end - input) > bufferSize)
+    {
+        const size_t stripeCount = (size_t)(end - 1 - input) / STRIPE_SIZE;
+        input                    = consume_stripes(state->acc, &state->stripeCount, input, stripeCount);
+        memcpy(&state->buffer[bufferSize - STRIPE_SIZE], input - STRIPE_SIZE, STRIPE_SIZE);
+    }
+
+    memcpy(state->buffer, input, (size_t)(end - input));
+    state->bufferedSize = (size_t)(end - input);
+}
+
+uint64_t Xxh3_Digest(const Xxh3State *state)
+{
+    if (state->length <= MID_SIZE_MAX) { return hash_short(state->buffer, (size_t)state->length); }
+
+    // The digest works on a copy so the state can keep going.
+    _Alignas(16) uint64_t acc[8];
+    memcpy(acc, state->acc, sizeof(acc));
+
+    const unsigned char *lastStripe = NULL;
+    unsigned char joined[STRIPE_SIZE];
+    if (state->bufferedSize >= STRIPE_SIZE)
+    {
+        size_t stripeCount = state->stripeCount;
+        consume_stripes(acc, &stripeCount, state->buffer, (state->bufferedSize - 1) / STRIPE_SIZE);
+        lastStripe = &state->buffer[state->bufferedSize - STRIPE_SIZE];
+    }
+    else
+    {
+        // The last stripe is partly the end of what was already taken.
+        const size_t catchUp = STRIPE_SIZE - state->bufferedSize;
+        memcpy(joined, &state->buffer[sizeof(state->buffer) - catchUp], catchUp);
+        memcpy(&joined[catchUp], state->buffer, state->bufferedSize);
+        lastStripe = joined;
+    }
+
+    accumulate_stripe(acc, lastStripe, &DEFAULT_SECRET[SECRET_LAST_STRIPE_OFFSET]);
+
+    return merge_accumulators(acc, state->length * PRIME64_1);
+}
+
+const char *Xxh3_GetKernelName(void)
+{
+#ifdef __SSE2__
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+static void sha1_compress(uint32_t state[5], const unsigned char *blocks, size_t blockCount)
+{
+    for (size_t block = 0; block < blockCount; block++)
+    {
+        uint32_t w[16];
+        for (int i = 0; i < 16; i++) { w[i] = read_32_big(&blocks[block * 64 + i * 4]); }
+
+        uint32_t a = state[0];
+        uint32_t b = state[1];
+        uint32_t c = state[2];
+        uint32_t d = state[3];
+        uint32_t e = state[4];
+
+        // Each quarter has its own mixing function. Keeping them in separate loops keeps the branch out of every round.
+        for (int i = 0; i < 16; i++) { sha1_round(&a, &b, &c, &d, &e, d ^ (b & (c ^ d)), 0x5A827999u, w[i]); }
+        for (int i = 16; i < 20; i++)
+        {
+            sha1_round(&a, &b, &c, &d, &e, d ^ (b & (c ^ d)), 0x5A827999u, sha1_schedule(w, i));
+        }
+        for (int i = 20; i < 40; i++) { sha1_round(&a, &b, &c, &d, &e, b ^ c ^ d, 0x6ED9EBA1u, sha1_schedule(w, i)); }
+        for (int i = 40; i < 60; i++)
+        {
+            sha1_round(&a, &b, &c, &d, &e, (b & c) | (d & (b | c)), 0x8F1BBCDCu, sha1_schedule(w, i));
+        }
+        for (int i = 60; i < 80; i++) { sha1_round(&a, &b, &c, &d, &e, b ^ c ^ d, 0xCA62C1D6u, sha1_schedule(w, i)); }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+static inline void sha1_round(uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d, uint32_t *e, uint32_t f, uint32_t k,
+                              uint32_t word)
+{
+    const uint32_t temp = rotate_left_32(*a, 5) + f + *e + k + word;
+    *e                  = *d;
+    *d                  = *c;
+    *c                  = rotate_left_32(*b, 30);
+    *b                  = *a;
+    *a                  = temp;
+}
+
+static inline uint32_t sha1_schedule(uint32_t w[16], int round)
+{
+    // The schedule is a ring of 16 words instead of all 80.
+    const int i = round & 15;
+    w[i]        = rotate_left_32(w[(round + 13) & 15] ^ w[(round + 8) & 15] ^ w[(round + 2) & 15] ^ w[i], 1);
+    return w[i];
+}
+
+static void accumulate_stripe(uint64_t *acc, const unsigned char *input, const unsigned char *secret)
+{
+#ifdef __SSE2__
+    // Two lanes at a time. The low 32 bits of each keyed lane are multiplied by the high 32 bits, and the input is
+    // added to the lane next to it.
+    __m128i *lanes = (__m128i *)acc;
+    for (int i = 0; i < 4; i++)
+    {
+        const __m128i data    = _mm_loadu_si128((const __m128i *)&input[i * 16]);
+        const __m128i key     = _mm_loadu_si128((const __m128i *)&secret[i * 16]);
+        const __m128i keyed   = _mm_xor_si128(data, key);
+        const __m128i high    = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product = _mm_mul_epu32(keyed, high);
+        const __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        lanes[i]              = _mm_add_epi64(_mm_add_epi64(lanes[i], swapped), product);
+    }
+#else
+    for (int i = 0; i < 8; i++)
+    {
+        const uint64_t data  = read_64(&input[i * 8]);
+        const uint64_t keyed = data ^ read_64(&secret[i * 8]);
+        acc[i ^ 1] += data;
+        acc[i] += (keyed & 0xFFFFFFFFu) * (keyed >> 32);
+    }
+#endif
+}
+
+static void scramble(uint64_t *acc, const unsigned char *secret)
+{
+#ifdef __SSE2__
+    // SSE2 has no 64 bit multiply, so the 32 bit prime is multiplied into each half and the high half shifted back up.
+    __m128i *lanes        = (__m128i *)acc;
+    const __m128i prime32 = _mm_set1_epi32((int)PRIME32_1);
+    for (int i = 0; i < 4; i++)
+    {
+        const __m128i shifted  = _mm_xor_si128(lanes[i], _mm_srli_epi64(lanes[i], 47));
+        const __m128i keyed    = _mm_xor_si128(shifted, _mm_loadu_si128((const __m128i *)&secret[i * 16]));
+        const __m128i high     = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i lowPart  = _mm_mul_epu32(keyed, prime32);
+        const __m128i highPart = _mm_mul_epu32(high, prime32);
+        lanes[i]               = _mm_add_epi64(lowPart, _mm_slli_epi64(highPart, 32));
+    }
+#else
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t lane = acc[i] ^ (acc[i] >> 47);
+        lane ^= read_64(&secret[i * 8]);
+        acc[i] = lane * PRIME32_1;
+    }
+#endif
+}
+
+static const unsigned char *consume_stripes(uint64_t *acc,
+                                            size_t *stripeCount,
+                                            const unsigned char *input,
+                                            size_t count)
+{
+    // Each stripe in a block uses the secret a little further in. The block is scrambled once the secret runs out.
+    while (count > 0)
+    {
+        const size_t blockLeft = STRIPES_PER_BLOCK - *stripeCount;
+        const size_t take      = count < blockLeft ? count : blockLeft;
+        for (size_t i = 0; i < take; i++)
+        {
+            accumulate_stripe(acc, &input[i * STRIPE_SIZE], &DEFAULT_SECRET[(*stripeCount + i) * SECRET_CONSUME_RATE]);
+        }
+
+        input += take * STRIPE_SIZE;
+        count -= take;
+        *stripeCount += take;
+
+        if (*stripeCount == STRIPES_PER_BLOCK)
+        {
+            scramble(acc, &DEFAULT_SECRET[SECRET_SCRAMBLE_OFFSET]);
+            *stripeCount = 0;
+        }
+    }
+
+    return input;
+}
+
+static uint64_t hash_short(const unsigned char *input, size_t size)
+{
+    const unsigned char *secret = DEFAULT_SECRET;
+
+    if (size == 0) { return avalanche_xxh64(read_64(&secret[56]) ^ read_64(&secret[64])); }
+
+    if (size <= 3)
+    {
+        const uint32_t combined = (uint32_t)input[0] << 16 | (uint32_t)input[size >> 1] << 24 |
+                                  (uint32_t)input[size - 1] | (uint32_t)size << 8;
+        const uint64_t flip     = read_32(&secret[0]) ^ read_32(&secret[4]);
+        return avalanche_xxh64(combined ^ flip);
+    }
+
+    if (size <= 8)
+    {
+        const uint64_t flip     = read_64(&secret[8]) ^ read_64(&secret[16]);
+        const uint64_t combined = read_32(&input[size - 4]) + ((uint64_t)read_32(input) << 32);
+        return avalanche_rrmxmx(combined ^ flip, size);
+    }
+
+    if (size <= 16)
+    {
+        const uint64_t low  = read_64(input) ^ (read_64(&secret[24]) ^ read_64(&secret[32]));
+        const uint64_t high = read_64(&input[size - 8]) ^ (read_64(&secret[40]) ^ read_64(&secret[48]));
+        return avalanche(size + swap_64(low) + high + multiply_fold(low, high));
+    }
+
+    uint64_t acc = size * PRIME64_1;
+    if (size <= 128)
+    {
+        // Pairs of 16 bytes from each end, working inward.
+        const size_t pairCount = (size - 1) / 32;
+        for (size_t i = 0; i <= pairCount; i++)
+        {
+            acc += mix_16(&input[i * 16], &secret[i * 32]);
+            acc += mix_16(&input[size - (i + 1) * 16], &secret[i * 32 + 16]);
+        }
+
+        return avalanche(acc);
+    }
+
+    const size_t roundCount = size / 16;
+    for (size_t i = 0; i < 8; i++) { acc += mix_16(&input[i * 16], &secret[i * 16]); }
+    acc = avalanche(acc);
+
+    for (size_t i = 8; i < roundCount; i++)
+    {
+        acc += mix_16(&input[i * 16], &secret[(i - 8) * 16 + MID_SIZE_START_OFFSET]);
+    }
+    acc += mix_16(&input[size - 16], &secret[MID_SIZE_LAST_OFFSET]);
+
+    return avalanche(acc);
+}
+
+static uint64_t merge_accumulators(const uint64_t *acc, uint64_t start)
+{
+    const unsigned char *secret = &DEFAULT_SECRET[SECRET_MERGE_OFFSET];
+
+    uint64_t result = start;
+    for (int i = 0; i < 4; i++)
+    {
+        result += multiply_fold(acc[i * 2] ^ read_64(&secret[i * 16]), acc[i * 2 + 1] ^ read_64(&secret[i * 16 + 8]));
+    }
+
+    return avalanche(result);
+}
+
+static inline uint64_t multiply_fold(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    const unsigned __int128 product = (unsigned __int128)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    // Schoolbook multiply out of 32 bit halves.
+    const uint64_t lowLow   = (a & 0xFFFFFFFFu) * (b & 0xFFFFFFFFu);
+    const uint64_t highLow  = (a >> 32) * (b & 0xFFFFFFFFu);
+    const uint64_t lowHigh  = (a & 0xFFFFFFFFu) * (b >> 32);
+    const uint64_t highHigh = (a >> 32) * (b >> 32);
+    const uint64_t cross    = (lowLow >> 32) + (highLow & 0xFFFFFFFFu) + lowHigh;
+    const uint64_t high     = (highLow >> 32) + (cross >> 32) + highHigh;
+    const uint64_t low      = (cross << 32) | (lowLow & 0xFFFFFFFFu);
+    return low ^ high;
+#endif
+}
+
+static inline uint64_t mix_16(const unsigned char *input, const unsigned char *secret)
+{
+    return multiply_fold(read_64(input) ^ read_64(secret), read_64(&input[8]) ^ read_64(&secret[8]));
+}
+
+static inline uint64_t avalanche(uint64_t hash)
+{
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ull;
+    return hash ^ (hash >> 32);
+}
+
+static inline uint64_t avalanche_xxh64(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    return hash ^ (hash >> 32);
+}
+
+static inline uint64_t avalanche_rrmxmx(uint64_t hash, uint64_t size)
+{
+    hash ^= rotate_left_64(hash, 49) ^ rotate_left_64(hash, 24);
+    hash *= 0x9FB21C651E98DF25ull;
+    hash ^= (hash >> 35) + size;
+    hash *= 0x9FB21C651E98DF25ull;
+    return hash ^ (hash >> 28);
+}
+
+static inline uint32_t read_32(const unsigned char *data)
+{
+    return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+static inline uint64_t read_64(const unsigned char *data) { return read_32(data) | (uint64_t)read_32(&data[4]) << 32; }
+
+static inline uint32_t read_32_big(const unsigned char *data)
+{
+    return (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | (uint32_t)data[3];
+}
+
+static inline uint64_t swap_64(uint64_t value)
+{
+    uint64_t swapped = 0;
+    for (int i = 0; i < 8; i++) { swapped = swapped << 8 | ((value >> (i * 8)) & 0xFF); }
+    return swapped;
+}
+
+static inline uint32_t rotate_left_32(uint32_t value, int count) { return value << count | value >> (32 - count); }
+
+static inline uint64_t rotate_left_64(uint64_t value, int count) { return value << count | value >> (64 - count); }
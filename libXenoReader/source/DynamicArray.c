@@ -3,8 +3,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-// This is the capacity extended with when the array is getting full.
-#define EXTEND_CAPACITY 64
+// This is the smallest capacity the array grows to. Past this, the capacity doubles whenever the array is full.
+#define MINIMUM_CAPACITY 64
 
 // clang-format off
 struct DynamicArray
@@ -49,13 +49,15 @@ void *DynamicArray_New(DynamicArray *array)
 {
     if (!array) { return NULL; }
 
-    if (array->capacity - array->length <= 2)
+    if (array->length >= array->capacity)
     {
-        array->capacity += EXTEND_CAPACITY;
-        void *newArray = realloc(array->array, array->elementSize * array->capacity);
+        // Doubling keeps the number of reallocations logarithmic instead of linear.
+        const size_t newCapacity = array->capacity < MINIMUM_CAPACITY ? MINIMUM_CAPACITY : array->capacity * 2;
+        void *newArray           = realloc(array->array, array->elementSize * newCapacity);
         if (!newArray) { return NULL; }
 
-        array->array = newArray;
+        array->array    = newArray;
+        array->capacity = newCapacity;
     }
 
     return &array->array[array->length++ * array->elementSize];
@@ -0,0 +1,134 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "HunkCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+// clang-format off
+struct HunkCache
+{
+    /// @brief Protects everything below.
+    mtx_t lock;
+
+    /// @brief Size of a hunk and number of slots.
+    size_t hunkSize;
+    int slotCount;
+
+    /// @brief Number of slots in use. Slots are filled in order until the cache is full.
+    int used;
+
+    /// @brief Slot the CLOCK hand is pointing at.
+    int hand;
+
+    /// @brief Hunk in each slot.
+    uint64_t *hunks;
+
+    /// @brief Set when a slot is used. The hand clears these and evicts the first slot it finds already clear.
+    uint8_t *referenced;
+
+    /// @brief Decoded hunks. One per slot.
+    unsigned char *data;
+};
+// clang-format on
+
+// Returns the slot holding the hunk or -1.
+static int find_slot(const HunkCache *cache, uint64_t hunk);
+
+HunkCache *HunkCache_Create(size_t hunkSize, int slotCount)
+{
+    if (hunkSize == 0 || slotCount <= 0) { return NULL; }
+
+    HunkCache *cache = calloc(1, sizeof(HunkCache));
+    if (!cache) { return NULL; }
+
+    cache->hunkSize   = hunkSize;
+    cache->slotCount  = slotCount;
+    cache->hunks      = malloc(sizeof(uint64_t) * (size_t)slotCount);
+    cache->referenced = calloc((size_t)slotCount, sizeof(uint8_t));
+    cache->data       = malloc(hunkSize * (size_t)slotCount);
+
+    if (!cache->hunks || !cache->referenced || !cache->data || mtx_init(&cache->lock, mtx_plain) != thrd_success)
+    {
+        free(cache->hunks);
+        free(cache->referenced);
+        free(cache->data);
+        free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void HunkCache_Free(HunkCache *cache)
+{
+    if (!cache) { return; }
+
+    mtx_destroy(&cache->lock);
+    free(cache->hunks);
+    free(cache->referenced);
+    free(cache->data);
+    free(cache);
+}
+
+bool HunkCache_Read(HunkCache *cache, uint64_t hunk, size_t offset, void *buffer, size_t length)
+{
+    mtx_lock(&cache->lock);
+
+    const int slot = find_slot(cache, hunk);
+    if (slot >= 0)
+    {
+        cache->referenced[slot] = 1;
+        memcpy(buffer, &cache->data[(size_t)slot * cache->hunkSize + offset], length);
+    }
+
+    mtx_unlock(&cache->lock);
+
+    return slot >= 0;
+}
+
+void HunkCache_Put(HunkCache *cache, uint64_t hunk, const void *hunkData)
+{
+    mtx_lock(&cache->lock);
+
+    // Another thread might have decoded the same hunk and beaten us here.
+    int slot = find_slot(cache, hunk);
+    if (slot < 0)
+    {
+        if (cache->used < cache->slotCount) { slot = cache->used++; }
+        else
+        {
+            // Anything used since the last time the hand passed gets a second chance.
+            while (cache->referenced[cache->hand])
+            {
+                cache->referenced[cache->hand] = 0;
+                cache->hand                    = (cache->hand + 1) % cache->slotCount;
+            }
+
+            slot        = cache->hand;
+            cache->hand = (cache->hand + 1) % cache->slotCount;
+        }
+
+        cache->hunks[slot] = hunk;
+        memcpy(&cache->data[(size_t)slot * cache->hunkSize], hunkData, cache->hunkSize);
+    }
+
+    mtx_unlock(&cache->lock);
+}
+
+static int find_slot(const HunkCache *cache, uint64_t hunk)
+{
+    for (int i = 0; i < cache->used; i++)
+    {
+        if (cache->hunks[i] == hunk) { return i; }
+    }
+
+    return -1;
+}
@@ -0,0 +1,239 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "IoRing.h"
+
+#include <stdlib.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #define IORING_SUPPORTED
+    #include <errno.h>
+    #include <linux/io_uring.h>
+    #include <stdatomic.h>
+    #include <string.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#ifdef IORING_SUPPORTED
+
+// clang-format off
+struct IoRing
+{
+    /// @brief Descriptor of the ring itself.
+    int descriptor;
+
+    /// @brief Submission and completion rings. These can be the same mapping on newer kernels.
+    void *submissionMap;
+    size_t submissionMapSize;
+    void *completionMap;
+    size_t completionMapSize;
+
+    /// @brief Submission queue entries.
+    struct io_uring_sqe *entries;
+    size_t entriesSize;
+
+    /// @brief Pointers into the submission ring.
+    _Atomic(unsigned int) *submissionHead;
+    _Atomic(unsigned int) *submissionTail;
+    unsigned int submissionMask;
+    unsigned int *submissionArray;
+
+    /// @brief Pointers into the completion ring.
+    _Atomic(unsigned int) *completionHead;
+    _Atomic(unsigned int) *completionTail;
+    unsigned int completionMask;
+    struct io_uring_cqe *completions;
+
+    /// @brief Number of entries in each ring.
+    unsigned int entryCount;
+    unsigned int completionCount;
+
+    /// @brief Number of entries queued since the last submit.
+    unsigned int queuedCount;
+};
+// clang-format on
+
+// Returns a pointer offset bytes into a mapping.
+static inline void *get_offset(void *map, uint32_t offset) { return (unsigned char *)map + offset; }
+
+IoRing *IoRing_Create(unsigned int entryCount)
+{
+    IoRing *ring = calloc(1, sizeof(IoRing));
+    if (!ring) { return NULL; }
+
+    struct io_uring_params params = {0};
+    ring->descriptor              = (int)syscall(__NR_io_uring_setup, entryCount, &params);
+    if (ring->descriptor < 0)
+    {
+        // This happens on old kernels and in containers that block it.
+        free(ring);
+        return NULL;
+    }
+
+    ring->entryCount        = params.sq_entries;
+    ring->completionCount   = params.cq_entries;
+    ring->submissionMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->completionMapSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->entriesSize       = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    // Newer kernels let both rings share one mapping.
+    const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap && ring->completionMapSize > ring->submissionMapSize)
+    {
+        ring->submissionMapSize = ring->completionMapSize;
+    }
+
+    const int protection = PROT_READ | PROT_WRITE;
+    const int flags      = MAP_SHARED | MAP_POPULATE;
+    ring->submissionMap  = mmap(NULL, ring->submissionMapSize, protection, flags, ring->descriptor, IORING_OFF_SQ_RING);
+    ring->completionMap  = singleMap ? ring->submissionMap
+                                     : mmap(NULL, ring->completionMapSize, protection, flags, ring->descriptor,
+                                            IORING_OFF_CQ_RING);
+    ring->entries = mmap(NULL, ring->entriesSize, protection, flags, ring->descriptor, IORING_OFF_SQES);
+    if (ring->submissionMap == MAP_FAILED || ring->completionMap == MAP_FAILED || ring->entries == MAP_FAILED)
+    {
+        IoRing_Free(ring);
+        return NULL;
+    }
+
+    ring->submissionHead  = get_offset(ring->submissionMap, params.sq_off.head);
+    ring->submissionTail  = get_offset(ring->submissionMap, params.sq_off.tail);
+    ring->submissionMask  = *(unsigned int *)get_offset(ring->submissionMap, params.sq_off.ring_mask);
+    ring->submissionArray = get_offset(ring->submissionMap, params.sq_off.array);
+    ring->completionHead  = get_offset(ring->completionMap, params.cq_off.head);
+    ring->completionTail  = get_offset(ring->completionMap, params.cq_off.tail);
+    ring->completionMask  = *(unsigned int *)get_offset(ring->completionMap, params.cq_off.ring_mask);
+    ring->completions     = get_offset(ring->completionMap, params.cq_off.cqes);
+
+    return ring;
+}
+
+void IoRing_Free(IoRing *ring)
+{
+    if (!ring) { return; }
+
+    if (ring->entries && ring->entries != MAP_FAILED) { munmap(ring->entries, ring->entriesSize); }
+
+    const bool separateMaps = ring->completionMap != ring->submissionMap;
+    if (separateMaps && ring->completionMap && ring->completionMap != MAP_FAILED)
+    {
+        munmap(ring->completionMap, ring->completionMapSize);
+    }
+
+    if (ring->submissionMap && ring->submissionMap != MAP_FAILED)
+    {
+        munmap(ring->submissionMap, ring->submissionMapSize);
+    }
+
+    close(ring->descriptor);
+    free(ring);
+}
+
+unsigned int IoRing_GetCompletionCapacity(const IoRing *ring) { return ring->completionCount; }
+
+bool IoRing_QueueRead(IoRing *ring, int descriptor, void *buffer, uint32_t length, uint64_t offset, uint64_t userData)
+{
+    // Only this thread writes the tail. The kernel moves the head.
+    const unsigned int tail = atomic_load_explicit(ring->submissionTail, memory_order_relaxed);
+    const unsigned int head = atomic_load_explicit(ring->submissionHead, memory_order_acquire);
+    if (tail - head >= ring->entryCount) { return false; }
+
+    const unsigned int index   = tail & ring->submissionMask;
+    struct io_uring_sqe *entry = &ring->entries[index];
+    memset(entry, 0, sizeof(struct io_uring_sqe));
+
+    entry->opcode    = IORING_OP_READ;
+    entry->fd        = descriptor;
+    entry->addr      = (uint64_t)(uintptr_t)buffer;
+    entry->len       = length;
+    entry->off       = offset;
+    entry->user_data = userData;
+
+    ring->submissionArray[index] = index;
+    atomic_store_explicit(ring->submissionTail, tail + 1, memory_order_release);
+    ++ring->queuedCount;
+
+    return true;
+}
+
+bool IoRing_Submit(IoRing *ring, unsigned int waitCount)
+{
+    const unsigned int flags = waitCount > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+    while (true)
+    {
+        const long result = syscall(__NR_io_uring_enter, ring->descriptor, ring->queuedCount, waitCount, flags, NULL, 0);
+        if (result < 0 && errno == EINTR) { continue; }
+        if (result < 0) { return false; }
+
+        // Without SQPOLL, the kernel takes everything or fails the call.
+        ring->queuedCount -= (unsigned int)result;
+        if (ring->queuedCount == 0) { return true; }
+    }
+}
+
+bool IoRing_PopCompletion(IoRing *ring, uint64_t *userDataOut, int32_t *resultOut)
+{
+    const unsigned int head = atomic_load_explicit(ring->completionHead, memory_order_relaxed);
+    const unsigned int tail = atomic_load_explicit(ring->completionTail, memory_order_acquire);
+    if (head == tail) { return false; }
+
+    const struct io_uring_cqe *completion = &ring->completions[head & ring->completionMask];
+    *userDataOut                          = completion->user_data;
+    *resultOut                            = completion->res;
+
+    atomic_store_explicit(ring->completionHead, head + 1, memory_order_release);
+
+    return true;
+}
+
+#else
+
+IoRing *IoRing_Create(unsigned int entryCount)
+{
+    (void)entryCount;
+    return NULL;
+}
+
+void IoRing_Free(IoRing *ring) { (void)ring; }
+
+unsigned int IoRing_GetCompletionCapacity(const IoRing *ring)
+{
+    (void)ring;
+    return 0;
+}
+
+bool IoRing_QueueRead(IoRing *ring, int descriptor, void *buffer, uint32_t length, uint64_t offset, uint64_t userData)
+{
+    (void)ring;
+    (void)descriptor;
+    (void)buffer;
+    (void)length;
+    (void)offset;
+    (void)userData;
+    return false;
+}
+
+bool IoRing_Submit(IoRing *ring, unsigned int waitCount)
+{
+    (void)ring;
+    (void)waitCount;
+    return false;
+}
+
+bool IoRing_PopCompletion(IoRing *ring, uint64_t *userDataOut, int32_t *resultOut)
+{
+    (void)ring;
+    (void)userDataOut;
+    (void)resultOut;
+    return false;
+}
+
+#endif
@@ -0,0 +1,286 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "SectorCache.h"
+
+#include "Sector.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+/// @brief Number of shards. This needs to be a power of two.
+#define SHARD_COUNT 16
+
+/// @brief Marks an empty bucket in a shard's hash table.
+#define EMPTY_BUCKET UINT32_MAX
+
+// clang-format off
+/// @brief One piece of the cache. Every sector always lands in the same shard.
+typedef struct
+{
+    /// @brief Protects everything below.
+    mtx_t lock;
+
+    /// @brief Number of slots.
+    uint32_t capacity;
+
+    /// @brief Number of slots in use. Slots are filled in order until the shard is full.
+    uint32_t used;
+
+    /// @brief Slot the CLOCK hand is pointing at.
+    uint32_t hand;
+
+    /// @brief Size of the hash table minus one. The table is a power of two at least twice the capacity.
+    uint32_t bucketMask;
+
+    /// @brief Sector in each slot.
+    uint32_t *sectors;
+
+    /// @brief Set when a slot is used. The hand clears these and evicts the first slot it finds already clear.
+    uint8_t *referenced;
+
+    /// @brief Linear probing table of slot indexes.
+    uint32_t *buckets;
+
+    /// @brief Raw sectors. One per slot.
+    unsigned char *data;
+} CacheShard;
+
+struct SectorCache
+{
+    /// @brief Shards.
+    CacheShard shards[SHARD_COUNT];
+
+    /// @brief Budget passed at creation.
+    size_t budget;
+
+    /// @brief Counters. These are only ever added to.
+    atomic_uint_fast64_t hits;
+    atomic_uint_fast64_t misses;
+    atomic_uint_fast64_t evictions;
+};
+// clang-format on
+
+// Returns the shard the sector belongs to. Neighboring sectors are spread out so sequential reads don't fight.
+static CacheShard *get_shard(SectorCache *cache, uint32_t sector);
+
+// Returns the bucket a sector's probe begins at.
+static uint32_t get_home_bucket(const CacheShard *shard, uint32_t sector);
+
+// Returns the bucket holding the sector or the empty bucket where it would go.
+static uint32_t find_bucket(const CacheShard *shard, uint32_t sector);
+
+// Empties a bucket and shifts everything after it back so probing still works without tombstones.
+static void remove_bucket(CacheShard *shard, uint32_t bucket);
+
+// Moves the hand to a slot that can be reused.
+static uint32_t evict_slot(CacheShard *shard);
+
+SectorCache *SectorCache_Create(size_t budget)
+{
+    const size_t shardCapacity = budget / SECTOR_SIZE / SHARD_COUNT;
+    if (shardCapacity == 0 || shardCapacity > UINT32_MAX / 4) { return NULL; }
+
+    SectorCache *cache = calloc(1, sizeof(SectorCache));
+    if (!cache) { return NULL; }
+
+    cache->budget = budget;
+    atomic_init(&cache->hits, 0);
+    atomic_init(&cache->misses, 0);
+    atomic_init(&cache->evictions, 0);
+
+    uint32_t bucketCount = 1;
+    while (bucketCount < shardCapacity * 2) { bucketCount <<= 1; }
+
+    for (int i = 0; i < SHARD_COUNT; i++)
+    {
+        CacheShard *shard = &cache->shards[i];
+        shard->capacity   = (uint32_t)shardCapacity;
+        shard->bucketMask = bucketCount - 1;
+        shard->sectors    = malloc(sizeof(uint32_t) * shardCapacity);
+        shard->referenced = calloc(shardCapacity, sizeof(uint8_t));
+        shard->buckets    = malloc(sizeof(uint32_t) * bucketCount);
+        shard->data       = malloc(shardCapacity * SECTOR_SIZE);
+
+        // Free only destroys locks that were made, so this needs to bail before the lock if anything failed.
+        if (!shard->sectors || !shard->referenced || !shard->buckets || !shard->data ||
+            mtx_init(&shard->lock, mtx_plain) != thrd_success)
+        {
+            shard->capacity = 0;
+            SectorCache_Free(cache);
+            return NULL;
+        }
+
+        memset(shard->buckets, 0xFF, sizeof(uint32_t) * bucketCount);
+    }
+
+    return cache;
+}
+
+void SectorCache_Free(SectorCache *cache)
+{
+    if (!cache) { return; }
+
+    for (int i = 0; i < SHARD_COUNT; i++)
+    {
+        CacheShard *shard = &cache->shards[i];
+        if (shard->capacity > 0) { mtx_destroy(&shard->lock); }
+
+        free(shard->sectors);
+        free(shard->referenced);
+        free(shard->buckets);
+        free(shard->data);
+    }
+
+    free(cache);
+}
+
+bool SectorCache_Get(SectorCache *cache, uint32_t sector, void *sectorOut)
+{
+    CacheShard *shard = get_shard(cache, sector);
+
+    mtx_lock(&shard->lock);
+
+    const uint32_t slot = shard->buckets[find_bucket(shard, sector)];
+    const bool hit      = slot != EMPTY_BUCKET;
+    if (hit)
+    {
+        shard->referenced[slot] = 1;
+        memcpy(sectorOut, &shard->data[(size_t)slot * SECTOR_SIZE], SECTOR_SIZE);
+    }
+
+    mtx_unlock(&shard->lock);
+
+    atomic_fetch_add_explicit(hit ? &cache->hits : &cache->misses, 1, memory_order_relaxed);
+
+    return hit;
+}
+
+void SectorCache_Put(SectorCache *cache, uint32_t sector, const void *sectorData)
+{
+    CacheShard *shard = get_shard(cache, sector);
+
+    mtx_lock(&shard->lock);
+
+    // Another thread might have missed on the same sector and beaten us here.
+    uint32_t bucket = find_bucket(shard, sector);
+    uint32_t slot   = shard->buckets[bucket];
+    if (slot == EMPTY_BUCKET)
+    {
+        if (shard->used < shard->capacity) { slot = shard->used++; }
+        else
+        {
+            slot = evict_slot(shard);
+            remove_bucket(shard, find_bucket(shard, shard->sectors[slot]));
+            atomic_fetch_add_explicit(&cache->evictions, 1, memory_order_relaxed);
+
+            // Removing can shift the sector's bucket.
+            bucket = find_bucket(shard, sector);
+        }
+
+        shard->sectors[slot]   = sector;
+        shard->buckets[bucket] = slot;
+    }
+
+    // New sectors start out unreferenced so a single pass over something big doesn't look hot.
+    memcpy(&shard->data[(size_t)slot * SECTOR_SIZE], sectorData, SECTOR_SIZE);
+
+    mtx_unlock(&shard->lock);
+}
+
+void SectorCache_Update(SectorCache *cache, uint32_t sector, const void *sectorData)
+{
+    CacheShard *shard = get_shard(cache, sector);
+
+    mtx_lock(&shard->lock);
+
+    const uint32_t slot = shard->buckets[find_bucket(shard, sector)];
+    if (slot != EMPTY_BUCKET) { memcpy(&shard->data[(size_t)slot * SECTOR_SIZE], sectorData, SECTOR_SIZE); }
+
+    mtx_unlock(&shard->lock);
+}
+
+void SectorCache_GetStats(SectorCache *cache, XenoCacheStats *statsOut)
+{
+    statsOut->hits      = atomic_load_explicit(&cache->hits, memory_order_relaxed);
+    statsOut->misses    = atomic_load_explicit(&cache->misses, memory_order_relaxed);
+    statsOut->evictions = atomic_load_explicit(&cache->evictions, memory_order_relaxed);
+    statsOut->budget    = cache->budget;
+    statsOut->used      = 0;
+
+    for (int i = 0; i < SHARD_COUNT; i++)
+    {
+        CacheShard *shard = &cache->shards[i];
+
+        mtx_lock(&shard->lock);
+        statsOut->used += (size_t)shard->used * SECTOR_SIZE;
+        mtx_unlock(&shard->lock);
+    }
+}
+
+static CacheShard *get_shard(SectorCache *cache, uint32_t sector)
+{
+    // Fibonacci hashing. The top bits are the best mixed.
+    return &cache->shards[(sector * 0x9E3779B1u) >> 28];
+}
+
+static uint32_t get_home_bucket(const CacheShard *shard, uint32_t sector)
+{
+    // Every sector in a shard has the same top bits, so this uses different ones.
+    return ((sector * 0x85EBCA6Bu) ^ (sector >> 16)) & shard->bucketMask;
+}
+
+static uint32_t find_bucket(const CacheShard *shard, uint32_t sector)
+{
+    // The table is never more than half full, so this always hits an empty bucket eventually.
+    uint32_t bucket = get_home_bucket(shard, sector);
+    while (shard->buckets[bucket] != EMPTY_BUCKET && shard->sectors[shard->buckets[bucket]] != sector)
+    {
+        bucket = (bucket + 1) & shard->bucketMask;
+    }
+
+    return bucket;
+}
+
+static void remove_bucket(CacheShard *shard, uint32_t bucket)
+{
+    uint32_t next = bucket;
+    while (true)
+    {
+        next = (next + 1) & shard->bucketMask;
+        if (shard->buckets[next] == EMPTY_BUCKET) { break; }
+
+        // If the entry's home is cyclically between the hole and where it is, it has to stay put.
+        const uint32_t home         = get_home_bucket(shard, shard->sectors[shard->buckets[next]]);
+        const uint32_t distanceHome = (next - home) & shard->bucketMask;
+        const uint32_t distanceHole = (next - bucket) & shard->bucketMask;
+        if (distanceHome < distanceHole) { continue; }
+
+        shard->buckets[bucket] = shard->buckets[next];
+        bucket                 = next;
+    }
+
+    shard->buckets[bucket] = EMPTY_BUCKET;
+}
+
+static uint32_t evict_slot(CacheShard *shard)
+{
+    // Anything used since the last time the hand passed gets a second chance.
+    while (shard->referenced[shard->hand])
+    {
+        shard->referenced[shard->hand] = 0;
+        shard->hand                    = (shard->hand + 1) % shard->capacity;
+    }
+
+    const uint32_t slot = shard->hand;
+    shard->hand         = (shard->hand + 1) % shard->capacity;
+
+    return slot;
+}
@@ -0,0 +1,190 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "SectorEcc.h"
+
+#include <string.h>
+#include <threads.h>
+
+/// @brief Reversed polynomial of the EDC.
+#define EDC_POLYNOMIAL 0xD8018001u
+
+/// @brief Field polynomial of the ECC. x^8 + x^4 + x^3 + x^2 + 1.
+#define ECC_POLYNOMIAL 0x11D
+
+/// @brief Size of what the ECC covers. Everything from the header up to Q.
+#define ECC_BLOCK_SIZE (SECTOR_ECC_Q_OFFSET - SECTOR_ECC_HEADER_OFFSET)
+
+// Slice-by-8 tables. Table 0 is the usual byte at a time table. Each one after it is the next byte further back.
+static uint32_t edcTables[8][256];
+
+// Multiplying by x in the field and the inverse of multiplying by x + 1.
+static uint8_t eccForward[256];
+static uint8_t eccBackward[256];
+
+static once_flag tablesOnce = ONCE_FLAG_INIT;
+
+// Fills in the tables. This only ever runs once.
+static void build_tables(void);
+
+// Computes one of the two product codes. Each major is a codeword made of minorCount bytes taken minorStep apart.
+static void compute_block(const unsigned char *block,
+                          int majorCount,
+                          int minorCount,
+                          int majorStep,
+                          int minorStep,
+                          unsigned char *parityOut);
+
+// Copies what the ECC covers. Mode 2 sectors get their header cleared.
+static void copy_ecc_block(const unsigned char *sector, size_t size, unsigned char *blockOut);
+
+uint32_t SectorEcc_ComputeEdc(const unsigned char *data, size_t size)
+{
+    call_once(&tablesOnce, build_tables);
+
+    uint32_t edc = 0;
+
+    // Eight bytes at a time. The tables do eight steps at once without waiting on the last byte.
+    while (size >= 8)
+    {
+        const uint32_t low  = edc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 |
+                                    (uint32_t)data[3] << 24);
+        const uint32_t high = (uint32_t)data[4] | (uint32_t)data[5] << 8 | (uint32_t)data[6] << 16 |
+                              (uint32_t)data[7] << 24;
+
+        edc = edcTables[7][low & 0xFF] ^ edcTables[6][(low >> 8) & 0xFF] ^ edcTables[5][(low >> 16) & 0xFF] ^
+              edcTables[4][low >> 24] ^ edcTables[3][high & 0xFF] ^ edcTables[2][(high >> 8) & 0xFF] ^
+              edcTables[1][(high >> 16) & 0xFF] ^ edcTables[0][high >> 24];
+
+        data += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0) { edc = (edc >> 8) ^ edcTables[0][(edc ^ *data++) & 0xFF]; }
+
+    return edc;
+}
+
+void SectorEcc_ComputeP(const unsigned char *sector, unsigned char *parityOut)
+{
+    call_once(&tablesOnce, build_tables);
+
+    unsigned char block[ECC_BLOCK_SIZE];
+    copy_ecc_block(sector, SECTOR_ECC_P_OFFSET - SECTOR_ECC_HEADER_OFFSET, block);
+    compute_block(block, 86, 24, 2, 86, parityOut);
+}
+
+void SectorEcc_ComputeQ(const unsigned char *sector, unsigned char *parityOut)
+{
+    call_once(&tablesOnce, build_tables);
+
+    unsigned char block[ECC_BLOCK_SIZE];
+    copy_ecc_block(sector, ECC_BLOCK_SIZE, block);
+    compute_block(block, 52, 43, 86, 88, parityOut);
+}
+
+bool SectorEcc_Generate(unsigned char *sector)
+{
+    const Sector *header = (const Sector *)sector;
+
+    size_t edcOffset = 0;
+    size_t edcSize   = 0;
+    bool hasEcc      = true;
+    if (header->header.mode == 1) { edcSize = SECTOR_EDC_MODE_1_SIZE; }
+    else if (header->header.mode == 2 && (header->subHeader[0].subMode & SUBMODE_FORM_2))
+    {
+        edcOffset = SECTOR_EDC_FORM_2_OFFSET;
+        edcSize   = SECTOR_EDC_FORM_2_SIZE;
+        hasEcc    = false;
+    }
+    else if (header->header.mode == 2)
+    {
+        edcOffset = SECTOR_EDC_FORM_1_OFFSET;
+        edcSize   = SECTOR_EDC_FORM_1_SIZE;
+    }
+    else { return false; }
+
+    const uint32_t edc = SectorEcc_ComputeEdc(&sector[edcOffset], edcSize);
+    unsigned char *out = &sector[edcOffset + edcSize];
+    out[0]             = (unsigned char)edc;
+    out[1]             = (unsigned char)(edc >> 8);
+    out[2]             = (unsigned char)(edc >> 16);
+    out[3]             = (unsigned char)(edc >> 24);
+
+    // Q covers P, so P has to be in place first.
+    if (hasEcc)
+    {
+        SectorEcc_ComputeP(sector, &sector[SECTOR_ECC_P_OFFSET]);
+        SectorEcc_ComputeQ(sector, &sector[SECTOR_ECC_Q_OFFSET]);
+    }
+
+    return true;
+}
+
+static void build_tables(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t edc = i;
+        for (int bit = 0; bit < 8; bit++) { edc = (edc >> 1) ^ ((edc & 1) ? EDC_POLYNOMIAL : 0); }
+        edcTables[0][i] = edc;
+    }
+
+    for (int table = 1; table < 8; table++)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            const uint32_t previous = edcTables[table - 1][i];
+            edcTables[table][i]     = (previous >> 8) ^ edcTables[0][previous & 0xFF];
+        }
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        const int doubled        = (i << 1) ^ ((i & 0x80) ? ECC_POLYNOMIAL : 0);
+        eccForward[i]            = (uint8_t)doubled;
+        eccBackward[i ^ doubled] = (uint8_t)i;
+    }
+}
+
+static void compute_block(const unsigned char *block,
+                          int majorCount,
+                          int minorCount,
+                          int majorStep,
+                          int minorStep,
+                          unsigned char *parityOut)
+{
+    const int size = majorCount * minorCount;
+    for (int major = 0; major < majorCount; major++)
+    {
+        // Even and odd bytes are separate codewords. Each pair of majors shares a starting word.
+        int index    = (major >> 1) * majorStep + (major & 1);
+        uint8_t eccA = 0;
+        uint8_t eccB = 0;
+        for (int minor = 0; minor < minorCount; minor++)
+        {
+            const uint8_t value = block[index];
+            index += minorStep;
+            if (index >= size) { index -= size; }
+
+            eccA ^= value;
+            eccB ^= value;
+            eccA = eccForward[eccA];
+        }
+
+        eccA                          = eccBackward[eccForward[eccA] ^ eccB];
+        parityOut[major]              = eccA;
+        parityOut[major + majorCount] = eccA ^ eccB;
+    }
+}
+
+static void copy_ecc_block(const unsigned char *sector, size_t size, unsigned char *blockOut)
+{
+    memcpy(blockOut, &sector[SECTOR_ECC_HEADER_OFFSET], size);
+    if (((const Sector *)sector)->header.mode == 2) { memset(blockOut, 0, sizeof(SectorHeader)); }
+}
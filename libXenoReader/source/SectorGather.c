@@ -0,0 +1,162 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "SectorGather.h"
+
+#include "Sector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+    #define XENO_GATHER_SSE2
+    #include <emmintrin.h>
+    #if defined(__GNUC__) || defined(__clang__)
+        #define XENO_GATHER_AVX2
+        #include <immintrin.h>
+    #endif
+#endif
+
+/// @brief Offset of the data inside of a raw sector.
+#define DATA_OFFSET offsetof(Sector, data)
+
+/// @brief Runs this long (4MB of data) are copied with streaming stores when possible.
+#define STREAM_SECTOR_COUNT 2048
+
+void SectorGather_PayloadsScalar(unsigned char *destination, const unsigned char *source, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        memcpy(&destination[i * DATA_SIZE], &source[i * SECTOR_SIZE + DATA_OFFSET], DATA_SIZE);
+    }
+}
+
+#ifdef XENO_GATHER_SSE2
+static void gather_sse2(unsigned char *destination, const unsigned char *source, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        // The data begins 24 bytes in, so the loads are never aligned. The stores usually are.
+        const unsigned char *in = &source[i * SECTOR_SIZE + DATA_OFFSET];
+        unsigned char *out      = &destination[i * DATA_SIZE];
+
+        for (size_t j = 0; j < DATA_SIZE; j += 64)
+        {
+            const __m128i a = _mm_loadu_si128((const __m128i *)&in[j]);
+            const __m128i b = _mm_loadu_si128((const __m128i *)&in[j + 16]);
+            const __m128i c = _mm_loadu_si128((const __m128i *)&in[j + 32]);
+            const __m128i d = _mm_loadu_si128((const __m128i *)&in[j + 48]);
+            _mm_storeu_si128((__m128i *)&out[j], a);
+            _mm_storeu_si128((__m128i *)&out[j + 16], b);
+            _mm_storeu_si128((__m128i *)&out[j + 32], c);
+            _mm_storeu_si128((__m128i *)&out[j + 48], d);
+        }
+    }
+}
+
+static void gather_stream_sse2(unsigned char *destination, const unsigned char *source, size_t count)
+{
+    // Same as above, but the stores skip the cache. The output of a big run is never going to fit in it anyway.
+    for (size_t i = 0; i < count; i++)
+    {
+        const unsigned char *in = &source[i * SECTOR_SIZE + DATA_OFFSET];
+        unsigned char *out      = &destination[i * DATA_SIZE];
+
+        if (i + 1 < count) { _mm_prefetch((const char *)&in[SECTOR_SIZE], _MM_HINT_T0); }
+
+        for (size_t j = 0; j < DATA_SIZE; j += 64)
+        {
+            const __m128i a = _mm_loadu_si128((const __m128i *)&in[j]);
+            const __m128i b = _mm_loadu_si128((const __m128i *)&in[j + 16]);
+            const __m128i c = _mm_loadu_si128((const __m128i *)&in[j + 32]);
+            const __m128i d = _mm_loadu_si128((const __m128i *)&in[j + 48]);
+            _mm_stream_si128((__m128i *)&out[j], a);
+            _mm_stream_si128((__m128i *)&out[j + 16], b);
+            _mm_stream_si128((__m128i *)&out[j + 32], c);
+            _mm_stream_si128((__m128i *)&out[j + 48], d);
+        }
+    }
+
+    // Streaming stores need to be fenced before anyone else reads the output.
+    _mm_sfence();
+}
+#endif
+
+#ifdef XENO_GATHER_AVX2
+__attribute__((target("avx2"))) static void gather_avx2(unsigned char *destination,
+                                                        const unsigned char *source,
+                                                        size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const unsigned char *in = &source[i * SECTOR_SIZE + DATA_OFFSET];
+        unsigned char *out      = &destination[i * DATA_SIZE];
+
+        // Pull the next sector in while this one is being copied.
+        if (i + 1 < count) { _mm_prefetch((const char *)&in[SECTOR_SIZE], _MM_HINT_T0); }
+
+        for (size_t j = 0; j < DATA_SIZE; j += 128)
+        {
+            const __m256i a = _mm256_loadu_si256((const __m256i *)&in[j]);
+            const __m256i b = _mm256_loadu_si256((const __m256i *)&in[j + 32]);
+            const __m256i c = _mm256_loadu_si256((const __m256i *)&in[j + 64]);
+            const __m256i d = _mm256_loadu_si256((const __m256i *)&in[j + 96]);
+            _mm256_storeu_si256((__m256i *)&out[j], a);
+            _mm256_storeu_si256((__m256i *)&out[j + 32], b);
+            _mm256_storeu_si256((__m256i *)&out[j + 64], c);
+            _mm256_storeu_si256((__m256i *)&out[j + 96], d);
+        }
+    }
+
+    // Avoid the AVX to SSE transition penalty in whatever runs next.
+    _mm256_zeroupper();
+}
+
+static bool cpu_has_avx2(void) { return __builtin_cpu_supports("avx2"); }
+#endif
+
+void SectorGather_Payloads(unsigned char *destination, const unsigned char *source, size_t count)
+{
+#if defined(XENO_GATHER_SSE2)
+    // Streaming stores need 16 byte alignment. malloc always gives at least that.
+    if (count >= STREAM_SECTOR_COUNT && ((uintptr_t)destination & 15) == 0)
+    {
+        gather_stream_sse2(destination, source, count);
+        return;
+    }
+#endif
+
+#if defined(XENO_GATHER_AVX2)
+    if (cpu_has_avx2())
+    {
+        gather_avx2(destination, source, count);
+        return;
+    }
+#endif
+
+#if defined(XENO_GATHER_SSE2)
+    gather_sse2(destination, source, count);
+#else
+    SectorGather_PayloadsScalar(destination, source, count);
+#endif
+}
+
+const char *SectorGather_GetKernelName(void)
+{
+#if defined(XENO_GATHER_AVX2)
+    if (cpu_has_avx2()) { return "AVX2"; }
+#endif
+
+#if defined(XENO_GATHER_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
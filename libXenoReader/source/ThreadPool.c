@@ -0,0 +1,359 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "ThreadPool.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+/// @brief Initial capacity of every thread's queue.
+#define QUEUE_INITIAL_CAPACITY 64
+
+// clang-format off
+typedef struct
+{
+    /// @brief Function to run.
+    ThreadPoolTask task;
+
+    /// @brief Argument to pass to it.
+    void *argument;
+} Job;
+
+/// @brief This is a deque. The thread that owns it takes from the tail. Everyone else steals from the head.
+typedef struct
+{
+    /// @brief Protects everything below.
+    mtx_t lock;
+
+    /// @brief Ring buffer of jobs.
+    Job *jobs;
+
+    /// @brief Capacity of the ring buffer.
+    size_t capacity;
+
+    /// @brief Index of the oldest job.
+    size_t head;
+
+    /// @brief Number of jobs in the queue.
+    size_t length;
+} WorkQueue;
+
+/// @brief This is what's passed to each thread.
+typedef struct
+{
+    /// @brief Pool the thread belongs to.
+    ThreadPool *pool;
+
+    /// @brief Index of the thread's own queue.
+    int index;
+} WorkerArgument;
+
+struct ThreadPool
+{
+    /// @brief Threads.
+    thrd_t *threads;
+
+    /// @brief Arguments passed to the threads.
+    WorkerArgument *arguments;
+
+    /// @brief One queue per thread.
+    WorkQueue *queues;
+
+    /// @brief Number of threads and queues.
+    int threadCount;
+
+    /// @brief Number of threads that were actually started. This only differs from above if creation failed.
+    int startedCount;
+
+    /// @brief Used with the conditions below.
+    mtx_t lock;
+
+    /// @brief Signaled when a job is submitted or the pool is shutting down.
+    cnd_t workAvailable;
+
+    /// @brief Signaled when the last pending job finishes.
+    cnd_t allDone;
+
+    /// @brief Jobs that have been submitted and haven't finished yet.
+    atomic_size_t pending;
+
+    /// @brief Jobs sitting in queues that nobody has taken yet.
+    atomic_size_t queued;
+
+    /// @brief Round-robin counter used to spread jobs over the queues.
+    atomic_uint nextQueue;
+
+    /// @brief Set when the pool is being freed.
+    bool shuttingDown;
+};
+// clang-format on
+
+// Defined at bottom.
+static int worker_main(void *argument);
+static bool queue_push(WorkQueue *queue, Job job);
+static bool queue_pop_tail(WorkQueue *queue, Job *jobOut);
+static bool queue_pop_head(WorkQueue *queue, Job *jobOut);
+
+ThreadPool *ThreadPool_Create(int threadCount)
+{
+    if (threadCount <= 0) { threadCount = ThreadPool_GetProcessorCount(); }
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) { return NULL; }
+
+    pool->threads   = calloc(threadCount, sizeof(thrd_t));
+    pool->arguments = calloc(threadCount, sizeof(WorkerArgument));
+    pool->queues    = calloc(threadCount, sizeof(WorkQueue));
+    if (!pool->threads || !pool->arguments || !pool->queues) { goto Label_cleanup; }
+
+    pool->threadCount = threadCount;
+
+    mtx_init(&pool->lock, mtx_plain);
+    cnd_init(&pool->workAvailable);
+    cnd_init(&pool->allDone);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->nextQueue, 0);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        WorkQueue *queue = &pool->queues[i];
+        queue->jobs      = malloc(sizeof(Job) * QUEUE_INITIAL_CAPACITY);
+        queue->capacity  = QUEUE_INITIAL_CAPACITY;
+        if (!queue->jobs) { goto Label_cleanup; }
+
+        mtx_init(&queue->lock, mtx_plain);
+    }
+
+    // Threads are started last so everything they touch exists.
+    for (int i = 0; i < threadCount; i++)
+    {
+        pool->arguments[i].pool  = pool;
+        pool->arguments[i].index = i;
+        if (thrd_create(&pool->threads[i], worker_main, &pool->arguments[i]) != thrd_success)
+        {
+            // Let the threads that did start run down before bailing.
+            ThreadPool_Free(pool);
+            return NULL;
+        }
+        ++pool->startedCount;
+    }
+
+    return pool;
+
+Label_cleanup:
+    if (pool->queues)
+    {
+        for (int i = 0; i < threadCount; i++) { free(pool->queues[i].jobs); }
+    }
+    free(pool->queues);
+    free(pool->arguments);
+    free(pool->threads);
+    free(pool);
+
+    return NULL;
+}
+
+void ThreadPool_Free(ThreadPool *pool)
+{
+    if (!pool) { return; }
+
+    ThreadPool_Wait(pool);
+
+    mtx_lock(&pool->lock);
+    pool->shuttingDown = true;
+    cnd_broadcast(&pool->workAvailable);
+    mtx_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->startedCount; i++) { thrd_join(pool->threads[i], NULL); }
+
+    // The queues were all created even if not every thread started.
+    for (int i = 0; i < pool->threadCount; i++)
+    {
+        mtx_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].jobs);
+    }
+
+    cnd_destroy(&pool->allDone);
+    cnd_destroy(&pool->workAvailable);
+    mtx_destroy(&pool->lock);
+
+    free(pool->queues);
+    free(pool->arguments);
+    free(pool->threads);
+    free(pool);
+}
+
+bool ThreadPool_Submit(ThreadPool *pool, ThreadPoolTask task, void *argument)
+{
+    if (!pool || !task) { return false; }
+
+    const unsigned int queueIndex = atomic_fetch_add(&pool->nextQueue, 1) % (unsigned int)pool->threadCount;
+
+    // Pending has to go up before the job is visible, otherwise a fast worker could finish it and underflow.
+    atomic_fetch_add(&pool->pending, 1);
+    if (!queue_push(&pool->queues[queueIndex], (Job){.task = task, .argument = argument}))
+    {
+        atomic_fetch_sub(&pool->pending, 1);
+        return false;
+    }
+    atomic_fetch_add(&pool->queued, 1);
+
+    // The lock is taken so a worker can't check queued and go to sleep between the increment and the signal.
+    mtx_lock(&pool->lock);
+    cnd_signal(&pool->workAvailable);
+    mtx_unlock(&pool->lock);
+
+    return true;
+}
+
+void ThreadPool_Wait(ThreadPool *pool)
+{
+    mtx_lock(&pool->lock);
+    while (atomic_load(&pool->pending) > 0) { cnd_wait(&pool->allDone, &pool->lock); }
+    mtx_unlock(&pool->lock);
+}
+
+int ThreadPool_GetThreadCount(const ThreadPool *pool) { return pool->threadCount; }
+
+int ThreadPool_GetProcessorCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    const long count = (long)systemInfo.dwNumberOfProcessors;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return count > 0 ? (int)count : 1;
+}
+
+static bool take_job(ThreadPool *pool, int index, Job *jobOut)
+{
+    // Own queue first, newest job first since it's most likely to still be in cache.
+    if (queue_pop_tail(&pool->queues[index], jobOut)) { return true; }
+
+    // Then go around stealing the oldest job from everyone else.
+    for (int i = 1; i < pool->threadCount; i++)
+    {
+        const int victim = (index + i) % pool->threadCount;
+        if (queue_pop_head(&pool->queues[victim], jobOut)) { return true; }
+    }
+
+    return false;
+}
+
+static int worker_main(void *argument)
+{
+    const WorkerArgument *worker = (const WorkerArgument *)argument;
+    ThreadPool *pool             = worker->pool;
+
+    while (true)
+    {
+        Job job;
+        if (take_job(pool, worker->index, &job))
+        {
+            atomic_fetch_sub(&pool->queued, 1);
+            job.task(job.argument);
+
+            // The last job out wakes up anyone waiting.
+            if (atomic_fetch_sub(&pool->pending, 1) == 1)
+            {
+                mtx_lock(&pool->lock);
+                cnd_broadcast(&pool->allDone);
+                mtx_unlock(&pool->lock);
+            }
+            continue;
+        }
+
+        // Nothing to do. Sleep until something is submitted.
+        mtx_lock(&pool->lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->shuttingDown)
+        {
+            cnd_wait(&pool->workAvailable, &pool->lock);
+        }
+        const bool exit = pool->shuttingDown && atomic_load(&pool->queued) == 0;
+        mtx_unlock(&pool->lock);
+
+        if (exit) { break; }
+    }
+
+    return 0;
+}
+
+static bool queue_push(WorkQueue *queue, Job job)
+{
+    mtx_lock(&queue->lock);
+
+    if (queue->length == queue->capacity)
+    {
+        // Grow and unwrap the ring so head is at zero again.
+        const size_t newCapacity = queue->capacity * 2;
+        Job *newJobs             = malloc(sizeof(Job) * newCapacity);
+        if (!newJobs)
+        {
+            mtx_unlock(&queue->lock);
+            return false;
+        }
+
+        for (size_t i = 0; i < queue->length; i++) { newJobs[i] = queue->jobs[(queue->head + i) % queue->capacity]; }
+
+        free(queue->jobs);
+        queue->jobs     = newJobs;
+        queue->capacity = newCapacity;
+        queue->head     = 0;
+    }
+
+    queue->jobs[(queue->head + queue->length) % queue->capacity] = job;
+    ++queue->length;
+
+    mtx_unlock(&queue->lock);
+
+    return true;
+}
+
+static bool queue_pop_tail(WorkQueue *queue, Job *jobOut)
+{
+    mtx_lock(&queue->lock);
+
+    const bool hasJob = queue->length > 0;
+    if (hasJob)
+    {
+        --queue->length;
+        *jobOut = queue->jobs[(queue->head + queue->length) % queue->capacity];
+    }
+
+    mtx_unlock(&queue->lock);
+
+    return hasJob;
+}
+
+static bool queue_pop_head(WorkQueue *queue, Job *jobOut)
+{
+    mtx_lock(&queue->lock);
+
+    const bool hasJob = queue->length > 0;
+    if (hasJob)
+    {
+        *jobOut     = queue->jobs[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        --queue->length;
+    }
+
+    mtx_unlock(&queue->lock);
+
+    return hasJob;
+}
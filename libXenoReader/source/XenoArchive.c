@@ -0,0 +1,215 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoArchive.h"
+
+#define __XENO_INTERNAL__
+#include "XenoArchiveInternal.h"
+#include "XenoFileInternal.h"
+#include "XenoReaderInternal.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Size of the count and of each offset in a table.
+#define ARCHIVE_FIELD_SIZE 4
+
+// clang-format off
+struct XenoArchive
+{
+    /// @brief File the archive is in.
+    const XenoFile *file;
+
+    /// @brief Number of entries.
+    uint32_t entryCount;
+
+    /// @brief Offset of each entry in the file followed by where the last one ends. These are entryCount + 1 long.
+    uint32_t *offsets;
+
+    /// @brief Tables of entries that have been asked for as archives. These are built the same way the reader's are.
+    _Atomic(XenoArchive *) *children;
+};
+// clang-format on
+
+// This is cached for anything that isn't an archive so it's only read once. It's never handed out.
+static XenoArchive notAnArchive;
+
+// Gets the table in a slot or parses it and puts it there. Whoever loses a race frees theirs.
+static const XenoArchive *get_cached(XenoReader *reader,
+                                     _Atomic(XenoArchive *) *slot,
+                                     const XenoFile *file,
+                                     uint32_t base,
+                                     uint32_t size);
+
+// Parses the table at base. Returns notAnArchive if it doesn't look like one and NULL if it couldn't be read.
+static XenoArchive *parse_table(XenoReader *reader, const XenoFile *file, uint32_t base, uint32_t size);
+
+// Reads a little endian 32 bit integer.
+static uint32_t read_uint32(const unsigned char *bytes);
+
+const XenoArchive *XenoReader_GetArchive(XenoReader *reader, const XenoFile *file)
+{
+    // The file has to come from this reader's table.
+    const XenoFile *files = XenoFsTable_GetFiles(reader->fsTable);
+    if (file < files || file >= files + reader->fsTable->fileCount || file->size < 0) { return NULL; }
+
+    return get_cached(reader, &reader->archives[file - files], file, 0, (uint32_t)file->size);
+}
+
+const XenoArchive *XenoArchive_GetNested(XenoReader *reader, const XenoArchive *archive, int index)
+{
+    if (index < 0 || (uint32_t)index >= archive->entryCount) { return NULL; }
+
+    const uint32_t begin = archive->offsets[index];
+    const uint32_t end   = archive->offsets[index + 1];
+
+    return get_cached(reader, &archive->children[index], archive->file, begin, end - begin);
+}
+
+int XenoArchive_GetEntryCount(const XenoArchive *archive) { return (int)archive->entryCount; }
+
+bool XenoArchive_GetEntry(const XenoArchive *archive, int index, XenoArchiveEntry *entryOut)
+{
+    if (index < 0 || (uint32_t)index >= archive->entryCount) { return false; }
+
+    entryOut->file   = archive->file;
+    entryOut->offset = archive->offsets[index];
+    entryOut->size   = archive->offsets[index + 1] - archive->offsets[index];
+
+    return true;
+}
+
+bool XenoArchiveEntry_ReadRange(XenoReader *reader,
+                                const XenoArchiveEntry *entry,
+                                size_t offset,
+                                size_t length,
+                                void *dataOut)
+{
+    if (offset > entry->size || length > entry->size - offset) { return false; }
+
+    return XenoReader_ReadFileRange(reader, entry->file, entry->offset + offset, length, (unsigned char *)dataOut);
+}
+
+XenoBuffer *XenoArchiveEntry_Read(XenoReader *reader, const XenoArchiveEntry *entry)
+{
+    if (entry->size > INT32_MAX) { return NULL; }
+
+    XenoBuffer *buffer = malloc(sizeof(XenoBuffer));
+    if (!buffer) { return NULL; }
+
+    // Empty entries are common enough. malloc(0) is allowed to return NULL, so they get a byte anyway.
+    buffer->size = (int32_t)entry->size;
+    buffer->data = malloc(entry->size ? entry->size : 1);
+    if (!buffer->data || !XenoArchiveEntry_ReadRange(reader, entry, 0, entry->size, buffer->data))
+    {
+        XenoBuffer_Free(buffer);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+void XenoArchive_Free(XenoArchive *archive)
+{
+    if (!archive || archive == &notAnArchive) { return; }
+
+    for (uint32_t i = 0; i < archive->entryCount; i++) { XenoArchive_Free(atomic_load(&archive->children[i])); }
+
+    // The offsets and children live in the same block as the archive.
+    free(archive);
+}
+
+static const XenoArchive *get_cached(XenoReader *reader,
+                                     _Atomic(XenoArchive *) *slot,
+                                     const XenoFile *file,
+                                     uint32_t base,
+                                     uint32_t size)
+{
+    XenoArchive *archive = atomic_load_explicit(slot, memory_order_acquire);
+    if (!archive)
+    {
+        // Failed reads aren't cached. The next call gets to try again.
+        archive = parse_table(reader, file, base, size);
+        if (!archive) { return NULL; }
+
+        XenoArchive *expected = NULL;
+        if (!atomic_compare_exchange_strong_explicit(slot,
+                                                     &expected,
+                                                     archive,
+                                                     memory_order_acq_rel,
+                                                     memory_order_acquire))
+        {
+            XenoArchive_Free(archive);
+            archive = expected;
+        }
+    }
+
+    return archive == &notAnArchive ? NULL : archive;
+}
+
+static XenoArchive *parse_table(XenoReader *reader, const XenoFile *file, uint32_t base, uint32_t size)
+{
+    if (size < ARCHIVE_FIELD_SIZE) { return &notAnArchive; }
+
+    unsigned char countBytes[ARCHIVE_FIELD_SIZE];
+    if (!XenoReader_ReadFileRange(reader, file, base, ARCHIVE_FIELD_SIZE, countBytes)) { return NULL; }
+
+    // The count and the table have to fit in the archive.
+    const uint32_t entryCount = read_uint32(countBytes);
+    if (entryCount == 0 || entryCount > (size - ARCHIVE_FIELD_SIZE) / ARCHIVE_FIELD_SIZE) { return &notAnArchive; }
+
+    // The children come first since they need the most alignment. Everything is one allocation.
+    const size_t childrenSize = sizeof(_Atomic(XenoArchive *)) * entryCount;
+    const size_t offsetsSize  = sizeof(uint32_t) * ((size_t)entryCount + 1);
+    static_assert(sizeof(XenoArchive) % alignof(_Atomic(XenoArchive *)) == 0, "Children would be misaligned!");
+
+    XenoArchive *archive = malloc(sizeof(XenoArchive) + childrenSize + offsetsSize);
+    if (!archive) { return NULL; }
+
+    archive->file       = file;
+    archive->entryCount = entryCount;
+    archive->children   = (_Atomic(XenoArchive *) *)(archive + 1);
+    archive->offsets    = (uint32_t *)((unsigned char *)archive->children + childrenSize);
+
+    // The raw table is read over the offsets and converted in place.
+    const size_t tableSize = (size_t)entryCount * ARCHIVE_FIELD_SIZE;
+    unsigned char *table   = (unsigned char *)archive->offsets;
+    if (!XenoReader_ReadFileRange(reader, file, base + ARCHIVE_FIELD_SIZE, tableSize, table))
+    {
+        free(archive);
+        return NULL;
+    }
+
+    // Anything that points into the table, past the end or backwards means this was never an archive.
+    const uint32_t tableEnd = ARCHIVE_FIELD_SIZE + (uint32_t)tableSize;
+    uint32_t previous       = tableEnd;
+    for (uint32_t i = 0; i < entryCount; i++)
+    {
+        const uint32_t offset = read_uint32(&table[(size_t)i * ARCHIVE_FIELD_SIZE]);
+        if (offset < previous || offset > size)
+        {
+            free(archive);
+            return &notAnArchive;
+        }
+
+        archive->offsets[i] = base + offset;
+        previous            = offset;
+    }
+
+    archive->offsets[entryCount] = base + size;
+    for (uint32_t i = 0; i < entryCount; i++) { atomic_init(&archive->children[i], NULL); }
+
+    return archive;
+}
+
+static uint32_t read_uint32(const unsigned char *bytes)
+{
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
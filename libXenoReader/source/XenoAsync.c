@@ -0,0 +1,540 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoAsync.h"
+
+#include "IoRing.h"
+#include "Sector.h"
+#include "SectorGather.h"
+#include "ThreadPool.h"
+
+#define __XENO_INTERNAL__
+#include "XenoFileInternal.h"
+#include "XenoReaderInternal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+/// @brief Queue depth used when 0 or less is passed.
+#define DEFAULT_QUEUE_DEPTH 64
+
+/// @brief The thread pool fallback never starts more threads than this.
+#define MAX_FALLBACK_THREADS 32
+
+// clang-format off
+/// @brief How the queue actually reads.
+typedef enum
+{
+    ENGINE_IO_URING,
+    ENGINE_MAPPED,
+    ENGINE_THREAD_POOL
+} AsyncEngine;
+
+/// @brief One queued read.
+typedef struct AsyncRequest
+{
+    /// @brief Queue this belongs to. The thread pool needs this.
+    XenoAsync *async;
+
+    /// @brief Passed when the read was queued.
+    XenoAsyncCallback callback;
+    void *userData;
+
+    /// @brief Where the data goes.
+    unsigned char *dataOut;
+
+    /// @brief First sector to read.
+    size_t firstSector;
+
+    /// @brief Number of bytes of data to read. The last sector can be partial.
+    size_t size;
+
+    /// @brief io_uring reads the raw sectors here first. The data is gathered out once it's all there.
+    unsigned char *raw;
+
+    /// @brief Size of the buffer above and how much of it has been read so far.
+    size_t rawSize;
+    size_t rawRead;
+
+    /// @brief When the ring was handed the read. Only set if the reader is counting.
+    uint64_t queuedAt;
+
+    /// @brief Whether the read worked.
+    bool success;
+
+    /// @brief Next request in whichever list this is in.
+    struct AsyncRequest *next;
+} AsyncRequest;
+
+struct XenoAsync
+{
+    /// @brief Reader to read from.
+    XenoReader *reader;
+
+    /// @brief How reads are done.
+    AsyncEngine engine;
+
+    /// @brief Maximum number of reads in flight.
+    int queueDepth;
+
+    /// @brief Ring and the descriptor it reads from. Only for ENGINE_IO_URING.
+    IoRing *ring;
+    int descriptor;
+
+    /// @brief Number of reads the ring is working on.
+    int ringInFlight;
+
+    /// @brief Only for ENGINE_THREAD_POOL.
+    ThreadPool *pool;
+
+    /// @brief Reads queued since the last submit.
+    AsyncRequest *queuedHead;
+    AsyncRequest *queuedTail;
+
+    /// @brief Number of reads submitted and not reaped yet.
+    int pendingCount;
+
+    /// @brief Protects the finished list. The thread pool adds to it from its threads.
+    mtx_t lock;
+
+    /// @brief Signaled every time something is added to the finished list.
+    cnd_t finishedCondition;
+
+    /// @brief Reads that are done and waiting to be reaped.
+    AsyncRequest *finishedHead;
+    AsyncRequest *finishedTail;
+};
+// clang-format on
+
+// Adds a request to the queue.
+static bool queue_request(XenoAsync *async,
+                          size_t firstSector,
+                          size_t size,
+                          unsigned char *dataOut,
+                          XenoAsyncCallback callback,
+                          void *userData);
+
+// Does the whole read right here with the reader's normal functions.
+static bool read_request(XenoReader *reader, const AsyncRequest *request);
+
+// Moves a request to the finished list.
+static void finish_request(AsyncRequest *request, bool success);
+
+// Thread pool task.
+static void run_request(void *argument);
+
+// Hands a request to the ring. Falls back to reading it right here if that doesn't work out.
+static void submit_to_ring(XenoAsync *async, AsyncRequest *request);
+
+// Processes completions from the ring. If wait is true, blocks until there's at least one.
+static void reap_ring(XenoAsync *async, bool wait);
+
+// Returns whether anything is waiting to be reaped.
+static bool has_finished(XenoAsync *async);
+
+// Frees a list of requests.
+static void free_requests(AsyncRequest *request);
+
+XenoAsync *XenoAsync_Create(XenoReader *reader, int queueDepth)
+{
+    XenoAsync *async = calloc(1, sizeof(XenoAsync));
+    if (!async) { return NULL; }
+
+    async->reader     = reader;
+    async->queueDepth = queueDepth > 0 ? queueDepth : DEFAULT_QUEUE_DEPTH;
+    async->descriptor = XenoBackend_GetDescriptor(reader->backend);
+
+    if (mtx_init(&async->lock, mtx_plain) != thrd_success) { goto Label_cleanup; }
+    if (cnd_init(&async->finishedCondition) != thrd_success)
+    {
+        mtx_destroy(&async->lock);
+        goto Label_cleanup;
+    }
+
+    // Mapped images are already in memory, so there's nothing to wait on.
+    if (XenoBackend_Map(reader->backend, 0, SECTOR_SIZE))
+    {
+        async->engine = ENGINE_MAPPED;
+        return async;
+    }
+
+    async->ring = async->descriptor >= 0 ? IoRing_Create((unsigned int)async->queueDepth) : NULL;
+    if (async->ring)
+    {
+        async->engine = ENGINE_IO_URING;
+        return async;
+    }
+
+    const int threadCount = async->queueDepth < MAX_FALLBACK_THREADS ? async->queueDepth : MAX_FALLBACK_THREADS;
+    async->engine         = ENGINE_THREAD_POOL;
+    async->pool           = ThreadPool_Create(threadCount);
+    if (async->pool) { return async; }
+
+    cnd_destroy(&async->finishedCondition);
+    mtx_destroy(&async->lock);
+
+Label_cleanup:
+    free(async);
+
+    return NULL;
+}
+
+void XenoAsync_Free(XenoAsync *async)
+{
+    if (!async) { return; }
+
+    // Everything in flight needs to land before its buffers go away.
+    if (async->pool) { ThreadPool_Free(async->pool); }
+    while (async->ring && async->ringInFlight > 0) { reap_ring(async, true); }
+    IoRing_Free(async->ring);
+
+    free_requests(async->queuedHead);
+    free_requests(async->finishedHead);
+
+    cnd_destroy(&async->finishedCondition);
+    mtx_destroy(&async->lock);
+    free(async);
+}
+
+bool XenoAsync_QueueFile(XenoAsync *async,
+                         const XenoFile *file,
+                         unsigned char *dataOut,
+                         XenoAsyncCallback callback,
+                         void *userData)
+{
+    if (file->size < 0) { return false; }
+
+    return queue_request(async, file->sector, (size_t)file->size, dataOut, callback, userData);
+}
+
+bool XenoAsync_QueueSectorData(XenoAsync *async,
+                               size_t firstSector,
+                               size_t count,
+                               unsigned char *dataOut,
+                               XenoAsyncCallback callback,
+                               void *userData)
+{
+    return queue_request(async, firstSector, count * DATA_SIZE, dataOut, callback, userData);
+}
+
+int XenoAsync_Submit(XenoAsync *async)
+{
+    int submitted = 0;
+    while (async->queuedHead)
+    {
+        AsyncRequest *request = async->queuedHead;
+        async->queuedHead     = request->next;
+        request->next         = NULL;
+        ++async->pendingCount;
+        ++submitted;
+
+        switch (async->engine)
+        {
+            case ENGINE_IO_URING:
+            {
+                submit_to_ring(async, request);
+            }
+            break;
+
+            case ENGINE_MAPPED:
+            {
+                finish_request(request, read_request(async->reader, request));
+            }
+            break;
+
+            case ENGINE_THREAD_POOL:
+            {
+                if (!ThreadPool_Submit(async->pool, run_request, request)) { run_request(request); }
+            }
+            break;
+        }
+    }
+
+    async->queuedTail = NULL;
+
+    // Everything handed to the ring goes to the kernel in one call.
+    if (async->ring && !IoRing_Submit(async->ring, 0)) { return -1; }
+
+    return submitted;
+}
+
+int XenoAsync_Poll(XenoAsync *async, XenoAsyncCompletion *completionsOut, int maxCompletions, bool wait)
+{
+    // Ring completions are processed on this thread, so this needs to happen before the lock is taken.
+    if (async->ring)
+    {
+        reap_ring(async, false);
+        while (wait && async->ringInFlight > 0 && !has_finished(async)) { reap_ring(async, true); }
+    }
+
+    mtx_lock(&async->lock);
+
+    while (wait && !async->ring && !async->finishedHead && async->pendingCount > 0)
+    {
+        cnd_wait(&async->finishedCondition, &async->lock);
+    }
+
+    // Take what's needed off the list. Callbacks are called after the lock is released.
+    AsyncRequest *reaped = async->finishedHead;
+    AsyncRequest *last   = NULL;
+    int reapedCount      = 0;
+    for (AsyncRequest *request = reaped; request && reapedCount < maxCompletions; request = request->next)
+    {
+        last = request;
+        ++reapedCount;
+    }
+
+    if (last)
+    {
+        async->finishedHead = last->next;
+        if (!async->finishedHead) { async->finishedTail = NULL; }
+        last->next = NULL;
+    }
+    else { reaped = NULL; }
+
+    mtx_unlock(&async->lock);
+
+    async->pendingCount -= reapedCount;
+
+    int index = 0;
+    while (reaped)
+    {
+        AsyncRequest *next = reaped->next;
+
+        if (reaped->callback) { reaped->callback(reaped->userData, reaped->success); }
+        if (completionsOut)
+        {
+            completionsOut[index].userData = reaped->userData;
+            completionsOut[index].success  = reaped->success;
+        }
+
+        ++index;
+        free(reaped);
+        reaped = next;
+    }
+
+    return reapedCount;
+}
+
+int XenoAsync_GetPendingCount(const XenoAsync *async) { return async->pendingCount; }
+
+const char *XenoAsync_GetEngineName(const XenoAsync *async)
+{
+    switch (async->engine)
+    {
+        case ENGINE_IO_URING:
+            return "io_uring";
+
+        case ENGINE_MAPPED:
+            return "mapped";
+
+        case ENGINE_THREAD_POOL:
+            return "thread pool";
+    }
+
+    return "unknown";
+}
+
+static bool queue_request(XenoAsync *async,
+                          size_t firstSector,
+                          size_t size,
+                          unsigned char *dataOut,
+                          XenoAsyncCallback callback,
+                          void *userData)
+{
+    // Everything is checked here so the engines don't need to.
+    const size_t sectorCount = (size + DATA_SIZE - 1) / DATA_SIZE;
+    const size_t imageSize   = XenoReader_GetSectorCount(async->reader);
+    if (firstSector > imageSize || sectorCount > imageSize - firstSector) { return false; }
+
+    AsyncRequest *request = calloc(1, sizeof(AsyncRequest));
+    if (!request) { return false; }
+
+    request->async       = async;
+    request->callback    = callback;
+    request->userData    = userData;
+    request->dataOut     = dataOut;
+    request->firstSector = firstSector;
+    request->size        = size;
+    request->rawSize     = sectorCount * SECTOR_SIZE;
+
+    if (async->queuedTail) { async->queuedTail->next = request; }
+    else { async->queuedHead = request; }
+    async->queuedTail = request;
+
+    return true;
+}
+
+static bool read_request(XenoReader *reader, const AsyncRequest *request)
+{
+    // This is the same as XenoReader_ReadFile, just into the caller's buffer.
+    const size_t fullSectors = request->size / DATA_SIZE;
+    const size_t remainder   = request->size % DATA_SIZE;
+    if (!XenoReader_ReadSectorData(reader, request->firstSector, fullSectors, request->dataOut)) { return false; }
+
+    if (remainder > 0)
+    {
+        Sector sector;
+        if (!XenoReader_ReadRawSectorAt(reader, request->firstSector + fullSectors, &sector)) { return false; }
+
+        memcpy(&request->dataOut[fullSectors * DATA_SIZE], sector.data, remainder);
+    }
+
+    return true;
+}
+
+static void finish_request(AsyncRequest *request, bool success)
+{
+    XenoAsync *async = request->async;
+
+    free(request->raw);
+    request->raw     = NULL;
+    request->success = success;
+
+    mtx_lock(&async->lock);
+
+    if (async->finishedTail) { async->finishedTail->next = request; }
+    else { async->finishedHead = request; }
+    async->finishedTail = request;
+
+    cnd_signal(&async->finishedCondition);
+    mtx_unlock(&async->lock);
+}
+
+static void run_request(void *argument)
+{
+    AsyncRequest *request = (AsyncRequest *)argument;
+
+    finish_request(request, read_request(request->async->reader, request));
+}
+
+static void submit_to_ring(XenoAsync *async, AsyncRequest *request)
+{
+    // Nothing to read.
+    if (request->rawSize == 0)
+    {
+        finish_request(request, true);
+        return;
+    }
+
+    // The ring can only hold so much. Make room by waiting for something to finish.
+    while (async->ringInFlight >= async->queueDepth)
+    {
+        IoRing_Submit(async->ring, 0);
+        reap_ring(async, true);
+    }
+
+    request->raw      = malloc(request->rawSize);
+    request->queuedAt = XenoStats_IsActive(&async->reader->stats) ? XenoTrace_GetTime() : 0;
+
+    const uint64_t offset = (uint64_t)request->firstSector * SECTOR_SIZE;
+    const bool queued     = request->raw && request->rawSize <= UINT32_MAX &&
+                        IoRing_QueueRead(async->ring,
+                                         async->descriptor,
+                                         request->raw,
+                                         (uint32_t)request->rawSize,
+                                         offset,
+                                         (uint64_t)(uintptr_t)request);
+    if (!queued)
+    {
+        finish_request(request, read_request(async->reader, request));
+        return;
+    }
+
+    ++async->ringInFlight;
+}
+
+static void reap_ring(XenoAsync *async, bool wait)
+{
+    if (wait && !IoRing_Submit(async->ring, 1)) { return; }
+
+    bool resubmit     = false;
+    uint64_t userData = 0;
+    int32_t result    = 0;
+    while (IoRing_PopCompletion(async->ring, &userData, &result))
+    {
+        AsyncRequest *request = (AsyncRequest *)(uintptr_t)userData;
+
+        // Big reads can come back short. The rest is queued again in the same slot.
+        if (result > 0 && request->rawRead + result < request->rawSize)
+        {
+            request->rawRead += result;
+
+            const uint64_t offset = (uint64_t)request->firstSector * SECTOR_SIZE + request->rawRead;
+            const uint32_t length = (uint32_t)(request->rawSize - request->rawRead);
+            unsigned char *buffer = &request->raw[request->rawRead];
+            if (IoRing_QueueRead(async->ring, async->descriptor, buffer, length, offset, userData))
+            {
+                resubmit = true;
+                continue;
+            }
+        }
+
+        --async->ringInFlight;
+
+        // The ring reads around the reader, so it's counted here as one read from queueing to completion.
+        XenoStatsState *stats = &async->reader->stats;
+        const bool complete   = result > 0 && request->rawRead + result >= request->rawSize;
+        const bool active     = XenoStats_IsActive(stats);
+        if (active)
+        {
+            XenoStats_RecordSectors(stats, request->firstSector, request->rawSize / SECTOR_SIZE, request->queuedAt,
+                                    XenoTrace_GetTime(), false, complete);
+        }
+
+        // If the kernel couldn't do it, whatever the error was, try once more the normal way.
+        if (!complete)
+        {
+            finish_request(request, read_request(async->reader, request));
+            continue;
+        }
+
+        // Everything is there. Strip the sectors down to their data.
+        const uint64_t begin     = active ? XenoTrace_GetTime() : 0;
+        const size_t fullSectors = request->size / DATA_SIZE;
+        const size_t remainder   = request->size % DATA_SIZE;
+        SectorGather_Payloads(request->dataOut, request->raw, fullSectors);
+        if (remainder > 0)
+        {
+            const Sector *last = (const Sector *)&request->raw[fullSectors * SECTOR_SIZE];
+            memcpy(&request->dataOut[fullSectors * DATA_SIZE], last->data, remainder);
+        }
+
+        if (active)
+        {
+            XenoStats_RecordCopy(stats, begin, XenoTrace_GetTime());
+            XenoStats_RecordDelivered(stats, request->size);
+        }
+
+        finish_request(request, true);
+    }
+
+    if (resubmit) { IoRing_Submit(async->ring, 0); }
+}
+
+static bool has_finished(XenoAsync *async)
+{
+    mtx_lock(&async->lock);
+    const bool finished = async->finishedHead != NULL;
+    mtx_unlock(&async->lock);
+
+    return finished;
+}
+
+static void free_requests(AsyncRequest *request)
+{
+    while (request)
+    {
+        AsyncRequest *next = request->next;
+
+        free(request->raw);
+        free(request);
+        request = next;
+    }
+}
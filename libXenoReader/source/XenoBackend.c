@@ -0,0 +1,415 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoBackend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// clang-format off
+struct XenoBackend
+{
+    /// @brief The functions used to actually do things.
+    XenoBackendInterface interface;
+
+    /// @brief Passed to the functions above.
+    void *context;
+
+    /// @brief Size of the image in bytes.
+    uint64_t size;
+};
+
+/// @brief Context for images that are mapped or already in memory.
+typedef struct
+{
+    /// @brief Beginning of the image.
+    const unsigned char *data;
+
+    /// @brief Size of the image.
+    size_t size;
+} MemoryContext;
+// clang-format on
+
+// Stdio functions.
+static bool stdio_read(void *context, uint64_t offset, void *buffer, size_t length);
+static void stdio_close(void *context);
+#ifdef _WIN32
+static bool stdio_write(void *context, uint64_t offset, const void *buffer, size_t length);
+#endif
+
+// Opens a FILE and gets its size. Shared by both stdio backends.
+static FILE *stdio_open(const char *path, const char *mode, long *sizeOut);
+
+#ifndef _WIN32
+// Descriptor functions.
+static bool file_read(void *context, uint64_t offset, void *buffer, size_t length);
+static bool file_write(void *context, uint64_t offset, const void *buffer, size_t length);
+static void file_close(void *context);
+
+// Opens a descriptor and gets its size. Shared by both descriptor backends.
+static int file_open(const char *path, int flags, off_t *sizeOut);
+#endif
+
+// Memory functions. These are shared by the mmap backend.
+static bool memory_read(void *context, uint64_t offset, void *buffer, size_t length);
+static const void *memory_map(void *context, uint64_t offset, size_t length);
+static void memory_close(void *context);
+#ifndef _WIN32
+static void mmap_close(void *context);
+#endif
+
+XenoBackend *XenoBackend_Create(const XenoBackendInterface *interface, void *context, uint64_t size)
+{
+    if (!interface || !interface->read) { return NULL; }
+
+    XenoBackend *backend = malloc(sizeof(XenoBackend));
+    if (!backend) { return NULL; }
+
+    backend->interface = *interface;
+    backend->context   = context;
+    backend->size      = size;
+
+    return backend;
+}
+
+XenoBackend *XenoBackend_OpenStdio(const char *path)
+{
+    long size   = 0;
+    FILE *image = stdio_open(path, "rb", &size);
+    if (!image) { return NULL; }
+
+    static const XenoBackendInterface STDIO_INTERFACE = {.read = stdio_read, .map = NULL, .close = stdio_close};
+
+    XenoBackend *backend = XenoBackend_Create(&STDIO_INTERFACE, image, (uint64_t)size);
+    if (!backend) { fclose(image); }
+
+    return backend;
+}
+
+XenoBackend *XenoBackend_OpenFile(const char *path)
+{
+#ifdef _WIN32
+    (void)path;
+    return NULL;
+#else
+    off_t size           = 0;
+    const int descriptor = file_open(path, O_RDONLY, &size);
+    if (descriptor < 0) { return NULL; }
+
+    // The descriptor is stored directly in the context pointer. There's nothing else to keep track of.
+    static const XenoBackendInterface FILE_INTERFACE = {.read = file_read, .map = NULL, .close = file_close};
+
+    XenoBackend *backend = XenoBackend_Create(&FILE_INTERFACE, (void *)(intptr_t)descriptor, size);
+    if (!backend) { close(descriptor); }
+
+    return backend;
+#endif
+}
+
+XenoBackend *XenoBackend_OpenWritable(const char *path)
+{
+#ifdef _WIN32
+    long size   = 0;
+    FILE *image = stdio_open(path, "r+b", &size);
+    if (!image) { return NULL; }
+
+    static const XenoBackendInterface WRITABLE_INTERFACE = {.read  = stdio_read,
+                                                           .map   = NULL,
+                                                           .close = stdio_close,
+                                                           .write = stdio_write};
+
+    XenoBackend *backend = XenoBackend_Create(&WRITABLE_INTERFACE, image, (uint64_t)size);
+    if (!backend) { fclose(image); }
+
+    return backend;
+#else
+    off_t size           = 0;
+    const int descriptor = file_open(path, O_RDWR, &size);
+    if (descriptor < 0) { return NULL; }
+
+    // This reads the same way the descriptor backend does, so reads can still go to io_uring.
+    static const XenoBackendInterface WRITABLE_INTERFACE = {.read  = file_read,
+                                                           .map   = NULL,
+                                                           .close = file_close,
+                                                           .write = file_write};
+
+    XenoBackend *backend = XenoBackend_Create(&WRITABLE_INTERFACE, (void *)(intptr_t)descriptor, size);
+    if (!backend) { close(descriptor); }
+
+    return backend;
+#endif
+}
+
+XenoBackend *XenoBackend_OpenMmap(const char *path)
+{
+#ifdef _WIN32
+    (void)path;
+    return NULL;
+#else
+    const int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) { return NULL; }
+
+    struct stat fileStat;
+    if (fstat(descriptor, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(descriptor);
+        return NULL;
+    }
+
+    const size_t size = (size_t)fileStat.st_size;
+    void *map         = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    // The mapping holds its own reference to the file.
+    close(descriptor);
+    if (map == MAP_FAILED) { return NULL; }
+
+    MemoryContext *context = malloc(sizeof(MemoryContext));
+    if (!context)
+    {
+        munmap(map, size);
+        return NULL;
+    }
+
+    context->data = map;
+    context->size = size;
+
+    static const XenoBackendInterface MMAP_INTERFACE = {.read = memory_read, .map = memory_map, .close = mmap_close};
+
+    XenoBackend *backend = XenoBackend_Create(&MMAP_INTERFACE, context, size);
+    if (!backend) { mmap_close(context); }
+
+    return backend;
+#endif
+}
+
+XenoBackend *XenoBackend_OpenMemory(const void *data, size_t size)
+{
+    if (!data) { return NULL; }
+
+    MemoryContext *context = malloc(sizeof(MemoryContext));
+    if (!context) { return NULL; }
+
+    context->data = data;
+    context->size = size;
+
+    static const XenoBackendInterface MEMORY_INTERFACE = {.read  = memory_read,
+                                                          .map   = memory_map,
+                                                          .close = memory_close};
+
+    XenoBackend *backend = XenoBackend_Create(&MEMORY_INTERFACE, context, size);
+    if (!backend) { free(context); }
+
+    return backend;
+}
+
+void XenoBackend_Close(XenoBackend *backend)
+{
+    if (!backend) { return; }
+
+    if (backend->interface.close) { backend->interface.close(backend->context); }
+
+    free(backend);
+}
+
+uint64_t XenoBackend_GetSize(const XenoBackend *backend) { return backend->size; }
+
+bool XenoBackend_Read(XenoBackend *backend, uint64_t offset, void *buffer, size_t length)
+{
+    if (offset > backend->size || length > backend->size - offset) { return false; }
+
+    return backend->interface.read(backend->context, offset, buffer, length);
+}
+
+bool XenoBackend_Write(XenoBackend *backend, uint64_t offset, const void *buffer, size_t length)
+{
+    if (!backend->interface.write || offset > backend->size || length > backend->size - offset) { return false; }
+
+    return backend->interface.write(backend->context, offset, buffer, length);
+}
+
+bool XenoBackend_IsWritable(const XenoBackend *backend) { return backend->interface.write != NULL; }
+
+const void *XenoBackend_Map(XenoBackend *backend, uint64_t offset, size_t length)
+{
+    if (!backend->interface.map || offset > backend->size || length > backend->size - offset) { return NULL; }
+
+    return backend->interface.map(backend->context, offset, length);
+}
+
+int XenoBackend_GetDescriptor(const XenoBackend *backend)
+{
+#ifdef _WIN32
+    (void)backend;
+    return -1;
+#else
+    // Only the descriptor backend stores one, and it's the only one using file_read.
+    if (backend->interface.read != file_read) { return -1; }
+
+    return (int)(intptr_t)backend->context;
+#endif
+}
+
+static bool stdio_read(void *context, uint64_t offset, void *buffer, size_t length)
+{
+    FILE *image = (FILE *)context;
+
+    // The seek and read need to happen together or another thread can move the position in between.
+#ifdef _WIN32
+    _lock_file(image);
+#else
+    flockfile(image);
+#endif
+
+    const bool seek = fseek(image, (long)offset, SEEK_SET) == 0;
+    const bool read = seek && fread(buffer, 1, length, image) == length;
+
+#ifdef _WIN32
+    _unlock_file(image);
+#else
+    funlockfile(image);
+#endif
+
+    return read;
+}
+
+#ifdef _WIN32
+static bool stdio_write(void *context, uint64_t offset, const void *buffer, size_t length)
+{
+    FILE *image = (FILE *)context;
+
+    // Same as reading. The seek and write can't be split up.
+    _lock_file(image);
+
+    const bool seek  = fseek(image, (long)offset, SEEK_SET) == 0;
+    const bool write = seek && fwrite(buffer, 1, length, image) == length && fflush(image) == 0;
+
+    _unlock_file(image);
+
+    return write;
+}
+#endif
+
+static void stdio_close(void *context) { fclose((FILE *)context); }
+
+static FILE *stdio_open(const char *path, const char *mode, long *sizeOut)
+{
+    FILE *image = fopen(path, mode);
+    if (!image) { return NULL; }
+
+    // Grab the size by seeking to the end.
+    const bool endSeek = fseek(image, 0, SEEK_END) == 0;
+    *sizeOut           = endSeek ? ftell(image) : -1;
+    if (*sizeOut < 0)
+    {
+        fclose(image);
+        return NULL;
+    }
+
+    return image;
+}
+
+#ifndef _WIN32
+static bool file_read(void *context, uint64_t offset, void *buffer, size_t length)
+{
+    const int descriptor = (int)(intptr_t)context;
+    unsigned char *out   = (unsigned char *)buffer;
+
+    // pread never touches the file position, so any number of threads can do this at once.
+    while (length > 0)
+    {
+        const ssize_t bytesRead = pread(descriptor, out, length, (off_t)offset);
+        if (bytesRead < 0 && errno == EINTR) { continue; }
+        if (bytesRead <= 0) { return false; }
+
+        out += bytesRead;
+        offset += bytesRead;
+        length -= bytesRead;
+    }
+
+    return true;
+}
+
+static bool file_write(void *context, uint64_t offset, const void *buffer, size_t length)
+{
+    const int descriptor    = (int)(intptr_t)context;
+    const unsigned char *in = (const unsigned char *)buffer;
+
+    // Like pread, this never touches the file position.
+    while (length > 0)
+    {
+        const ssize_t bytesWritten = pwrite(descriptor, in, length, (off_t)offset);
+        if (bytesWritten < 0 && errno == EINTR) { continue; }
+        if (bytesWritten <= 0) { return false; }
+
+        in += bytesWritten;
+        offset += bytesWritten;
+        length -= bytesWritten;
+    }
+
+    return true;
+}
+
+static void file_close(void *context) { close((int)(intptr_t)context); }
+
+static int file_open(const char *path, int flags, off_t *sizeOut)
+{
+    const int descriptor = open(path, flags);
+    if (descriptor < 0) { return -1; }
+
+    struct stat fileStat;
+    if (fstat(descriptor, &fileStat) != 0 || fileStat.st_size < 0)
+    {
+        close(descriptor);
+        return -1;
+    }
+
+    *sizeOut = fileStat.st_size;
+
+    return descriptor;
+}
+#endif
+
+static bool memory_read(void *context, uint64_t offset, void *buffer, size_t length)
+{
+    const MemoryContext *memory = (const MemoryContext *)context;
+
+    // Bounds were already checked by XenoBackend_Read.
+    memcpy(buffer, &memory->data[offset], length);
+
+    return true;
+}
+
+static const void *memory_map(void *context, uint64_t offset, size_t length)
+{
+    (void)length;
+
+    const MemoryContext *memory = (const MemoryContext *)context;
+
+    return &memory->data[offset];
+}
+
+static void memory_close(void *context) { free(context); }
+
+#ifndef _WIN32
+static void mmap_close(void *context)
+{
+    MemoryContext *memory = (MemoryContext *)context;
+
+    munmap((void *)memory->data, memory->size);
+    free(memory);
+}
+#endif
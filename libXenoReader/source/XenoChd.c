@@ -0,0 +1,829 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoBackend.h"
+
+#include "Codec.h"
+#include "HunkCache.h"
+#include "Sector.h"
+#include "SectorEcc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+/// @brief Every CHD file begins with these eight bytes.
+#define CHD_MAGIC      "MComprHD"
+#define CHD_MAGIC_SIZE 8
+
+/// @brief Only version 5 headers are read. This is what chdman has made for years.
+#define CHD_VERSION     5
+#define CHD_HEADER_SIZE 124
+
+/// @brief Offsets in the header. Everything is big endian.
+#define CHD_HEADER_LENGTH_OFFSET  8
+#define CHD_HEADER_VERSION_OFFSET 12
+#define CHD_HEADER_CODECS_OFFSET  16
+#define CHD_HEADER_LOGICAL_OFFSET 32
+#define CHD_HEADER_MAP_OFFSET     40
+#define CHD_HEADER_META_OFFSET    48
+#define CHD_HEADER_HUNK_OFFSET    56
+#define CHD_HEADER_UNIT_OFFSET    60
+#define CHD_HEADER_PARENT_OFFSET  104
+
+/// @brief Size of the parent's SHA-1 in the header. It's all zeros if there's no parent.
+#define CHD_PARENT_SHA1_SIZE 20
+
+/// @brief CD images store every sector followed by its subcode.
+#define CHD_SUBCODE_SIZE 96
+#define CHD_FRAME_SIZE   (SECTOR_SIZE + CHD_SUBCODE_SIZE)
+
+/// @brief Size of the header in front of a compressed map and of each entry once it's decoded.
+#define CHD_MAP_HEADER_SIZE 16
+#define CHD_MAP_ENTRY_SIZE  12
+
+/// @brief Size of the header in front of each piece of metadata.
+#define CHD_META_HEADER_SIZE 16
+
+/// @brief Metadata is walked this far at most. This keeps a corrupt file with a loop from hanging.
+#define CHD_MAX_META_ENTRIES 1024
+
+/// @brief Number of decoded hunks kept around.
+#define CHD_CACHE_HUNKS 32
+
+/// @brief Hunks that refer to other hunks are only followed this far.
+#define CHD_MAX_SELF_DEPTH 4
+
+/// @brief Builds a four character tag.
+#define CHD_TAG(a, b, c, d) ((uint32_t)(a) << 24 | (uint32_t)(b) << 16 | (uint32_t)(c) << 8 | (uint32_t)(d))
+
+/// @brief Codecs. Only deflate and LZMA are decoded. FLAC and Zstandard hunks make the image be turned away.
+#define CHD_CODEC_ZLIB    CHD_TAG('z', 'l', 'i', 'b')
+#define CHD_CODEC_LZMA    CHD_TAG('l', 'z', 'm', 'a')
+#define CHD_CODEC_CD_ZLIB CHD_TAG('c', 'd', 'z', 'l')
+#define CHD_CODEC_CD_LZMA CHD_TAG('c', 'd', 'l', 'z')
+
+/// @brief Metadata that describes a track. The second is what chdman used before pregaps were stored.
+#define CHD_META_TRACK   CHD_TAG('C', 'H', 'T', '2')
+#define CHD_META_TRACK_1 CHD_TAG('C', 'H', 'T', 'R')
+
+/// @brief Every hunk chdman makes is compressed with these settings, whatever the level.
+#define CHD_LZMA_LC 3
+#define CHD_LZMA_LP 0
+#define CHD_LZMA_PB 2
+
+/// @brief The map's Huffman code has one code for each entry type, and none of them are longer than this.
+#define CHD_MAP_CODE_COUNT 16
+#define CHD_MAP_CODE_BITS  8
+
+// clang-format off
+/// @brief How a hunk is stored. These are the values in the map.
+typedef enum
+{
+    /// @brief Compressed with one of the four codecs in the header.
+    CHD_HUNK_CODEC_0,
+    CHD_HUNK_CODEC_1,
+    CHD_HUNK_CODEC_2,
+    CHD_HUNK_CODEC_3,
+
+    /// @brief Stored as it is.
+    CHD_HUNK_NONE,
+
+    /// @brief The same as an earlier hunk.
+    CHD_HUNK_SELF,
+
+    /// @brief The same as a hunk in a parent image.
+    CHD_HUNK_PARENT,
+
+    /// @brief These only show up while the map is decoded. They're shorthand for the entries above.
+    CHD_HUNK_RLE_SMALL,
+    CHD_HUNK_RLE_LARGE,
+    CHD_HUNK_SELF_0,
+    CHD_HUNK_SELF_1,
+    CHD_HUNK_PARENT_SELF,
+    CHD_HUNK_PARENT_0,
+    CHD_HUNK_PARENT_1,
+
+    /// @brief Stored as it is in an image without a compressed map. There's no CRC to check.
+    CHD_HUNK_UNCHECKED,
+
+    /// @brief Never written in an image without a compressed map. This reads as zeros.
+    CHD_HUNK_ZERO
+} ChdHunkType;
+
+/// @brief One entry of the map.
+typedef struct
+{
+    /// @brief Offset in the file. For hunks that are the same as an earlier one, this is the earlier hunk.
+    uint64_t offset;
+
+    /// @brief Number of bytes in the file.
+    uint32_t length;
+
+    /// @brief CRC of the decoded hunk, subcode and all.
+    uint16_t crc;
+
+    /// @brief How the hunk is stored.
+    uint8_t type;
+} ChdHunk;
+
+/// @brief Everything a CHD backend needs.
+typedef struct
+{
+    /// @brief Backend holding the CHD file.
+    XenoBackend *source;
+
+    /// @brief Codecs hunks can be compressed with.
+    uint32_t codecs[4];
+
+    /// @brief Size of a hunk with subcode and the number of sectors in one.
+    uint32_t hunkBytes;
+    uint32_t hunkSectors;
+
+    /// @brief Every hunk in the file.
+    ChdHunk *hunks;
+    uint32_t hunkCount;
+
+    /// @brief Size of the first track once the subcode is taken out.
+    uint64_t size;
+
+    /// @brief Recently decoded hunks. These only have the raw sectors.
+    HunkCache *cache;
+} ChdContext;
+
+/// @brief Bits of the compressed map. These are taken from the top of each byte first.
+typedef struct
+{
+    /// @brief The map.
+    const unsigned char *data;
+    size_t size;
+
+    /// @brief Number of bits taken so far. This can go past the end, which reads as zeros.
+    size_t position;
+} MapBits;
+
+/// @brief Huffman code of the map's entry types.
+typedef struct
+{
+    /// @brief Symbol and length of every code, indexed by the next CHD_MAP_CODE_BITS bits. The symbol is in the top
+    /// bits and the length in the low four. 0 means the bits aren't a code.
+    uint16_t lookup[1 << CHD_MAP_CODE_BITS];
+} MapHuffman;
+// clang-format on
+
+// The CRC that covers the map and every hunk.
+static uint16_t crc16Table[256];
+static once_flag crc16Once = ONCE_FLAG_INIT;
+
+// Sync pattern every data sector begins with. Images can leave it out along with the ECC.
+static const unsigned char SYNC_PATTERN[12] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+
+// Backend functions.
+static bool chd_read(void *context, uint64_t offset, void *buffer, size_t length);
+static void chd_close(void *context);
+
+// Finds the first track in the metadata and gets its number of sectors.
+static bool read_track(ChdContext *chd, uint64_t metaOffset, uint64_t *sectorCountOut);
+
+// Reads the map. Images made with any codec have a compressed map, and images made without one have a flat one.
+static bool read_map(ChdContext *chd, uint64_t mapOffset);
+static bool read_flat_map(ChdContext *chd, uint64_t mapOffset);
+
+// Reads the Huffman code in front of the compressed map.
+static bool import_map_huffman(MapHuffman *huffman, MapBits *bits);
+
+// Takes bits from the compressed map.
+static uint32_t peek_map_bits(const MapBits *bits, int count);
+static uint32_t read_map_bits(MapBits *bits, int count);
+
+// Decodes one entry type from the compressed map. Returns -1 if the bits aren't a code.
+static int decode_map_symbol(const MapHuffman *huffman, MapBits *bits);
+
+// Gets a hunk from the cache or decodes it.
+static bool get_hunk(ChdContext *chd, uint32_t hunk, unsigned char *sectorsOut, int depth);
+
+// Decodes a hunk into its raw sectors.
+static bool decode_hunk(ChdContext *chd, uint32_t hunk, unsigned char *sectorsOut, int depth);
+
+// Decodes a hunk that's compressed with a codec into the whole hunk, subcode and all.
+static bool decode_codec(const ChdContext *chd,
+                         uint32_t codec,
+                         const unsigned char *input,
+                         size_t inputSize,
+                         unsigned char *hunkOut,
+                         unsigned char *scratch);
+
+// Returns true if a codec can be decoded.
+static bool is_codec_supported(uint32_t codec);
+
+// Computes the CRC of a run of bytes, continuing from an earlier CRC.
+static uint16_t compute_crc16(uint16_t crc, const unsigned char *data, size_t size);
+
+// Fills in the CRC table. This only ever runs once.
+static void build_crc16_table(void);
+
+// Reads big endian integers.
+static uint64_t read_big_endian(const unsigned char *bytes, int size);
+
+XenoBackend *XenoBackend_OpenChd(XenoBackend *source)
+{
+    unsigned char header[CHD_HEADER_SIZE];
+    if (!source || !XenoBackend_Read(source, 0, header, CHD_HEADER_SIZE) ||
+        memcmp(header, CHD_MAGIC, CHD_MAGIC_SIZE) != 0 ||
+        read_big_endian(&header[CHD_HEADER_VERSION_OFFSET], 4) != CHD_VERSION ||
+        read_big_endian(&header[CHD_HEADER_LENGTH_OFFSET], 4) < CHD_HEADER_SIZE)
+    {
+        return NULL;
+    }
+
+    // Images that only store what changed from a parent can't be read on their own.
+    for (int i = 0; i < CHD_PARENT_SHA1_SIZE; i++)
+    {
+        if (header[CHD_HEADER_PARENT_OFFSET + i] != 0) { return NULL; }
+    }
+
+    const uint64_t logicalBytes = read_big_endian(&header[CHD_HEADER_LOGICAL_OFFSET], 8);
+    const uint64_t mapOffset    = read_big_endian(&header[CHD_HEADER_MAP_OFFSET], 8);
+    const uint64_t metaOffset   = read_big_endian(&header[CHD_HEADER_META_OFFSET], 8);
+    const uint32_t hunkBytes    = (uint32_t)read_big_endian(&header[CHD_HEADER_HUNK_OFFSET], 4);
+    const uint32_t unitBytes    = (uint32_t)read_big_endian(&header[CHD_HEADER_UNIT_OFFSET], 4);
+    const uint64_t hunkCount    = hunkBytes ? (logicalBytes + hunkBytes - 1) / hunkBytes : 0;
+    if (unitBytes != CHD_FRAME_SIZE || hunkBytes == 0 || hunkBytes % CHD_FRAME_SIZE != 0 || hunkCount == 0 ||
+        hunkCount > UINT32_MAX / CHD_MAP_ENTRY_SIZE)
+    {
+        return NULL;
+    }
+
+    ChdContext *chd = calloc(1, sizeof(ChdContext));
+    if (!chd) { return NULL; }
+
+    chd->source      = source;
+    chd->hunkBytes   = hunkBytes;
+    chd->hunkSectors = hunkBytes / CHD_FRAME_SIZE;
+    chd->hunkCount   = (uint32_t)hunkCount;
+    for (int i = 0; i < 4; i++)
+    {
+        chd->codecs[i] = (uint32_t)read_big_endian(&header[CHD_HEADER_CODECS_OFFSET + i * 4], 4);
+    }
+
+    uint64_t sectorCount = 0;
+    if (!read_track(chd, metaOffset, &sectorCount) || sectorCount * CHD_FRAME_SIZE > logicalBytes ||
+        !read_map(chd, mapOffset))
+    {
+        goto Label_error;
+    }
+
+    // Hunks in a codec that can't be decoded would only fail later in the middle of something, so they fail here.
+    for (uint32_t i = 0; i < chd->hunkCount; i++)
+    {
+        if (chd->hunks[i].type <= CHD_HUNK_CODEC_3 && !is_codec_supported(chd->codecs[chd->hunks[i].type]))
+        {
+            goto Label_error;
+        }
+    }
+
+    chd->size  = sectorCount * SECTOR_SIZE;
+    chd->cache = HunkCache_Create((size_t)chd->hunkSectors * SECTOR_SIZE, CHD_CACHE_HUNKS);
+    if (!chd->cache) { goto Label_error; }
+
+    static const XenoBackendInterface CHD_INTERFACE = {.read = chd_read, .map = NULL, .close = chd_close};
+
+    XenoBackend *backend = XenoBackend_Create(&CHD_INTERFACE, chd, chd->size);
+    if (!backend) { goto Label_error; }
+
+    return backend;
+
+Label_error:
+    // The source still belongs to the caller if this fails.
+    chd->source = NULL;
+    chd_close(chd);
+
+    return NULL;
+}
+
+static bool chd_read(void *context, uint64_t offset, void *buffer, size_t length)
+{
+    ChdContext *chd       = (ChdContext *)context;
+    const size_t hunkSize = (size_t)chd->hunkSectors * SECTOR_SIZE;
+    unsigned char *out    = (unsigned char *)buffer;
+
+    // Only hunks that miss need somewhere to be decoded to.
+    unsigned char *sectors = NULL;
+    bool success           = true;
+    while (length > 0)
+    {
+        const uint32_t hunk = (uint32_t)(offset / hunkSize);
+        const size_t inHunk = (size_t)(offset % hunkSize);
+        const size_t count  = length < hunkSize - inHunk ? length : hunkSize - inHunk;
+
+        if (!HunkCache_Read(chd->cache, hunk, inHunk, out, count))
+        {
+            if (!sectors) { sectors = malloc(hunkSize); }
+            if (!sectors || !decode_hunk(chd, hunk, sectors, 0))
+            {
+                success = false;
+                break;
+            }
+
+            HunkCache_Put(chd->cache, hunk, sectors);
+            memcpy(out, &sectors[inHunk], count);
+        }
+
+        out += count;
+        offset += count;
+        length -= count;
+    }
+
+    free(sectors);
+
+    return success;
+}
+
+static void chd_close(void *context)
+{
+    ChdContext *chd = (ChdContext *)context;
+
+    if (chd->source) { XenoBackend_Close(chd->source); }
+    HunkCache_Free(chd->cache);
+    free(chd->hunks);
+    free(chd);
+}
+
+static bool read_track(ChdContext *chd, uint64_t metaOffset, uint64_t *sectorCountOut)
+{
+    uint64_t offset = metaOffset;
+    for (int i = 0; i < CHD_MAX_META_ENTRIES && offset != 0; i++)
+    {
+        unsigned char header[CHD_META_HEADER_SIZE];
+        if (!XenoBackend_Read(chd->source, offset, header, CHD_META_HEADER_SIZE)) { return false; }
+
+        // The length shares its word with a byte of flags.
+        const uint32_t tag    = (uint32_t)read_big_endian(header, 4);
+        const uint32_t length = (uint32_t)read_big_endian(&header[4], 4) & 0xFFFFFF;
+        const uint64_t next   = read_big_endian(&header[8], 8);
+
+        if (tag == CHD_META_TRACK || tag == CHD_META_TRACK_1)
+        {
+            char text[256];
+            const size_t size = length < sizeof(text) - 1 ? length : sizeof(text) - 1;
+            if (!XenoBackend_Read(chd->source, offset + CHD_META_HEADER_SIZE, text, size)) { return false; }
+            text[size] = '\0';
+
+            // Only the first track is read. That's the data track, and it's the only one Xenogears has.
+            int track  = 0;
+            int frames = 0;
+            char type[32];
+            if (sscanf(text, "TRACK:%d TYPE:%31s SUBTYPE:%*s FRAMES:%d", &track, type, &frames) == 3 && track == 1)
+            {
+                if (frames <= 0 || (strcmp(type, "MODE1_RAW") != 0 && strcmp(type, "MODE2_RAW") != 0)) { return false; }
+
+                *sectorCountOut = (uint64_t)frames;
+                return true;
+            }
+        }
+
+        offset = next;
+    }
+
+    return false;
+}
+
+static bool read_map(ChdContext *chd, uint64_t mapOffset)
+{
+    chd->hunks = calloc(chd->hunkCount, sizeof(ChdHunk));
+    if (!chd->hunks) { return false; }
+
+    if (chd->codecs[0] == 0) { return read_flat_map(chd, mapOffset); }
+
+    unsigned char header[CHD_MAP_HEADER_SIZE];
+    if (!XenoBackend_Read(chd->source, mapOffset, header, CHD_MAP_HEADER_SIZE)) { return false; }
+
+    const uint32_t mapBytes   = (uint32_t)read_big_endian(header, 4);
+    const uint64_t firstEntry = read_big_endian(&header[4], 6);
+    const uint16_t mapCrc     = (uint16_t)read_big_endian(&header[10], 2);
+    const int lengthBits      = header[12];
+    const int selfBits        = header[13];
+    const int parentBits      = header[14];
+    if (lengthBits > 32 || selfBits > 32 || parentBits > 32) { return false; }
+
+    unsigned char *compressed = malloc(mapBytes ? mapBytes : 1);
+    if (!compressed || !XenoBackend_Read(chd->source, mapOffset + CHD_MAP_HEADER_SIZE, compressed, mapBytes))
+    {
+        free(compressed);
+        return false;
+    }
+
+    MapBits bits = {.data = compressed, .size = mapBytes, .position = 0};
+    MapHuffman huffman;
+    bool success = import_map_huffman(&huffman, &bits);
+
+    // The types come first. Runs of the same type are stored as a count.
+    int lastType    = CHD_HUNK_CODEC_0;
+    uint32_t repeat = 0;
+    for (uint32_t i = 0; success && i < chd->hunkCount; i++)
+    {
+        if (repeat > 0)
+        {
+            chd->hunks[i].type = (uint8_t)lastType;
+            --repeat;
+            continue;
+        }
+
+        const int symbol = decode_map_symbol(&huffman, &bits);
+        int extra        = 0;
+        if (symbol == CHD_HUNK_RLE_SMALL) { extra = decode_map_symbol(&huffman, &bits); }
+        else if (symbol == CHD_HUNK_RLE_LARGE)
+        {
+            const int high = decode_map_symbol(&huffman, &bits);
+            const int low  = decode_map_symbol(&huffman, &bits);
+            extra          = high < 0 || low < 0 ? -1 : 16 + (high << 4) + low;
+        }
+        else { lastType = symbol; }
+
+        if (symbol < 0 || extra < 0)
+        {
+            success = false;
+            break;
+        }
+
+        // A run is this hunk and at least two more.
+        if (symbol == CHD_HUNK_RLE_SMALL || symbol == CHD_HUNK_RLE_LARGE) { repeat = 2 + (uint32_t)extra; }
+
+        chd->hunks[i].type = (uint8_t)lastType;
+    }
+
+    // Then everything else. Compressed and stored hunks come one after another in the file from the first offset.
+    // The map's CRC is over every entry in the order and layout chdman keeps it in.
+    uint64_t offset     = firstEntry;
+    uint64_t lastSelf   = 0;
+    uint64_t lastParent = 0;
+    uint16_t crc        = 0xFFFF;
+    for (uint32_t i = 0; success && i < chd->hunkCount; i++)
+    {
+        ChdHunk *hunk = &chd->hunks[i];
+        switch (hunk->type)
+        {
+            case CHD_HUNK_CODEC_0:
+            case CHD_HUNK_CODEC_1:
+            case CHD_HUNK_CODEC_2:
+            case CHD_HUNK_CODEC_3:
+            {
+                hunk->length = read_map_bits(&bits, lengthBits);
+                hunk->offset = offset;
+                hunk->crc    = (uint16_t)read_map_bits(&bits, 16);
+                offset += hunk->length;
+            }
+            break;
+
+            case CHD_HUNK_NONE:
+            {
+                hunk->length = chd->hunkBytes;
+                hunk->offset = offset;
+                hunk->crc    = (uint16_t)read_map_bits(&bits, 16);
+                offset += hunk->length;
+            }
+            break;
+
+            case CHD_HUNK_SELF:
+            {
+                lastSelf     = read_map_bits(&bits, selfBits);
+                hunk->offset = lastSelf;
+            }
+            break;
+
+            case CHD_HUNK_SELF_0:
+            case CHD_HUNK_SELF_1:
+            {
+                // Shorthand for the same hunk as the last reference or the one after it.
+                lastSelf += hunk->type == CHD_HUNK_SELF_1 ? 1 : 0;
+                hunk->type   = CHD_HUNK_SELF;
+                hunk->offset = lastSelf;
+            }
+            break;
+
+            case CHD_HUNK_PARENT:
+            {
+                lastParent   = read_map_bits(&bits, parentBits);
+                hunk->offset = lastParent;
+            }
+            break;
+
+            case CHD_HUNK_PARENT_SELF:
+            case CHD_HUNK_PARENT_0:
+            case CHD_HUNK_PARENT_1:
+            {
+                // The parent's copy of this same hunk, the same as the last reference, or the one after it. These are
+                // kept track of so the CRC comes out right, but they can't be read.
+                if (hunk->type == CHD_HUNK_PARENT_SELF) { lastParent = (uint64_t)i * chd->hunkSectors; }
+                else if (hunk->type == CHD_HUNK_PARENT_1) { lastParent += chd->hunkSectors; }
+
+                hunk->type   = CHD_HUNK_PARENT;
+                hunk->offset = lastParent;
+            }
+            break;
+
+            default:
+            {
+                success = false;
+            }
+            break;
+        }
+
+        const unsigned char entry[CHD_MAP_ENTRY_SIZE] = {hunk->type,
+                                                         (unsigned char)(hunk->length >> 16),
+                                                         (unsigned char)(hunk->length >> 8),
+                                                         (unsigned char)hunk->length,
+                                                         (unsigned char)(hunk->offset >> 40),
+                                                         (unsigned char)(hunk->offset >> 32),
+                                                         (unsigned char)(hunk->offset >> 24),
+                                                         (unsigned char)(hunk->offset >> 16),
+                                                         (unsigned char)(hunk->offset >> 8),
+                                                         (unsigned char)hunk->offset,
+                                                         (unsigned char)(hunk->crc >> 8),
+                                                         (unsigned char)hunk->crc};
+        crc = compute_crc16(crc, entry, CHD_MAP_ENTRY_SIZE);
+
+        // Hunks can only ever point back at hunks that came before them.
+        if (hunk->type == CHD_HUNK_SELF && hunk->offset >= i) { success = false; }
+    }
+
+    free(compressed);
+
+    return success && bits.position <= (size_t)mapBytes * 8 && crc == mapCrc;
+}
+
+static bool read_flat_map(ChdContext *chd, uint64_t mapOffset)
+{
+    const size_t size  = (size_t)chd->hunkCount * 4;
+    unsigned char *map = malloc(size);
+    if (!map || !XenoBackend_Read(chd->source, mapOffset, map, size))
+    {
+        free(map);
+        return false;
+    }
+
+    // Each entry is where the hunk is in units of hunks. Hunks that were never written are left at 0.
+    for (uint32_t i = 0; i < chd->hunkCount; i++)
+    {
+        const uint64_t index = read_big_endian(&map[(size_t)i * 4], 4);
+        chd->hunks[i].type   = index ? CHD_HUNK_UNCHECKED : CHD_HUNK_ZERO;
+        chd->hunks[i].offset = index * chd->hunkBytes;
+        chd->hunks[i].length = chd->hunkBytes;
+    }
+
+    free(map);
+
+    return true;
+}
+
+static bool import_map_huffman(MapHuffman *huffman, MapBits *bits)
+{
+    // The length of each code is four bits. 1 is an escape: 1 then 1 is a length of 1, and 1 then anything else is
+    // that length repeated as many times as the next four bits plus three.
+    uint8_t lengths[CHD_MAP_CODE_COUNT];
+    int code = 0;
+    while (code < CHD_MAP_CODE_COUNT)
+    {
+        const uint8_t length = (uint8_t)read_map_bits(bits, 4);
+        if (length != 1)
+        {
+            lengths[code++] = length;
+            continue;
+        }
+
+        const uint8_t escaped = (uint8_t)read_map_bits(bits, 4);
+        if (escaped == 1)
+        {
+            lengths[code++] = 1;
+            continue;
+        }
+
+        const int repeat = (int)read_map_bits(bits, 4) + 3;
+        if (code + repeat > CHD_MAP_CODE_COUNT) { return false; }
+
+        for (int i = 0; i < repeat; i++) { lengths[code++] = escaped; }
+    }
+
+    // Codes are handed out from the longest length to the shortest, each length picking up where the last left off.
+    uint32_t starts[CHD_MAP_CODE_BITS + 1] = {0};
+    for (int i = 0; i < CHD_MAP_CODE_COUNT; i++)
+    {
+        if (lengths[i] > CHD_MAP_CODE_BITS) { return false; }
+
+        starts[lengths[i]]++;
+    }
+
+    uint32_t start = 0;
+    for (int length = CHD_MAP_CODE_BITS; length > 0; length--)
+    {
+        const uint32_t total = start + starts[length];
+        if (length != 1 && (total & 1)) { return false; }
+
+        starts[length] = start;
+        start          = total >> 1;
+    }
+
+    memset(huffman->lookup, 0, sizeof(huffman->lookup));
+    for (int i = 0; i < CHD_MAP_CODE_COUNT; i++)
+    {
+        if (lengths[i] == 0) { continue; }
+
+        const int shift     = CHD_MAP_CODE_BITS - lengths[i];
+        const uint32_t base = starts[lengths[i]]++ << shift;
+        for (uint32_t j = 0; j < (1u << shift); j++) { huffman->lookup[base | j] = (uint16_t)(i << 4 | lengths[i]); }
+    }
+
+    return bits->position <= bits->size * 8;
+}
+
+static uint32_t peek_map_bits(const MapBits *bits, int count)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const size_t bit    = bits->position + (size_t)i;
+        const uint32_t byte = bit / 8 < bits->size ? bits->data[bit / 8] : 0;
+        value               = value << 1 | ((byte >> (7 - bit % 8)) & 1);
+    }
+
+    return value;
+}
+
+static uint32_t read_map_bits(MapBits *bits, int count)
+{
+    const uint32_t value = peek_map_bits(bits, count);
+    bits->position += (size_t)count;
+
+    return value;
+}
+
+static int decode_map_symbol(const MapHuffman *huffman, MapBits *bits)
+{
+    const uint16_t entry = huffman->lookup[peek_map_bits(bits, CHD_MAP_CODE_BITS)];
+    if (entry == 0) { return -1; }
+
+    bits->position += entry & 15;
+
+    return entry >> 4;
+}
+
+static bool get_hunk(ChdContext *chd, uint32_t hunk, unsigned char *sectorsOut, int depth)
+{
+    const size_t hunkSize = (size_t)chd->hunkSectors * SECTOR_SIZE;
+    if (HunkCache_Read(chd->cache, hunk, 0, sectorsOut, hunkSize)) { return true; }
+    if (!decode_hunk(chd, hunk, sectorsOut, depth)) { return false; }
+
+    HunkCache_Put(chd->cache, hunk, sectorsOut);
+
+    return true;
+}
+
+static bool decode_hunk(ChdContext *chd, uint32_t hunk, unsigned char *sectorsOut, int depth)
+{
+    const ChdHunk *entry = &chd->hunks[hunk];
+    if (entry->type == CHD_HUNK_ZERO)
+    {
+        memset(sectorsOut, 0, (size_t)chd->hunkSectors * SECTOR_SIZE);
+        return true;
+    }
+
+    // The map already made sure these only point backwards. The depth is just in case.
+    if (entry->type == CHD_HUNK_SELF)
+    {
+        return depth < CHD_MAX_SELF_DEPTH && get_hunk(chd, (uint32_t)entry->offset, sectorsOut, depth + 1);
+    }
+
+    if (entry->type == CHD_HUNK_PARENT) { return false; }
+
+    unsigned char *input   = malloc(entry->length ? entry->length : 1);
+    unsigned char *raw     = malloc(chd->hunkBytes);
+    unsigned char *scratch = malloc(chd->hunkBytes);
+
+    bool success = input && raw && scratch && XenoBackend_Read(chd->source, entry->offset, input, entry->length);
+
+    if (success && entry->type <= CHD_HUNK_CODEC_3)
+    {
+        success = decode_codec(chd, chd->codecs[entry->type], input, entry->length, raw, scratch) &&
+                  compute_crc16(0xFFFF, raw, chd->hunkBytes) == entry->crc;
+    }
+    else if (success)
+    {
+        memcpy(raw, input, chd->hunkBytes);
+        success = entry->type == CHD_HUNK_UNCHECKED || compute_crc16(0xFFFF, raw, chd->hunkBytes) == entry->crc;
+    }
+
+    // Only the sectors are kept. Nothing here has any use for subcode.
+    for (uint32_t i = 0; success && i < chd->hunkSectors; i++)
+    {
+        memcpy(&sectorsOut[(size_t)i * SECTOR_SIZE], &raw[(size_t)i * CHD_FRAME_SIZE], SECTOR_SIZE);
+    }
+
+    free(scratch);
+    free(raw);
+    free(input);
+
+    return success;
+}
+
+static bool decode_codec(const ChdContext *chd,
+                         uint32_t codec,
+                         const unsigned char *input,
+                         size_t inputSize,
+                         unsigned char *hunkOut,
+                         unsigned char *scratch)
+{
+    if (codec == CHD_CODEC_ZLIB) { return Inflate_Decode(input, inputSize, hunkOut, chd->hunkBytes); }
+    if (codec == CHD_CODEC_LZMA)
+    {
+        return Lzma_Decode(input, inputSize, hunkOut, chd->hunkBytes, CHD_LZMA_LC, CHD_LZMA_LP, CHD_LZMA_PB);
+    }
+
+    // The CD codecs begin with a bit for each sector that had its sync and ECC taken out, then the size of the
+    // compressed sectors. The sectors and the subcode are compressed separately, and the subcode is always deflate.
+    const size_t sectorCount = chd->hunkSectors;
+    const size_t eccBytes    = (sectorCount + 7) / 8;
+    const size_t sizeBytes   = chd->hunkBytes < 65536 ? 2 : 3;
+    const size_t headerBytes = eccBytes + sizeBytes;
+    if (inputSize < headerBytes) { return false; }
+
+    const size_t baseSize = (size_t)read_big_endian(&input[eccBytes], (int)sizeBytes);
+    if (baseSize > inputSize - headerBytes) { return false; }
+
+    unsigned char *sectors    = scratch;
+    unsigned char *subcode    = &scratch[sectorCount * SECTOR_SIZE];
+    const unsigned char *base = &input[headerBytes];
+    const bool decoded        = codec == CHD_CODEC_CD_ZLIB
+                                    ? Inflate_Decode(base, baseSize, sectors, sectorCount * SECTOR_SIZE)
+                                    : Lzma_Decode(base,
+                                                  baseSize,
+                                                  sectors,
+                                                  sectorCount * SECTOR_SIZE,
+                                                  CHD_LZMA_LC,
+                                                  CHD_LZMA_LP,
+                                                  CHD_LZMA_PB);
+    if (!decoded || !Inflate_Decode(&base[baseSize],
+                                    inputSize - headerBytes - baseSize,
+                                    subcode,
+                                    sectorCount * CHD_SUBCODE_SIZE))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < sectorCount; i++)
+    {
+        unsigned char *frame = &hunkOut[i * CHD_FRAME_SIZE];
+        memcpy(frame, &sectors[i * SECTOR_SIZE], SECTOR_SIZE);
+        memcpy(&frame[SECTOR_SIZE], &subcode[i * CHD_SUBCODE_SIZE], CHD_SUBCODE_SIZE);
+
+        // chdman only takes the ECC out of sectors it can regenerate exactly, which in practice means Mode 1. If a Mode
+        // 2 sector ever came through here differently, the CRC would catch it.
+        if (input[i / 8] & (1 << (i % 8)))
+        {
+            memcpy(frame, SYNC_PATTERN, sizeof(SYNC_PATTERN));
+            SectorEcc_ComputeP(frame, &frame[SECTOR_ECC_P_OFFSET]);
+            SectorEcc_ComputeQ(frame, &frame[SECTOR_ECC_Q_OFFSET]);
+        }
+    }
+
+    return true;
+}
+
+static bool is_codec_supported(uint32_t codec)
+{
+    return codec == CHD_CODEC_ZLIB || codec == CHD_CODEC_LZMA || codec == CHD_CODEC_CD_ZLIB ||
+           codec == CHD_CODEC_CD_LZMA;
+}
+
+static uint16_t compute_crc16(uint16_t crc, const unsigned char *data, size_t size)
+{
+    call_once(&crc16Once, build_crc16_table);
+
+    for (size_t i = 0; i < size; i++) { crc = (uint16_t)(crc << 8) ^ crc16Table[(crc >> 8) ^ data[i]]; }
+
+    return crc;
+}
+
+static void build_crc16_table(void)
+{
+    // CRC-16-CCITT, top bit first.
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint16_t crc = (uint16_t)(i << 8);
+        for (int bit = 0; bit < 8; bit++) { crc = (uint16_t)(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1); }
+        crc16Table[i] = crc;
+    }
+}
+
+static uint64_t read_big_endian(const unsigned char *bytes, int size)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) { value = value << 8 | bytes[i]; }
+
+    return value;
+}
@@ -2,61 +2,234 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define __XENO_INTERNAL__
 #include "XenoDirInternal.h"
+#include "XenoReaderInternal.h"
+
+// Defined at bottom.
+static FsEntry *read_entries(const unsigned char *tableData, size_t size, int *entryCountOut);
+static XenoFsTable *build_table(const FsEntry *entries, int entryCount, uint32_t *tableIndicesOut);
+static void count_directory(const FsEntry *entries, int begin, int end, uint32_t *dirCount, uint32_t *fileCount);
+static void fill_directory(XenoFsTable *table,
+                           XenoDir *dir,
+                           const FsEntry *entries,
+                           int begin,
+                           int end,
+                           uint32_t *nextDir,
+                           uint32_t *nextFile,
+                           uint32_t *tableIndicesOut);
+static int get_directory_end(const FsEntry *entry, int index, int end);
+
+/// @brief Gets the table back from any directory in it.
+static inline const XenoFsTable *get_table(const XenoDir *dir)
+{
+    const XenoDir *dirs = dir - dir->index;
+    return (const XenoFsTable *)((const unsigned char *)dirs - offsetof(XenoFsTable, dirs));
+}
+
+uint32_t XenoDir_GetSubDirCount(const XenoDir *dir) { return dir->subDirCount; }
+
+uint32_t XenoDir_GetFileCount(const XenoDir *dir) { return dir->fileCount; }
+
+XenoDir *XenoDir_GetDirAt(const XenoDir *dir, int index)
+{
+    if (index < 0 || index >= (int)dir->subDirCount) { return NULL; }
+
+    return (XenoDir *)&get_table(dir)->dirs[dir->firstSubDir + index];
+}
+
+XenoFile *XenoDir_GetFileAt(const XenoDir *dir, int index)
+{
+    if (index < 0 || index >= (int)dir->fileCount) { return NULL; }
+
+    return &XenoFsTable_GetFiles(get_table(dir))[dir->firstFile + index];
+}
+
+XenoFsTable *XenoFsTable_Build(const FsEntry *entries, int entryCount)
+{
+    return build_table(entries, entryCount, NULL);
+}
+
+XenoFsTable *XenoFsTable_Parse(const unsigned char *tableData, size_t size)
+{
+    int entryCount   = 0;
+    FsEntry *entries = read_entries(tableData, size, &entryCount);
+    if (!entries) { return NULL; }
+
+    XenoFsTable *table = build_table(entries, entryCount, NULL);
+    free(entries);
+
+    return table;
+}
 
-XenoDir *XenoDir_Create()
+bool XenoFsTable_GetTableIndices(const unsigned char *tableData, size_t size, uint32_t fileCount,
+                                 uint32_t *tableIndicesOut)
 {
-    XenoDir *dir = malloc(sizeof(XenoDir));
-    if (!dir) { return NULL; }
+    int entryCount   = 0;
+    FsEntry *entries = read_entries(tableData, size, &entryCount);
+    if (!entries) { return false; }
 
-    // Both of these need to be allocated too.
-    dir->subDirs = DynamicArray_Create(sizeof(XenoDir), 32);
-    dir->files   = DynamicArray_Create(sizeof(XenoFile), 32);
-    if (!dir->subDirs || !dir->files) { goto Label_cleanup; }
+    // The table is laid out again just to see where each file lands. It's small enough that this doesn't matter.
+    uint32_t dirCount       = 1;
+    uint32_t tableFileCount = 0;
+    count_directory(entries, 0, entryCount, &dirCount, &tableFileCount);
 
-    // Good to go?
-    return dir;
+    XenoFsTable *table = tableFileCount == fileCount ? build_table(entries, entryCount, tableIndicesOut) : NULL;
+    const bool success = table != NULL;
+    free(table);
+    free(entries);
 
-Label_cleanup:
-    if (dir->subDirs) { DynamicArray_Free(dir->subDirs); }
-    if (dir->files) { DynamicArray_Free(dir->files); }
-    if (dir) { XenoDir_Free(dir, true); }
+    return success;
+}
 
-    return NULL;
+size_t XenoFsTable_GetSize(const XenoFsTable *table)
+{
+    return sizeof(XenoFsTable) + sizeof(XenoDir) * table->dirCount + sizeof(XenoFile) * table->fileCount;
 }
 
-void XenoDir_Free(XenoDir *dir, bool isRoot)
+XenoDir *XenoFsTable_GetRoot(const XenoFsTable *table) { return (XenoDir *)&table->dirs[0]; }
+
+XenoFile *XenoFsTable_GetFiles(const XenoFsTable *table) { return (XenoFile *)&table->dirs[table->dirCount]; }
+
+static FsEntry *read_entries(const unsigned char *tableData, size_t size, int *entryCountOut)
 {
-    if (!dir) { return; }
+    // There can't be more entries than this, so there's no need to grow anything.
+    FsEntry *entries = malloc(sizeof(FsEntry) * (size / TABLE_ENTRY_SIZE + 1));
+    int entryCount   = 0;
+    if (!entries) { return NULL; }
 
-    const int dirCount = DynamicArray_GetLength(dir->subDirs);
-    for (int i = 0; i < dirCount; i++)
+    for (size_t i = 0; i + TABLE_ENTRY_SIZE <= size; i += TABLE_ENTRY_SIZE)
     {
-        XenoDir *subDir = (XenoDir *)DynamicArray_GetElementAt(dir->subDirs, i);
-        if (subDir) { XenoDir_Free(subDir, false); }
+        // What we're reading to.
+        uint32_t sector   = 0; // This is actually stored as a 24bit value.
+        int32_t entrySize = 0;
+
+        // Copy them.
+        memcpy(&sector, &tableData[i], 3);
+        memcpy(&entrySize, &tableData[i + 3], 4);
+        // If it has no sector, skip it. There are files that have 0 as a size. Not sure what purpose that serves yet.
+        if (sector == 0) { continue; }
+
+        entries[entryCount].sector     = sector;
+        entries[entryCount].size       = entrySize;
+        entries[entryCount].tableIndex = (uint32_t)(i / TABLE_ENTRY_SIZE);
+        ++entryCount;
     }
 
-    if (dir->subDirs) { DynamicArray_Free(dir->subDirs); }
-    if (dir->files) { DynamicArray_Free(dir->files); }
-    if (isRoot && dir) { free(dir); } // This feels like a bandaid, but it is what it is.
+    *entryCountOut = entryCount;
+
+    return entries;
 }
 
-uint32_t XenoDir_GetSubDirCount(const XenoDir *dir) { return DynamicArray_GetLength(dir->subDirs); }
+static XenoFsTable *build_table(const FsEntry *entries, int entryCount, uint32_t *tableIndicesOut)
+{
+    // Count first so everything fits in one allocation. The root counts as a directory.
+    uint32_t dirCount  = 1;
+    uint32_t fileCount = 0;
+    count_directory(entries, 0, entryCount, &dirCount, &fileCount);
 
-uint32_t XenoDir_GetFileCount(const XenoDir *dir) { return DynamicArray_GetLength(dir->files); }
+    const size_t tableSize = sizeof(XenoFsTable) + sizeof(XenoDir) * dirCount + sizeof(XenoFile) * fileCount;
+    XenoFsTable *table     = malloc(tableSize);
+    if (!table) { return NULL; }
 
-XenoDir *XenoDir_GetDirAt(const XenoDir *dir, int index)
+    table->dirCount  = dirCount;
+    table->fileCount = fileCount;
+
+    // The root is always the first directory.
+    uint32_t nextDir  = 1;
+    uint32_t nextFile = 0;
+    table->dirs[0]    = (XenoDir){.index = 0};
+    fill_directory(table, &table->dirs[0], entries, 0, entryCount, &nextDir, &nextFile, tableIndicesOut);
+
+    return table;
+}
+
+static int get_directory_end(const FsEntry *entry, int index, int end)
 {
-    if (index < 0 || index >= (int)DynamicArray_GetLength(dir->subDirs)) { return NULL; }
+    // Negative size is the number of entries in the directory. Clamp it so a bad table can't run off the end.
+    const int64_t entryCount   = -(int64_t)entry->size;
+    const int64_t directoryEnd = index + 1 + entryCount;
 
-    return (XenoDir *)DynamicArray_GetElementAt(dir->subDirs, index);
+    return directoryEnd > end ? end : (int)directoryEnd;
 }
 
-XenoFile *XenoDir_GetFileAt(const XenoDir *dir, int index)
+static void count_directory(const FsEntry *entries, int begin, int end, uint32_t *dirCount, uint32_t *fileCount)
 {
-    if (index < 0 || index >= (int)DynamicArray_GetLength(dir->files)) { return NULL; }
+    for (int i = begin; i < end;)
+    {
+        if (entries[i].size < 0)
+        {
+            const int directoryEnd = get_directory_end(&entries[i], i, end);
+            ++*dirCount;
+            count_directory(entries, i + 1, directoryEnd, dirCount, fileCount);
+            i = directoryEnd;
+        }
+        else
+        {
+            ++*fileCount;
+            ++i;
+        }
+    }
+}
 
-    return (XenoFile *)DynamicArray_GetElementAt(dir->files, index);
-}
\ No newline at end of file
+static void fill_directory(XenoFsTable *table,
+                           XenoDir *dir,
+                           const FsEntry *entries,
+                           int begin,
+                           int end,
+                           uint32_t *nextDir,
+                           uint32_t *nextFile,
+                           uint32_t *tableIndicesOut)
+{
+    // Count the direct children first so they can be given slots next to each other.
+    uint32_t subDirCount = 0;
+    uint32_t fileCount   = 0;
+    for (int i = begin; i < end;)
+    {
+        if (entries[i].size < 0)
+        {
+            ++subDirCount;
+            i = get_directory_end(&entries[i], i, end);
+        }
+        else
+        {
+            ++fileCount;
+            ++i;
+        }
+    }
+
+    dir->firstSubDir = *nextDir;
+    dir->subDirCount = subDirCount;
+    dir->firstFile   = *nextFile;
+    dir->fileCount   = fileCount;
+    *nextDir += subDirCount;
+    *nextFile += fileCount;
+
+    // Now fill the slots. Subdirectories recurse after every slot at this level is taken.
+    XenoFile *files      = XenoFsTable_GetFiles(table);
+    uint32_t subDirIndex = dir->firstSubDir;
+    uint32_t fileIndex   = dir->firstFile;
+    for (int i = begin; i < end;)
+    {
+        if (entries[i].size < 0)
+        {
+            const int directoryEnd = get_directory_end(&entries[i], i, end);
+
+            XenoDir *subDir = &table->dirs[subDirIndex];
+            subDir->index   = subDirIndex++;
+            fill_directory(table, subDir, entries, i + 1, directoryEnd, nextDir, nextFile, tableIndicesOut);
+
+            i = directoryEnd;
+        }
+        else
+        {
+            files[fileIndex].sector = entries[i].sector;
+            files[fileIndex].size   = entries[i].size;
+            if (tableIndicesOut) { tableIndicesOut[fileIndex] = entries[i].tableIndex; }
+            ++fileIndex;
+            ++i;
+        }
+    }
+}
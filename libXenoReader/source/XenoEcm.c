@@ -0,0 +1,460 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoBackend.h"
+
+#include "HunkCache.h"
+#include "Sector.h"
+#include "SectorEcc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Every ECM file begins with these four bytes.
+#define ECM_MAGIC      "ECM"
+#define ECM_MAGIC_SIZE 4
+
+/// @brief The image is decoded in blocks of this many raw sectors. A block is the least that's ever decoded, and it's
+/// what the cache holds.
+#define ECM_BLOCK_SECTORS 16
+#define ECM_BLOCK_SIZE    (ECM_BLOCK_SECTORS * SECTOR_SIZE)
+
+/// @brief Number of decoded blocks kept around. This is a bit over a megabyte.
+#define ECM_CACHE_BLOCKS 32
+
+/// @brief Number of bytes read at a time while the index is built.
+#define ECM_SCAN_SIZE (1024 * 1024)
+
+/// @brief Most bytes a record header can take.
+#define ECM_MAX_HEADER_SIZE 5
+
+/// @brief Most bytes one item can take in the file.
+#define ECM_MAX_ITEM_SIZE 2328
+
+/// @brief Records can't have more items than this.
+#define ECM_MAX_ITEM_COUNT 0x80000000u
+
+// clang-format off
+/// @brief Kinds of record. Everything but literals is a sector with the parts that can be worked out left out.
+typedef enum
+{
+    /// @brief Bytes that are copied as they are.
+    ECM_LITERAL,
+
+    /// @brief A whole Mode 1 sector. Only the address and data are stored.
+    ECM_MODE_1,
+
+    /// @brief A Mode 2 Form 1 sector without its sync and header. Only the subheader and data are stored.
+    ECM_FORM_1,
+
+    /// @brief A Mode 2 Form 2 sector without its sync and header. Everything but the EDC is stored.
+    ECM_FORM_2
+} EcmType;
+
+/// @brief Where decoding has to begin for a block.
+typedef struct
+{
+    /// @brief Offset in the file of the item the block begins in. This is past the record header.
+    uint64_t input;
+
+    /// @brief Offset in the image the item begins at. This is at or before the beginning of the block.
+    uint64_t output;
+
+    /// @brief Number of items left in the record, counting this one.
+    uint32_t remaining;
+
+    /// @brief Type of the record.
+    uint8_t type;
+} EcmCheckpoint;
+
+/// @brief Everything an ECM backend needs.
+typedef struct
+{
+    /// @brief Backend holding the ECM file and its size.
+    XenoBackend *source;
+    uint64_t sourceSize;
+
+    /// @brief Where each block begins.
+    EcmCheckpoint *checkpoints;
+    size_t blockCount;
+
+    /// @brief Size of the decoded image.
+    uint64_t size;
+
+    /// @brief Recently decoded blocks.
+    HunkCache *cache;
+} EcmContext;
+
+/// @brief Reads the file a piece at a time while the index is built.
+typedef struct
+{
+    /// @brief Backend holding the ECM file and its size.
+    XenoBackend *source;
+    uint64_t sourceSize;
+
+    /// @brief Piece of the file that's loaded.
+    unsigned char *buffer;
+    uint64_t bufferOffset;
+    size_t bufferSize;
+} EcmScanner;
+// clang-format on
+
+// Number of bytes each type of item takes in the file and in the image.
+static const uint32_t INPUT_SIZES[4]  = {1, 2051, 2052, 2328};
+static const uint32_t OUTPUT_SIZES[4] = {1, SECTOR_SIZE, SECTOR_SIZE - 16, SECTOR_SIZE - 16};
+
+// Backend functions.
+static bool ecm_read(void *context, uint64_t offset, void *buffer, size_t length);
+static void ecm_close(void *context);
+
+// Walks every record header in the file and notes where each block begins.
+static bool build_index(EcmContext *ecm);
+
+// Gets a byte of the file while the index is built.
+static bool scan_byte(EcmScanner *scanner, uint64_t offset, unsigned char *byteOut);
+
+// Parses a record header. Returns 1 at the end marker, 0 for a record and -1 if the header is corrupt or cut off.
+static int parse_header(const unsigned char *bytes,
+                        size_t available,
+                        EcmType *typeOut,
+                        uint32_t *countOut,
+                        size_t *sizeOut);
+
+// Decodes one block.
+static bool decode_block(EcmContext *ecm, size_t block, unsigned char *blockOut);
+
+// Rebuilds a sector from an item. Returns where the part of the sector that's in the image begins.
+static const unsigned char *rebuild_sector(EcmType type, const unsigned char *item, unsigned char *sector);
+
+// Computes the EDC of part of a sector and stores it right after.
+static void store_edc(unsigned char *sector, size_t offset, size_t size);
+
+XenoBackend *XenoBackend_OpenEcm(XenoBackend *source)
+{
+    unsigned char magic[ECM_MAGIC_SIZE];
+    if (!source || !XenoBackend_Read(source, 0, magic, ECM_MAGIC_SIZE) || memcmp(magic, ECM_MAGIC, ECM_MAGIC_SIZE) != 0)
+    {
+        return NULL;
+    }
+
+    EcmContext *ecm = calloc(1, sizeof(EcmContext));
+    if (!ecm) { return NULL; }
+
+    ecm->source     = source;
+    ecm->sourceSize = XenoBackend_GetSize(source);
+    ecm->cache      = HunkCache_Create(ECM_BLOCK_SIZE, ECM_CACHE_BLOCKS);
+    if (!ecm->cache || !build_index(ecm)) { goto Label_error; }
+
+    static const XenoBackendInterface ECM_INTERFACE = {.read = ecm_read, .map = NULL, .close = ecm_close};
+
+    XenoBackend *backend = XenoBackend_Create(&ECM_INTERFACE, ecm, ecm->size);
+    if (!backend) { goto Label_error; }
+
+    return backend;
+
+Label_error:
+    // The source still belongs to the caller if this fails.
+    ecm->source = NULL;
+    ecm_close(ecm);
+
+    return NULL;
+}
+
+static bool ecm_read(void *context, uint64_t offset, void *buffer, size_t length)
+{
+    EcmContext *ecm    = (EcmContext *)context;
+    unsigned char *out = (unsigned char *)buffer;
+
+    // Only blocks that miss need somewhere to be decoded to.
+    unsigned char *block = NULL;
+    bool success         = true;
+    while (length > 0)
+    {
+        const size_t index   = (size_t)(offset / ECM_BLOCK_SIZE);
+        const size_t inBlock = (size_t)(offset % ECM_BLOCK_SIZE);
+        const size_t count   = length < ECM_BLOCK_SIZE - inBlock ? length : ECM_BLOCK_SIZE - inBlock;
+
+        if (!HunkCache_Read(ecm->cache, index, inBlock, out, count))
+        {
+            // The last block is usually short. Zeroing it up front keeps the cache from holding garbage past the end.
+            if (!block) { block = calloc(1, ECM_BLOCK_SIZE); }
+            if (!block || !decode_block(ecm, index, block))
+            {
+                success = false;
+                break;
+            }
+
+            HunkCache_Put(ecm->cache, index, block);
+            memcpy(out, &block[inBlock], count);
+        }
+
+        out += count;
+        offset += count;
+        length -= count;
+    }
+
+    free(block);
+
+    return success;
+}
+
+static void ecm_close(void *context)
+{
+    EcmContext *ecm = (EcmContext *)context;
+
+    if (ecm->source) { XenoBackend_Close(ecm->source); }
+    HunkCache_Free(ecm->cache);
+    free(ecm->checkpoints);
+    free(ecm);
+}
+
+static bool build_index(EcmContext *ecm)
+{
+    EcmScanner scanner = {.source       = ecm->source,
+                          .sourceSize   = ecm->sourceSize,
+                          .buffer       = malloc(ECM_SCAN_SIZE),
+                          .bufferOffset = 0,
+                          .bufferSize   = 0};
+    if (!scanner.buffer) { return false; }
+
+    size_t capacity = 0;
+    uint64_t input  = ECM_MAGIC_SIZE;
+    uint64_t output = 0;
+    bool success    = false;
+    while (true)
+    {
+        unsigned char header[ECM_MAX_HEADER_SIZE];
+        size_t available = 0;
+        while (available < ECM_MAX_HEADER_SIZE && scan_byte(&scanner, input + available, &header[available]))
+        {
+            ++available;
+        }
+
+        EcmType type      = ECM_LITERAL;
+        uint32_t count    = 0;
+        size_t headerSize = 0;
+        const int parsed  = parse_header(header, available, &type, &count, &headerSize);
+        input += headerSize;
+        if (parsed < 0) { goto Label_cleanup; }
+        if (parsed > 0) { break; }
+
+        // Every block that begins inside the record gets a checkpoint at the item it begins in. Literal items are a
+        // single byte, so those checkpoints are right on the block.
+        const uint64_t recordSize = (uint64_t)count * OUTPUT_SIZES[type];
+        while ((uint64_t)ecm->blockCount * ECM_BLOCK_SIZE < output + recordSize)
+        {
+            if (ecm->blockCount == capacity)
+            {
+                capacity               = capacity ? capacity * 2 : 1024;
+                EcmCheckpoint *resized = realloc(ecm->checkpoints, sizeof(EcmCheckpoint) * capacity);
+                if (!resized) { goto Label_cleanup; }
+
+                ecm->checkpoints = resized;
+            }
+
+            const uint64_t item = ((uint64_t)ecm->blockCount * ECM_BLOCK_SIZE - output) / OUTPUT_SIZES[type];
+            ecm->checkpoints[ecm->blockCount++] = (EcmCheckpoint){.input     = input + item * INPUT_SIZES[type],
+                                                                  .output    = output + item * OUTPUT_SIZES[type],
+                                                                  .remaining = count - (uint32_t)item,
+                                                                  .type      = (uint8_t)type};
+        }
+
+        output += recordSize;
+        input += (uint64_t)count * INPUT_SIZES[type];
+        if (input > ecm->sourceSize) { goto Label_cleanup; }
+    }
+
+    // An EDC of the whole image follows the end marker. Checking it would mean decoding everything up front, so the
+    // sectors are left to speak for themselves.
+    ecm->size = output;
+    success   = input + 4 <= ecm->sourceSize;
+
+Label_cleanup:
+    free(scanner.buffer);
+
+    return success;
+}
+
+static bool scan_byte(EcmScanner *scanner, uint64_t offset, unsigned char *byteOut)
+{
+    if (offset < scanner->bufferOffset || offset - scanner->bufferOffset >= scanner->bufferSize)
+    {
+        if (offset >= scanner->sourceSize) { return false; }
+
+        const uint64_t remaining = scanner->sourceSize - offset;
+        scanner->bufferOffset    = offset;
+        scanner->bufferSize      = remaining < ECM_SCAN_SIZE ? (size_t)remaining : ECM_SCAN_SIZE;
+        if (!XenoBackend_Read(scanner->source, offset, scanner->buffer, scanner->bufferSize))
+        {
+            scanner->bufferSize = 0;
+            return false;
+        }
+    }
+
+    *byteOut = scanner->buffer[offset - scanner->bufferOffset];
+
+    return true;
+}
+
+static int parse_header(const unsigned char *bytes,
+                        size_t available,
+                        EcmType *typeOut,
+                        uint32_t *countOut,
+                        size_t *sizeOut)
+{
+    if (available == 0) { return -1; }
+
+    // The type is the bottom two bits of the first byte. The count follows seven bits at a time for as long as the top
+    // bit is set. The count is stored minus one, and all ones is the end marker.
+    unsigned char byte = bytes[0];
+    uint32_t count     = (byte >> 2) & 0x1F;
+    size_t size        = 1;
+    int shift          = 5;
+    while (byte & 0x80)
+    {
+        if (size == available || size == ECM_MAX_HEADER_SIZE) { return -1; }
+
+        byte = bytes[size++];
+        count |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    }
+
+    *typeOut = (EcmType)(bytes[0] & 3);
+    *sizeOut = size;
+    if (count == UINT32_MAX) { return 1; }
+
+    *countOut = count + 1;
+
+    return *countOut < ECM_MAX_ITEM_COUNT ? 0 : -1;
+}
+
+static bool decode_block(EcmContext *ecm, size_t block, unsigned char *blockOut)
+{
+    const EcmCheckpoint *checkpoint = &ecm->checkpoints[block];
+    const uint64_t blockStart       = (uint64_t)block * ECM_BLOCK_SIZE;
+    const uint64_t blockEnd         = ecm->size - blockStart < ECM_BLOCK_SIZE ? ecm->size : blockStart + ECM_BLOCK_SIZE;
+
+    // The block ends somewhere in the item the next block begins in, so nothing past that item is needed.
+    uint64_t inputEnd = ecm->sourceSize;
+    if (block + 1 < ecm->blockCount && ecm->checkpoints[block + 1].input + ECM_MAX_ITEM_SIZE < inputEnd)
+    {
+        inputEnd = ecm->checkpoints[block + 1].input + ECM_MAX_ITEM_SIZE;
+    }
+
+    const size_t inputSize = (size_t)(inputEnd - checkpoint->input);
+    unsigned char *input   = malloc(inputSize);
+    if (!input || !XenoBackend_Read(ecm->source, checkpoint->input, input, inputSize))
+    {
+        free(input);
+        return false;
+    }
+
+    unsigned char sector[SECTOR_SIZE];
+    EcmType type       = (EcmType)checkpoint->type;
+    uint32_t remaining = checkpoint->remaining;
+    uint64_t output    = checkpoint->output;
+    size_t position    = 0;
+    bool success       = true;
+    while (success && output < blockEnd)
+    {
+        if (remaining == 0)
+        {
+            const size_t available = inputSize - position;
+            size_t headerSize      = 0;
+
+            success = parse_header(&input[position], available, &type, &remaining, &headerSize) == 0;
+            position += headerSize;
+            continue;
+        }
+
+        if (type == ECM_LITERAL)
+        {
+            // Literal records only ever begin on or after the start of the block.
+            const uint64_t left = blockEnd - output;
+            const size_t count  = remaining < left ? remaining : (size_t)left;
+            if (count > inputSize - position)
+            {
+                success = false;
+                break;
+            }
+
+            memcpy(&blockOut[output - blockStart], &input[position], count);
+            position += count;
+            output += count;
+            remaining -= (uint32_t)count;
+            continue;
+        }
+
+        if (INPUT_SIZES[type] > inputSize - position)
+        {
+            success = false;
+            break;
+        }
+
+        // Sectors can hang off either end of the block. Only the part inside it is copied.
+        const unsigned char *rebuilt = rebuild_sector(type, &input[position], sector);
+        const uint64_t begin         = output > blockStart ? output : blockStart;
+        const uint64_t end           = output + OUTPUT_SIZES[type] < blockEnd ? output + OUTPUT_SIZES[type] : blockEnd;
+        memcpy(&blockOut[begin - blockStart], &rebuilt[begin - output], (size_t)(end - begin));
+
+        position += INPUT_SIZES[type];
+        output += OUTPUT_SIZES[type];
+        --remaining;
+    }
+
+    free(input);
+
+    return success;
+}
+
+static const unsigned char *rebuild_sector(EcmType type, const unsigned char *item, unsigned char *sector)
+{
+    Sector *raw = (Sector *)sector;
+
+    if (type == ECM_MODE_1)
+    {
+        memset(sector, 0, SECTOR_SIZE);
+        memset(&raw->syncPattern[1], 0xFF, 10);
+        memcpy(&raw->header, item, 3);
+        raw->header.mode = 1;
+        memcpy(&sector[16], &item[3], DATA_SIZE);
+
+        store_edc(sector, 0, SECTOR_EDC_MODE_1_SIZE);
+        SectorEcc_ComputeP(sector, &sector[SECTOR_ECC_P_OFFSET]);
+        SectorEcc_ComputeQ(sector, &sector[SECTOR_ECC_Q_OFFSET]);
+
+        return sector;
+    }
+
+    // Mode 2 sectors leave the header out of the ECC, so it just needs to say Mode 2. The subheader is stored once and
+    // repeated. This doesn't go through SectorEcc_Generate because the form is the record type, not the subheader.
+    memset(&raw->header, 0, sizeof(SectorHeader));
+    raw->header.mode = 2;
+    memcpy(&raw->subHeader[0], item, sizeof(SectorSubHeader));
+    memcpy(&raw->subHeader[1], item, INPUT_SIZES[type]);
+
+    if (type == ECM_FORM_1)
+    {
+        store_edc(sector, SECTOR_EDC_FORM_1_OFFSET, SECTOR_EDC_FORM_1_SIZE);
+        SectorEcc_ComputeP(sector, &sector[SECTOR_ECC_P_OFFSET]);
+        SectorEcc_ComputeQ(sector, &sector[SECTOR_ECC_Q_OFFSET]);
+    }
+    else { store_edc(sector, SECTOR_EDC_FORM_2_OFFSET, SECTOR_EDC_FORM_2_SIZE); }
+
+    return &sector[16];
+}
+
+static void store_edc(unsigned char *sector, size_t offset, size_t size)
+{
+    const uint32_t edc = SectorEcc_ComputeEdc(&sector[offset], size);
+    unsigned char *out = &sector[offset + size];
+    out[0]             = (unsigned char)edc;
+    out[1]             = (unsigned char)(edc >> 8);
+    out[2]             = (unsigned char)(edc >> 16);
+    out[3]             = (unsigned char)(edc >> 24);
+}
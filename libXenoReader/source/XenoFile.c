@@ -1,8 +1,15 @@
 #include "XenoFile.h"
 
+#include "defines.h"
+
 #define __XENO_INTERNAL__
 #include "XenoFileInternal.h"
 
 uint32_t XenoFile_GetSector(const XenoFile *file) { return file->sector; }
 
-int32_t XenoFile_GetSize(const XenoFile *file) { return file->size; }
\ No newline at end of file
+int32_t XenoFile_GetSize(const XenoFile *file) { return file->size; }
+
+size_t XenoFile_GetCapacity(const XenoFile *file)
+{
+    return file->size > 0 ? ((size_t)file->size + DATA_SIZE - 1) / DATA_SIZE * DATA_SIZE : 0;
+}
\ No newline at end of file
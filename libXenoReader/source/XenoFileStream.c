@@ -0,0 +1,176 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoFileStream.h"
+
+#include "Sector.h"
+#include "XenoReader.h"
+
+#define __XENO_INTERNAL__
+#include "XenoFileInternal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// clang-format off
+struct XenoFileStream
+{
+    /// @brief Reader the file is read from.
+    XenoReader *reader;
+
+    /// @brief First sector of the file.
+    uint32_t firstSector;
+
+    /// @brief Size of the file.
+    int64_t size;
+
+    /// @brief Position of the next read.
+    int64_t position;
+
+    /// @brief Offset in the file of the beginning of the window. This is always on a sector boundary.
+    int64_t windowBegin;
+
+    /// @brief Number of bytes of the file in the window. 0 means the window is empty.
+    int64_t windowLength;
+
+    /// @brief Data of the sectors in the window.
+    unsigned char window[XENO_FILE_STREAM_WINDOW_SECTORS * DATA_SIZE];
+};
+// clang-format on
+
+// Fills the window with the sectors at and after the stream's position.
+static bool fill_window(XenoFileStream *stream);
+
+XenoFileStream *XenoReader_OpenFileStream(XenoReader *reader, const XenoFile *file)
+{
+    if (file->size < 0) { return NULL; }
+
+    // Everything the stream could ever read needs to be in the image.
+    const size_t sectorCount = ((size_t)file->size + DATA_SIZE - 1) / DATA_SIZE;
+    if ((size_t)file->sector + sectorCount > XenoReader_GetSectorCount(reader)) { return NULL; }
+
+    XenoFileStream *stream = malloc(sizeof(XenoFileStream));
+    if (!stream) { return NULL; }
+
+    stream->reader       = reader;
+    stream->firstSector  = file->sector;
+    stream->size         = file->size;
+    stream->position     = 0;
+    stream->windowBegin  = 0;
+    stream->windowLength = 0;
+
+    return stream;
+}
+
+void XenoFileStream_Close(XenoFileStream *stream) { free(stream); }
+
+int64_t XenoFileStream_Read(XenoFileStream *stream, void *buffer, size_t length)
+{
+    if (stream->position >= stream->size) { return 0; }
+
+    // Reads never go past the end of the file.
+    const int64_t available = stream->size - stream->position;
+    if ((uint64_t)available < length) { length = (size_t)available; }
+
+    unsigned char *out = (unsigned char *)buffer;
+    size_t remaining   = length;
+    while (remaining > 0)
+    {
+        const int64_t windowEnd = stream->windowBegin + stream->windowLength;
+        if (stream->position >= stream->windowBegin && stream->position < windowEnd)
+        {
+            const int64_t inWindow = windowEnd - stream->position;
+            const size_t copySize  = (uint64_t)inWindow < remaining ? (size_t)inWindow : remaining;
+            memcpy(out, &stream->window[stream->position - stream->windowBegin], copySize);
+
+            out += copySize;
+            remaining -= copySize;
+            stream->position += copySize;
+            continue;
+        }
+
+        // Whole sectors can skip the window. Since reads are clamped to the file, these are never the partial last one.
+        if (stream->position % DATA_SIZE == 0 && remaining >= DATA_SIZE)
+        {
+            const size_t sectorCount = remaining / DATA_SIZE;
+            const size_t sector      = stream->firstSector + (size_t)(stream->position / DATA_SIZE);
+            if (!XenoReader_ReadSectorData(stream->reader, sector, sectorCount, out)) { return -1; }
+
+            out += sectorCount * DATA_SIZE;
+            remaining -= sectorCount * DATA_SIZE;
+            stream->position += sectorCount * DATA_SIZE;
+            continue;
+        }
+
+        if (!fill_window(stream)) { return -1; }
+    }
+
+    return (int64_t)length;
+}
+
+bool XenoFileStream_Seek(XenoFileStream *stream, int64_t offset, int origin)
+{
+    int64_t base = 0;
+    switch (origin)
+    {
+        case SEEK_SET:
+            base = 0;
+            break;
+
+        case SEEK_CUR:
+            base = stream->position;
+            break;
+
+        case SEEK_END:
+            base = stream->size;
+            break;
+
+        default:
+            return false;
+    }
+
+    // The base is always inside of the file, so anything further than its size from it is out of bounds anyway. This
+    // keeps the addition below from overflowing.
+    if (offset < -stream->size || offset > stream->size) { return false; }
+
+    const int64_t position = base + offset;
+    if (position < 0 || position > stream->size) { return false; }
+
+    // The window is left alone. If the new position is in it, the next read doesn't need to touch the image.
+    stream->position = position;
+
+    return true;
+}
+
+int64_t XenoFileStream_Tell(const XenoFileStream *stream) { return stream->position; }
+
+int64_t XenoFileStream_GetSize(const XenoFileStream *stream) { return stream->size; }
+
+static bool fill_window(XenoFileStream *stream)
+{
+    const int64_t windowBegin = stream->position - stream->position % DATA_SIZE;
+    const size_t firstSector  = (size_t)(windowBegin / DATA_SIZE);
+    const size_t fileSectors  = (size_t)((stream->size + DATA_SIZE - 1) / DATA_SIZE);
+    const size_t sectorCount  = fileSectors - firstSector < XENO_FILE_STREAM_WINDOW_SECTORS
+                                    ? fileSectors - firstSector
+                                    : XENO_FILE_STREAM_WINDOW_SECTORS;
+
+    // The window is emptied first so a failed read doesn't leave half of it looking valid.
+    stream->windowLength = 0;
+    if (!XenoReader_ReadSectorData(stream->reader, stream->firstSector + firstSector, sectorCount, stream->window))
+    {
+        return false;
+    }
+
+    const int64_t windowSize = (int64_t)(sectorCount * DATA_SIZE);
+    stream->windowBegin      = windowBegin;
+    stream->windowLength     = windowSize < stream->size - windowBegin ? windowSize : stream->size - windowBegin;
+
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoFileView.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define __XENO_INTERNAL__
+#include "XenoFileViewInternal.h"
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <limits.h>
+    #include <stddef.h>
+    #include <sys/uio.h>
+
+// The segments are handed straight to writev, so this has to hold.
+static_assert(sizeof(XenoSegment) == sizeof(struct iovec), "XenoSegment does not match struct iovec!");
+static_assert(offsetof(XenoSegment, data) == offsetof(struct iovec, iov_base), "XenoSegment does not match iovec!");
+static_assert(offsetof(XenoSegment, length) == offsetof(struct iovec, iov_len), "XenoSegment does not match iovec!");
+
+    #ifndef IOV_MAX
+        #define IOV_MAX 1024
+    #endif
+#endif
+
+void XenoFileView_Free(XenoFileView *view)
+{
+    if (!view) { return; }
+
+    if (view->staging) { free(view->staging); }
+
+    // The segments live in the same block as the view.
+    free(view);
+}
+
+const XenoSegment *XenoFileView_GetSegments(const XenoFileView *view) { return view->segments; }
+
+int XenoFileView_GetSegmentCount(const XenoFileView *view) { return view->segmentCount; }
+
+int32_t XenoFileView_GetSize(const XenoFileView *view) { return view->size; }
+
+bool XenoFileView_Write(const XenoFileView *view, int descriptor)
+{
+#ifdef _WIN32
+    (void)view;
+    (void)descriptor;
+    return false;
+#else
+    // Copy of the current batch so partial writes can be resumed without touching the view.
+    struct iovec batch[IOV_MAX < 256 ? IOV_MAX : 256];
+    const int batchMax = (int)(sizeof(batch) / sizeof(batch[0]));
+
+    int index = 0;
+    while (index < view->segmentCount)
+    {
+        const int batchCount = view->segmentCount - index < batchMax ? view->segmentCount - index : batchMax;
+        for (int i = 0; i < batchCount; i++)
+        {
+            batch[i].iov_base = (void *)view->segments[index + i].data;
+            batch[i].iov_len  = view->segments[index + i].length;
+        }
+
+        // Keep going until the whole batch is out. writev is allowed to write less than asked.
+        struct iovec *current = batch;
+        int remaining         = batchCount;
+        while (remaining > 0)
+        {
+            const ssize_t written = writev(descriptor, current, remaining);
+            if (written < 0 && errno == EINTR) { continue; }
+            if (written < 0) { return false; }
+
+            size_t left = (size_t)written;
+            while (remaining > 0 && left >= current->iov_len)
+            {
+                left -= current->iov_len;
+                ++current;
+                --remaining;
+            }
+
+            if (remaining > 0)
+            {
+                current->iov_base = (unsigned char *)current->iov_base + left;
+                current->iov_len -= left;
+            }
+        }
+
+        index += batchCount;
+    }
+
+    return true;
+#endif
+}
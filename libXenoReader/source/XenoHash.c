@@ -0,0 +1,408 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoHash.h"
+
+#include "Digest.h"
+#include "Sector.h"
+#include "ThreadPool.h"
+
+#define __XENO_INTERNAL__
+#include "XenoFileInternal.h"
+#include "XenoReaderInternal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Number of sectors read at a time. This is a bit under 5MB, and two of these are held at once.
+#define CHUNK_SECTOR_COUNT 2048
+
+/// @brief File tasks are made about this much data each so small files don't each get their own.
+#define BATCH_DATA_SIZE (512 * 1024)
+
+/// @brief Offset of the data in a raw sector.
+#define DATA_OFFSET offsetof(Sector, data)
+
+// clang-format off
+/// @brief Running hashes of one file. Files that share sectors and size with another share one of these.
+typedef struct
+{
+    /// @brief Hashes so far.
+    Sha1State sha1;
+    Xxh3State xxh3;
+
+    /// @brief Sectors the file covers and its size.
+    size_t firstSector;
+    size_t sectorCount;
+    int64_t size;
+
+    /// @brief Finished hashes.
+    XenoDigest digest;
+} FileHasher;
+
+/// @brief The files one task hashes out of a chunk.
+typedef struct
+{
+    /// @brief Files. Each of these overlaps the chunk.
+    FileHasher **files;
+    int count;
+
+    /// @brief Chunk and the sector it begins at.
+    const unsigned char *chunk;
+    size_t chunkFirstSector;
+    size_t chunkSectorCount;
+} FileBatch;
+
+/// @brief Running hashes of the whole image.
+typedef struct
+{
+    /// @brief Hashes so far.
+    Sha1State sha1;
+    Xxh3State xxh3;
+
+    /// @brief Chunk to add next.
+    const unsigned char *chunk;
+    size_t size;
+} ImageHasher;
+
+struct XenoHashReport
+{
+    /// @brief Hashes of the image.
+    XenoDigest image;
+
+    /// @brief The reader's file table. This is only used to find the index of a file.
+    const XenoFile *files;
+    uint32_t fileCount;
+
+    /// @brief Hashes of each file in table order and whether it could be hashed.
+    XenoDigest *fileDigests;
+    bool *hashed;
+};
+// clang-format on
+
+// Orders files by sector, then by size.
+static int compare_files(const void *a, const void *b);
+
+// Returns the chunk. It's mapped if the backend can map and read into the buffer if not.
+static const unsigned char *load_chunk(XenoReader *reader, size_t chunk, unsigned char **bufferInOut);
+
+// Submits tasks for every file that overlaps the chunk.
+static void submit_file_batches(ThreadPool *pool,
+                                FileHasher **active,
+                                int activeCount,
+                                FileBatch *batches,
+                                const unsigned char *chunk,
+                                size_t chunkFirstSector,
+                                size_t chunkSectorCount);
+
+// Adds the chunk to the hashes of every file in a batch. This is a thread pool task.
+static void hash_file_batch(void *argument);
+
+// Adds the chunk to the hashes of the image. These are thread pool tasks.
+static void hash_image_sha1(void *argument);
+static void hash_image_xxh3(void *argument);
+
+// Runs a task on the pool, or right here if there isn't one or it's full.
+static void run_task(ThreadPool *pool, ThreadPoolTask task, void *argument);
+
+XenoHashReport *XenoReader_HashImage(XenoReader *reader, int threadCount)
+{
+    const XenoFile *files    = XenoFsTable_GetFiles(reader->fsTable);
+    const uint32_t fileCount = reader->fsTable->fileCount;
+    const size_t allocCount  = fileCount ? fileCount : 1;
+
+    XenoHashReport *report    = calloc(1, sizeof(XenoHashReport));
+    const XenoFile **sorted   = malloc(sizeof(const XenoFile *) * allocCount);
+    int *hasherIndexes        = malloc(sizeof(int) * allocCount);
+    FileHasher *hashers       = malloc(sizeof(FileHasher) * allocCount);
+    FileHasher **active       = malloc(sizeof(FileHasher *) * allocCount);
+    FileBatch *batches        = malloc(sizeof(FileBatch) * allocCount);
+    ImageHasher *image        = malloc(sizeof(ImageHasher));
+    unsigned char *buffers[2] = {NULL, NULL};
+    ThreadPool *pool          = NULL;
+    if (!report || !sorted || !hasherIndexes || !hashers || !active || !batches || !image) { goto Label_error; }
+
+    report->files       = files;
+    report->fileCount   = fileCount;
+    report->fileDigests = calloc(allocCount, sizeof(XenoDigest));
+    report->hashed      = calloc(allocCount, sizeof(bool));
+    if (!report->fileDigests || !report->hashed) { goto Label_error; }
+
+    // Only files that are entirely in the image can be hashed. Everything else is left out of the sweep.
+    int sortedCount = 0;
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        const XenoFile *file     = &files[i];
+        const size_t sectorCount = file->size < 0 ? 0 : ((size_t)file->size + DATA_SIZE - 1) / DATA_SIZE;
+        hasherIndexes[i]         = -1;
+        if (file->size >= 0 && file->sector + sectorCount <= reader->sectorCount) { sorted[sortedCount++] = file; }
+    }
+
+    // In sector order, the files that overlap each chunk are always a window that only moves forward. The table often
+    // has the same file more than once, and those end up next to each other.
+    qsort(sorted, (size_t)sortedCount, sizeof(const XenoFile *), compare_files);
+
+    int hasherCount = 0;
+    for (int i = 0; i < sortedCount; i++)
+    {
+        const XenoFile *file = sorted[i];
+        if (i == 0 || compare_files(&sorted[i - 1], &sorted[i]) != 0)
+        {
+            FileHasher *hasher  = &hashers[hasherCount++];
+            hasher->firstSector = file->sector;
+            hasher->sectorCount = ((size_t)file->size + DATA_SIZE - 1) / DATA_SIZE;
+            hasher->size        = file->size;
+            Sha1_Init(&hasher->sha1);
+            Xxh3_Init(&hasher->xxh3);
+        }
+
+        hasherIndexes[file - files] = hasherCount - 1;
+    }
+
+    Sha1_Init(&image->sha1);
+    Xxh3_Init(&image->xxh3);
+
+    // If the pool can't be made, everything just runs here.
+    pool = ThreadPool_Create(threadCount);
+
+    const size_t chunkCount    = (reader->sectorCount + CHUNK_SECTOR_COUNT - 1) / CHUNK_SECTOR_COUNT;
+    const unsigned char *chunk = chunkCount > 0 ? load_chunk(reader, 0, &buffers[0]) : NULL;
+    int activeCount            = 0;
+    int nextHasher             = 0;
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        if (!chunk) { goto Label_error; }
+
+        const size_t chunkFirstSector = i * CHUNK_SECTOR_COUNT;
+        const size_t remaining        = reader->sectorCount - chunkFirstSector;
+        const size_t chunkSectorCount = remaining < CHUNK_SECTOR_COUNT ? remaining : CHUNK_SECTOR_COUNT;
+        const size_t chunkEnd         = chunkFirstSector + chunkSectorCount;
+
+        // Files that ended before this chunk are dropped and files that begin in it are picked up.
+        int kept = 0;
+        for (int j = 0; j < activeCount; j++)
+        {
+            if (active[j]->firstSector + active[j]->sectorCount > chunkFirstSector) { active[kept++] = active[j]; }
+        }
+        activeCount = kept;
+
+        while (nextHasher < hasherCount && hashers[nextHasher].firstSector < chunkEnd)
+        {
+            FileHasher *hasher = &hashers[nextHasher++];
+            if (hasher->sectorCount > 0) { active[activeCount++] = hasher; }
+        }
+
+        image->chunk = chunk;
+        image->size  = chunkSectorCount * SECTOR_SIZE;
+        run_task(pool, hash_image_sha1, image);
+        run_task(pool, hash_image_xxh3, image);
+        submit_file_batches(pool, active, activeCount, batches, chunk, chunkFirstSector, chunkSectorCount);
+
+        // The next chunk is read while this one is hashed. Every stream only ever has one task adding to it at a time,
+        // and the wait keeps the chunks in order.
+        const unsigned char *next = i + 1 < chunkCount ? load_chunk(reader, i + 1, &buffers[(i + 1) & 1]) : NULL;
+        if (pool) { ThreadPool_Wait(pool); }
+        chunk = next;
+    }
+
+    if (pool) { ThreadPool_Free(pool); }
+    pool = NULL;
+
+    Sha1_Final(&image->sha1, report->image.sha1);
+    report->image.xxh3 = Xxh3_Digest(&image->xxh3);
+
+    for (int i = 0; i < hasherCount; i++)
+    {
+        Sha1_Final(&hashers[i].sha1, hashers[i].digest.sha1);
+        hashers[i].digest.xxh3 = Xxh3_Digest(&hashers[i].xxh3);
+    }
+
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        if (hasherIndexes[i] < 0) { continue; }
+
+        report->fileDigests[i]   = hashers[hasherIndexes[i]].digest;
+        report->hashed[i]        = true;
+        reader->metadata[i].hash = report->fileDigests[i].xxh3;
+    }
+
+    goto Label_cleanup;
+
+Label_error:
+    XenoHashReport_Free(report);
+    report = NULL;
+
+Label_cleanup:
+    if (pool) { ThreadPool_Free(pool); }
+    free(buffers[0]);
+    free(buffers[1]);
+    free(image);
+    free(batches);
+    free(active);
+    free(hashers);
+    free(hasherIndexes);
+    free(sorted);
+
+    return report;
+}
+
+void XenoHashReport_Free(XenoHashReport *report)
+{
+    if (!report) { return; }
+
+    free(report->fileDigests);
+    free(report->hashed);
+    free(report);
+}
+
+void XenoHashReport_GetImageDigest(const XenoHashReport *report, XenoDigest *digestOut) { *digestOut = report->image; }
+
+bool XenoHashReport_GetFileDigest(const XenoHashReport *report, const XenoFile *file, XenoDigest *digestOut)
+{
+    if (file < report->files || file >= report->files + report->fileCount) { return false; }
+
+    const size_t index = (size_t)(file - report->files);
+    if (!report->hashed[index]) { return false; }
+
+    *digestOut = report->fileDigests[index];
+
+    return true;
+}
+
+void XenoHash_Compute(const void *data, size_t size, XenoDigest *digestOut)
+{
+    Sha1State sha1;
+    Sha1_Init(&sha1);
+    Sha1_Update(&sha1, data, size);
+    Sha1_Final(&sha1, digestOut->sha1);
+
+    Xxh3State xxh3;
+    Xxh3_Init(&xxh3);
+    Xxh3_Update(&xxh3, data, size);
+    digestOut->xxh3 = Xxh3_Digest(&xxh3);
+}
+
+const char *XenoHash_GetKernelName(void) { return Xxh3_GetKernelName(); }
+
+static int compare_files(const void *a, const void *b)
+{
+    const XenoFile *fileA = *(const XenoFile *const *)a;
+    const XenoFile *fileB = *(const XenoFile *const *)b;
+
+    if (fileA->sector != fileB->sector) { return fileA->sector < fileB->sector ? -1 : 1; }
+    if (fileA->size != fileB->size) { return fileA->size < fileB->size ? -1 : 1; }
+
+    return 0;
+}
+
+static const unsigned char *load_chunk(XenoReader *reader, size_t chunk, unsigned char **bufferInOut)
+{
+    const size_t firstSector = chunk * CHUNK_SECTOR_COUNT;
+    const size_t remaining   = reader->sectorCount - firstSector;
+    const size_t size        = (remaining < CHUNK_SECTOR_COUNT ? remaining : CHUNK_SECTOR_COUNT) * SECTOR_SIZE;
+    const uint64_t offset    = (uint64_t)firstSector * SECTOR_SIZE;
+
+    const size_t count          = size / SECTOR_SIZE;
+    const unsigned char *mapped = XenoBackend_Map(reader->backend, offset, size);
+    if (mapped)
+    {
+        // Nothing is copied here, so there's no time to count. The sectors still count as read.
+        if (XenoStats_IsActive(&reader->stats))
+        {
+            const uint64_t now = XenoTrace_GetTime();
+            XenoStats_RecordSectors(&reader->stats, firstSector, count, now, now, true, true);
+        }
+
+        return mapped;
+    }
+
+    // The buffer is only made once something needs reading, so mapped images never allocate it.
+    if (!*bufferInOut) { *bufferInOut = malloc((size_t)CHUNK_SECTOR_COUNT * SECTOR_SIZE); }
+    if (!*bufferInOut || !XenoReader_ReadBackend(reader, firstSector, count, *bufferInOut)) { return NULL; }
+
+    return *bufferInOut;
+}
+
+static void submit_file_batches(ThreadPool *pool,
+                                FileHasher **active,
+                                int activeCount,
+                                FileBatch *batches,
+                                const unsigned char *chunk,
+                                size_t chunkFirstSector,
+                                size_t chunkSectorCount)
+{
+    const size_t chunkEnd = chunkFirstSector + chunkSectorCount;
+
+    int batchCount   = 0;
+    size_t batchData = 0;
+    for (int i = 0; i < activeCount; i++)
+    {
+        const FileHasher *file = active[i];
+        const size_t begin     = file->firstSector > chunkFirstSector ? file->firstSector : chunkFirstSector;
+        const size_t fileEnd   = file->firstSector + file->sectorCount;
+        const size_t end       = fileEnd < chunkEnd ? fileEnd : chunkEnd;
+
+        if (batchCount == 0 || batchData >= BATCH_DATA_SIZE)
+        {
+            batches[batchCount++] = (FileBatch){.files            = &active[i],
+                                                .count            = 0,
+                                                .chunk            = chunk,
+                                                .chunkFirstSector = chunkFirstSector,
+                                                .chunkSectorCount = chunkSectorCount};
+            batchData             = 0;
+        }
+
+        ++batches[batchCount - 1].count;
+        batchData += (end - begin) * DATA_SIZE;
+    }
+
+    // Batches are only submitted once they're all built. The array of active files isn't touched until the wait.
+    for (int i = 0; i < batchCount; i++) { run_task(pool, hash_file_batch, &batches[i]); }
+}
+
+static void hash_file_batch(void *argument)
+{
+    const FileBatch *batch = (const FileBatch *)argument;
+    const size_t chunkEnd  = batch->chunkFirstSector + batch->chunkSectorCount;
+
+    for (int i = 0; i < batch->count; i++)
+    {
+        FileHasher *file     = batch->files[i];
+        const size_t begin   = file->firstSector > batch->chunkFirstSector ? file->firstSector : batch->chunkFirstSector;
+        const size_t fileEnd = file->firstSector + file->sectorCount;
+        const size_t end     = fileEnd < chunkEnd ? fileEnd : chunkEnd;
+
+        for (size_t sector = begin; sector < end; sector++)
+        {
+            // Only the last sector of a file is ever partly used.
+            const int64_t offset      = (int64_t)(sector - file->firstSector) * DATA_SIZE;
+            const size_t size         = file->size - offset < DATA_SIZE ? (size_t)(file->size - offset) : DATA_SIZE;
+            const unsigned char *data = &batch->chunk[(sector - batch->chunkFirstSector) * SECTOR_SIZE + DATA_OFFSET];
+
+            Sha1_Update(&file->sha1, data, size);
+            Xxh3_Update(&file->xxh3, data, size);
+        }
+    }
+}
+
+static void hash_image_sha1(void *argument)
+{
+    ImageHasher *image = (ImageHasher *)argument;
+    Sha1_Update(&image->sha1, image->chunk, image->size);
+}
+
+static void hash_image_xxh3(void *argument)
+{
+    ImageHasher *image = (ImageHasher *)argument;
+    Xxh3_Update(&image->xxh3, image->chunk, image->size);
+}
+
+static void run_task(ThreadPool *pool, ThreadPoolTask task, void *argument)
+{
+    if (!pool || !ThreadPool_Submit(pool, task, argument)) { task(argument); }
+}
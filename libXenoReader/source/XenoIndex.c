@@ -0,0 +1,308 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "Sector.h"
+#include "XenoReader.h"
+
+#define __XENO_INTERNAL__
+#include "XenoDirInternal.h"
+#include "XenoReaderInternal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/// @brief Magic at the beginning of every index.
+static const char INDEX_MAGIC[8] = "XENOIDX";
+
+/// @brief This needs to be bumped any time the layout of the header, the table, or the metadata changes.
+static const uint32_t INDEX_VERSION = 1;
+
+/// @brief Written as is. If it doesn't read back the same, the index came from a machine with a different byte order.
+static const uint32_t INDEX_BYTE_ORDER = 0x01020304;
+
+/// @brief First sector hashed. This is the boot record.
+static const uint64_t HASHED_SECTOR = 16;
+
+/// @brief Number of sectors hashed. This covers the boot record, the disc identification and the whole table.
+static const uint64_t HASHED_SECTOR_COUNT = 24;
+
+// clang-format off
+/// @brief This is at the beginning of the index. The table and metadata follow it at the offsets recorded.
+typedef struct
+{
+    /// @brief INDEX_MAGIC.
+    char magic[8];
+
+    /// @brief INDEX_VERSION.
+    uint32_t version;
+
+    /// @brief INDEX_BYTE_ORDER.
+    uint32_t byteOrder;
+
+    /// @brief Size of the image file in bytes when the index was saved. For ECM and CHD images, this is the container.
+    uint64_t imageSize;
+
+    /// @brief Modification time of the image file when the index was saved.
+    int64_t imageModified;
+
+    /// @brief FNV-1a hash of the raw sectors HASHED_SECTOR through HASHED_SECTOR + HASHED_SECTOR_COUNT.
+    uint64_t headerHash;
+
+    /// @brief Disc number so verification can be skipped.
+    uint32_t discNumber;
+
+    /// @brief Offset and size of the table in bytes.
+    uint32_t tableOffset;
+    uint32_t tableSize;
+
+    /// @brief Offset of the metadata array and the number of entries in it.
+    uint32_t metadataOffset;
+    uint32_t metadataCount;
+
+    /// @brief Keeps the header a multiple of 8 bytes.
+    uint32_t reserved;
+} IndexHeader;
+// clang-format on
+
+static_assert(sizeof(IndexHeader) % 8 == 0, "The table needs to be 8 byte aligned after the header!");
+
+// Hashes the sectors the table is built from.
+static bool hash_header_sectors(XenoBackend *backend, uint64_t *hashOut);
+
+// Gets the size and modification time of the image.
+static bool stat_image(const char *imagePath, uint64_t *sizeOut, int64_t *modifiedOut);
+
+// Checks the header and the table's spans so a bad index can never be used.
+static bool validate_index(const IndexHeader *header, uint64_t indexSize, uint64_t imageSize, int64_t imageModified);
+
+// Writes the whole index to a temporary file and renames it over indexPath.
+static bool write_index(const char *indexPath, const IndexHeader *header, const void *table, const void *metadata);
+
+XenoReader *XenoReader_OpenWithIndex(const char *imagePath, const char *indexPath)
+{
+    const uint64_t openBegin = XenoTrace_GetTime();
+
+    uint64_t imageSize    = 0;
+    int64_t imageModified = 0;
+    if (!stat_image(imagePath, &imageSize, &imageModified)) { return NULL; }
+
+    XenoBackend *backend = XenoReader_OpenImageBackend(imagePath);
+    if (!backend) { return NULL; }
+
+    // The index is mapped so the table can be used right where it is.
+    XenoBackend *indexBackend = XenoBackend_OpenMmap(indexPath);
+    const uint64_t indexSize  = indexBackend ? XenoBackend_GetSize(indexBackend) : 0;
+    const IndexHeader *header = indexBackend ? XenoBackend_Map(indexBackend, 0, sizeof(IndexHeader)) : NULL;
+
+    uint64_t headerHash = 0;
+    const bool valid    = header && validate_index(header, indexSize, imageSize, imageModified) &&
+                       hash_header_sectors(backend, &headerHash) && headerHash == header->headerHash;
+    if (!valid)
+    {
+        XenoBackend_Close(indexBackend);
+
+        // The index is stale or doesn't exist. Do things the slow way and save a new one for next time.
+        XenoReader *reader = XenoReader_OpenWithBackend(backend);
+        if (!reader)
+        {
+            XenoBackend_Close(backend);
+            return NULL;
+        }
+
+        // Not being able to save the index isn't a reason to fail opening.
+        XenoReader_SaveIndex(reader, imagePath, indexPath);
+
+        return reader;
+    }
+
+    const size_t sectorCount = XenoBackend_GetSize(backend) / SECTOR_SIZE;
+    XenoReader *reader       = XenoReader_Allocate(backend, sectorCount, (int)header->discNumber);
+    if (!reader)
+    {
+        XenoBackend_Close(indexBackend);
+        XenoBackend_Close(backend);
+        return NULL;
+    }
+
+    XenoFsTable *table = (XenoFsTable *)XenoBackend_Map(indexBackend, header->tableOffset, header->tableSize);
+    if (!XenoReader_AttachTable(reader, table, indexBackend))
+    {
+        XenoReader_Close(reader);
+        return NULL;
+    }
+
+    // The metadata can be written to, so it's copied out of the map.
+    const size_t metadataSize = header->metadataCount * sizeof(XenoFileMetadata);
+    const void *metadata      = XenoBackend_Map(indexBackend, header->metadataOffset, metadataSize);
+    memcpy(reader->metadata, metadata, metadataSize);
+
+    if (XenoStats_IsActive(&reader->stats)) { XenoStats_RecordOpen(&reader->stats, openBegin, reader->sectorCount); }
+
+    return reader;
+}
+
+bool XenoReader_SaveIndex(XenoReader *reader, const char *imagePath, const char *indexPath)
+{
+    IndexHeader header = {0};
+    memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version   = INDEX_VERSION;
+    header.byteOrder = INDEX_BYTE_ORDER;
+
+    // ECM and CHD images are keyed on the file on disk, not the image it decodes to. The header hash is what ties the
+    // index to the image the reader has open, so an index saved against the wrong path is thrown out when it's used.
+    if (!stat_image(imagePath, &header.imageSize, &header.imageModified)) { return false; }
+    if (!hash_header_sectors(reader->backend, &header.headerHash)) { return false; }
+
+    // Everything is kept 8 byte aligned so the table can be used straight out of the map.
+    const size_t tableSize = XenoFsTable_GetSize(reader->fsTable);
+    header.discNumber      = (uint32_t)reader->discNumber;
+    header.tableOffset     = sizeof(IndexHeader);
+    header.tableSize       = (uint32_t)tableSize;
+    header.metadataOffset  = (uint32_t)(sizeof(IndexHeader) + ((tableSize + 7) & ~(size_t)7));
+    header.metadataCount   = reader->fsTable->fileCount;
+
+    return write_index(indexPath, &header, reader->fsTable, reader->metadata);
+}
+
+static bool hash_header_sectors(XenoBackend *backend, uint64_t *hashOut)
+{
+    unsigned char *buffer = malloc(HASHED_SECTOR_COUNT * SECTOR_SIZE);
+    if (!buffer) { return false; }
+
+    if (!XenoBackend_Read(backend, HASHED_SECTOR * SECTOR_SIZE, buffer, HASHED_SECTOR_COUNT * SECTOR_SIZE))
+    {
+        free(buffer);
+        return false;
+    }
+
+    // FNV-1a. This is only here to notice changes, so it doesn't need to be anything fancy.
+    uint64_t hash = 0xCBF29CE484222325;
+    for (size_t i = 0; i < HASHED_SECTOR_COUNT * SECTOR_SIZE; i++)
+    {
+        hash ^= buffer[i];
+        hash *= 0x100000001B3;
+    }
+
+    free(buffer);
+    *hashOut = hash;
+
+    return true;
+}
+
+static bool stat_image(const char *imagePath, uint64_t *sizeOut, int64_t *modifiedOut)
+{
+    struct stat imageStat;
+    if (stat(imagePath, &imageStat) != 0 || imageStat.st_size < 0) { return false; }
+
+    *sizeOut     = (uint64_t)imageStat.st_size;
+    *modifiedOut = (int64_t)imageStat.st_mtime;
+
+    return true;
+}
+
+static bool validate_index(const IndexHeader *header, uint64_t indexSize, uint64_t imageSize, int64_t imageModified)
+{
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(header->magic)) != 0) { return false; }
+    if (header->version != INDEX_VERSION || header->byteOrder != INDEX_BYTE_ORDER) { return false; }
+    if (header->imageSize != imageSize || header->imageModified != imageModified) { return false; }
+    if (header->discNumber != 1 && header->discNumber != 2) { return false; }
+
+    // The table and metadata need to be aligned and inside of the file.
+    if (header->tableOffset % 8 != 0 || header->metadataOffset % 8 != 0) { return false; }
+    if (header->tableSize < sizeof(XenoFsTable) || header->tableOffset + (uint64_t)header->tableSize > indexSize)
+    {
+        return false;
+    }
+
+    const uint64_t metadataSize = header->metadataCount * (uint64_t)sizeof(XenoFileMetadata);
+    if (header->metadataOffset + metadataSize > indexSize) { return false; }
+
+    // The map is page aligned, so this is aligned too.
+    const XenoFsTable *table = (const XenoFsTable *)((const unsigned char *)header + header->tableOffset);
+    const uint64_t dirsSize  = sizeof(XenoDir) * (uint64_t)table->dirCount;
+    const uint64_t tableSize = sizeof(XenoFsTable) + dirsSize + sizeof(XenoFile) * (uint64_t)table->fileCount;
+    if (table->dirCount == 0 || tableSize != header->tableSize || table->fileCount != header->metadataCount)
+    {
+        return false;
+    }
+
+    // Every directory but the root has to be claimed by exactly one parent.
+    bool *claimed = calloc(table->dirCount, sizeof(bool));
+    if (!claimed) { return false; }
+
+    // Every span has to stay inside of the table. Nothing else is checked when the table is used.
+    bool valid = true;
+    for (uint32_t i = 0; valid && i < table->dirCount; i++)
+    {
+        const XenoDir *dir   = &table->dirs[i];
+        const uint32_t dirs  = table->dirCount;
+        const uint32_t files = table->fileCount;
+        const bool dirsFit   = dir->firstSubDir <= dirs && dir->subDirCount <= dirs - dir->firstSubDir;
+        const bool filesFit  = dir->firstFile <= files && dir->fileCount <= files - dir->firstFile;
+
+        // Subdirectories are always laid out after their parent, so a span that points back at an ancestor or at
+        // itself would send the walk around in circles.
+        const bool afterParent = dir->subDirCount == 0 || dir->firstSubDir > i;
+        valid                  = dir->index == i && dirsFit && filesFit && afterParent;
+
+        for (uint32_t j = 0; valid && j < dir->subDirCount; j++)
+        {
+            valid                         = !claimed[dir->firstSubDir + j];
+            claimed[dir->firstSubDir + j] = true;
+        }
+    }
+
+    // A directory nobody claims can't be reached from the root.
+    for (uint32_t i = 1; valid && i < table->dirCount; i++) { valid = claimed[i]; }
+
+    free(claimed);
+
+    return valid;
+}
+
+static bool write_index(const char *indexPath, const IndexHeader *header, const void *table, const void *metadata)
+{
+    // The index is written next to where it's going and renamed so nobody can ever map half of one.
+    const size_t pathLength = strlen(indexPath);
+    char *tempPath          = malloc(pathLength + 5);
+    if (!tempPath) { return false; }
+
+    memcpy(tempPath, indexPath, pathLength);
+    memcpy(&tempPath[pathLength], ".tmp", 5);
+
+    FILE *indexFile = fopen(tempPath, "wb");
+    if (!indexFile)
+    {
+        free(tempPath);
+        return false;
+    }
+
+    static const unsigned char PADDING[8] = {0};
+    const size_t paddingSize              = header->metadataOffset - header->tableOffset - header->tableSize;
+    const size_t metadataSize             = header->metadataCount * sizeof(XenoFileMetadata);
+
+    bool written = fwrite(header, 1, sizeof(IndexHeader), indexFile) == sizeof(IndexHeader);
+    written      = written && fwrite(table, 1, header->tableSize, indexFile) == header->tableSize;
+    written      = written && fwrite(PADDING, 1, paddingSize, indexFile) == paddingSize;
+    written      = written && fwrite(metadata, 1, metadataSize, indexFile) == metadataSize;
+    written      = fclose(indexFile) == 0 && written;
+
+#ifdef _WIN32
+    // rename won't replace an existing file on Windows.
+    if (written) { remove(indexPath); }
+#endif
+
+    written = written && rename(tempPath, indexPath) == 0;
+    if (!written) { remove(tempPath); }
+
+    free(tempPath);
+
+    return written;
+}
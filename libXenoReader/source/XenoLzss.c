@@ -0,0 +1,444 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoLzss.h"
+
+#include "Sector.h"
+#include "ThreadPool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief References can reach this far back.
+#define LZSS_WINDOW_SIZE 4096
+
+/// @brief Shortest reference. The length stored is this much less than the real one.
+#define LZSS_MIN_LENGTH 3
+
+/// @brief Most bytes a flag byte and its eight items can take in and put out.
+#define LZSS_GROUP_INPUT  17
+#define LZSS_GROUP_OUTPUT 144
+
+/// @brief Wide copies can write this many bytes past the end of a reference. The next item overwrites them.
+#define LZSS_COPY_SLACK 8
+
+/// @brief Number of compressed bytes streams read from their source at a time.
+#define LZSS_STREAM_INPUT_SIZE (XENO_FILE_STREAM_WINDOW_SECTORS * DATA_SIZE)
+
+/// @brief Number of bytes streams decompress at a time on top of the window they keep.
+#define LZSS_STREAM_CHUNK_SIZE (XENO_FILE_STREAM_WINDOW_SECTORS * DATA_SIZE)
+
+/// @brief Size of the buffer streams decompress to. Groups are never split, so the last one can run past the chunk.
+#define LZSS_STREAM_OUTPUT_SIZE (LZSS_WINDOW_SIZE + LZSS_STREAM_CHUNK_SIZE + LZSS_GROUP_OUTPUT + LZSS_COPY_SLACK)
+
+// clang-format off
+/// @brief Where decompression is at.
+typedef struct
+{
+    /// @brief Compressed data after the header, how much of it there is and how far into it decompression is.
+    const unsigned char *input;
+    size_t inputSize;
+    size_t inputPosition;
+
+    /// @brief Set when there's no more input coming after what's in the buffer.
+    bool inputFinal;
+
+    /// @brief Buffer to decompress to and how far into it decompression is.
+    unsigned char *output;
+    size_t outputPosition;
+
+    /// @brief Where the decompressed data ends or as far as the buffer can take it, whichever is first.
+    size_t outputEnd;
+} LzssDecoder;
+
+struct XenoLzssStream
+{
+    /// @brief Stream the compressed data is read from and how much of it is left to read.
+    XenoFileStream *source;
+    int64_t sourceRemaining;
+
+    /// @brief Decompressed size, how much of it has been decompressed and how much of it has been read.
+    int64_t size;
+    int64_t produced;
+    int64_t position;
+
+    /// @brief Decompresses from input to output.
+    LzssDecoder decoder;
+
+    /// @brief Offset in output of the next byte to be read.
+    size_t outputBegin;
+
+    /// @brief Compressed data that's been read from the source.
+    unsigned char input[LZSS_STREAM_INPUT_SIZE];
+
+    /// @brief The last LZSS_WINDOW_SIZE bytes handed out followed by whatever's been decompressed since.
+    unsigned char output[LZSS_STREAM_OUTPUT_SIZE];
+};
+
+/// @brief One buffer of a batch.
+typedef struct
+{
+    /// @brief Buffer to decompress.
+    const XenoBuffer *buffer;
+
+    /// @brief Set to the result.
+    XenoBuffer *decompressed;
+} LzssTask;
+// clang-format on
+
+// Decompresses whole groups until the output reaches the limit, ends, or the input needs to be refilled.
+static bool decode(LzssDecoder *decoder, size_t outputLimit);
+
+// Copies a reference. The source and destination can overlap.
+static inline void copy_reference(unsigned char *out, size_t distance, size_t length);
+
+// Decompresses the next chunk of a stream.
+static bool decode_chunk(XenoLzssStream *stream);
+
+// Moves what's left of a stream's input to the beginning of its buffer and reads more after it.
+static bool refill_input(XenoLzssStream *stream);
+
+// Thread pool task for batches.
+static void decompress_task(void *argument);
+
+int64_t XenoLzss_GetSize(const void *data, size_t size)
+{
+    if (size < XENO_LZSS_HEADER_SIZE) { return -1; }
+
+    const unsigned char *header = (const unsigned char *)data;
+    const int64_t decompressed  = (int64_t)((uint32_t)header[0] | (uint32_t)header[1] << 8 |
+                                           (uint32_t)header[2] << 16 | (uint32_t)header[3] << 24);
+
+    // Every full group puts out at most LZSS_GROUP_OUTPUT bytes. Anything claiming more than that can't be LZSS, which
+    // turns away most files that aren't compressed before anything is decompressed.
+    const uint64_t groups = (size - XENO_LZSS_HEADER_SIZE) / LZSS_GROUP_INPUT + 1;
+    if (decompressed == 0 || (uint64_t)decompressed > groups * LZSS_GROUP_OUTPUT) { return -1; }
+
+    return decompressed;
+}
+
+bool XenoLzss_Decompress(const void *input, size_t inputSize, void *output, size_t outputSize)
+{
+    const int64_t size = XenoLzss_GetSize(input, inputSize);
+    if (size < 0 || (uint64_t)size != outputSize) { return false; }
+
+    LzssDecoder decoder = {.input          = (const unsigned char *)input + XENO_LZSS_HEADER_SIZE,
+                           .inputSize      = inputSize - XENO_LZSS_HEADER_SIZE,
+                           .inputPosition  = 0,
+                           .inputFinal     = true,
+                           .output         = (unsigned char *)output,
+                           .outputPosition = 0,
+                           .outputEnd      = outputSize};
+
+    return decode(&decoder, outputSize) && decoder.outputPosition == outputSize;
+}
+
+XenoLzssStream *XenoLzssStream_Open(XenoFileStream *source)
+{
+    unsigned char header[XENO_LZSS_HEADER_SIZE];
+    const int64_t remaining = XenoFileStream_GetSize(source) - XenoFileStream_Tell(source);
+    if (XenoFileStream_Read(source, header, XENO_LZSS_HEADER_SIZE) != XENO_LZSS_HEADER_SIZE) { return NULL; }
+
+    const int64_t size = XenoLzss_GetSize(header, (size_t)remaining);
+    if (size < 0) { return NULL; }
+
+    XenoLzssStream *stream = malloc(sizeof(XenoLzssStream));
+    if (!stream) { return NULL; }
+
+    stream->source          = source;
+    stream->sourceRemaining = remaining - XENO_LZSS_HEADER_SIZE;
+    stream->size            = size;
+    stream->produced        = 0;
+    stream->position        = 0;
+    stream->outputBegin     = 0;
+    stream->decoder         = (LzssDecoder){.input          = stream->input,
+                                            .inputSize      = 0,
+                                            .inputPosition  = 0,
+                                            .inputFinal     = stream->sourceRemaining == 0,
+                                            .output         = stream->output,
+                                            .outputPosition = 0,
+                                            .outputEnd      = 0};
+
+    return stream;
+}
+
+void XenoLzssStream_Close(XenoLzssStream *stream) { free(stream); }
+
+int64_t XenoLzssStream_Read(XenoLzssStream *stream, void *buffer, size_t length)
+{
+    if (stream->position >= stream->size) { return 0; }
+
+    const int64_t available = stream->size - stream->position;
+    if ((uint64_t)available < length) { length = (size_t)available; }
+
+    unsigned char *out = (unsigned char *)buffer;
+    size_t remaining   = length;
+    while (remaining > 0)
+    {
+        const size_t decoded = stream->decoder.outputPosition - stream->outputBegin;
+        if (decoded == 0)
+        {
+            if (!decode_chunk(stream)) { return -1; }
+            continue;
+        }
+
+        const size_t copySize = decoded < remaining ? decoded : remaining;
+        memcpy(out, &stream->output[stream->outputBegin], copySize);
+
+        out += copySize;
+        remaining -= copySize;
+        stream->outputBegin += copySize;
+    }
+
+    stream->position += (int64_t)length;
+
+    return (int64_t)length;
+}
+
+int64_t XenoLzssStream_GetSize(const XenoLzssStream *stream) { return stream->size; }
+
+XenoBuffer *XenoBuffer_DecompressLzss(const XenoBuffer *buffer)
+{
+    if (!buffer || !buffer->data || buffer->size < 0) { return NULL; }
+
+    const int64_t size = XenoLzss_GetSize(buffer->data, (size_t)buffer->size);
+    if (size < 0 || size > INT32_MAX) { return NULL; }
+
+    XenoBuffer *decompressed = malloc(sizeof(XenoBuffer));
+    if (!decompressed) { return NULL; }
+
+    decompressed->size = (int32_t)size;
+    decompressed->data = malloc((size_t)size);
+    if (!decompressed->data ||
+        !XenoLzss_Decompress(buffer->data, (size_t)buffer->size, decompressed->data, (size_t)size))
+    {
+        XenoBuffer_Free(decompressed);
+        return NULL;
+    }
+
+    return decompressed;
+}
+
+bool XenoBuffer_DecompressLzssBatch(const XenoBuffer *const *buffers,
+                                    int count,
+                                    int threadCount,
+                                    XenoBuffer **decompressedOut)
+{
+    if (count <= 0) { return true; }
+
+    LzssTask *tasks = malloc(sizeof(LzssTask) * (size_t)count);
+    if (!tasks)
+    {
+        for (int i = 0; i < count; i++) { decompressedOut[i] = NULL; }
+        return false;
+    }
+
+    // If the pool can't be made, everything just runs here.
+    ThreadPool *pool = ThreadPool_Create(threadCount);
+    for (int i = 0; i < count; i++)
+    {
+        tasks[i] = (LzssTask){.buffer = buffers[i], .decompressed = NULL};
+        if (!pool || !ThreadPool_Submit(pool, decompress_task, &tasks[i])) { decompress_task(&tasks[i]); }
+    }
+    if (pool) { ThreadPool_Free(pool); }
+
+    bool success = true;
+    for (int i = 0; i < count; i++)
+    {
+        decompressedOut[i] = tasks[i].decompressed;
+        if (!tasks[i].decompressed) { success = false; }
+    }
+
+    free(tasks);
+
+    return success;
+}
+
+static bool decode(LzssDecoder *decoder, size_t outputLimit)
+{
+    const unsigned char *in = decoder->input;
+    unsigned char *out      = decoder->output;
+    size_t inPosition       = decoder->inputPosition;
+    size_t outPosition      = decoder->outputPosition;
+    bool success            = true;
+    while (outPosition < outputLimit && outPosition < decoder->outputEnd)
+    {
+        // A group is never split across refills. The fast path below depends on having all of it.
+        const size_t available = decoder->inputSize - inPosition;
+        if (available < LZSS_GROUP_INPUT && !decoder->inputFinal) { break; }
+
+        // Far enough from both ends, a whole group can go without checking either.
+        if (available >= LZSS_GROUP_INPUT && decoder->outputEnd - outPosition >= LZSS_GROUP_OUTPUT + LZSS_COPY_SLACK)
+        {
+            const uint32_t flags = in[inPosition++];
+
+            // Runs of literals are common enough in everything that isn't graphics to be worth one copy.
+            if (flags == 0)
+            {
+                memcpy(&out[outPosition], &in[inPosition], 8);
+                inPosition += 8;
+                outPosition += 8;
+                continue;
+            }
+
+            for (int bit = 0; bit < 8; bit++)
+            {
+                if (!(flags & (1u << bit)))
+                {
+                    out[outPosition++] = in[inPosition++];
+                    continue;
+                }
+
+                const size_t distance = in[inPosition] | (size_t)(in[inPosition + 1] & 0x0F) << 8;
+                const size_t length   = (size_t)(in[inPosition + 1] >> 4) + LZSS_MIN_LENGTH;
+                inPosition += 2;
+
+                if (distance == 0 || distance > outPosition)
+                {
+                    success = false;
+                    goto Label_done;
+                }
+
+                copy_reference(&out[outPosition], distance, length);
+                outPosition += length;
+            }
+
+            continue;
+        }
+
+        // The last group or so gets every check.
+        if (available == 0)
+        {
+            success = false;
+            break;
+        }
+
+        const uint32_t flags = in[inPosition++];
+        for (int bit = 0; bit < 8 && outPosition < decoder->outputEnd; bit++)
+        {
+            if (!(flags & (1u << bit)))
+            {
+                if (inPosition == decoder->inputSize)
+                {
+                    success = false;
+                    goto Label_done;
+                }
+
+                out[outPosition++] = in[inPosition++];
+                continue;
+            }
+
+            if (decoder->inputSize - inPosition < 2)
+            {
+                success = false;
+                goto Label_done;
+            }
+
+            const size_t distance = in[inPosition] | (size_t)(in[inPosition + 1] & 0x0F) << 8;
+            size_t length         = (size_t)(in[inPosition + 1] >> 4) + LZSS_MIN_LENGTH;
+            inPosition += 2;
+
+            if (distance == 0 || distance > outPosition)
+            {
+                success = false;
+                goto Label_done;
+            }
+
+            // The last reference can run past the size in the header. Only what fits is kept.
+            if (length > decoder->outputEnd - outPosition) { length = decoder->outputEnd - outPosition; }
+
+            for (size_t i = 0; i < length; i++) { out[outPosition + i] = out[outPosition - distance + i]; }
+            outPosition += length;
+        }
+    }
+
+Label_done:
+    decoder->inputPosition  = inPosition;
+    decoder->outputPosition = outPosition;
+
+    return success;
+}
+
+static inline void copy_reference(unsigned char *out, size_t distance, size_t length)
+{
+    const unsigned char *source = out - distance;
+
+    // Eight bytes at a time is safe as long as every chunk is read after the bytes it covers are written.
+    if (distance >= 8)
+    {
+        for (size_t i = 0; i < length; i += 8)
+        {
+            uint64_t chunk;
+            memcpy(&chunk, &source[i], sizeof(chunk));
+            memcpy(&out[i], &chunk, sizeof(chunk));
+        }
+    }
+    else if (distance == 1) { memset(out, *source, length); }
+    else
+    {
+        for (size_t i = 0; i < length; i++) { out[i] = source[i]; }
+    }
+}
+
+static bool decode_chunk(XenoLzssStream *stream)
+{
+    LzssDecoder *decoder = &stream->decoder;
+
+    // Everything before the window has been read and can't be referred to anymore.
+    if (decoder->outputPosition > LZSS_WINDOW_SIZE)
+    {
+        memmove(stream->output, &stream->output[decoder->outputPosition - LZSS_WINDOW_SIZE], LZSS_WINDOW_SIZE);
+        decoder->outputPosition = LZSS_WINDOW_SIZE;
+        stream->outputBegin     = LZSS_WINDOW_SIZE;
+    }
+
+    const size_t begin      = decoder->outputPosition;
+    const int64_t remaining = stream->size - stream->produced;
+    const size_t room       = LZSS_STREAM_OUTPUT_SIZE - begin;
+    decoder->outputEnd      = begin + ((uint64_t)remaining < room ? (size_t)remaining : room);
+
+    while (decoder->outputPosition == begin)
+    {
+        if (!decoder->inputFinal && decoder->inputSize - decoder->inputPosition < LZSS_GROUP_INPUT &&
+            !refill_input(stream))
+        {
+            return false;
+        }
+
+        if (!decode(decoder, LZSS_WINDOW_SIZE + LZSS_STREAM_CHUNK_SIZE)) { return false; }
+    }
+
+    stream->produced += (int64_t)(decoder->outputPosition - begin);
+
+    return true;
+}
+
+static bool refill_input(XenoLzssStream *stream)
+{
+    LzssDecoder *decoder = &stream->decoder;
+    const size_t left    = decoder->inputSize - decoder->inputPosition;
+    memmove(stream->input, &stream->input[decoder->inputPosition], left);
+
+    const size_t space     = LZSS_STREAM_INPUT_SIZE - left;
+    const size_t readSize  = (uint64_t)stream->sourceRemaining < space ? (size_t)stream->sourceRemaining : space;
+    const int64_t bytesRead = XenoFileStream_Read(stream->source, &stream->input[left], readSize);
+    if (bytesRead < 0) { return false; }
+
+    stream->sourceRemaining -= bytesRead;
+    decoder->inputSize     = left + (size_t)bytesRead;
+    decoder->inputPosition = 0;
+    decoder->inputFinal    = stream->sourceRemaining == 0 || bytesRead == 0;
+
+    return true;
+}
+
+static void decompress_task(void *argument)
+{
+    LzssTask *task     = (LzssTask *)argument;
+    task->decompressed = XenoBuffer_DecompressLzss(task->buffer);
+}
@@ -0,0 +1,506 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoPack.h"
+#include "DynamicArray.h"
+#include "XenoBackend.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+/// @brief Magic at the beginning and the end of every pack.
+static const char PACK_MAGIC[8] = "XENOPAK";
+
+/// @brief This needs to be bumped any time the layout of the header, the table, or the footer changes.
+static const uint32_t PACK_VERSION = 1;
+
+/// @brief Written as is. If it doesn't read back the same, the pack came from a machine with a different byte order.
+static const uint32_t PACK_BYTE_ORDER = 0x01020304;
+
+/// @brief Every entry begins on a multiple of this.
+static const uint64_t PACK_ALIGNMENT = 16;
+
+/// @brief Size of the buffer writes are gathered in before they go to the file.
+static const size_t PACK_BUFFER_SIZE = 0x100000;
+
+/// @brief Set in flags while writing when an entry has been dropped. Never written.
+static const uint32_t ENTRY_DROPPED = 1;
+
+// clang-format off
+/// @brief This is at the beginning of the pack. The data of the first entry follows it.
+typedef struct
+{
+    /// @brief PACK_MAGIC.
+    char magic[8];
+
+    /// @brief PACK_VERSION.
+    uint32_t version;
+
+    /// @brief PACK_BYTE_ORDER.
+    uint32_t byteOrder;
+} PackHeader;
+
+/// @brief One entry in the table.
+typedef struct
+{
+    /// @brief Offset of the data from the beginning of the pack and its size.
+    uint64_t offset;
+    uint64_t size;
+
+    /// @brief Sector the entry came from.
+    uint32_t sector;
+
+    /// @brief Offset of the name in the names that follow the table and its length without the terminator.
+    uint32_t nameOffset;
+    uint32_t nameLength;
+
+    /// @brief Always 0 in a pack. ENTRY_DROPPED while writing.
+    uint32_t flags;
+} PackEntry;
+
+/// @brief This is at the very end of the pack. The table begins at tableOffset and the names follow it.
+typedef struct
+{
+    /// @brief Offset of the table.
+    uint64_t tableOffset;
+
+    /// @brief Number of entries in the table and the size of the names in bytes.
+    uint32_t entryCount;
+    uint32_t namesSize;
+
+    /// @brief PACK_VERSION and PACK_BYTE_ORDER again, so the footer can be checked on its own.
+    uint32_t version;
+    uint32_t byteOrder;
+
+    /// @brief PACK_MAGIC.
+    char magic[8];
+} PackFooter;
+
+struct XenoPackWriter
+{
+    /// @brief Protects everything below.
+    mtx_t lock;
+
+    /// @brief The temporary file and where it's going once it's done.
+    FILE *file;
+    char *path;
+    char *tempPath;
+
+    /// @brief Every entry added so far, dropped or not.
+    DynamicArray *entries;
+
+    /// @brief Every name, each with a terminator.
+    char *names;
+    size_t namesSize;
+    size_t namesCapacity;
+
+    /// @brief Where the next entry goes.
+    uint64_t end;
+
+    /// @brief Writes that follow on from each other are gathered here. It holds the bytes at bufferOffset onward.
+    unsigned char *buffer;
+    uint64_t bufferOffset;
+    size_t bufferLength;
+
+    /// @brief Where the file is positioned, so writes that follow on from each other never seek.
+    uint64_t filePosition;
+
+    /// @brief Set if anything failed. Nothing is written after that.
+    bool failed;
+};
+
+struct XenoPack
+{
+    /// @brief The mapped pack.
+    XenoBackend *backend;
+    const unsigned char *base;
+
+    /// @brief The table and names.
+    const PackEntry *entries;
+    const char *names;
+    uint32_t entryCount;
+};
+// clang-format on
+
+static_assert(sizeof(PackHeader) % 16 == 0, "The first entry needs to be aligned after the header!");
+static_assert(sizeof(PackEntry) == 32, "The table layout changed without bumping PACK_VERSION!");
+static_assert(sizeof(PackFooter) == 32, "The footer layout changed without bumping PACK_VERSION!");
+
+// Writes whatever is buffered to the file.
+static bool flush_buffer(XenoPackWriter *writer);
+
+// Writes straight to the file at an offset.
+static bool write_at(XenoPackWriter *writer, uint64_t offset, const void *data, size_t length);
+
+// Writes the table, names and footer to the end of the file.
+static bool write_table(XenoPackWriter *writer);
+
+// Checks the footer, table and names so a bad pack can never be used.
+static bool validate_pack(const unsigned char *base, uint64_t size);
+
+// Frees everything but the file.
+static void free_writer(XenoPackWriter *writer);
+
+XenoPackWriter *XenoPackWriter_Create(const char *path)
+{
+    XenoPackWriter *writer = calloc(1, sizeof(XenoPackWriter));
+    if (!writer) { return NULL; }
+
+    // The pack is written next to where it's going and renamed so nobody can ever map half of one.
+    const size_t pathLength = strlen(path);
+    writer->path            = malloc(pathLength + 1);
+    writer->tempPath        = malloc(pathLength + 5);
+    writer->entries         = DynamicArray_Create(sizeof(PackEntry), 1024);
+    writer->buffer          = malloc(PACK_BUFFER_SIZE);
+    if (!writer->path || !writer->tempPath || !writer->entries || !writer->buffer ||
+        mtx_init(&writer->lock, mtx_plain) != thrd_success)
+    {
+        free_writer(writer);
+        return NULL;
+    }
+
+    memcpy(writer->path, path, pathLength + 1);
+    memcpy(writer->tempPath, path, pathLength);
+    memcpy(&writer->tempPath[pathLength], ".tmp", 5);
+
+    writer->file = fopen(writer->tempPath, "wb");
+    if (!writer->file)
+    {
+        mtx_destroy(&writer->lock);
+        free_writer(writer);
+        return NULL;
+    }
+
+    // Everything is already gathered into large writes, so stdio's buffer would only be another copy.
+    setvbuf(writer->file, NULL, _IONBF, 0);
+
+    PackHeader header = {.version = PACK_VERSION, .byteOrder = PACK_BYTE_ORDER};
+    memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+
+    memcpy(writer->buffer, &header, sizeof(PackHeader));
+    writer->bufferLength = sizeof(PackHeader);
+    writer->end          = sizeof(PackHeader);
+
+    return writer;
+}
+
+int XenoPackWriter_AddEntry(XenoPackWriter *writer, const char *name, uint32_t sector, uint64_t size)
+{
+    const size_t nameLength = strlen(name);
+    if (nameLength >= UINT32_MAX) { return -1; }
+
+    mtx_lock(&writer->lock);
+
+    int index = -1;
+
+    if (writer->namesSize + nameLength + 1 > writer->namesCapacity)
+    {
+        size_t capacity = writer->namesCapacity ? writer->namesCapacity * 2 : 0x10000;
+        while (capacity < writer->namesSize + nameLength + 1) { capacity *= 2; }
+
+        char *names = realloc(writer->names, capacity);
+        if (!names) { goto Label_cleanup; }
+
+        writer->names         = names;
+        writer->namesCapacity = capacity;
+    }
+
+    PackEntry *entry = DynamicArray_New(writer->entries);
+    if (!entry) { goto Label_cleanup; }
+
+    *entry = (PackEntry){.offset     = writer->end,
+                         .size       = size,
+                         .sector     = sector,
+                         .nameOffset = (uint32_t)writer->namesSize,
+                         .nameLength = (uint32_t)nameLength,
+                         .flags      = 0};
+
+    memcpy(&writer->names[writer->namesSize], name, nameLength + 1);
+    writer->namesSize += nameLength + 1;
+    writer->end        = (writer->end + size + PACK_ALIGNMENT - 1) & ~(PACK_ALIGNMENT - 1);
+
+    index = (int)DynamicArray_GetLength(writer->entries) - 1;
+
+Label_cleanup:
+    mtx_unlock(&writer->lock);
+
+    return index;
+}
+
+bool XenoPackWriter_Write(XenoPackWriter *writer, int index, uint64_t offset, const void *data, size_t length)
+{
+    mtx_lock(&writer->lock);
+
+    bool written = false;
+
+    const PackEntry *entry = DynamicArray_GetElementAt(writer->entries, index);
+    if (writer->failed || !entry || offset > entry->size || length > entry->size - offset) { goto Label_cleanup; }
+
+    const uint64_t position = entry->offset + offset;
+
+    // Padding between entries goes in the buffer too, so entries written in order stay one long run.
+    const uint64_t bufferEnd = writer->bufferOffset + writer->bufferLength;
+    if (position >= bufferEnd && position - bufferEnd < PACK_ALIGNMENT &&
+        writer->bufferLength + (position - bufferEnd) + length <= PACK_BUFFER_SIZE)
+    {
+        memset(&writer->buffer[writer->bufferLength], 0, position - bufferEnd);
+        memcpy(&writer->buffer[writer->bufferLength + (position - bufferEnd)], data, length);
+        writer->bufferLength += (position - bufferEnd) + length;
+        written               = true;
+        goto Label_cleanup;
+    }
+
+    if (!flush_buffer(writer)) { goto Label_cleanup; }
+
+    // Anything too big for the buffer goes straight out. Anything else begins a new run.
+    if (length >= PACK_BUFFER_SIZE) { written = write_at(writer, position, data, length); }
+    else
+    {
+        memcpy(writer->buffer, data, length);
+        writer->bufferOffset = position;
+        writer->bufferLength = length;
+        written              = true;
+    }
+
+Label_cleanup:
+    if (!written) { writer->failed = true; }
+
+    mtx_unlock(&writer->lock);
+
+    return written;
+}
+
+void XenoPackWriter_DropEntry(XenoPackWriter *writer, int index)
+{
+    mtx_lock(&writer->lock);
+
+    PackEntry *entry = DynamicArray_GetElementAt(writer->entries, index);
+    if (entry) { entry->flags |= ENTRY_DROPPED; }
+
+    mtx_unlock(&writer->lock);
+}
+
+bool XenoPackWriter_Close(XenoPackWriter *writer)
+{
+    if (!writer) { return false; }
+
+    bool written = !writer->failed && flush_buffer(writer) && write_table(writer);
+    written      = fclose(writer->file) == 0 && written;
+
+#ifdef _WIN32
+    // rename won't replace an existing file on Windows.
+    if (written) { remove(writer->path); }
+#endif
+
+    written = written && rename(writer->tempPath, writer->path) == 0;
+    if (!written) { remove(writer->tempPath); }
+
+    mtx_destroy(&writer->lock);
+    free_writer(writer);
+
+    return written;
+}
+
+XenoPack *XenoPack_Open(const char *path)
+{
+    XenoBackend *backend = XenoBackend_OpenMmap(path);
+    if (!backend) { return NULL; }
+
+    const uint64_t size       = XenoBackend_GetSize(backend);
+    const unsigned char *base = size <= SIZE_MAX ? XenoBackend_Map(backend, 0, (size_t)size) : NULL;
+    if (!base || !validate_pack(base, size))
+    {
+        XenoBackend_Close(backend);
+        return NULL;
+    }
+
+    XenoPack *pack = malloc(sizeof(XenoPack));
+    if (!pack)
+    {
+        XenoBackend_Close(backend);
+        return NULL;
+    }
+
+    PackFooter footer;
+    memcpy(&footer, &base[size - sizeof(PackFooter)], sizeof(PackFooter));
+
+    pack->backend    = backend;
+    pack->base       = base;
+    pack->entries    = (const PackEntry *)&base[footer.tableOffset];
+    pack->names      = (const char *)&base[footer.tableOffset + (uint64_t)footer.entryCount * sizeof(PackEntry)];
+    pack->entryCount = footer.entryCount;
+
+    return pack;
+}
+
+void XenoPack_Close(XenoPack *pack)
+{
+    if (!pack) { return; }
+
+    XenoBackend_Close(pack->backend);
+    free(pack);
+}
+
+int XenoPack_GetEntryCount(const XenoPack *pack)
+{
+    return (int)pack->entryCount;
+}
+
+bool XenoPack_GetEntry(const XenoPack *pack, int index, XenoPackEntry *entryOut)
+{
+    if (index < 0 || (uint32_t)index >= pack->entryCount) { return false; }
+
+    const PackEntry *entry = &pack->entries[index];
+
+    *entryOut = (XenoPackEntry){.name   = &pack->names[entry->nameOffset],
+                                .data   = &pack->base[entry->offset],
+                                .size   = entry->size,
+                                .sector = entry->sector};
+
+    return true;
+}
+
+int XenoPack_FindEntry(const XenoPack *pack, const char *name)
+{
+    const size_t nameLength = strlen(name);
+
+    for (uint32_t i = 0; i < pack->entryCount; i++)
+    {
+        const PackEntry *entry = &pack->entries[i];
+        if (entry->nameLength == nameLength && memcmp(&pack->names[entry->nameOffset], name, nameLength) == 0)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+static bool flush_buffer(XenoPackWriter *writer)
+{
+    if (writer->bufferLength == 0) { return true; }
+
+    const bool written = write_at(writer, writer->bufferOffset, writer->buffer, writer->bufferLength);
+
+    writer->bufferOffset += writer->bufferLength;
+    writer->bufferLength  = 0;
+
+    return written;
+}
+
+static bool write_at(XenoPackWriter *writer, uint64_t offset, const void *data, size_t length)
+{
+    if (offset != writer->filePosition)
+    {
+#ifdef _WIN32
+        if (_fseeki64(writer->file, (long long)offset, SEEK_SET) != 0) { return false; }
+#else
+        if (fseeko(writer->file, (off_t)offset, SEEK_SET) != 0) { return false; }
+#endif
+    }
+
+    const bool written   = fwrite(data, 1, length, writer->file) == length;
+    writer->filePosition = written ? offset + length : UINT64_MAX;
+
+    return written;
+}
+
+static bool write_table(XenoPackWriter *writer)
+{
+    if (writer->namesSize > UINT32_MAX) { return false; }
+
+    // Dropped entries are left out, so the table is built up in a copy.
+    const size_t entryCount = DynamicArray_GetLength(writer->entries);
+    PackEntry *table        = malloc(sizeof(PackEntry) * (entryCount ? entryCount : 1));
+    if (!table) { return false; }
+
+    uint32_t kept = 0;
+    for (size_t i = 0; i < entryCount; i++)
+    {
+        const PackEntry *entry = DynamicArray_GetElementAt(writer->entries, (int)i);
+        if (entry->flags & ENTRY_DROPPED) { continue; }
+
+        table[kept]       = *entry;
+        table[kept].flags = 0;
+        kept++;
+    }
+
+    PackFooter footer = {.tableOffset = writer->end,
+                         .entryCount  = kept,
+                         .namesSize   = (uint32_t)writer->namesSize,
+                         .version     = PACK_VERSION,
+                         .byteOrder   = PACK_BYTE_ORDER};
+    memcpy(footer.magic, PACK_MAGIC, sizeof(footer.magic));
+
+    // The names of dropped entries are still written. Nothing points at them, and it keeps every offset the same.
+    const size_t tableSize = sizeof(PackEntry) * kept;
+
+    bool written = write_at(writer, writer->end, table, tableSize);
+    written      = written && fwrite(writer->names, 1, writer->namesSize, writer->file) == writer->namesSize;
+    written      = written && fwrite(&footer, 1, sizeof(PackFooter), writer->file) == sizeof(PackFooter);
+
+    free(table);
+
+    return written;
+}
+
+static bool validate_pack(const unsigned char *base, uint64_t size)
+{
+    if (size < sizeof(PackHeader) + sizeof(PackFooter)) { return false; }
+
+    // Nothing in the map is guaranteed to be aligned for these, so they're copied out first.
+    PackHeader header;
+    PackFooter footer;
+    memcpy(&header, base, sizeof(PackHeader));
+    memcpy(&footer, &base[size - sizeof(PackFooter)], sizeof(PackFooter));
+
+    if (memcmp(header.magic, PACK_MAGIC, sizeof(header.magic)) != 0) { return false; }
+    if (memcmp(footer.magic, PACK_MAGIC, sizeof(footer.magic)) != 0) { return false; }
+    if (header.version != PACK_VERSION || footer.version != PACK_VERSION) { return false; }
+    if (header.byteOrder != PACK_BYTE_ORDER || footer.byteOrder != PACK_BYTE_ORDER) { return false; }
+    if (footer.entryCount > INT32_MAX) { return false; }
+
+    // The table has to sit right after the data and the names right before the footer.
+    const uint64_t tableSize = (uint64_t)footer.entryCount * sizeof(PackEntry);
+    if (footer.tableOffset < sizeof(PackHeader) || footer.tableOffset % 8 != 0) { return false; }
+    if (footer.tableOffset > size || size - footer.tableOffset != tableSize + footer.namesSize + sizeof(PackFooter))
+    {
+        return false;
+    }
+
+    const PackEntry *entries = (const PackEntry *)&base[footer.tableOffset];
+    const char *names        = (const char *)&entries[footer.entryCount];
+
+    for (uint32_t i = 0; i < footer.entryCount; i++)
+    {
+        const PackEntry *entry = &entries[i];
+
+        const bool dataFits = entry->offset >= sizeof(PackHeader) && entry->offset <= footer.tableOffset &&
+                              entry->size <= footer.tableOffset - entry->offset;
+        const bool nameFits = entry->nameOffset < footer.namesSize &&
+                              entry->nameLength < footer.namesSize - entry->nameOffset &&
+                              names[entry->nameOffset + entry->nameLength] == '\0';
+        if (!dataFits || !nameFits) { return false; }
+    }
+
+    return true;
+}
+
+static void free_writer(XenoPackWriter *writer)
+{
+    if (writer->entries) { DynamicArray_Free(writer->entries); }
+
+    free(writer->path);
+    free(writer->tempPath);
+    free(writer->names);
+    free(writer->buffer);
+    free(writer);
+}
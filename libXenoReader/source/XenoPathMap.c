@@ -0,0 +1,186 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoReader.h"
+
+#define __XENO_INTERNAL__
+#include "XenoDirInternal.h"
+#include "XenoReaderInternal.h"
+
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Name the CLI gives the root.
+#define ROOT_NAME "DISC_ROOT"
+
+/// @brief Prefixes of the names the CLI gives directories and files.
+#define DIR_PREFIX  "DIR_"
+#define FILE_PREFIX "FILE_"
+
+/// @brief Extension the CLI gives files. It's optional in paths.
+#define FILE_EXTENSION ".bin"
+
+/// @brief Returned by parse_number when a component isn't a number.
+static const int64_t NOT_A_NUMBER = -1;
+
+/// @brief Parent of the root.
+static const uint32_t NO_PARENT = UINT32_MAX;
+
+// clang-format off
+/// @brief One directory in the order the CLI numbers them.
+typedef struct
+{
+    /// @brief Index of the directory in the table.
+    uint32_t tableIndex;
+
+    /// @brief Number of the parent directory.
+    uint32_t parent;
+} NumberedDir;
+
+struct XenoPathMap
+{
+    /// @brief Number of directories. This is the same as the table's.
+    uint32_t dirCount;
+
+    /// @brief Directories indexed by their number.
+    NumberedDir dirs[];
+};
+// clang-format on
+
+// Returns the map, building it if this is the first time.
+static XenoPathMap *get_path_map(XenoReader *reader);
+
+// Numbers the directory and everything under it depth first. This is the same order ExtractPlan walks in.
+static void number_directory(const XenoFsTable *table, XenoPathMap *map, uint32_t tableIndex, uint32_t parent);
+
+// Parses the digits of a path component of length after the prefix. The suffix passed is allowed at the end.
+static int64_t parse_number(const char *component, size_t length, const char *prefix, const char *suffix);
+
+XenoDir *XenoReader_GetDirByNumber(XenoReader *reader, int dirNumber)
+{
+    const XenoPathMap *map = get_path_map(reader);
+    if (!map || dirNumber < 0 || dirNumber >= (int)map->dirCount) { return NULL; }
+
+    return &reader->fsTable->dirs[map->dirs[dirNumber].tableIndex];
+}
+
+XenoFile *XenoReader_FindFile(XenoReader *reader, int dirNumber, int fileNumber)
+{
+    const XenoDir *dir = XenoReader_GetDirByNumber(reader, dirNumber);
+    if (!dir) { return NULL; }
+
+    return XenoDir_GetFileAt(dir, fileNumber - 1);
+}
+
+XenoFile *XenoReader_FindFileByPath(XenoReader *reader, const char *path)
+{
+    const XenoPathMap *map = get_path_map(reader);
+    if (!map || !path) { return NULL; }
+
+    // This stays negative until the first directory is found.
+    int64_t dirNumber = NOT_A_NUMBER;
+    while (*path != '\0')
+    {
+        const size_t length = strcspn(path, "/\\");
+        const char *next    = path[length] != '\0' ? &path[length + 1] : &path[length];
+
+        const int64_t subDirNumber = parse_number(path, length, DIR_PREFIX, "");
+        const int64_t fileNumber   = parse_number(path, length, FILE_PREFIX, FILE_EXTENSION);
+        const bool isRoot          = length == strlen(ROOT_NAME) && strncmp(path, ROOT_NAME, length) == 0;
+
+        if (isRoot) { dirNumber = 0; }
+        else if (subDirNumber != NOT_A_NUMBER)
+        {
+            // Every directory after the first has to be inside of the one before it.
+            if (subDirNumber >= map->dirCount) { return NULL; }
+            if (dirNumber != NOT_A_NUMBER && map->dirs[subDirNumber].parent != dirNumber) { return NULL; }
+
+            dirNumber = subDirNumber;
+        }
+        else if (fileNumber != NOT_A_NUMBER)
+        {
+            // Files have to be last and have to be in a directory.
+            if (dirNumber == NOT_A_NUMBER || *next != '\0' || fileNumber > INT32_MAX) { return NULL; }
+
+            return XenoReader_FindFile(reader, (int)dirNumber, (int)fileNumber);
+        }
+        else if (dirNumber != NOT_A_NUMBER) { return NULL; }
+
+        path = next;
+    }
+
+    // The path ended on a directory.
+    return NULL;
+}
+
+static XenoPathMap *get_path_map(XenoReader *reader)
+{
+    XenoPathMap *map = atomic_load_explicit(&reader->pathMap, memory_order_acquire);
+    if (map) { return map; }
+
+    const XenoFsTable *table = reader->fsTable;
+    map                      = malloc(sizeof(XenoPathMap) + sizeof(NumberedDir) * table->dirCount);
+    if (!map) { return NULL; }
+
+    // The root is always 0.
+    map->dirCount = 0;
+    number_directory(table, map, 0, NO_PARENT);
+
+    // Same as the sector map. If another thread beat us here, use theirs.
+    XenoPathMap *expected = NULL;
+    if (!atomic_compare_exchange_strong_explicit(&reader->pathMap,
+                                                 &expected,
+                                                 map,
+                                                 memory_order_acq_rel,
+                                                 memory_order_acquire))
+    {
+        free(map);
+        map = expected;
+    }
+
+    return map;
+}
+
+static void number_directory(const XenoFsTable *table, XenoPathMap *map, uint32_t tableIndex, uint32_t parent)
+{
+    const uint32_t number    = map->dirCount++;
+    map->dirs[number]        = (NumberedDir){.tableIndex = tableIndex, .parent = parent};
+    const XenoDir *directory = &table->dirs[tableIndex];
+
+    for (uint32_t i = 0; i < directory->subDirCount; i++)
+    {
+        number_directory(table, map, directory->firstSubDir + i, number);
+    }
+}
+
+static int64_t parse_number(const char *component, size_t length, const char *prefix, const char *suffix)
+{
+    const size_t prefixLength = strlen(prefix);
+    const size_t suffixLength = strlen(suffix);
+    if (length <= prefixLength || strncmp(component, prefix, prefixLength) != 0) { return NOT_A_NUMBER; }
+
+    // The suffix is optional.
+    if (length > prefixLength + suffixLength && strncmp(&component[length - suffixLength], suffix, suffixLength) == 0)
+    {
+        length -= suffixLength;
+    }
+
+    // Anything past nine digits is too big to be real and could overflow.
+    if (length - prefixLength > 9) { return NOT_A_NUMBER; }
+
+    int64_t number = 0;
+    for (size_t i = prefixLength; i < length; i++)
+    {
+        if (!isdigit((unsigned char)component[i])) { return NOT_A_NUMBER; }
+        number = number * 10 + (component[i] - '0');
+    }
+
+    return number;
+}
@@ -8,40 +8,27 @@
 
 #include "XenoReader.h"
 
-#include "DynamicArray.h"
 #include "Sector.h"
+#include "SectorGather.h"
 
 #define __XENO_INTERNAL__
+#include "XenoArchiveInternal.h"
 #include "XenoDirInternal.h"
+#include "XenoFileViewInternal.h"
+#include "XenoReaderInternal.h"
+#include "XenoStatsInternal.h"
 
 #include <math.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/stat.h>
 
-// clang-format off
-typedef struct
-{
-    uint32_t sector;
-    int32_t size;
-} FsEntry;
-
-struct XenoReader
-{
-    /// @brief Pointer the the image being read.
-    FILE *image;
-
-    /// @brief Stores the number of sectors the image has.
-    size_t sectorCount;
+/// @brief This is the number of raw sectors the staging buffer can hold. This is about 300KB.
+#define STAGING_SECTOR_COUNT 128
 
-    /// @brief Stores the disc number from allocation verification.
-    int discNumber;
-
-    /// @brief This is the root of the filesystem.
-    XenoDir *root;
-};
-// clang-format on
+/// @brief Reads longer than this skip the cache.
+#define CACHE_MAX_READ_SECTOR_COUNT 256
 
 // The following consts and values are used to verify the image before returning the struct.
 // This is the size of the buffer used to pull strings from sectors to verify the image.
@@ -76,154 +63,270 @@ static const char *DISC_2_STRING = "DS02_XENOGEARS";
 static const int DISC_STRING_LENGTH = 14;
 
 // Defined at bottom.
-static bool read_array_to_directory(XenoDir *dir, DynamicArray *array, int *index);
+static unsigned char *acquire_staging(XenoReader *reader);
+static void release_staging(XenoReader *reader, unsigned char *staging);
 
-XenoReader *XenoReader_Open(const char *path)
+// Reads raw sectors through the cache if there is one and the read is small enough. Everything else goes to the backend.
+static bool read_raw_sectors(XenoReader *reader, size_t firstSector, size_t count, unsigned char *out, bool cacheable);
+
+// Reads one raw sector the same way. Fails if the sector is past the end of the image.
+static bool read_raw_sector_at(XenoReader *reader, size_t sectorNumber, Sector *sectorOut);
+
+// These are the bodies of the public functions with the same names. The library uses these itself so the bytes they
+// read aren't counted as delivered twice.
+static bool read_sector_data(XenoReader *reader, size_t firstSector, size_t count, unsigned char *dataOut);
+static bool read_file_range(XenoReader *reader,
+                            const XenoFile *file,
+                            size_t offset,
+                            size_t length,
+                            unsigned char *dataOut);
+
+XenoFileView *XenoReader_OpenFileView(XenoReader *reader, const XenoFile *file)
 {
-    // This will pretty much
-    struct stat fileStat;
-    if (stat(path, &fileStat) != 0) { return NULL; };
+    if (file->size < 0) { return NULL; }
 
-    // Check the sector count first.
-    const size_t sectorCount = fileStat.st_size / SECTOR_SIZE;
-    if (sectorCount != DISC_1_SECTOR_COUNT && sectorCount != DISC_2_SECTOR_COUNT) { return NULL; }
+    const int sectorCount = (file->size + DATA_SIZE - 1) / DATA_SIZE;
+    if ((size_t)file->sector + sectorCount > reader->sectorCount) { return NULL; }
 
-    // Try to open the image for reading.
-    FILE *image = fopen(path, "rb");
-    if (!image) { goto Label_cleanup; }
+    // The segment array is tacked onto the end of the view so there's only one allocation.
+    XenoFileView *view = malloc(sizeof(XenoFileView) + sizeof(XenoSegment) * sectorCount);
+    if (!view) { return NULL; }
 
-    // This is scoped so that it doesn't hang around in the stack after it's not needed.
-    {
-        // Here, we read the boot sector and check for the XENOGEARS string.
-        Sector bootSector;
-        const bool bootSeek = fseek(image, BOOT_RECORD_SECTOR * SECTOR_SIZE, SEEK_SET) == 0;
-        const bool bootRead = bootSeek && fread(&bootSector, 1, SECTOR_SIZE, image) == SECTOR_SIZE;
-        if (!bootRead) { goto Label_cleanup; }
+    XenoStats_RecordAllocation(&reader->stats, sizeof(XenoFileView) + sizeof(XenoSegment) * sectorCount);
 
-        // This is used to pull and copy the "header(?)" from the boot sector.
-        char headerBuffer[STRING_BUFFER_SIZE] = {0};
+    view->segments     = (XenoSegment *)(view + 1);
+    view->segmentCount = sectorCount;
+    view->size         = file->size;
+    view->staging      = NULL;
 
-        // Copy the string into the buffer and .
-        strncpy(headerBuffer, &bootSector.data[BOOT_RECORD_OFFSET], XENOGEARS_STRING_LENGTH);
+    // Try to point straight into the image first.
+    const uint64_t offset    = (uint64_t)file->sector * SECTOR_SIZE;
+    const size_t rawSize     = (size_t)sectorCount * SECTOR_SIZE;
+    const unsigned char *raw = XenoBackend_Map(reader->backend, offset, rawSize);
+    if (!raw && sectorCount > 0)
+    {
+        // The backend can't map, so the raw sectors are read in one go and the view points into that instead.
+        const bool cacheable = sectorCount <= CACHE_MAX_READ_SECTOR_COUNT;
+        view->staging        = malloc(rawSize);
+        XenoStats_RecordAllocation(&reader->stats, rawSize);
+        if (!view->staging || !read_raw_sectors(reader, file->sector, sectorCount, view->staging, cacheable))
+        {
+            XenoFileView_Free(view);
+            return NULL;
+        }
 
-        const bool isXenogears = strcmp(headerBuffer, BOOT_RECORD_STRING) == 0;
-        if (!isXenogears) { goto Label_cleanup; }
+        raw = view->staging;
     }
 
-    // Same as above. Scoped.
-    bool discOne;
-    bool discTwo;
+    for (int i = 0; i < sectorCount; i++)
     {
-        // Seek to sector 23 and read it to check which disc we're working with for sure.
-        Sector discSector;
-        bool seek             = fseek(image, DISC_IDENTIFICATION_SECTOR * SECTOR_SIZE, SEEK_SET) == 0;
-        const bool sectorRead = seek && fread(&discSector, 1, SECTOR_SIZE, image) == SECTOR_SIZE;
-        if (!sectorRead) { goto Label_cleanup; }
+        const Sector *sector = (const Sector *)&raw[(size_t)i * SECTOR_SIZE];
 
-        // This is used to read the disc identification string in sector 23.
-        char discBuffer[STRING_BUFFER_SIZE] = {0};
+        // The last sector is trimmed to wherever the file ends.
+        const int currentOffset = i * DATA_SIZE;
+        const int dataSize      = file->size - currentOffset < DATA_SIZE ? file->size - currentOffset : DATA_SIZE;
 
-        // Copy the string to our local buffer. Compare that buffer to see what disc we're using.
-        strncpy(discBuffer, discSector.data, DISC_STRING_LENGTH);
-        discOne = strcmp(DISC_1_STRING, discBuffer) == 0;
-        discTwo = strcmp(DISC_2_STRING, discBuffer) == 0;
-        if (!discOne && !discTwo) { goto Label_cleanup; }
+        view->segments[i].data   = sector->data;
+        view->segments[i].length = dataSize;
     }
 
-    // Seek back to the beginning of the image for consistency.
-    const bool beginningSeek = fseek(image, 0, SEEK_SET) == 0;
-    if (!beginningSeek) { goto Label_cleanup; }
+    return view;
+}
 
-    // I wanted all of the validation done before this to make this less of a pain.
-    XenoReader *reader = (XenoReader *)malloc(sizeof(XenoReader));
-    if (!reader) { goto Label_cleanup; }
+XenoReader *XenoReader_Open(const char *path)
+{
+    XenoBackend *backend = XenoReader_OpenImageBackend(path);
+    if (!backend) { return NULL; }
 
-    reader->image       = image;
-    reader->sectorCount = sectorCount;
-    reader->discNumber  = discOne ? 1 : 2;
-    reader->root        = XenoDir_Create();
-    if (!reader->root) { goto Label_cleanup; }
+    XenoReader *reader = XenoReader_OpenWithBackend(backend);
+    if (!reader) { XenoBackend_Close(backend); }
 
-    // Seek to where the filesystem/table is.
-    if (!XenoReader_SeekToSector(reader, 24)) { goto Label_cleanup; }
+    return reader;
+}
+
+XenoReader *XenoReader_OpenWithBackend(XenoBackend *backend)
+{
+    if (!backend) { return NULL; }
 
-    // The table takes up 16 sectors. We're going to buffer them all.
-    const int tableBufferSize  = 16 * DATA_SIZE;
+    // Opening is traced as a whole, verification and all.
+    const uint64_t openBegin = XenoTrace_GetTime();
+
+    int discNumber = 0;
+    if (!XenoReader_VerifyBackend(backend, &discNumber)) { return NULL; }
+
+    // I wanted all of the validation done before this to make this less of a pain.
+    const size_t sectorCount = XenoBackend_GetSize(backend) / SECTOR_SIZE;
+    XenoReader *reader       = XenoReader_Allocate(backend, sectorCount, discNumber);
+    if (!reader) { return NULL; }
+
+    // The table begins at sector 24 and takes up 16 sectors. We're going to buffer them all in one read.
+    const int tableBufferSize  = TABLE_SECTOR_COUNT * DATA_SIZE;
     unsigned char *tableBuffer = malloc(tableBufferSize);
-    for (int i = 0; i < 16; i++)
+    if (!tableBuffer || !read_sector_data(reader, TABLE_SECTOR, TABLE_SECTOR_COUNT, tableBuffer))
     {
-        Sector sector = {0};
-        if (!XenoReader_ReadRawSector(reader, &sector)) { goto Label_cleanup; }
+        goto Label_cleanup;
+    }
+
+    // Build the whole tree in one go. The buffer isn't needed after this.
+    XenoFsTable *fsTable = XenoFsTable_Parse(tableBuffer, tableBufferSize);
+    free(tableBuffer);
+    tableBuffer = NULL;
+
+    if (!XenoReader_AttachTable(reader, fsTable, NULL)) { goto Label_cleanup; }
+
+    if (XenoStats_IsActive(&reader->stats)) { XenoStats_RecordOpen(&reader->stats, openBegin, sectorCount); }
+
+    return reader;
+
+Label_cleanup:
+    if (tableBuffer) { free(tableBuffer); }
+
+    // The backend still belongs to the caller.
+    reader->backend = NULL;
+    XenoReader_Close(reader);
+
+    return NULL;
+}
+
+XenoReader *XenoReader_OpenWritable(const char *path)
+{
+    XenoBackend *backend = XenoBackend_OpenWritable(path);
+    if (!backend) { return NULL; }
+
+    XenoReader *reader = XenoReader_OpenWithBackend(backend);
+    if (!reader) { XenoBackend_Close(backend); }
+
+    return reader;
+}
 
-        // Copy it the the buffer.
-        memcpy(&tableBuffer[i * DATA_SIZE], sector.data, DATA_SIZE);
+XenoBackend *XenoReader_OpenImageBackend(const char *path)
+{
+    // Mapping the image is preferred. If that doesn't work out, fall back to pread and then plain stdio.
+    XenoBackend *backend = XenoBackend_OpenMmap(path);
+    if (!backend) { backend = XenoBackend_OpenFile(path); }
+    if (!backend) { backend = XenoBackend_OpenStdio(path); }
+
+    // Compressed images are wrapped in a backend that decodes them, so everything past here only ever sees sectors.
+    unsigned char magic[8];
+    if (!backend || XenoBackend_GetSize(backend) < sizeof(magic) || !XenoBackend_Read(backend, 0, magic, sizeof(magic)))
+    {
+        return backend;
     }
 
-    // We're going to read all of the entries to this. This initial capacity is to prevent reallocations.
-    DynamicArray *fsArray = DynamicArray_Create(sizeof(FsEntry), 4096);
-    if (!fsArray) { goto Label_cleanup; }
+    XenoBackend *decoded = backend;
+    if (memcmp(magic, "ECM", 4) == 0) { decoded = XenoBackend_OpenEcm(backend); }
+    else if (memcmp(magic, "MComprHD", 8) == 0) { decoded = XenoBackend_OpenChd(backend); }
+
+    if (!decoded) { XenoBackend_Close(backend); }
 
-    for (int i = 0; i < tableBufferSize; i += 7)
+    return decoded;
+}
+
+XenoReader *XenoReader_Allocate(XenoBackend *backend, size_t sectorCount, int discNumber)
+{
+    XenoReader *reader = (XenoReader *)malloc(sizeof(XenoReader));
+    if (!reader) { return NULL; }
+
+    reader->backend       = backend;
+    reader->currentSector = 0;
+    reader->sectorCount   = sectorCount;
+    reader->discNumber    = discNumber;
+    reader->fsTable       = NULL;
+    reader->indexBackend  = NULL;
+    reader->root          = NULL;
+    reader->metadata      = NULL;
+    reader->archives      = NULL;
+    reader->cache         = NULL;
+    reader->staging       = NULL;
+    atomic_init(&reader->sectorMap, NULL);
+    atomic_init(&reader->pathMap, NULL);
+    atomic_flag_clear(&reader->stagingInUse);
+    XenoStats_Init(&reader->stats);
+
+    // The staging buffer is only needed if the backend can't hand out pointers.
+    if (!XenoBackend_Map(backend, 0, SECTOR_SIZE))
     {
-        if (i + 7 > tableBufferSize) { break; }
+        reader->staging = malloc(STAGING_SECTOR_COUNT * SECTOR_SIZE);
+        if (!reader->staging)
+        {
+            free(reader);
+            return NULL;
+        }
+    }
 
-        // What we're reading to.
-        uint32_t sector = 0; // This is actually stored as a 24bit value.
-        int32_t size    = 0;
+    return reader;
+}
 
-        // Positions in the buffer.
-        const void *sectorPosition = &tableBuffer[i];
-        const void *sizePosition   = &tableBuffer[i + 3];
+bool XenoReader_AttachTable(XenoReader *reader, XenoFsTable *fsTable, XenoBackend *indexBackend)
+{
+    reader->fsTable      = fsTable;
+    reader->indexBackend = indexBackend;
+    if (!fsTable) { return false; }
 
-        // Copy them.
-        memcpy(&sector, sectorPosition, 3);
-        memcpy(&size, sizePosition, 4);
-        // If it has no sector, skip it. There are files that have 0 as a size. Not sure what purpose that serves yet.
-        if (sector == 0) { continue; }
+    reader->root     = XenoFsTable_GetRoot(fsTable);
+    reader->metadata = calloc(fsTable->fileCount ? fsTable->fileCount : 1, sizeof(XenoFileMetadata));
+    reader->archives = calloc(fsTable->fileCount ? fsTable->fileCount : 1, sizeof(_Atomic(XenoArchive *)));
 
-        // Add it to our array.
-        FsEntry *entry = (FsEntry *)DynamicArray_New(fsArray);
-        if (!entry) { goto Label_cleanup; }
+    return reader->metadata != NULL && reader->archives != NULL;
+}
 
-        entry->sector = sector;
-        entry->size   = size;
-    }
+bool XenoReader_VerifyBackend(XenoBackend *backend, int *discNumberOut)
+{
+    // Check the sector count first.
+    const size_t sectorCount = XenoBackend_GetSize(backend) / SECTOR_SIZE;
+    if (sectorCount != DISC_1_SECTOR_COUNT && sectorCount != DISC_2_SECTOR_COUNT) { return false; }
 
-    // This isn't needed anymore.
-    free(tableBuffer);
+    // This is scoped so that it doesn't hang around in the stack after it's not needed.
+    {
+        // Here, we read the boot sector and check for the XENOGEARS string.
+        Sector bootSector;
+        const bool bootRead = XenoBackend_Read(backend, BOOT_RECORD_SECTOR * SECTOR_SIZE, &bootSector, SECTOR_SIZE);
+        if (!bootRead) { return false; }
+
+        // This is used to pull and copy the "header(?)" from the boot sector.
+        char headerBuffer[STRING_BUFFER_SIZE] = {0};
+
+        // Copy the string into the buffer and .
+        memcpy(headerBuffer, &bootSector.data[BOOT_RECORD_OFFSET], XENOGEARS_STRING_LENGTH);
+
+        const bool isXenogears = strcmp(headerBuffer, BOOT_RECORD_STRING) == 0;
+        if (!isXenogears) { return false; }
+    }
 
-    // We need to start the root here. The rest are recursive.
-    int index               = 0;
-    const int fsArrayLength = DynamicArray_GetLength(fsArray);
-    while (index < fsArrayLength)
+    // Same as above. Scoped.
     {
-        const FsEntry *entry = (const FsEntry *)DynamicArray_GetElementAt(fsArray, index);
+        // Read sector 23 to check which disc we're working with for sure.
+        Sector discSector;
+        const bool sectorRead =
+            XenoBackend_Read(backend, DISC_IDENTIFICATION_SECTOR * SECTOR_SIZE, &discSector, SECTOR_SIZE);
+        if (!sectorRead) { return false; }
 
-        // Negative size denotes a "directory".
-        if (entry->size < 0) { read_array_to_directory(reader->root, fsArray, &index); }
-        else
-        {
-            // Add a new file.
-            XenoFile *file = (XenoFile *)DynamicArray_New(reader->root->files);
+        // This is used to read the disc identification string in sector 23.
+        char discBuffer[STRING_BUFFER_SIZE] = {0};
 
-            // Assign.
-            file->sector = entry->sector;
-            file->size   = entry->size;
-            ++index;
-        }
+        // Copy the string to our local buffer. Compare that buffer to see what disc we're using.
+        memcpy(discBuffer, discSector.data, DISC_STRING_LENGTH);
+        const bool discOne = strcmp(DISC_1_STRING, discBuffer) == 0;
+        const bool discTwo = strcmp(DISC_2_STRING, discBuffer) == 0;
+        if (!discOne && !discTwo) { return false; }
+
+        *discNumberOut = discOne ? 1 : 2;
     }
 
-    DynamicArray_Free(fsArray);
+    return true;
+}
 
-    return reader;
+bool XenoReader_ReadBackend(XenoReader *reader, size_t firstSector, size_t count, unsigned char *out)
+{
+    const uint64_t offset = (uint64_t)firstSector * SECTOR_SIZE;
+    const size_t size     = count * SECTOR_SIZE;
+    if (!XenoStats_IsActive(&reader->stats)) { return XenoBackend_Read(reader->backend, offset, out, size); }
 
-Label_cleanup:
-    if (tableBuffer) { free(tableBuffer); }
-    if (reader->root) { XenoDir_Free(reader->root, true); }
-    if (reader) { free(reader); }
-    if (image) { fclose(image); }
+    const uint64_t begin = XenoTrace_GetTime();
+    const bool success   = XenoBackend_Read(reader->backend, offset, out, size);
+    XenoStats_RecordSectors(&reader->stats, firstSector, count, begin, XenoTrace_GetTime(), false, success);
 
-    return NULL;
+    return success;
 }
 
 void XenoReader_Close(XenoReader *reader)
@@ -231,20 +334,61 @@ void XenoReader_Close(XenoReader *reader)
     // Bail if NULL is passed.
     if (!reader) { return; }
 
-    // Free the Filesystem tree.
-    if (reader->root) { XenoDir_Free(reader->root, true); }
+    // The archive tables have to go before the filesystem table, since that's where the count is.
+    for (uint32_t i = 0; reader->archives && i < reader->fsTable->fileCount; i++)
+    {
+        XenoArchive_Free(atomic_load(&reader->archives[i]));
+    }
+    free(reader->archives);
+
+    // Free the Filesystem table. If it came from an index, closing the index is enough.
+    if (reader->indexBackend) { XenoBackend_Close(reader->indexBackend); }
+    else if (reader->fsTable) { free(reader->fsTable); }
+
+    if (reader->metadata) { free(reader->metadata); }
+
+    // These are only here if somebody looked a sector or path up.
+    free(atomic_load(&reader->sectorMap));
+    free(atomic_load(&reader->pathMap));
 
-    // Only try to close the file if it's actually open.
-    if (reader->image)
+    if (reader->staging) { free(reader->staging); }
+
+    SectorCache_Free(reader->cache);
+
+    // Close whatever the image is being read through.
+    if (reader->backend)
     {
-        fclose(reader->image);
-        reader->image = NULL;
+        XenoBackend_Close(reader->backend);
+        reader->backend = NULL;
     }
 
     // Free the memory.
     free(reader);
 }
 
+bool XenoReader_EnableCache(XenoReader *reader, size_t budget)
+{
+    if (reader->cache) { return false; }
+
+    // Mapped images don't need this.
+    if (XenoBackend_Map(reader->backend, 0, SECTOR_SIZE)) { return true; }
+
+    reader->cache = SectorCache_Create(budget);
+
+    return reader->cache != NULL;
+}
+
+void XenoReader_GetCacheStats(XenoReader *reader, XenoCacheStats *statsOut)
+{
+    if (!reader->cache)
+    {
+        *statsOut = (XenoCacheStats){0};
+        return;
+    }
+
+    SectorCache_GetStats(reader->cache, statsOut);
+}
+
 int XenoReader_GetDiscNumber(const XenoReader *reader) { return reader->discNumber; }
 
 size_t XenoReader_GetSectorCount(const XenoReader *reader) { return reader->sectorCount; }
@@ -253,19 +397,74 @@ bool XenoReader_SeekToSector(XenoReader *reader, size_t sectorNumber)
 {
     if (sectorNumber >= reader->sectorCount) { return false; }
 
-    return fseek(reader->image, sectorNumber * SECTOR_SIZE, SEEK_SET) == 0;
+    reader->currentSector = sectorNumber;
+
+    return true;
 }
 
 bool XenoReader_ReadRawSector(XenoReader *reader, Sector *sectorOut)
 {
-    return fread(sectorOut, 1, SECTOR_SIZE, reader->image) == SECTOR_SIZE;
+    if (!XenoReader_ReadRawSectorAt(reader, reader->currentSector, sectorOut)) { return false; }
+
+    ++reader->currentSector;
+
+    return true;
+}
+
+bool XenoReader_ReadRawSectorAt(XenoReader *reader, size_t sectorNumber, Sector *sectorOut)
+{
+    if (!read_raw_sector_at(reader, sectorNumber, sectorOut)) { return false; }
+
+    XenoStats_RecordDelivered(&reader->stats, SECTOR_SIZE);
+
+    return true;
 }
 
 XenoDir *XenoReader_GetRootDirectory(XenoReader *reader) { return reader->root; }
 
+uint32_t XenoReader_GetFileCount(const XenoReader *reader) { return reader->fsTable->fileCount; }
+
+XenoFile *XenoReader_GetFileAt(const XenoReader *reader, int index)
+{
+    if (index < 0 || index >= (int)reader->fsTable->fileCount) { return NULL; }
+
+    return &XenoFsTable_GetFiles(reader->fsTable)[index];
+}
+
+XenoFileMetadata *XenoReader_GetFileMetadata(XenoReader *reader, const XenoFile *file)
+{
+    // The file has to come from this reader's table.
+    const XenoFile *files = XenoFsTable_GetFiles(reader->fsTable);
+    if (file < files || file >= files + reader->fsTable->fileCount) { return NULL; }
+
+    return &reader->metadata[file - files];
+}
+
+bool XenoReader_ReadRawSectors(XenoReader *reader, size_t firstSector, size_t count, Sector *sectorsOut)
+{
+    if (firstSector > reader->sectorCount || count > reader->sectorCount - firstSector) { return false; }
+
+    // The Sector struct matches the raw layout exactly, so this can go straight to the output.
+    const bool cacheable = count <= CACHE_MAX_READ_SECTOR_COUNT;
+    if (!read_raw_sectors(reader, firstSector, count, (unsigned char *)sectorsOut, cacheable)) { return false; }
+
+    XenoStats_RecordDelivered(&reader->stats, (uint64_t)count * SECTOR_SIZE);
+
+    return true;
+}
+
+bool XenoReader_ReadSectorData(XenoReader *reader, size_t firstSector, size_t count, unsigned char *dataOut)
+{
+    if (!read_sector_data(reader, firstSector, count, dataOut)) { return false; }
+
+    XenoStats_RecordDelivered(&reader->stats, (uint64_t)count * DATA_SIZE);
+
+    return true;
+}
+
 XenoBuffer *XenoReader_ReadFile(XenoReader *reader, const XenoFile *file)
 {
-    if (!XenoReader_SeekToSector(reader, file->sector)) { goto Label_cleanup; }
+    if (file->size < 0 || file->sector >= reader->sectorCount) { return NULL; }
 
     // Allocate and setup buffer.
     XenoBuffer *buffer = malloc(sizeof(XenoBuffer));
@@ -275,67 +474,176 @@ XenoBuffer *XenoReader_ReadFile(XenoReader *reader, const XenoFile *file)
     if (!buffer->data) { goto Label_cleanup; }
     buffer->size = file->size;
 
-    const int sectorCount = (file->size + DATA_SIZE - 1) / DATA_SIZE;
-
-    for (int i = 0; i < sectorCount; i++)
-    {
-        Sector sector = {0};
-        XenoReader_ReadRawSector(reader, &sector);
-
-        // This is what the offset will be after the next sector is copied.
-        const int currentOffset = i * DATA_SIZE;
-        const int endOffset     = currentOffset + DATA_SIZE;
-        const int dataSize      = endOffset > buffer->size ? buffer->size - currentOffset : DATA_SIZE;
+    XenoStats_RecordAllocation(&reader->stats, sizeof(XenoBuffer));
+    XenoStats_RecordAllocation(&reader->stats, (uint64_t)file->size);
 
-        memcpy(&buffer->data[i * DATA_SIZE], sector.data, dataSize);
-    }
+    if (!XenoReader_ReadFileRange(reader, file, 0, file->size, buffer->data)) { goto Label_cleanup; }
 
     return buffer;
 
 Label_cleanup:
     if (buffer->data) { free(buffer->data); }
-    if (buffer) { free(buffer); }
+    free(buffer);
 
     return NULL;
 }
 
-static bool read_array_to_directory(XenoDir *dir, DynamicArray *array, int *index)
+bool XenoReader_ReadFileRange(XenoReader *reader,
+                              const XenoFile *file,
+                              size_t offset,
+                              size_t length,
+                              unsigned char *dataOut)
+{
+    if (!XenoStats_IsActive(&reader->stats)) { return read_file_range(reader, file, offset, length, dataOut); }
+
+    const uint64_t begin = XenoTrace_GetTime();
+    const bool success   = read_file_range(reader, file, offset, length, dataOut);
+    XenoStats_RecordFileRead(&reader->stats, file->sector, offset, length, begin, success);
+
+    return success;
+}
+
+static bool read_file_range(XenoReader *reader,
+                            const XenoFile *file,
+                            size_t offset,
+                            size_t length,
+                            unsigned char *dataOut)
+{
+    if (file->size < 0 || offset > (size_t)file->size || length > (size_t)file->size - offset) { return false; }
+    if (length == 0) { return true; }
+
+    // Begin at the first sector that has part of the range in it.
+    size_t sector       = file->sector + offset / DATA_SIZE;
+    size_t sectorOffset = offset % DATA_SIZE;
+    Sector rawSector;
+
+    // If the range begins partway into a sector or is smaller than one, only part of this sector is wanted.
+    if (sectorOffset > 0 || length < DATA_SIZE)
+    {
+        const size_t copySize = DATA_SIZE - sectorOffset < length ? DATA_SIZE - sectorOffset : length;
+        if (!read_raw_sector_at(reader, sector++, &rawSector)) { return false; }
+
+        memcpy(dataOut, &rawSector.data[sectorOffset], copySize);
+        dataOut += copySize;
+        length -= copySize;
+        sectorOffset = 0;
+    }
+
+    // Every whole sector in the middle goes straight to the caller's buffer.
+    const size_t fullSectors = length / DATA_SIZE;
+    if (fullSectors > 0 && !read_sector_data(reader, sector, fullSectors, dataOut)) { return false; }
+
+    dataOut += fullSectors * DATA_SIZE;
+    length -= fullSectors * DATA_SIZE;
+    sector += fullSectors;
+
+    // Whatever is left is the beginning of the last sector.
+    if (length > 0)
+    {
+        if (!read_raw_sector_at(reader, sector, &rawSector)) { return false; }
+
+        memcpy(dataOut, rawSector.data, length);
+    }
+
+    return true;
+}
+
+static bool read_raw_sector_at(XenoReader *reader, size_t sectorNumber, Sector *sectorOut)
+{
+    if (sectorNumber >= reader->sectorCount) { return false; }
+
+    return read_raw_sectors(reader, sectorNumber, 1, (unsigned char *)sectorOut, true);
+}
+
+static bool read_sector_data(XenoReader *reader, size_t firstSector, size_t count, unsigned char *dataOut)
 {
-    // Grab the entry and ensure it's an array.
-    const FsEntry *entry = (const FsEntry *)DynamicArray_GetElementAt(array, *index);
-    if (entry->size >= 0) { return false; }
+    if (firstSector > reader->sectorCount || count > reader->sectorCount - firstSector) { return false; }
+
+    // If the image is in memory, the data can be gathered straight from it.
+    const uint64_t offset    = (uint64_t)firstSector * SECTOR_SIZE;
+    const unsigned char *raw = XenoBackend_Map(reader->backend, offset, count * SECTOR_SIZE);
+    if (raw)
+    {
+        if (!XenoStats_IsActive(&reader->stats))
+        {
+            SectorGather_Payloads(dataOut, raw, count);
+            return true;
+        }
 
-    // Increment the index and invert the size to get the total entries.
-    ++*index;
-    const int entryCount = -(entry->size);
+        const uint64_t begin = XenoTrace_GetTime();
+        SectorGather_Payloads(dataOut, raw, count);
+        XenoStats_RecordSectors(&reader->stats, firstSector, count, begin, XenoTrace_GetTime(), true, true);
 
-    // Calculate where the end of the directory is.
-    const int directoryEnd = *index + entryCount;
+        return true;
+    }
 
-    // Add the new subDir to the incoming dir since directory is confirmed.
-    XenoDir *subDir = (XenoDir *)DynamicArray_New(dir->subDirs);
-    subDir->subDirs = DynamicArray_Create(sizeof(XenoDir), 32);
-    subDir->files   = DynamicArray_Create(sizeof(XenoFile), 32);
+    unsigned char *staging = acquire_staging(reader);
+    if (!staging) { return false; }
 
-    // Loop. This is recursive.
-    for (; *index < directoryEnd;)
+    // Otherwise, read as many sectors as the staging buffer holds at a time and gather from there.
+    const bool cacheable = count <= CACHE_MAX_READ_SECTOR_COUNT;
+    bool success         = true;
+    for (size_t i = 0; success && i < count; i += STAGING_SECTOR_COUNT)
     {
-        const FsEntry *subEntry = (const FsEntry *)DynamicArray_GetElementAt(array, *index);
+        const size_t batchCount = count - i < STAGING_SECTOR_COUNT ? count - i : STAGING_SECTOR_COUNT;
+        success                 = read_raw_sectors(reader, firstSector + i, batchCount, staging, cacheable);
+        if (!success) { break; }
+
+        const bool active    = XenoStats_IsActive(&reader->stats);
+        const uint64_t begin = active ? XenoTrace_GetTime() : 0;
+        SectorGather_Payloads(&dataOut[i * DATA_SIZE], staging, batchCount);
+        if (active) { XenoStats_RecordCopy(&reader->stats, begin, XenoTrace_GetTime()); }
+    }
+
+    release_staging(reader, staging);
+
+    return success;
+}
+
+static unsigned char *acquire_staging(XenoReader *reader)
+{
+    // Whoever gets the flag first gets the reader's buffer. Everyone else gets their own for the length of the read.
+    const bool available = reader->staging && !atomic_flag_test_and_set_explicit(&reader->stagingInUse,
+                                                                                  memory_order_acquire);
+    if (available) { return reader->staging; }
 
-        // Same as above.
-        if (subEntry->size < 0 && !read_array_to_directory(subDir, array, index)) { return false; }
-        else
+    XenoStats_RecordAllocation(&reader->stats, STAGING_SECTOR_COUNT * SECTOR_SIZE);
+
+    return malloc(STAGING_SECTOR_COUNT * SECTOR_SIZE);
+}
+
+static void release_staging(XenoReader *reader, unsigned char *staging)
+{
+    if (staging == reader->staging) { atomic_flag_clear_explicit(&reader->stagingInUse, memory_order_release); }
+    else { free(staging); }
+}
+
+static bool read_raw_sectors(XenoReader *reader, size_t firstSector, size_t count, unsigned char *out, bool cacheable)
+{
+    if (!reader->cache || !cacheable) { return XenoReader_ReadBackend(reader, firstSector, count, out); }
+
+    // Hits are copied out one at a time. Runs of misses between them are read from the backend in one go.
+    size_t missBegin = count;
+    for (size_t i = 0; i <= count; i++)
+    {
+        const bool hit = i < count && SectorCache_Get(reader->cache, firstSector + i, &out[i * SECTOR_SIZE]);
+        if (i < count && !hit)
         {
-            // Create new file entry.
-            XenoFile *file = (XenoFile *)DynamicArray_New(subDir->files);
+            if (missBegin == count) { missBegin = i; }
+            continue;
+        }
 
-            // Copy the array values to the new file.
-            file->sector = subEntry->sector;
-            file->size   = subEntry->size;
+        if (missBegin == count) { continue; }
 
-            // Increment index.
-            ++*index;
+        unsigned char *missOut = &out[missBegin * SECTOR_SIZE];
+        if (!XenoReader_ReadBackend(reader, firstSector + missBegin, i - missBegin, missOut)) { return false; }
+
+        for (size_t j = missBegin; j < i; j++)
+        {
+            SectorCache_Put(reader->cache, firstSector + j, &out[j * SECTOR_SIZE]);
         }
+
+        missBegin = count;
     }
 
     return true;
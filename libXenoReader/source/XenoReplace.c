@@ -0,0 +1,317 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoReplace.h"
+
+#include "Sector.h"
+#include "SectorEcc.h"
+#include "ThreadPool.h"
+
+#define __XENO_INTERNAL__
+#include "XenoArchiveInternal.h"
+#include "XenoFileInternal.h"
+#include "XenoReaderInternal.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Number of sectors each task rewrites. Files bigger than this are split between tasks.
+#define RUN_SECTOR_COUNT 256
+
+// clang-format off
+/// @brief A run of sectors of one file to rewrite.
+typedef struct
+{
+    /// @brief Reader to write through.
+    XenoReader *reader;
+
+    /// @brief First sector of the run.
+    size_t firstSector;
+
+    /// @brief Number of sectors in the run.
+    size_t count;
+
+    /// @brief New data for the run and its size. The last sector of a file can be partial.
+    const unsigned char *data;
+    size_t size;
+
+    /// @brief Set if anything went wrong.
+    bool failed;
+} ReplaceRun;
+// clang-format on
+
+// Returns the number of sectors that hold size bytes.
+static size_t get_sector_count(size_t size);
+
+// Returns the number of sectors a replacement touches. That's whichever is more of what the file has now and what
+// it's going to have.
+static size_t get_extent(const XenoReplacement *replacement);
+
+// Checks the replacements don't overlap. Sorts the replacements passed by sector along the way.
+static bool check_overlaps(const XenoReplacement **order, int count);
+
+// Sets the size of the table entry the file was read from. Fails if the entry isn't the file anymore.
+static bool update_table(unsigned char *table, uint32_t tableIndex, const XenoFile *file, int32_t size);
+
+// Rewrites a run of sectors. This is the thread pool task.
+static void replace_run(void *argument);
+
+// Reads the table of contents as raw sectors and packs its data into one buffer.
+static bool read_table(XenoReader *reader, unsigned char *rawOut, unsigned char *tableOut);
+
+// Copies the table back into its raw sectors and writes the ones that changed.
+static bool write_table(XenoReader *reader, unsigned char *raw, const unsigned char *table);
+
+// Compares two replacements by the sector of their file.
+static int compare_replacements(const void *a, const void *b);
+
+bool XenoReader_ReplaceFile(XenoReader *reader, const XenoFile *file, const void *data, size_t size)
+{
+    const XenoReplacement replacement = {.file = file, .data = data, .size = size};
+
+    return XenoReader_ReplaceFiles(reader, &replacement, 1, 1);
+}
+
+bool XenoReader_ReplaceFiles(XenoReader *reader, const XenoReplacement *replacements, int count, int threadCount)
+{
+    // The table has to be writable too, which it isn't when it's mapped from an index.
+    if (count <= 0 || !XenoBackend_IsWritable(reader->backend) || reader->indexBackend) { return count == 0; }
+
+    const XenoFile *files = XenoFsTable_GetFiles(reader->fsTable);
+    const size_t rawSize  = TABLE_SECTOR_COUNT * SECTOR_SIZE;
+    const size_t dataSize = TABLE_SECTOR_COUNT * DATA_SIZE;
+
+    const uint32_t fileCount      = reader->fsTable->fileCount;
+    const XenoReplacement **order = malloc(sizeof(XenoReplacement *) * count);
+    unsigned char *raw            = malloc(rawSize + dataSize);
+    unsigned char *table          = raw ? &raw[rawSize] : NULL;
+    uint32_t *tableIndices        = malloc(sizeof(uint32_t) * (fileCount ? fileCount : 1));
+    ReplaceRun *runs              = NULL;
+    size_t runCount               = 0;
+    bool success                  = false;
+    if (!order || !raw || !tableIndices || !read_table(reader, raw, table)) { goto Label_cleanup; }
+
+    // Entries are found by where they sit in the table. Entries at the same sector are separate files even if their
+    // sizes match, so only the one a file was read from is ever changed.
+    if (!XenoFsTable_GetTableIndices(table, dataSize, fileCount, tableIndices)) { goto Label_cleanup; }
+
+    // Every replacement is checked and its table entries are changed in memory before anything touches the image.
+    for (int i = 0; i < count; i++)
+    {
+        const XenoReplacement *replacement = &replacements[i];
+        const XenoFile *file               = replacement->file;
+        if (file < files || file >= files + fileCount) { goto Label_cleanup; }
+
+        const size_t sectorCount = get_sector_count(replacement->size);
+        if (replacement->size > XenoFile_GetCapacity(file) || replacement->size > INT32_MAX ||
+            (replacement->size > 0 && !replacement->data) || file->sector + sectorCount > reader->sectorCount)
+        {
+            goto Label_cleanup;
+        }
+
+        if (!update_table(table, tableIndices[file - files], file, (int32_t)replacement->size)) { goto Label_cleanup; }
+
+        order[i] = replacement;
+        runCount += (sectorCount + RUN_SECTOR_COUNT - 1) / RUN_SECTOR_COUNT;
+    }
+
+    if (!check_overlaps(order, count)) { goto Label_cleanup; }
+
+    runs = calloc(runCount ? runCount : 1, sizeof(ReplaceRun));
+    if (!runs) { goto Label_cleanup; }
+
+    // Files are split into runs in sector order, so the writes sweep forward across the image.
+    size_t runIndex = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const XenoReplacement *replacement = order[i];
+        const size_t sectorCount           = get_sector_count(replacement->size);
+        for (size_t sector = 0; sector < sectorCount; sector += RUN_SECTOR_COUNT)
+        {
+            const size_t offset = sector * DATA_SIZE;
+            ReplaceRun *run     = &runs[runIndex++];
+            run->reader         = reader;
+            run->firstSector    = replacement->file->sector + sector;
+            run->count          = sectorCount - sector < RUN_SECTOR_COUNT ? sectorCount - sector : RUN_SECTOR_COUNT;
+            run->data           = (const unsigned char *)replacement->data + offset;
+            run->size           = replacement->size - offset < run->count * DATA_SIZE ? replacement->size - offset
+                                                                                      : run->count * DATA_SIZE;
+        }
+    }
+
+    // A single run isn't worth starting threads for.
+    ThreadPool *pool = runCount > 1 ? ThreadPool_Create(threadCount) : NULL;
+    for (size_t i = 0; i < runCount; i++)
+    {
+        if (!pool || !ThreadPool_Submit(pool, replace_run, &runs[i])) { replace_run(&runs[i]); }
+    }
+    if (pool) { ThreadPool_Free(pool); }
+
+    for (size_t i = 0; i < runCount; i++)
+    {
+        if (runs[i].failed) { goto Label_cleanup; }
+    }
+
+    if (!write_table(reader, raw, table)) { goto Label_cleanup; }
+
+    // The files in memory need to match the table now.
+    for (int i = 0; i < count; i++)
+    {
+        XenoFile *replaced    = (XenoFile *)replacements[i].file;
+        const uint32_t sector = replaced->sector;
+        replaced->size        = (int32_t)replacements[i].size;
+
+        // Archive tables of anything at the same sector are stale now. They're parsed again when next asked for.
+        for (uint32_t j = 0; j < fileCount; j++)
+        {
+            if (files[j].sector == sector) { XenoArchive_Free(atomic_exchange(&reader->archives[j], NULL)); }
+        }
+    }
+
+    // Sizes changed, so the sector map is rebuilt by whoever needs it next.
+    free(atomic_exchange(&reader->sectorMap, NULL));
+
+    success = true;
+
+Label_cleanup:
+    free(runs);
+    free(tableIndices);
+    free(raw);
+    free(order);
+
+    return success;
+}
+
+static size_t get_sector_count(size_t size) { return (size + DATA_SIZE - 1) / DATA_SIZE; }
+
+static size_t get_extent(const XenoReplacement *replacement)
+{
+    const size_t oldCount = get_sector_count((size_t)replacement->file->size);
+    const size_t newCount = get_sector_count(replacement->size);
+
+    return oldCount > newCount ? oldCount : newCount;
+}
+
+static bool check_overlaps(const XenoReplacement **order, int count)
+{
+    qsort(order, count, sizeof(XenoReplacement *), compare_replacements);
+
+    // Once sorted, anything that overlaps has to start before the furthest end so far. Two files starting at the same
+    // sector always overlap, even if both are empty, since they're aliases of the same data.
+    size_t end = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const XenoReplacement *current = order[i];
+        if (i > 0 && (order[i - 1]->file->sector == current->file->sector || end > current->file->sector))
+        {
+            return false;
+        }
+
+        const size_t currentEnd = current->file->sector + get_extent(current);
+        if (currentEnd > end) { end = currentEnd; }
+    }
+
+    return true;
+}
+
+static bool update_table(unsigned char *table, uint32_t tableIndex, const XenoFile *file, int32_t size)
+{
+    const size_t offset = (size_t)tableIndex * TABLE_ENTRY_SIZE;
+    if (offset + TABLE_ENTRY_SIZE > TABLE_SECTOR_COUNT * DATA_SIZE) { return false; }
+
+    // The table read now is the one the reader was opened with, unless something else wrote to the image since.
+    uint32_t sector   = 0;
+    int32_t entrySize = 0;
+    memcpy(&sector, &table[offset], 3);
+    memcpy(&entrySize, &table[offset + 3], 4);
+    if (sector != file->sector || entrySize != file->size) { return false; }
+
+    memcpy(&table[offset + 3], &size, 4);
+
+    return true;
+}
+
+static void replace_run(void *argument)
+{
+    ReplaceRun *run = (ReplaceRun *)argument;
+
+    const uint64_t offset = (uint64_t)run->firstSector * SECTOR_SIZE;
+    const size_t size     = run->count * SECTOR_SIZE;
+    unsigned char *buffer = malloc(size);
+    if (!buffer || !XenoBackend_Read(run->reader->backend, offset, buffer, size))
+    {
+        run->failed = true;
+        free(buffer);
+        return;
+    }
+
+    // Only the data changes. Whatever was past the end of the old file in the last sector stays.
+    for (size_t i = 0; i < run->count; i++)
+    {
+        unsigned char *sector = &buffer[i * SECTOR_SIZE];
+        const size_t copied   = i * DATA_SIZE;
+        const size_t length   = run->size - copied < DATA_SIZE ? run->size - copied : DATA_SIZE;
+        memcpy(&sector[offsetof(Sector, data)], &run->data[copied], length);
+
+        if (!SectorEcc_Generate(sector)) { run->failed = true; }
+    }
+
+    if (!run->failed && !XenoBackend_Write(run->reader->backend, offset, buffer, size)) { run->failed = true; }
+
+    // Anything cached has to match what was written.
+    for (size_t i = 0; !run->failed && run->reader->cache && i < run->count; i++)
+    {
+        SectorCache_Update(run->reader->cache, (uint32_t)(run->firstSector + i), &buffer[i * SECTOR_SIZE]);
+    }
+
+    free(buffer);
+}
+
+static bool read_table(XenoReader *reader, unsigned char *rawOut, unsigned char *tableOut)
+{
+    const uint64_t offset = (uint64_t)TABLE_SECTOR * SECTOR_SIZE;
+    if (!XenoBackend_Read(reader->backend, offset, rawOut, TABLE_SECTOR_COUNT * SECTOR_SIZE)) { return false; }
+
+    for (size_t i = 0; i < TABLE_SECTOR_COUNT; i++)
+    {
+        memcpy(&tableOut[i * DATA_SIZE], &rawOut[i * SECTOR_SIZE + offsetof(Sector, data)], DATA_SIZE);
+    }
+
+    return true;
+}
+
+static bool write_table(XenoReader *reader, unsigned char *raw, const unsigned char *table)
+{
+    // Entries can straddle two sectors, so this goes by what changed instead of by entry.
+    for (size_t i = 0; i < TABLE_SECTOR_COUNT; i++)
+    {
+        unsigned char *sector = &raw[i * SECTOR_SIZE];
+        unsigned char *data   = &sector[offsetof(Sector, data)];
+        if (memcmp(data, &table[i * DATA_SIZE], DATA_SIZE) == 0) { continue; }
+
+        memcpy(data, &table[i * DATA_SIZE], DATA_SIZE);
+        if (!SectorEcc_Generate(sector)) { return false; }
+
+        const uint64_t offset = (uint64_t)(TABLE_SECTOR + i) * SECTOR_SIZE;
+        if (!XenoBackend_Write(reader->backend, offset, sector, SECTOR_SIZE)) { return false; }
+        if (reader->cache) { SectorCache_Update(reader->cache, (uint32_t)(TABLE_SECTOR + i), sector); }
+    }
+
+    return true;
+}
+
+static int compare_replacements(const void *a, const void *b)
+{
+    const XenoFile *fileA = (*(const XenoReplacement *const *)a)->file;
+    const XenoFile *fileB = (*(const XenoReplacement *const *)b)->file;
+
+    if (fileA->sector != fileB->sector) { return fileA->sector < fileB->sector ? -1 : 1; }
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "Sector.h"
+#include "XenoReader.h"
+
+#define __XENO_INTERNAL__
+#include "XenoDirInternal.h"
+#include "XenoReaderInternal.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// clang-format off
+/// @brief Sectors claimed by one file.
+typedef struct
+{
+    /// @brief First sector of the file.
+    uint32_t firstSector;
+
+    /// @brief Sector after the last sector of the file.
+    uint32_t endSector;
+
+    /// @brief Largest endSector of this and every interval before it. Lets lookups stop walking back over overlaps.
+    uint32_t maxEndSector;
+
+    /// @brief Index of the file in the table.
+    uint32_t fileIndex;
+} SectorInterval;
+
+struct XenoSectorMap
+{
+    /// @brief Number of intervals.
+    uint32_t intervalCount;
+
+    /// @brief Number of unclaimed runs.
+    uint32_t unclaimedCount;
+
+    /// @brief Points right after the intervals in the same allocation.
+    XenoSectorRange *unclaimed;
+
+    /// @brief Intervals sorted by first sector.
+    SectorInterval intervals[];
+};
+// clang-format on
+
+// Returns the map, building it if this is the first time.
+static XenoSectorMap *get_sector_map(XenoReader *reader);
+
+// Builds the map from the reader's table.
+static XenoSectorMap *build_sector_map(const XenoReader *reader);
+
+// qsort function for intervals.
+static int compare_intervals(const void *a, const void *b);
+
+XenoFile *XenoReader_FindFileBySector(XenoReader *reader, uint32_t sector)
+{
+    const XenoSectorMap *map = get_sector_map(reader);
+    if (!map) { return NULL; }
+
+    // Find the first interval that begins after the sector.
+    uint32_t low  = 0;
+    uint32_t high = map->intervalCount;
+    while (low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2;
+        if (map->intervals[middle].firstSector <= sector) { low = middle + 1; }
+        else { high = middle; }
+    }
+
+    // Walk back until nothing before can reach the sector. Without overlapping files this is one step.
+    for (uint32_t i = low; i > 0 && map->intervals[i - 1].maxEndSector > sector; i--)
+    {
+        const SectorInterval *interval = &map->intervals[i - 1];
+        if (sector < interval->endSector) { return XenoReader_GetFileAt(reader, (int)interval->fileIndex); }
+    }
+
+    return NULL;
+}
+
+int XenoReader_GetUnclaimedRangeCount(XenoReader *reader)
+{
+    const XenoSectorMap *map = get_sector_map(reader);
+
+    return map ? (int)map->unclaimedCount : 0;
+}
+
+bool XenoReader_GetUnclaimedRangeAt(XenoReader *reader, int index, XenoSectorRange *rangeOut)
+{
+    const XenoSectorMap *map = get_sector_map(reader);
+    if (!map || index < 0 || index >= (int)map->unclaimedCount) { return false; }
+
+    *rangeOut = map->unclaimed[index];
+
+    return true;
+}
+
+static XenoSectorMap *get_sector_map(XenoReader *reader)
+{
+    XenoSectorMap *map = atomic_load_explicit(&reader->sectorMap, memory_order_acquire);
+    if (map) { return map; }
+
+    // Threads can race here. Everyone builds the same thing, so whoever gets there first wins.
+    map                     = build_sector_map(reader);
+    XenoSectorMap *expected = NULL;
+    if (map && !atomic_compare_exchange_strong_explicit(&reader->sectorMap,
+                                                        &expected,
+                                                        map,
+                                                        memory_order_acq_rel,
+                                                        memory_order_acquire))
+    {
+        free(map);
+        map = expected;
+    }
+
+    return map;
+}
+
+static XenoSectorMap *build_sector_map(const XenoReader *reader)
+{
+    const uint32_t fileCount = reader->fsTable->fileCount;
+    const XenoFile *files    = XenoFsTable_GetFiles(reader->fsTable);
+
+    // Every file can add one gap before it and there's one after the last file.
+    const size_t intervalsSize = sizeof(SectorInterval) * fileCount;
+    const size_t unclaimedSize = sizeof(XenoSectorRange) * (fileCount + 1);
+    XenoSectorMap *map         = malloc(sizeof(XenoSectorMap) + intervalsSize + unclaimedSize);
+    if (!map) { return NULL; }
+
+    map->intervalCount  = 0;
+    map->unclaimedCount = 0;
+    map->unclaimed      = (XenoSectorRange *)((unsigned char *)map->intervals + intervalsSize);
+
+    const uint64_t sectorCount = reader->sectorCount;
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        // Padding entries and empty files don't own anything.
+        const uint64_t firstSector = files[i].sector;
+        const uint64_t fileSectors = ((uint64_t)(files[i].size > 0 ? files[i].size : 0) + DATA_SIZE - 1) / DATA_SIZE;
+        if (firstSector >= sectorCount || fileSectors == 0) { continue; }
+
+        const uint64_t endSector = firstSector + fileSectors;
+
+        SectorInterval *interval = &map->intervals[map->intervalCount++];
+        interval->firstSector    = (uint32_t)firstSector;
+        interval->endSector      = (uint32_t)(endSector > sectorCount ? sectorCount : endSector);
+        interval->fileIndex      = i;
+    }
+
+    qsort(map->intervals, map->intervalCount, sizeof(SectorInterval), compare_intervals);
+
+    // One pass fills in the running maximum and records the gaps.
+    uint32_t maxEndSector = 0;
+    for (uint32_t i = 0; i < map->intervalCount; i++)
+    {
+        SectorInterval *interval = &map->intervals[i];
+        if (interval->firstSector > maxEndSector)
+        {
+            map->unclaimed[map->unclaimedCount++] =
+                (XenoSectorRange){.firstSector = maxEndSector, .sectorCount = interval->firstSector - maxEndSector};
+        }
+
+        if (interval->endSector > maxEndSector) { maxEndSector = interval->endSector; }
+        interval->maxEndSector = maxEndSector;
+    }
+
+    if (maxEndSector < sectorCount)
+    {
+        map->unclaimed[map->unclaimedCount++] =
+            (XenoSectorRange){.firstSector = maxEndSector, .sectorCount = (uint32_t)sectorCount - maxEndSector};
+    }
+
+    return map;
+}
+
+static int compare_intervals(const void *a, const void *b)
+{
+    const SectorInterval *intervalA = (const SectorInterval *)a;
+    const SectorInterval *intervalB = (const SectorInterval *)b;
+
+    // Ties are broken by the file index so the order is the same no matter how qsort feels.
+    if (intervalA->firstSector != intervalB->firstSector)
+    {
+        return intervalA->firstSector < intervalB->firstSector ? -1 : 1;
+    }
+
+    return (intervalA->fileIndex > intervalB->fileIndex) - (intervalA->fileIndex < intervalB->fileIndex);
+}
@@ -0,0 +1,202 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoStats.h"
+
+#define __XENO_INTERNAL__
+#include "XenoReaderInternal.h"
+#include "XenoStatsInternal.h"
+
+#include <time.h>
+
+/// @brief What readers begin with. These are set by passing NULL for the reader.
+static atomic_bool defaultEnabled             = false;
+static XenoTraceCallback defaultTraceCallback = NULL;
+static void *defaultTraceUserData             = NULL;
+
+static void trace(XenoStatsState *state, const XenoTraceEvent *event);
+
+/// @brief Shorthand for the relaxed adds everything uses. Nothing orders anything else by these.
+static inline void add(atomic_uint_fast64_t *counter, uint64_t value)
+{
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+/// @brief Shorthand for reading a counter.
+static inline uint64_t load(atomic_uint_fast64_t *counter)
+{
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+void XenoReader_EnableStats(XenoReader *reader, bool enabled)
+{
+    atomic_store_explicit(reader ? &reader->stats.enabled : &defaultEnabled, enabled, memory_order_relaxed);
+}
+
+void XenoReader_GetStats(XenoReader *reader, XenoReaderStats *statsOut)
+{
+    XenoStatsState *state = &reader->stats;
+
+    *statsOut = (XenoReaderStats){.readCalls       = load(&state->readCalls),
+                                  .seekCount       = load(&state->seekCount),
+                                  .sectorsRead     = load(&state->sectorsRead),
+                                  .bytesRead       = load(&state->bytesRead),
+                                  .bytesDelivered  = load(&state->bytesDelivered),
+                                  .allocationCount = load(&state->allocationCount),
+                                  .allocationBytes = load(&state->allocationBytes),
+                                  .ioNanoseconds   = load(&state->ioNanoseconds),
+                                  .copyNanoseconds = load(&state->copyNanoseconds)};
+
+    // The cache already counts its own hits.
+    if (reader->cache)
+    {
+        XenoCacheStats cacheStats;
+        SectorCache_GetStats(reader->cache, &cacheStats);
+        statsOut->cacheHits = cacheStats.hits;
+    }
+}
+
+void XenoReader_ResetStats(XenoReader *reader)
+{
+    XenoStatsState *state = &reader->stats;
+
+    atomic_uint_fast64_t *counters[] = {&state->readCalls,       &state->seekCount,       &state->sectorsRead,
+                                        &state->bytesRead,       &state->bytesDelivered,  &state->allocationCount,
+                                        &state->allocationBytes, &state->ioNanoseconds,   &state->copyNanoseconds};
+    for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+    {
+        atomic_store_explicit(counters[i], 0, memory_order_relaxed);
+    }
+}
+
+void XenoReader_SetTraceCallback(XenoReader *reader, XenoTraceCallback callback, void *userData)
+{
+    if (!reader)
+    {
+        defaultTraceCallback = callback;
+        defaultTraceUserData = userData;
+        return;
+    }
+
+    reader->stats.traceCallback = callback;
+    reader->stats.traceUserData = userData;
+}
+
+uint64_t XenoTrace_GetTime(void)
+{
+    // C23 has a monotonic base, but it's optional. The wall clock is still good for anything that doesn't span a
+    // clock change.
+    struct timespec now;
+#ifdef TIME_MONOTONIC
+    timespec_get(&now, TIME_MONOTONIC);
+#else
+    timespec_get(&now, TIME_UTC);
+#endif
+
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+void XenoStats_Init(XenoStatsState *state)
+{
+    atomic_init(&state->enabled, atomic_load_explicit(&defaultEnabled, memory_order_relaxed));
+    state->traceCallback = defaultTraceCallback;
+    state->traceUserData = defaultTraceUserData;
+    atomic_init(&state->nextSector, 0);
+
+    atomic_init(&state->readCalls, 0);
+    atomic_init(&state->seekCount, 0);
+    atomic_init(&state->sectorsRead, 0);
+    atomic_init(&state->bytesRead, 0);
+    atomic_init(&state->bytesDelivered, 0);
+    atomic_init(&state->allocationCount, 0);
+    atomic_init(&state->allocationBytes, 0);
+    atomic_init(&state->ioNanoseconds, 0);
+    atomic_init(&state->copyNanoseconds, 0);
+}
+
+void XenoStats_RecordOpen(XenoStatsState *state, uint64_t begin, size_t sectorCount)
+{
+    const XenoTraceEvent event = {.type        = XENO_TRACE_OPEN,
+                                  .begin       = begin,
+                                  .end         = XenoTrace_GetTime(),
+                                  .firstSector = 0,
+                                  .sectorCount = (uint32_t)sectorCount,
+                                  .bytes       = (uint64_t)sectorCount * SECTOR_SIZE,
+                                  .success     = true};
+    trace(state, &event);
+}
+
+void XenoStats_RecordSectors(XenoStatsState *state,
+                             size_t firstSector,
+                             size_t count,
+                             uint64_t begin,
+                             uint64_t end,
+                             bool mapped,
+                             bool success)
+{
+    if (atomic_load_explicit(&state->enabled, memory_order_relaxed))
+    {
+        // With more than one thread reading this is only a rough idea of how much jumping around there is.
+        const size_t previousEnd = atomic_exchange_explicit(&state->nextSector, firstSector + count,
+                                                            memory_order_relaxed);
+        if (previousEnd != firstSector) { add(&state->seekCount, 1); }
+
+        add(&state->sectorsRead, count);
+        add(&state->bytesRead, (uint64_t)count * SECTOR_SIZE);
+        if (mapped) { add(&state->copyNanoseconds, end - begin); }
+        else
+        {
+            add(&state->readCalls, 1);
+            add(&state->ioNanoseconds, end - begin);
+        }
+    }
+
+    const XenoTraceEvent event = {.type        = XENO_TRACE_SECTOR_BATCH,
+                                  .begin       = begin,
+                                  .end         = end,
+                                  .firstSector = (uint32_t)firstSector,
+                                  .sectorCount = (uint32_t)count,
+                                  .bytes       = (uint64_t)count * SECTOR_SIZE,
+                                  .success     = success};
+    trace(state, &event);
+}
+
+void XenoStats_RecordFileRead(XenoStatsState *state,
+                              uint32_t sector,
+                              size_t offset,
+                              size_t length,
+                              uint64_t begin,
+                              bool success)
+{
+    if (success) { XenoStats_RecordDelivered(state, length); }
+
+    // The sectors the range covers, counting from the beginning of the file.
+    const size_t firstSector = offset / DATA_SIZE;
+    const size_t endSector   = length ? (offset + length + DATA_SIZE - 1) / DATA_SIZE : firstSector;
+
+    const XenoTraceEvent event = {.type        = XENO_TRACE_FILE_READ,
+                                  .begin       = begin,
+                                  .end         = state->traceCallback ? XenoTrace_GetTime() : begin,
+                                  .firstSector = sector,
+                                  .sectorCount = (uint32_t)(endSector - firstSector),
+                                  .bytes       = length,
+                                  .success     = success};
+    trace(state, &event);
+}
+
+void XenoStats_RecordCopy(XenoStatsState *state, uint64_t begin, uint64_t end)
+{
+    if (!atomic_load_explicit(&state->enabled, memory_order_relaxed)) { return; }
+
+    add(&state->copyNanoseconds, end - begin);
+}
+
+static void trace(XenoStatsState *state, const XenoTraceEvent *event)
+{
+    if (state->traceCallback) { state->traceCallback(state->traceUserData, event); }
+}
@@ -0,0 +1,294 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoVerify.h"
+
+#include "DynamicArray.h"
+#include "Sector.h"
+#include "SectorEcc.h"
+#include "ThreadPool.h"
+
+#define __XENO_INTERNAL__
+#include "XenoReaderInternal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief Number of sectors each task checks. This is a bit over 1MB.
+#define RUN_SECTOR_COUNT 512
+
+/// @brief What every sector begins with.
+static const unsigned char SYNC_PATTERN[12] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                               0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+
+// clang-format off
+/// @brief One task's share of the image.
+typedef struct
+{
+    /// @brief Reader to read from.
+    XenoReader *reader;
+
+    /// @brief Sectors to check.
+    size_t firstSector;
+    size_t count;
+
+    /// @brief Results. The bad sector array is only made once something is bad.
+    size_t checkedCount;
+    size_t skippedCount;
+    DynamicArray *badSectors;
+
+    /// @brief Set if the bad sector array couldn't be grown.
+    bool failed;
+} VerifyRun;
+
+struct XenoVerifyReport
+{
+    /// @brief Totals.
+    size_t checkedCount;
+    size_t skippedCount;
+
+    /// @brief Bad sectors in sector order.
+    size_t badSectorCount;
+    XenoBadSector *badSectors;
+};
+// clang-format on
+
+// Checks every sector in a run. This is the thread pool task.
+static void verify_run(void *argument);
+
+// Checks a sector. Returns the XENO_SECTOR_* flags of what is wrong with it.
+static uint32_t check_sector(const unsigned char *sector, bool *emptyOut);
+
+// Checks a stored EDC against the bytes before it.
+static bool check_edc(const unsigned char *sector, size_t offset, size_t size, bool zeroMeansNone);
+
+// Adds a bad sector to a run.
+static void add_bad_sector(VerifyRun *run, size_t sector, uint32_t errors);
+
+XenoVerifyReport *XenoReader_VerifyImage(XenoReader *reader, int threadCount)
+{
+    const size_t runCount    = (reader->sectorCount + RUN_SECTOR_COUNT - 1) / RUN_SECTOR_COUNT;
+    VerifyRun *runs          = calloc(runCount ? runCount : 1, sizeof(VerifyRun));
+    XenoVerifyReport *report = calloc(1, sizeof(XenoVerifyReport));
+    if (!runs || !report) { goto Label_error; }
+
+    for (size_t i = 0; i < runCount; i++)
+    {
+        const size_t firstSector = i * RUN_SECTOR_COUNT;
+        const size_t remaining   = reader->sectorCount - firstSector;
+        runs[i].reader           = reader;
+        runs[i].firstSector      = firstSector;
+        runs[i].count            = remaining < RUN_SECTOR_COUNT ? remaining : RUN_SECTOR_COUNT;
+    }
+
+    // If the pool can't be made, everything just runs here.
+    ThreadPool *pool = ThreadPool_Create(threadCount);
+    for (size_t i = 0; i < runCount; i++)
+    {
+        if (!pool || !ThreadPool_Submit(pool, verify_run, &runs[i])) { verify_run(&runs[i]); }
+    }
+    if (pool) { ThreadPool_Free(pool); }
+
+    for (size_t i = 0; i < runCount; i++)
+    {
+        if (runs[i].failed) { goto Label_error; }
+
+        report->checkedCount += runs[i].checkedCount;
+        report->skippedCount += runs[i].skippedCount;
+        report->badSectorCount += runs[i].badSectors ? DynamicArray_GetLength(runs[i].badSectors) : 0;
+    }
+
+    report->badSectors = malloc(sizeof(XenoBadSector) * (report->badSectorCount ? report->badSectorCount : 1));
+    if (!report->badSectors) { goto Label_error; }
+
+    // Runs are in sector order and so is everything in them, so putting them end to end keeps the order.
+    size_t badSectorIndex = 0;
+    for (size_t i = 0; i < runCount; i++)
+    {
+        const int length = runs[i].badSectors ? (int)DynamicArray_GetLength(runs[i].badSectors) : 0;
+        for (int j = 0; j < length; j++)
+        {
+            XenoBadSector *badSector = &report->badSectors[badSectorIndex++];
+            *badSector               = *(XenoBadSector *)DynamicArray_GetElementAt(runs[i].badSectors, j);
+            badSector->file          = XenoReader_FindFileBySector(reader, badSector->sector);
+        }
+
+        DynamicArray_Free(runs[i].badSectors);
+    }
+
+    free(runs);
+
+    return report;
+
+Label_error:
+    for (size_t i = 0; runs && i < runCount; i++) { DynamicArray_Free(runs[i].badSectors); }
+    free(runs);
+    XenoVerifyReport_Free(report);
+
+    return NULL;
+}
+
+void XenoVerifyReport_Free(XenoVerifyReport *report)
+{
+    if (!report) { return; }
+
+    free(report->badSectors);
+    free(report);
+}
+
+size_t XenoVerifyReport_GetCheckedCount(const XenoVerifyReport *report) { return report->checkedCount; }
+
+size_t XenoVerifyReport_GetSkippedCount(const XenoVerifyReport *report) { return report->skippedCount; }
+
+size_t XenoVerifyReport_GetBadSectorCount(const XenoVerifyReport *report) { return report->badSectorCount; }
+
+bool XenoVerifyReport_GetBadSectorAt(const XenoVerifyReport *report, size_t index, XenoBadSector *badSectorOut)
+{
+    if (index >= report->badSectorCount) { return false; }
+
+    *badSectorOut = report->badSectors[index];
+
+    return true;
+}
+
+const char *XenoVerify_GetKernelName(void) { return "Slice-by-8"; }
+
+static void verify_run(void *argument)
+{
+    VerifyRun *run = (VerifyRun *)argument;
+
+    // Mapped images can be checked in place. Everything else is read around the cache.
+    const uint64_t offset     = (uint64_t)run->firstSector * SECTOR_SIZE;
+    const size_t size         = run->count * SECTOR_SIZE;
+    XenoStatsState *stats     = &run->reader->stats;
+    const unsigned char *data = XenoBackend_Map(run->reader->backend, offset, size);
+    unsigned char *buffer     = NULL;
+    if (data && XenoStats_IsActive(stats))
+    {
+        const uint64_t now = XenoTrace_GetTime();
+        XenoStats_RecordSectors(stats, run->firstSector, run->count, now, now, true, true);
+    }
+    else if (!data)
+    {
+        buffer = malloc(size);
+        if (buffer && XenoReader_ReadBackend(run->reader, run->firstSector, run->count, buffer)) { data = buffer; }
+    }
+
+    for (size_t i = 0; i < run->count; i++)
+    {
+        if (!data)
+        {
+            ++run->checkedCount;
+            add_bad_sector(run, run->firstSector + i, XENO_SECTOR_UNREADABLE);
+            continue;
+        }
+
+        bool empty            = false;
+        const uint32_t errors = check_sector(&data[i * SECTOR_SIZE], &empty);
+        if (empty)
+        {
+            ++run->skippedCount;
+            continue;
+        }
+
+        ++run->checkedCount;
+        if (errors) { add_bad_sector(run, run->firstSector + i, errors); }
+    }
+
+    free(buffer);
+}
+
+static uint32_t check_sector(const unsigned char *sector, bool *emptyOut)
+{
+    const Sector *header = (const Sector *)sector;
+
+    // Mode 0 sectors are nothing but zeroes past the header, and there's nothing to check in them. Sectors that were
+    // never written at all are zero all the way through.
+    if (sector[0] == 0 && sector[1] == 0)
+    {
+        size_t i = 0;
+        while (i < SECTOR_SIZE && sector[i] == 0) { i++; }
+        if (i == SECTOR_SIZE)
+        {
+            *emptyOut = true;
+            return 0;
+        }
+    }
+
+    uint32_t errors = memcmp(sector, SYNC_PATTERN, sizeof(SYNC_PATTERN)) != 0 ? XENO_SECTOR_BAD_SYNC : 0;
+
+    bool hasEcc = true;
+    switch (header->header.mode)
+    {
+        case 0:
+            *emptyOut = errors == 0;
+            return errors;
+
+        case 1:
+            if (!check_edc(sector, 0, SECTOR_EDC_MODE_1_SIZE, false)) { errors |= XENO_SECTOR_BAD_EDC; }
+            break;
+
+        case 2:
+            if (header->subHeader[0].subMode & SUBMODE_FORM_2)
+            {
+                if (!check_edc(sector, SECTOR_EDC_FORM_2_OFFSET, SECTOR_EDC_FORM_2_SIZE, true))
+                {
+                    errors |= XENO_SECTOR_BAD_EDC;
+                }
+                hasEcc = false;
+            }
+            else if (!check_edc(sector, SECTOR_EDC_FORM_1_OFFSET, SECTOR_EDC_FORM_1_SIZE, false))
+            {
+                errors |= XENO_SECTOR_BAD_EDC;
+            }
+            break;
+
+        default:
+            return errors | XENO_SECTOR_BAD_MODE;
+    }
+
+    if (hasEcc)
+    {
+        unsigned char parity[SECTOR_ECC_P_SIZE];
+        SectorEcc_ComputeP(sector, parity);
+        if (memcmp(parity, &sector[SECTOR_ECC_P_OFFSET], SECTOR_ECC_P_SIZE) != 0) { errors |= XENO_SECTOR_BAD_ECC_P; }
+
+        SectorEcc_ComputeQ(sector, parity);
+        if (memcmp(parity, &sector[SECTOR_ECC_Q_OFFSET], SECTOR_ECC_Q_SIZE) != 0) { errors |= XENO_SECTOR_BAD_ECC_Q; }
+    }
+
+    return errors;
+}
+
+static bool check_edc(const unsigned char *sector, size_t offset, size_t size, bool zeroMeansNone)
+{
+    const unsigned char *stored = &sector[offset + size];
+    const uint32_t storedEdc    = (uint32_t)stored[0] | (uint32_t)stored[1] << 8 | (uint32_t)stored[2] << 16 |
+                                  (uint32_t)stored[3] << 24;
+
+    // Form 2 is allowed to leave the EDC out.
+    if (zeroMeansNone && storedEdc == 0) { return true; }
+
+    return SectorEcc_ComputeEdc(&sector[offset], size) == storedEdc;
+}
+
+static void add_bad_sector(VerifyRun *run, size_t sector, uint32_t errors)
+{
+    if (!run->badSectors) { run->badSectors = DynamicArray_Create(sizeof(XenoBadSector), 16); }
+
+    XenoBadSector *badSector = run->badSectors ? DynamicArray_New(run->badSectors) : NULL;
+    if (!badSector)
+    {
+        run->failed = true;
+        return;
+    }
+
+    badSector->sector = (uint32_t)sector;
+    badSector->errors = errors;
+    badSector->file   = NULL;
+}
@@ -0,0 +1,274 @@
+/*
+ *      This file is part of the XenoReader library
+ *      Copyright (c) 2025 JK
+ *
+ *      Licensed under the MIT License.
+ *      See the included LICENSE file for license and attribution details.
+ */
+
+#include "XenoXa.h"
+
+#include "Sector.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+/// @brief Number of sectors read at a time.
+#define CHUNK_SECTOR_COUNT 128
+
+/// @brief Every Form 2 audio sector has this many sound groups.
+#define GROUP_COUNT 18
+
+/// @brief Size of a sound group. 16 bytes of parameters and 112 bytes of samples.
+#define GROUP_SIZE 128
+
+/// @brief Offset of the samples in a group.
+#define GROUP_HEADER_SIZE 16
+
+/// @brief Every sound unit decodes to this many samples.
+#define UNIT_SAMPLE_COUNT 28
+
+/// @brief Number of units in a group when it's 4 bit. 8 bit has half as many.
+#define MAX_UNIT_COUNT 8
+
+/// @brief Most samples one sector can decode to.
+#define MAX_SECTOR_SAMPLES (GROUP_COUNT * MAX_UNIT_COUNT * UNIT_SAMPLE_COUNT)
+
+/// @brief Shifts past this are invalid. Hardware treats them as 9.
+#define MAX_SHIFT 12
+
+static_assert(GROUP_COUNT * GROUP_SIZE <= FORM_2_DATA_SIZE, "Sound groups don't fit in a Form 2 sector");
+
+// clang-format off
+/// @brief Decoder state of one stream.
+typedef struct
+{
+    /// @brief Identifies the stream.
+    uint8_t fileNumber;
+    uint8_t channelNumber;
+
+    /// @brief The last two samples decoded for each channel. The filters are applied with these.
+    int32_t history[2][2];
+} XaStream;
+// clang-format on
+
+/// @brief Filter coefficients. These are out of 64.
+static const int32_t FILTER_POSITIVE[4] = {0, 60, 115, 98};
+static const int32_t FILTER_NEGATIVE[4] = {0, 0, -52, -55};
+
+// Finds the stream for the file and channel or adds one.
+static XaStream *get_stream(XaStream **streams, int *streamCount, int *streamCapacity, uint8_t file, uint8_t channel);
+
+// Decodes the sound groups of one sector. Returns the number of frames.
+static size_t decode_sector(const Sector *sector, XaStream *stream, const XenoXaBlock *block, int16_t *samplesOut);
+
+// Expands the samples of every unit of a 4 bit group to 16 bits before filtering. Row is sample, column is unit.
+static void expand_group_4bit(const unsigned char *group, int16_t expanded[UNIT_SAMPLE_COUNT][MAX_UNIT_COUNT]);
+
+// Same, but 8 bit. Only the first four columns are used.
+static void expand_group_8bit(const unsigned char *group, int16_t expanded[UNIT_SAMPLE_COUNT][MAX_UNIT_COUNT]);
+
+// Returns the shift in the parameter. Shifts past the last valid one are treated the way the hardware treats them.
+static inline int get_unit_shift(uint8_t parameter);
+
+// Returns how much a 4 bit sample needs to be multiplied by to apply the shift in the parameter.
+static inline int16_t get_unit_scale(uint8_t parameter);
+
+bool XenoReader_DemuxXa(XenoReader *reader, size_t firstSector, size_t count, XenoXaCallback callback, void *userData)
+{
+    const size_t sectorCount = XenoReader_GetSectorCount(reader);
+    if (firstSector > sectorCount || count > sectorCount - firstSector) { return false; }
+
+    Sector *chunk     = malloc(sizeof(Sector) * CHUNK_SECTOR_COUNT);
+    int16_t *samples  = malloc(sizeof(int16_t) * MAX_SECTOR_SAMPLES);
+    XaStream *streams = NULL;
+    int streamCount   = 0;
+    int capacity      = 0;
+    bool success      = chunk && samples;
+
+    for (size_t i = 0; success && i < count; i += CHUNK_SECTOR_COUNT)
+    {
+        const size_t chunkCount = count - i < CHUNK_SECTOR_COUNT ? count - i : CHUNK_SECTOR_COUNT;
+        success                 = XenoReader_ReadRawSectors(reader, firstSector + i, chunkCount, chunk);
+
+        for (size_t j = 0; success && j < chunkCount; j++)
+        {
+            // Only Form 2 audio sectors matter. Everything else in the run is just skipped over.
+            const Sector *sector       = &chunk[j];
+            const SectorSubHeader *sub = &sector->subHeader[0];
+            const uint8_t audioForm2   = SUBMODE_AUDIO | SUBMODE_FORM_2;
+            if (sector->header.mode != 2 || (sub->subMode & audioForm2) != audioForm2) { continue; }
+
+            XaStream *stream = get_stream(&streams, &streamCount, &capacity, sub->fileNumber, sub->channelNumber);
+            if (!stream)
+            {
+                success = false;
+                break;
+            }
+
+            const XenoXaBlock block = {.fileNumber    = sub->fileNumber,
+                                       .channelNumber = sub->channelNumber,
+                                       .sector        = (uint32_t)(firstSector + i + j),
+                                       .sampleRate    = (sub->codingInfo & 0x04) ? 18900 : 37800,
+                                       .channelCount  = (sub->codingInfo & 0x01) ? 2 : 1,
+                                       .bitsPerSample = (sub->codingInfo & 0x10) ? 8 : 4,
+                                       .endOfStream   = (sub->subMode & SUBMODE_END_OF_FILE) != 0};
+
+            const size_t frameCount = decode_sector(sector, stream, &block, samples);
+            success                 = callback(userData, &block, samples, frameCount);
+
+            // Whatever comes next on this file and channel is a different stream.
+            if (block.endOfStream) { memset(stream->history, 0, sizeof(stream->history)); }
+        }
+    }
+
+    free(streams);
+    free(samples);
+    free(chunk);
+
+    return success;
+}
+
+const char *XenoXa_GetKernelName(void)
+{
+#ifdef __SSE2__
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+static XaStream *get_stream(XaStream **streams, int *streamCount, int *streamCapacity, uint8_t file, uint8_t channel)
+{
+    // There are only ever a handful of these at once, so a linear search is fine.
+    for (int i = 0; i < *streamCount; i++)
+    {
+        XaStream *stream = &(*streams)[i];
+        if (stream->fileNumber == file && stream->channelNumber == channel) { return stream; }
+    }
+
+    if (*streamCount == *streamCapacity)
+    {
+        const int newCapacity = *streamCapacity ? *streamCapacity * 2 : 8;
+        XaStream *newStreams  = realloc(*streams, sizeof(XaStream) * newCapacity);
+        if (!newStreams) { return NULL; }
+
+        *streams        = newStreams;
+        *streamCapacity = newCapacity;
+    }
+
+    XaStream *stream = &(*streams)[(*streamCount)++];
+    *stream          = (XaStream){.fileNumber = file, .channelNumber = channel};
+
+    return stream;
+}
+
+static size_t decode_sector(const Sector *sector, XaStream *stream, const XenoXaBlock *block, int16_t *samplesOut)
+{
+    // Form 2 data begins right where Form 1 data does. It just runs into the space the ECC would take.
+    const unsigned char *data   = (const unsigned char *)sector + offsetof(Sector, data);
+    const int unitCount         = block->bitsPerSample == 4 ? MAX_UNIT_COUNT : MAX_UNIT_COUNT / 2;
+    const int channels          = (int)block->channelCount;
+    const size_t framesPerGroup = (size_t)unitCount * UNIT_SAMPLE_COUNT / channels;
+
+    int16_t expanded[UNIT_SAMPLE_COUNT][MAX_UNIT_COUNT];
+    for (int group = 0; group < GROUP_COUNT; group++)
+    {
+        const unsigned char *groupData = &data[group * GROUP_SIZE];
+        if (block->bitsPerSample == 4) { expand_group_4bit(groupData, expanded); }
+        else { expand_group_8bit(groupData, expanded); }
+
+        // The filter depends on the last two samples, so this part can't be done in parallel. Stereo units alternate.
+        for (int unit = 0; unit < unitCount; unit++)
+        {
+            const int channel  = unit % channels;
+            const int filter   = (groupData[4 + unit] >> 4) & 0x03;
+            int32_t *history   = stream->history[channel];
+            const size_t frame = group * framesPerGroup + (size_t)(unit / channels) * UNIT_SAMPLE_COUNT;
+            int16_t *out       = &samplesOut[frame * channels + channel];
+
+            for (int i = 0; i < UNIT_SAMPLE_COUNT; i++)
+            {
+                const int32_t prediction = history[0] * FILTER_POSITIVE[filter] + history[1] * FILTER_NEGATIVE[filter];
+                int32_t sample           = expanded[i][unit] + ((prediction + 32) >> 6);
+                sample                   = sample > INT16_MAX ? INT16_MAX : sample < INT16_MIN ? INT16_MIN : sample;
+
+                history[1]        = history[0];
+                history[0]        = sample;
+                out[i * channels] = (int16_t)sample;
+            }
+        }
+    }
+
+    return GROUP_COUNT * framesPerGroup;
+}
+
+static void expand_group_4bit(const unsigned char *group, int16_t expanded[UNIT_SAMPLE_COUNT][MAX_UNIT_COUNT])
+{
+    // Parameters for units 0 through 3 are at 4 through 7 and 4 through 7 are at 8 through 11.
+    int16_t scales[MAX_UNIT_COUNT];
+    for (int unit = 0; unit < MAX_UNIT_COUNT; unit++) { scales[unit] = get_unit_scale(group[4 + unit]); }
+
+    // Every 4 byte row has one sample of each unit. Even units are in the low nibbles and odd units are in the high.
+#ifdef __SSE2__
+    // Each byte is spread into two lanes. Multiplying moves the nibble the lane wants to the top so it can be sign
+    // extended. Then it's scaled by the unit's shift.
+    const __m128i nibbleScales = _mm_setr_epi16(4096, 256, 4096, 256, 4096, 256, 4096, 256);
+    const __m128i topNibble    = _mm_set1_epi16((short)0xF000);
+    const __m128i unitScales   = _mm_loadu_si128((const __m128i *)scales);
+    for (int i = 0; i < UNIT_SAMPLE_COUNT; i++)
+    {
+        int32_t row;
+        memcpy(&row, &group[GROUP_HEADER_SIZE + i * 4], sizeof(int32_t));
+
+        const __m128i bytes   = _mm_cvtsi32_si128(row);
+        const __m128i words   = _mm_unpacklo_epi8(bytes, bytes);
+        const __m128i lanes   = _mm_unpacklo_epi16(words, words);
+        const __m128i nibbles = _mm_and_si128(_mm_mullo_epi16(lanes, nibbleScales), topNibble);
+        const __m128i samples = _mm_mullo_epi16(_mm_srai_epi16(nibbles, 12), unitScales);
+        _mm_storeu_si128((__m128i *)expanded[i], samples);
+    }
+#else
+    for (int i = 0; i < UNIT_SAMPLE_COUNT; i++)
+    {
+        for (int unit = 0; unit < MAX_UNIT_COUNT; unit++)
+        {
+            const uint8_t byte  = group[GROUP_HEADER_SIZE + i * 4 + unit / 2];
+            const int8_t nibble = (int8_t)(unit & 1 ? byte & 0xF0 : byte << 4) >> 4;
+            expanded[i][unit]   = (int16_t)(nibble * scales[unit]);
+        }
+    }
+#endif
+}
+
+static void expand_group_8bit(const unsigned char *group, int16_t expanded[UNIT_SAMPLE_COUNT][MAX_UNIT_COUNT])
+{
+    // This is rare enough that it isn't worth vectorizing. Shifts past 8 drop bits off the bottom of the sample, so
+    // unlike 4 bit samples this can't be done with a multiply.
+    for (int unit = 0; unit < MAX_UNIT_COUNT / 2; unit++)
+    {
+        const int shift = get_unit_shift(group[4 + unit]);
+        for (int i = 0; i < UNIT_SAMPLE_COUNT; i++)
+        {
+            const int32_t sample = (int8_t)group[GROUP_HEADER_SIZE + i * 4 + unit] * 256;
+            expanded[i][unit]    = (int16_t)(sample >> shift);
+        }
+    }
+}
+
+static inline int get_unit_shift(uint8_t parameter)
+{
+    const int shift = parameter & 0x0F;
+    return shift > MAX_SHIFT ? 9 : shift;
+}
+
+static inline int16_t get_unit_scale(uint8_t parameter)
+{
+    // The sample is placed at the top of 16 bits and then shifted right. Multiplying the signed sample is the same.
+    return (int16_t)(1 << (MAX_SHIFT - get_unit_shift(parameter)));
+}